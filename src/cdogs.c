@@ -77,12 +77,14 @@
 #include <cdogs/pickup.h>
 #include <cdogs/pics.h>
 #include <cdogs/player_template.h>
+#include <cdogs/profiler.h>
 #include <cdogs/sounds.h>
 #include <cdogs/triggers.h>
 #include <cdogs/utils.h>
 
 #include "autosave.h"
 #include "credits.h"
+#include "headless.h"
 #include "mainmenu.h"
 #include "player_select_menus.h"
 #include "prep.h"
@@ -167,6 +169,24 @@ static void PrintHelp(void)
 		LogLevelName(LL_TRACE), LogLevelName(LL_ERROR)
 	);
 
+	printf("%s\n",
+		"Headless Options:\n"
+		"    --headless       Run a mission with AI players and no video,\n"
+		"                       sound or input, then print timings.\n"
+		"                       Needs a campaign file argument.\n"
+		"    --ticks=n        Stop after n game ticks (0 = until mission end)\n"
+		"    --seed=n         Random seed for a repeatable run\n"
+		"    --mission=n      Mission index to run, starting from 0\n"
+		"    --players=n      Number of AI players, 1-4\n"
+	);
+
+	printf("%s\n",
+		"Profiling:\n"
+		"    --profile=file   Write per-frame section times, in\n"
+		"                       microseconds, to a CSV file.\n"
+		"    Set Interface.ShowProfiler to show a graph in-game.\n"
+	);
+
 	printf("%s\n",
 		"Other:\n"
 		"    --connect=host   (Experimental) connect to a game server\n"
@@ -192,6 +212,7 @@ int main(int argc, char *argv[])
 	const char *loadCampaign = NULL;
 	ENetAddress connectAddr;
 	memset(&connectAddr, 0, sizeof connectAddr);
+	HeadlessOptionsInit(&gHeadless);
 
 	srand((unsigned int)time(NULL));
 
@@ -227,6 +248,12 @@ int main(int argc, char *argv[])
 			{"connect",		required_argument,	NULL,	'x'},
 			{"debug",		required_argument,	NULL,	'd'},
 			{"log",			required_argument,	NULL,	1000},
+			{"headless",	no_argument,		NULL,	1001},
+			{"ticks",		required_argument,	NULL,	1002},
+			{"seed",		required_argument,	NULL,	1003},
+			{"mission",		required_argument,	NULL,	1004},
+			{"players",		required_argument,	NULL,	1005},
+			{"profile",		required_argument,	NULL,	1006},
 			{"help",		no_argument,		NULL,	'h'},
 			{0,				0,					NULL,	0}
 		};
@@ -294,6 +321,24 @@ int main(int argc, char *argv[])
 					printf("Logging %s at %s\n", optarg, LogLevelName(ll));
 				}
 				break;
+			case 1001:
+				gHeadless.Enabled = true;
+				break;
+			case 1002:
+				gHeadless.Ticks = MAX(atoi(optarg), 0);
+				break;
+			case 1003:
+				gHeadless.Seed = (unsigned int)strtoul(optarg, NULL, 10);
+				break;
+			case 1004:
+				gHeadless.Mission = atoi(optarg);
+				break;
+			case 1005:
+				gHeadless.Players = atoi(optarg);
+				break;
+			case 1006:
+				ProfilerOpenCSV(&gProfiler, optarg);
+				break;
 			case 'x':
 				if (enet_address_set_host(&connectAddr, optarg) != 0)
 				{
@@ -323,7 +368,9 @@ int main(int argc, char *argv[])
 
 	debug(D_NORMAL, "Initialising SDL...\n");
 	// if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_AUDIO | SDL_INIT_VIDEO | js_flag) != 0)
-	if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_AUDIO | js_flag) != 0)
+	const Uint32 sdlFlags =
+		gHeadless.Enabled ? 0 : (SDL_INIT_AUDIO | js_flag);
+	if (SDL_Init(SDL_INIT_TIMER | sdlFlags) != 0)
 	{
 		fprintf(stderr, "Could not initialise SDL: %s\n", SDL_GetError());
 		err = EXIT_FAILURE;
@@ -345,11 +392,14 @@ int main(int argc, char *argv[])
 
 	GetDataFilePath(buf, "sounds");
 	//#if !defined(__RS97__)
+	if (!gHeadless.Enabled)
+	{
 		SoundInitialize(&gSoundDevice, buf);
 		if (!gSoundDevice.isInitialised)
 		{
 			printf("Sound initialization failed!\n");
 		}
+	}
 	//#endif
 
 	LoadHighScores();
@@ -378,14 +428,25 @@ int main(int argc, char *argv[])
 	memcpy(origPalette, gPicManager.palette, sizeof(origPalette));
 
 	GraphicsInit(&gGraphicsDevice, &gConfig);
-	SDL_InitSubSystem(SDL_INIT_VIDEO);
-
-	GraphicsInitialize(&gGraphicsDevice, forceResolution);
-	if (!gGraphicsDevice.IsInitialized)
+	if (gHeadless.Enabled)
+	{
+		GraphicsInitializeHeadless(&gGraphicsDevice);
+	}
+	else
 	{
-		printf("Cannot initialise video; trying default config\n");
-		ConfigResetDefault(ConfigGet(&gConfig, "Graphics"));
+		SDL_InitSubSystem(SDL_INIT_VIDEO);
+
 		GraphicsInitialize(&gGraphicsDevice, forceResolution);
+		if (!gGraphicsDevice.IsInitialized)
+		{
+			printf("Cannot initialise video; trying default config\n");
+			Config *graphics = ConfigGet(&gConfig, "Graphics");
+			ConfigResetDefault(graphics);
+			// Apply the defaults so that listeners, such as the graphics
+			// device's cached brightness and scale mode, see them
+			ConfigSetChanged(graphics);
+			GraphicsInitialize(&gGraphicsDevice, forceResolution);
+		}
 	}
 	if (!gGraphicsDevice.IsInitialized)
 	{
@@ -416,7 +477,11 @@ int main(int argc, char *argv[])
 	LoadAllCampaigns(&campaigns);
 	PlayerDataInit(&gPlayerDatas);
 
-	GrafxMakeRandomBackground(&gGraphicsDevice, &gCampaign, &gMission, &gMap);
+	if (!gHeadless.Enabled)
+	{
+		GrafxMakeRandomBackground(
+			&gGraphicsDevice, &gCampaign, &gMission, &gMap);
+	}
 
 	debug(D_NORMAL, ">> Entering main loop\n");
 	// Attempt to pre-load campaign if requested
@@ -444,7 +509,17 @@ int main(int argc, char *argv[])
 			ScreenWaitForCampaignDef();
 		}
 	}
-	MainLoop(&creditsDisplayer, &campaigns);
+	if (gHeadless.Enabled)
+	{
+		if (!HeadlessRun(&gHeadless))
+		{
+			err = EXIT_FAILURE;
+		}
+	}
+	else
+	{
+		MainLoop(&creditsDisplayer, &campaigns);
+	}
 
 bail:
 	debug(D_NORMAL, ">> Shutting down...\n");
@@ -459,6 +534,7 @@ bail:
 	MissionOptionsTerminate(&gMission);
 
 	NetClientTerminate(&gNetClient);
+	ProfilerTerminate(&gProfiler);
 	atexit(enet_deinitialize);
 	EventTerminate(&gEventHandlers);
 	GraphicsTerminate(&gGraphicsDevice);
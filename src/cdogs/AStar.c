@@ -504,10 +504,7 @@ ASPath ASPathCreate(const ASPathNodeSource *source, void *context, void *startNo
             n = GetParentNode(n);
         }
         
-        CMALLOC(path, sizeof(struct __ASPath) + (count * source->nodeSize));
-        path->nodeSize = source->nodeSize;
-        path->count = count;
-        path->cost = GetNodeCost(current);
+        path = ASPathNew(source->nodeSize, count, GetNodeCost(current));
         
         n = current;
         for (i=count; i>0; i--) {
@@ -522,6 +519,16 @@ ASPath ASPathCreate(const ASPathNodeSource *source, void *context, void *startNo
     return path;
 }
 
+ASPath ASPathNew(size_t nodeSize, size_t count, float cost)
+{
+    ASPath path;
+    CMALLOC(path, sizeof(struct __ASPath) + (count * nodeSize));
+    path->nodeSize = nodeSize;
+    path->count = count;
+    path->cost = cost;
+    return path;
+}
+
 void ASPathDestroy(ASPath path)
 {
     CFREE(path);
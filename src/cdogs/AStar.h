@@ -53,6 +53,9 @@ void ASNeighborListAdd(ASNeighborList neighbors, void *node, float edgeCost);
 // as a path is created, the relevant nodes are copied into the path
 ASPath ASPathCreate(const ASPathNodeSource *nodeSource, void *context, void *startNode, void *goalNode);
 
+// creates an empty path of count nodes, for other searchers to fill in using ASPathGetNode()
+ASPath ASPathNew(size_t nodeSize, size_t count, float cost);
+
 // paths created with ASPathCreate() must be destroyed or else it will leak memory
 void ASPathDestroy(ASPath path);
 
@@ -198,9 +198,9 @@ Vec2i PlacePlayer(
 		aa.FullPos = PlaceActor(map);
 	}
 
-	GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD);
-	e.u.ActorAdd = aa;
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_ADD);
+	e->u.ActorAdd = aa;
+	GameEventsCommit(&gGameEvents, e);
 
 	if (pumpEvents)
 	{
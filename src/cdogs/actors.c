@@ -68,14 +68,24 @@
 #include "sounds.h"
 #include "defs.h"
 #include "objs.h"
+#include "path_cache.h"
 #include "pickup.h"
 #include "gamedata.h"
 #include "triggers.h"
+#include "uid_map.h"
 #include "hiscores.h"
 #include "mission.h"
 #include "game.h"
 #include "utils.h"
 
+static ConfigHandle sGameAmmo = CONFIG_HANDLE("Game.Ammo");
+static ConfigHandle sGameFireMoveStyle = CONFIG_HANDLE("Game.FireMoveStyle");
+static ConfigHandle sGameFriendlyFire = CONFIG_HANDLE("Game.FriendlyFire");
+static ConfigHandle sGameSwitchMoveStyle =
+	CONFIG_HANDLE("Game.SwitchMoveStyle");
+static ConfigHandle sInterfaceAIChatter = CONFIG_HANDLE("Interface.AIChatter");
+static ConfigHandle sSoundFootsteps = CONFIG_HANDLE("Sound.Footsteps");
+
 #define FOOTSTEP_DISTANCE_PLUS 380
 #define REPEL_STRENGTH 14
 #define SLIDE_LOCK 50
@@ -100,7 +110,10 @@ TranslationTable tablePurple;
 
 
 CArray gActors;
+SlotPool gActorSlots;
 static unsigned int sActorUIDs = 0;
+// Destroyed actors can still be found by UID until their slot is reused
+static UIDMap sActorIndices;
 
 static Animation animIdling =
 {
@@ -363,6 +376,7 @@ void UpdateActorState(TActor * actor, int ticks)
 		actor->MoveVel = Vec2iZero();
 		actor->stateCounter = 4;
 		actor->tileItem.flags = 0;
+		MapUpdateTileItem(&gMap, &actor->tileItem);
 		return;
 	}
 
@@ -389,7 +403,7 @@ void UpdateActorState(TActor * actor, int ticks)
 	// Footstep sounds
 	// Step on 1
 	// TODO: custom animation and footstep frames
-	if (ConfigGetBool(&gConfig, "Sound.Footsteps") &&
+	if (ConfigHandleGetBool(&sSoundFootsteps) &&
 		AnimationGetFrame(&actor->anim) == STATE_WALKING_1 &&
 		actor->anim.newFrame)
 	{
@@ -452,21 +466,22 @@ bool TryMoveActor(TActor *actor, Vec2i pos)
 				if (CanHit(actor->flags, actor->uid, target))
 				{
 					// Tell the server that we want to melee something
-					GameEvent e = GameEventNew(GAME_EVENT_ACTOR_MELEE);
-					e.u.Melee.UID = actor->uid;
-					strcpy(e.u.Melee.BulletClass, gun->Gun->Bullet->Name);
-					e.u.Melee.TargetKind = target->kind;
+					GameEvent *e =
+						GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_MELEE);
+					e->u.Melee.UID = actor->uid;
+					strcpy(e->u.Melee.BulletClass, gun->Gun->Bullet->Name);
+					e->u.Melee.TargetKind = target->kind;
 					switch (target->kind)
 					{
 					case KIND_CHARACTER:
-						e.u.Melee.TargetUID =
+						e->u.Melee.TargetUID =
 							((const TActor *)CArrayGet(&gActors, target->id))->uid;
-						e.u.Melee.HitType = HIT_FLESH;
+						e->u.Melee.HitType = HIT_FLESH;
 						break;
 					case KIND_OBJECT:
-						e.u.Melee.TargetUID =
+						e->u.Melee.TargetUID =
 							((const TObject *)CArrayGet(&gObjs, target->id))->uid;
-						e.u.Melee.HitType = HIT_OBJECT;
+						e->u.Melee.HitType = HIT_OBJECT;
 						break;
 					default:
 						CASSERT(false, "cannot damage target kind");
@@ -478,9 +493,9 @@ bool TryMoveActor(TActor *actor, Vec2i pos)
 					}
 					else
 					{
-						e.u.Melee.HitType = (int)HIT_NONE;
+						e->u.Melee.HitType = (int)HIT_NONE;
 					}
-					GameEventsEnqueue(&gGameEvents, e);
+					GameEventsCommit(&gGameEvents, e);
 				}
 				return false;
 			}
@@ -660,10 +675,10 @@ static void CheckTrigger(const Vec2i tilePos)
 		Trigger **tp = CArrayGet(&t->triggers, i);
 		if (TriggerCanActivate(*tp, gMission.KeyFlags))
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_TRIGGER);
-			e.u.TriggerEvent.ID = (*tp)->id;
-			e.u.TriggerEvent.Tile = Vec2i2Net(tilePos);
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_TRIGGER);
+			e->u.TriggerEvent.ID = (*tp)->id;
+			e->u.TriggerEvent.Tile = Vec2i2Net(tilePos);
+			GameEventsCommit(&gGameEvents, e);
 		}
 	}
 }
@@ -710,9 +725,11 @@ static void CheckRescue(const TActor *a)
 		if (other->flags & FLAGS_PRISONER)
 		{
 			other->flags &= ~FLAGS_PRISONER;
-			GameEvent e = GameEventNew(GAME_EVENT_RESCUE_CHARACTER);
-			e.u.Rescue.UID = other->uid;
-			GameEventsEnqueue(&gGameEvents, e);
+			MapUpdateTileItem(&gMap, &other->tileItem);
+			GameEvent *e =
+				GameEventsAdd(&gGameEvents, GAME_EVENT_RESCUE_CHARACTER);
+			e->u.Rescue.UID = other->uid;
+			GameEventsCommit(&gGameEvents, e);
 			UpdateMissionObjective(
 				&gMission, other->tileItem.flags, OBJECTIVE_RESCUE);
 		}
@@ -812,7 +829,7 @@ void ActorSetAIState(TActor *actor, const AIState s)
 {
 	if (AIContextSetState(actor->aiContext, s) &&
 		AIContextShowChatter(
-		actor->aiContext, ConfigGetEnum(&gConfig, "Interface.AIChatter")))
+		actor->aiContext, ConfigHandleGetEnum(&sInterfaceAIChatter)))
 	{
 		// Say something for a while
 		strcpy(actor->Chatter, AIStateGetChatterText(actor->aiContext->State));
@@ -825,7 +842,7 @@ void Shoot(TActor *actor)
 	Weapon *gun = ActorGetGun(actor);
 	if (!ActorCanFire(actor))
 	{
-		if (!WeaponIsLocked(gun) && ConfigGetBool(&gConfig, "Game.Ammo"))
+		if (!WeaponIsLocked(gun) && ConfigHandleGetBool(&sGameAmmo))
 		{
 			CASSERT(ActorGunGetAmmo(actor, gun) == 0, "should be out of ammo");
 			// Play a clicking sound if this gun is out of ammo
@@ -848,22 +865,23 @@ void Shoot(TActor *actor)
 		actor->uid);
 	if (actor->PlayerUID >= 0)
 	{
-		if (ConfigGetBool(&gConfig, "Game.Ammo") && gun->Gun->AmmoId >= 0)
+		if (ConfigHandleGetBool(&sGameAmmo) && gun->Gun->AmmoId >= 0)
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_ACTOR_USE_AMMO);
-			e.u.UseAmmo.UID = actor->uid;
-			e.u.UseAmmo.PlayerUID = actor->PlayerUID;
-			e.u.UseAmmo.AmmoId = gun->Gun->AmmoId;
-			e.u.UseAmmo.Amount = 1;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e =
+				GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_USE_AMMO);
+			e->u.UseAmmo.UID = actor->uid;
+			e->u.UseAmmo.PlayerUID = actor->PlayerUID;
+			e->u.UseAmmo.AmmoId = gun->Gun->AmmoId;
+			e->u.UseAmmo.Amount = 1;
+			GameEventsCommit(&gGameEvents, e);
 		}
 		else if (gun->Gun->Cost != 0)
 		{
 			// Classic C-Dogs score consumption
-			GameEvent e = GameEventNew(GAME_EVENT_SCORE);
-			e.u.Score.PlayerUID = actor->PlayerUID;
-			e.u.Score.Score = -gun->Gun->Cost;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_SCORE);
+			e->u.Score.PlayerUID = actor->PlayerUID;
+			e->u.Score.Score = -gun->Gun->Cost;
+			GameEventsCommit(&gGameEvents, e);
 		}
 	}
 }
@@ -874,15 +892,15 @@ static bool ActorTryChangeDirection(
 	const bool willChangeDirecton =
 		!actor->petrified &&
 		CMD_HAS_DIRECTION(cmd) &&
-		(!(cmd & CMD_BUTTON2) || ConfigGetEnum(&gConfig, "Game.SwitchMoveStyle") != SWITCHMOVE_STRAFE) &&
-		(!(prevCmd & CMD_BUTTON1) || ConfigGetEnum(&gConfig, "Game.FireMoveStyle") != FIREMOVE_STRAFE);
+		(!(cmd & CMD_BUTTON2) || ConfigHandleGetEnum(&sGameSwitchMoveStyle) != SWITCHMOVE_STRAFE) &&
+		(!(prevCmd & CMD_BUTTON1) || ConfigHandleGetEnum(&sGameFireMoveStyle) != FIREMOVE_STRAFE);
 	const direction_e dir = CmdToDirection(cmd);
 	if (willChangeDirecton && dir != actor->direction)
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_ACTOR_DIR);
-		e.u.ActorDir.UID = actor->uid;
-		e.u.ActorDir.Dir = (int32_t)dir;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_DIR);
+		e->u.ActorDir.UID = actor->uid;
+		e->u.ActorDir.Dir = (int32_t)dir;
+		GameEventsCommit(&gGameEvents, e);
 		// Change direction immediately because this affects shooting
 		actor->direction = dir;
 	}
@@ -898,10 +916,10 @@ int ActorTryShoot(TActor *actor, int cmd)
 	}
 	else if (ActorGetGun(actor)->state != GUNSTATE_READY)
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_GUN_STATE);
-		e.u.GunState.ActorUID = actor->uid;
-		e.u.GunState.State = GUNSTATE_READY;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_GUN_STATE);
+		e->u.GunState.ActorUID = actor->uid;
+		e->u.GunState.State = GUNSTATE_READY;
+		GameEventsCommit(&gGameEvents, e);
 	}
 	return willShoot;
 }
@@ -925,10 +943,11 @@ void CommandActor(TActor * actor, int cmd, int ticks)
 			// Idle if player hasn't done anything
 			if (actor->anim.Type != ACTORANIMATION_IDLE)
 			{
-				GameEvent e = GameEventNew(GAME_EVENT_ACTOR_STATE);
-				e.u.ActorState.UID = actor->uid;
-				e.u.ActorState.State = (int32_t)ACTORANIMATION_IDLE;
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEvent *e =
+					GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_STATE);
+				e->u.ActorState.UID = actor->uid;
+				e->u.ActorState.State = (int32_t)ACTORANIMATION_IDLE;
+				GameEventsCommit(&gGameEvents, e);
 			}
 		}
 	}
@@ -945,10 +964,11 @@ void CommandActor(TActor * actor, int cmd, int ticks)
 			// Special: pick up things that can only be picked up on demand
 			if (!actor->PickupAll)
 			{
-				GameEvent e = GameEventNew(GAME_EVENT_ACTOR_PICKUP_ALL);
-				e.u.ActorPickupAll.UID = actor->uid;
-				e.u.ActorPickupAll.PickupAll = true;
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEvent *e =
+					GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_PICKUP_ALL);
+				e->u.ActorPickupAll.UID = actor->uid;
+				e->u.ActorPickupAll.PickupAll = true;
+				GameEventsCommit(&gGameEvents, e);
 			}
 			actor->PickupAll = true;
 		}
@@ -958,10 +978,11 @@ void CommandActor(TActor * actor, int cmd, int ticks)
 		actor->specialCmdDir = false;
 		if (actor->PickupAll)
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_ACTOR_PICKUP_ALL);
-			e.u.ActorPickupAll.UID = actor->uid;
-			e.u.ActorPickupAll.PickupAll = false;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e =
+				GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_PICKUP_ALL);
+			e->u.ActorPickupAll.UID = actor->uid;
+			e->u.ActorPickupAll.PickupAll = false;
+			GameEventsCommit(&gGameEvents, e);
 		}
 		actor->PickupAll = false;
 	}
@@ -969,9 +990,9 @@ void CommandActor(TActor * actor, int cmd, int ticks)
 static bool ActorTryMove(TActor *actor, int cmd, int hasShot, int ticks)
 {
 	const bool canMoveWhenShooting =
-		ConfigGetEnum(&gConfig, "Game.FireMoveStyle") != FIREMOVE_STOP ||
+		ConfigHandleGetEnum(&sGameFireMoveStyle) != FIREMOVE_STOP ||
 		!hasShot ||
-		(ConfigGetEnum(&gConfig, "Game.SwitchMoveStyle") == SWITCHMOVE_STRAFE &&
+		(ConfigHandleGetEnum(&sGameSwitchMoveStyle) == SWITCHMOVE_STRAFE &&
 		(cmd & CMD_BUTTON2));
 	const bool willMove =
 		!actor->petrified && CMD_HAS_DIRECTION(cmd) && canMoveWhenShooting;
@@ -998,31 +1019,31 @@ static bool ActorTryMove(TActor *actor, int cmd, int hasShot, int ticks)
 
 		if (actor->anim.Type != ACTORANIMATION_WALKING)
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_ACTOR_STATE);
-			e.u.ActorState.UID = actor->uid;
-			e.u.ActorState.State = (int32_t)ACTORANIMATION_WALKING;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_STATE);
+			e->u.ActorState.UID = actor->uid;
+			e->u.ActorState.State = (int32_t)ACTORANIMATION_WALKING;
+			GameEventsCommit(&gGameEvents, e);
 		}
 	}
 	else
 	{
 		if (actor->anim.Type != ACTORANIMATION_IDLE)
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_ACTOR_STATE);
-			e.u.ActorState.UID = actor->uid;
-			e.u.ActorState.State = (int32_t)ACTORANIMATION_IDLE;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_STATE);
+			e->u.ActorState.UID = actor->uid;
+			e->u.ActorState.State = (int32_t)ACTORANIMATION_IDLE;
+			GameEventsCommit(&gGameEvents, e);
 		}
 	}
 
 	// If we have changed our move commands, send the move event
 	if (cmd != actor->lastCmd || actor->hasCollided)
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_ACTOR_MOVE);
-		e.u.ActorMove.UID = actor->uid;
-		e.u.ActorMove.Pos = Vec2i2Net(actor->Pos);
-		e.u.ActorMove.MoveVel = Vec2i2Net(actor->MoveVel);
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_MOVE);
+		e->u.ActorMove.UID = actor->uid;
+		e->u.ActorMove.Pos = Vec2i2Net(actor->Pos);
+		e->u.ActorMove.MoveVel = Vec2i2Net(actor->MoveVel);
+		GameEventsCommit(&gGameEvents, e);
 	}
 
 	return willMove;
@@ -1044,15 +1065,15 @@ void SlideActor(TActor *actor, int cmd)
 		cmd = CmdGetReverse(cmd);
 	}
 
-	GameEvent e = GameEventNew(GAME_EVENT_ACTOR_SLIDE);
-	e.u.ActorSlide.UID = actor->uid;
+	GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_SLIDE);
+	e->u.ActorSlide.UID = actor->uid;
 	Vec2i vel = Vec2iZero();
 	if (cmd & CMD_LEFT)			vel.x = -SLIDE_X * 256;
 	else if (cmd & CMD_RIGHT)	vel.x = SLIDE_X * 256;
 	if (cmd & CMD_UP)			vel.y = -SLIDE_Y * 256;
 	else if (cmd & CMD_DOWN)	vel.y = SLIDE_Y * 256;
-	e.u.ActorSlide.Vel = Vec2i2Net(vel);
-	GameEventsEnqueue(&gGameEvents, e);
+	e->u.ActorSlide.Vel = Vec2i2Net(vel);
+	GameEventsCommit(&gGameEvents, e);
 	
 	actor->slideLock = SLIDE_LOCK;
 }
@@ -1061,13 +1082,7 @@ static void ActorUpdatePosition(TActor *actor, int ticks);
 static void ActorDie(TActor *actor);
 void UpdateAllActors(int ticks)
 {
-	for (int i = 0; i < (int)gActors.size; i++)
-	{
-		TActor *actor = CArrayGet(&gActors, i);
-		if (!actor->isInUse)
-		{
-			continue;
-		}
+	SLOT_POOL_FOREACH(TActor, actor, gActorSlots)
 		ActorUpdatePosition(actor, ticks);
 		UpdateActorState(actor, ticks);
 		if (actor->dead > DEATH_MAX)
@@ -1101,19 +1116,21 @@ void UpdateAllActors(int ticks)
 						v = Vec2iNew(1, 0);
 					}
 					v = Vec2iScale(Vec2iNorm(v), REPEL_STRENGTH);
-					GameEvent e = GameEventNew(GAME_EVENT_ACTOR_IMPULSE);
-					e.u.ActorImpulse.UID = actor->uid;
-					e.u.ActorImpulse.Vel = Vec2i2Net(v);
-					e.u.ActorImpulse.Pos = Vec2i2Net(actor->Pos);
-					GameEventsEnqueue(&gGameEvents, e);
-					e.u.ActorImpulse.UID = collidingActor->uid;
-					e.u.ActorImpulse.Vel = Vec2i2Net(Vec2iScale(v, -1));
-					e.u.ActorImpulse.Pos = Vec2i2Net(collidingActor->Pos);
-					GameEventsEnqueue(&gGameEvents, e);
+					GameEvent *e =
+						GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_IMPULSE);
+					e->u.ActorImpulse.UID = actor->uid;
+					e->u.ActorImpulse.Vel = Vec2i2Net(v);
+					e->u.ActorImpulse.Pos = Vec2i2Net(actor->Pos);
+					GameEventsCommit(&gGameEvents, e);
+					e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_IMPULSE);
+					e->u.ActorImpulse.UID = collidingActor->uid;
+					e->u.ActorImpulse.Vel = Vec2i2Net(Vec2iScale(v, -1));
+					e->u.ActorImpulse.Pos = Vec2i2Net(collidingActor->Pos);
+					GameEventsCommit(&gGameEvents, e);
 				}
 			}
 		}
-	}
+	SLOT_POOL_FOREACH_END()
 }
 static void CheckManualPickups(TActor *a);
 static void ActorUpdatePosition(TActor *actor, int ticks)
@@ -1195,7 +1212,7 @@ static void ActorAddGunPickup(const TActor *actor);
 static void ActorDie(TActor *actor)
 {
 	// Add an ammo pickup of the actor's gun
-	if (ConfigGetBool(&gConfig, "Game.Ammo"))
+	if (ConfigHandleGetBool(&sGameAmmo))
 	{
 		ActorAddAmmoPickup(actor);
 	}
@@ -1207,19 +1224,19 @@ static void ActorDie(TActor *actor)
 	}
 
 	// Add a blood pool
-	GameEvent e = GameEventNew(GAME_EVENT_MAP_OBJECT_ADD);
-	e.u.MapObjectAdd.UID = ObjsGetNextUID();
+	GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_MAP_OBJECT_ADD);
+	e->u.MapObjectAdd.UID = ObjsGetNextUID();
 	strcpy(
-		e.u.MapObjectAdd.MapObjectClass,
+		e->u.MapObjectAdd.MapObjectClass,
 		RandomBloodMapObject(&gMapObjects)->Name);
-	e.u.MapObjectAdd.Pos = Vec2i2Net(Vec2iFull2Real(actor->Pos));
-	e.u.MapObjectAdd.TileItemFlags = TILEITEM_IS_WRECK;
-	e.u.MapObjectAdd.Health = 0;
-	GameEventsEnqueue(&gGameEvents, e);
-
-	e = GameEventNew(GAME_EVENT_ACTOR_DIE);
-	e.u.ActorDie.UID = actor->uid;
-	GameEventsEnqueue(&gGameEvents, e);
+	e->u.MapObjectAdd.Pos = Vec2i2Net(Vec2iFull2Real(actor->Pos));
+	e->u.MapObjectAdd.TileItemFlags = TILEITEM_IS_WRECK;
+	e->u.MapObjectAdd.Health = 0;
+	GameEventsCommit(&gGameEvents, e);
+
+	e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_DIE);
+	e->u.ActorDie.UID = actor->uid;
+	GameEventsCommit(&gGameEvents, e);
 }
 static bool IsUnarmedBot(const TActor *actor);
 static void ActorAddAmmoPickup(const TActor *actor)
@@ -1248,19 +1265,19 @@ static void ActorAddAmmoPickup(const TActor *actor)
 				continue;
 			}
 
-			GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
-			e.u.AddPickup.UID = PickupsGetNextUID();
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ADD_PICKUP);
+			e->u.AddPickup.UID = PickupsGetNextUID();
 			const Ammo *a = AmmoGetById(&gAmmo, w->Gun->AmmoId);
-			sprintf(e.u.AddPickup.PickupClass, "ammo_%s", a->Name);
-			e.u.AddPickup.IsRandomSpawned = false;
-			e.u.AddPickup.SpawnerUID = -1;
-			e.u.AddPickup.TileItemFlags = 0;
+			sprintf(e->u.AddPickup.PickupClass, "ammo_%s", a->Name);
+			e->u.AddPickup.IsRandomSpawned = false;
+			e->u.AddPickup.SpawnerUID = -1;
+			e->u.AddPickup.TileItemFlags = 0;
 			// Add a little random offset so the pickups aren't all together
 			const Vec2i offset = Vec2iNew(
 				RAND_INT(-TILE_WIDTH, TILE_WIDTH) / 2,
 				RAND_INT(-TILE_HEIGHT, TILE_HEIGHT) / 2);
-			e.u.AddPickup.Pos = Vec2i2Net(Vec2iAdd(Vec2iFull2Real(actor->Pos), offset));
-			GameEventsEnqueue(&gGameEvents, e);
+			e->u.AddPickup.Pos = Vec2i2Net(Vec2iAdd(Vec2iFull2Real(actor->Pos), offset));
+			GameEventsCommit(&gGameEvents, e);
 		}
 	}
 
@@ -1275,16 +1292,16 @@ static void ActorAddGunPickup(const TActor *actor)
 	// Select a gun at random to drop
 	if (!gCampaign.IsClient)
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
-		e.u.AddPickup.UID = PickupsGetNextUID();
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ADD_PICKUP);
+		e->u.AddPickup.UID = PickupsGetNextUID();
 		const int gunIndex = RAND_INT(0, (int)actor->guns.size - 1);
 		const Weapon *w = CArrayGet(&actor->guns, gunIndex);
-		sprintf(e.u.AddPickup.PickupClass, "gun_%s", w->Gun->name);
-		e.u.AddPickup.IsRandomSpawned = false;
-		e.u.AddPickup.SpawnerUID = -1;
-		e.u.AddPickup.TileItemFlags = 0;
-		e.u.AddPickup.Pos = Vec2i2Net(Vec2iFull2Real(actor->Pos));
-		GameEventsEnqueue(&gGameEvents, e);
+		sprintf(e->u.AddPickup.PickupClass, "gun_%s", w->Gun->name);
+		e->u.AddPickup.IsRandomSpawned = false;
+		e->u.AddPickup.SpawnerUID = -1;
+		e->u.AddPickup.TileItemFlags = 0;
+		e->u.AddPickup.Pos = Vec2i2Net(Vec2iFull2Real(actor->Pos));
+		GameEventsCommit(&gGameEvents, e);
 	}
 }
 static bool IsUnarmedBot(const TActor *actor)
@@ -1299,36 +1316,23 @@ void ActorsInit(void)
 {
 	CArrayInit(&gActors, sizeof(TActor));
 	CArrayReserve(&gActors, 64);
+	SlotPoolInit(&gActorSlots, &gActors);
+	UIDMapInit(&sActorIndices);
 	sActorUIDs = 0;
 }
 void ActorsTerminate(void)
 {
-	for (int i = 0; i < (int)gActors.size; i++)
-	{
-		TActor *a = CArrayGet(&gActors, i);
-		if (!a->isInUse) continue;
+	SLOT_POOL_FOREACH(TActor, a, gActorSlots)
 		ActorDestroy(a);
-	}
+	SLOT_POOL_FOREACH_END()
 	CArrayTerminate(&gActors);
+	SlotPoolTerminate(&gActorSlots);
+	UIDMapTerminate(&sActorIndices);
 }
 int ActorsGetNextUID(void)
 {
 	return sActorUIDs++;
 }
-int ActorsGetFreeIndex(void)
-{
-	// Find an empty slot in actor list
-	// actors.size if no slot found (i.e. add to end)
-	for (int i = 0; i < (int)gActors.size; i++)
-	{
-		const TActor *a = CArrayGet(&gActors, i);
-		if (!a->isInUse)
-		{
-			return i;
-		}
-	}
-	return (int)gActors.size;
-}
 TActor *ActorAdd(NActorAdd aa)
 {
 	// Don't add if UID exists
@@ -1338,16 +1342,12 @@ TActor *ActorAdd(NActorAdd aa)
 			"actor uid(%d) already exists; not adding", (int)aa.UID);
 		return NULL;
 	}
-	const int id = ActorsGetFreeIndex();
-	while (id >= (int)gActors.size)
-	{
-		TActor a;
-		memset(&a, 0, sizeof a);
-		CArrayPushBack(&gActors, &a);
-	}
+	const int id = SlotPoolAdd(&gActorSlots);
 	TActor *actor = CArrayGet(&gActors, id);
+	UIDMapRemoveIndex(&sActorIndices, actor->uid, id);
 	memset(actor, 0, sizeof *actor);
 	actor->uid = aa.UID;
+	UIDMapSet(&sActorIndices, actor->uid, id);
 	LOG(LM_ACTOR, LL_DEBUG,
 		"add actor uid(%d) playerUID(%d)", actor->uid, aa.PlayerUID);
 	CArrayInit(&actor->guns, sizeof(Weapon));
@@ -1424,9 +1424,15 @@ void ActorDestroy(TActor *a)
 	MapRemoveTileItem(&gMap, &a->tileItem);
 	// Set PlayerData's ActorUID to -1 to signify actor destruction
 	PlayerData *p = PlayerDataGetByUID(a->PlayerUID);
-	if (p != NULL) p->ActorUID = -1;
+	if (p != NULL)
+	{
+		p->ActorUID = -1;
+		// Until revived, nothing heads to the player
+		FlowFieldsRemove(&gPathCache.flow, p->UID);
+	}
 	AIContextDestroy(a->aiContext);
 	a->isInUse = false;
+	SlotPoolRemove(&gActorSlots, a->tileItem.id);
 }
 
 unsigned char BestMatch(const TPalette palette, int r, int g, int b)
@@ -1510,15 +1516,8 @@ void BuildTranslationTables(const TPalette palette)
 
 TActor *ActorGetByUID(const int uid)
 {
-	for (int i = 0; i < (int)gActors.size; i++)
-	{
-		TActor *a = CArrayGet(&gActors, i);
-		if (a->uid == uid)
-		{
-			return a;
-		}
-	}
-	return NULL;
+	const int id = UIDMapGet(&sActorIndices, uid);
+	return id >= 0 ? CArrayGet(&gActors, id) : NULL;
 }
 
 const Character *ActorGetCharacter(const TActor *a)
@@ -1548,7 +1547,7 @@ bool ActorCanFire(const TActor *a)
 	const bool hasAmmo = ActorGunGetAmmo(a, w) != 0;
 	return
 		!WeaponIsLocked(w) &&
-		(!ConfigGetBool(&gConfig, "Game.Ammo") || hasAmmo);
+		(!ConfigHandleGetBool(&sGameAmmo) || hasAmmo);
 }
 bool ActorCanSwitchGun(const TActor *a)
 {
@@ -1665,7 +1664,7 @@ bool ActorIsInvulnerable(
 			actor->PlayerUID >= 0 || (actor->flags & FLAGS_GOOD_GUY);
 		// Friendly fire (NPCs)
 		if (!IsPVP(mode) &&
-			!ConfigGetBool(&gConfig, "Game.FriendlyFire") &&
+			!ConfigHandleGetBool(&sGameFriendlyFire) &&
 			isGood && isTargetGood)
 		{
 			return 1;
@@ -1685,8 +1684,8 @@ bool ActorIsLocalPlayer(const int uid)
 	const TActor *a = ActorGetByUID(uid);
 	// Don't accept updates if actor doesn't exist
 	// This can happen in the very first frame, where we haven't yet
-	// processed an actor add message
-	// Otherwise this shouldn't happen
+	// processed an actor add message, or when unreliable latest state
+	// arrives before the add
 	if (a == NULL) return true;
 
 	return PlayerIsLocal(a->PlayerUID);
@@ -51,6 +51,7 @@
 #include "ai_context.h"
 #include "grafx.h"
 #include "player.h"
+#include "slot_pool.h"
 #include "weapon.h"
 
 
@@ -194,6 +195,7 @@ typedef struct Actor
 // actors are added and the array must be resized.
 // Therefore do not hold actor pointers and reuse.
 extern CArray gActors;	// of TActor
+extern SlotPool gActorSlots;	// live slots of gActors
 
 extern TranslationTable tableFlamed;
 extern TranslationTable tableGreen;
@@ -223,7 +225,6 @@ void ActorSetAIState(TActor *actor, const AIState s);
 void ActorsInit(void);
 void ActorsTerminate(void);
 int ActorsGetNextUID(void);
-int ActorsGetFreeIndex(void);
 TActor *ActorAdd(NActorAdd aa);
 void ActorDestroy(TActor *a);
 
@@ -50,6 +50,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "actor_placement.h"
 #include "ai_utils.h"
@@ -61,11 +62,17 @@
 #include "game_events.h"
 #include "gamedata.h"
 #include "handle_game_events.h"
+#include "los.h"
 #include "mission.h"
 #include "net_util.h"
 #include "sys_specifics.h"
 #include "utils.h"
 
+static ConfigHandle sGameDifficulty = CONFIG_HANDLE("Game.Difficulty");
+static ConfigHandle sGameEnemyDensity = CONFIG_HANDLE("Game.EnemyDensity");
+static ConfigHandle sGameAIThinksPerTick =
+	CONFIG_HANDLE("Game.AIThinksPerTick");
+
 static int gBaddieCount = 0;
 static int gAreGoodGuysPresent = 0;
 
@@ -293,13 +300,211 @@ static bool DidPlayerShoot(void)
 	return false;
 }
 
+// Actors away from players make full decisions every few ticks, spread
+// across ticks by UID; the rest of the time they keep moving as before
+#define AI_THINK_INTERVAL 4
+// Decisions put off because a tick had made too many are made anyway once
+// they are this late
+#define AI_THINK_INTERVAL_MAX (AI_THINK_INTERVAL * 4)
+// Actors this close to a player, or visible, decide every tick
+#define AI_PRIORITY_DISTANCE ((12 * TILE_WIDTH) << 8)
+
+AIScheduleStats gAIScheduleStats;
+static int sTick = 0;
+
+// farThinks is the number of decisions made so far this tick for actors
+// away from players; it is counted rather than timed so that runs with the
+// same seed make the same decisions
+static bool AIScheduleThink(
+	TActor *actor, int *farThinks, const int maxFarThinks)
+{
+	AIContext *c = actor->aiContext;
+	const bool isFar =
+		!LOSTileIsVisible(&gMap, Vec2iToTile(Vec2iFull2Real(actor->Pos))) &&
+		!IsCloseToPlayer(actor->Pos, AI_PRIORITY_DISTANCE);
+	if (isFar)
+	{
+		const int sinceThink = sTick - c->LastThinkTick;
+		const bool isDue = (sTick + actor->uid) % AI_THINK_INTERVAL == 0 ||
+			sinceThink > AI_THINK_INTERVAL;
+		if (!isDue)
+		{
+			gAIScheduleStats.Skipped++;
+			return false;
+		}
+		if (maxFarThinks > 0 && sinceThink < AI_THINK_INTERVAL_MAX &&
+			*farThinks >= maxFarThinks)
+		{
+			gAIScheduleStats.Deferred++;
+			return false;
+		}
+		(*farThinks)++;
+	}
+	c->LastThinkTick = sTick;
+	gAIScheduleStats.Thinks++;
+	return true;
+}
+
+// Start a detour instead of walking into something
+static int AvoidBlockedDirection(TActor *actor, const int cmd)
+{
+	if (cmd && !IsDirectionOK(actor, CmdToDirection(cmd)) &&
+		(actor->flags & FLAGS_DETOURING) == 0)
+	{
+		Detour(actor);
+		ActorSetAIState(actor, AI_STATE_TRACK);
+		return 0;
+	}
+	return cmd;
+}
+
+// Make a full AI decision for an enemy or NPC, returning its command
+static int BadGuyThink(
+	TActor *actor, const CharBot *bot,
+	const int delayModifier, const int rollLimit)
+{
+	int cmd = 0;
+
+	// Wake up if it can see a player
+	if ((actor->flags & FLAGS_SLEEPING) &&
+		actor->aiContext->Delay == 0)
+	{
+		if (CanSeeAPlayer(actor))
+		{
+			actor->flags &= ~FLAGS_SLEEPING;
+			ActorSetAIState(actor, AI_STATE_NONE);
+		}
+		actor->aiContext->Delay = bot->actionDelay * delayModifier;
+		// Randomly change direction
+		int newDir = (int)actor->direction + ((rand() % 2) * 2 - 1);
+		if (newDir < (int)DIRECTION_UP)
+		{
+			newDir = (int)DIRECTION_UPLEFT;
+		}
+		if (newDir == (int)DIRECTION_COUNT)
+		{
+			newDir = (int)DIRECTION_UP;
+		}
+		cmd = DirectionToCmd((int)newDir);
+	}
+	// Go to sleep if the player's too far away
+	if (!(actor->flags & FLAGS_SLEEPING) &&
+		actor->aiContext->Delay == 0 &&
+		!(actor->flags & FLAGS_AWAKEALWAYS))
+	{
+		if (!IsCloseToPlayer(actor->Pos, (40 * 16) << 8))
+		{
+			actor->flags |= FLAGS_SLEEPING;
+			ActorSetAIState(actor, AI_STATE_IDLE);
+		}
+	}
+
+	if (!actor->dead && !(actor->flags & FLAGS_SLEEPING))
+	{
+		bool bypass = false;
+		const int roll = rand() % rollLimit;
+		if (actor->flags & FLAGS_FOLLOWER)
+		{
+			if (IsCloseToPlayer(actor->Pos, 32 << 8))
+			{
+				cmd = 0;
+				ActorSetAIState(actor, AI_STATE_IDLE);
+			}
+			else
+			{
+				cmd = AIGoto(
+					actor, AIGetClosestPlayerPos(actor->Pos), true);
+				ActorSetAIState(actor, AI_STATE_FOLLOW);
+			}
+		}
+		else if (!!(actor->flags & FLAGS_SNEAKY) &&
+			!!(actor->flags & FLAGS_VISIBLE) &&
+			DidPlayerShoot())
+		{
+			cmd = AIHuntClosest(actor) | CMD_BUTTON1;
+			if (actor->flags & FLAGS_RUNS_AWAY)
+			{
+				// Turn back and shoot for running away characters
+				cmd = AIReverseDirection(cmd);
+			}
+			bypass = true;
+			ActorSetAIState(actor, AI_STATE_HUNT);
+		}
+		else if (actor->flags & FLAGS_DETOURING)
+		{
+			cmd = BrightWalk(actor, roll);
+			ActorSetAIState(actor, AI_STATE_TRACK);
+		}
+		else if (actor->aiContext->Delay > 0)
+		{
+			cmd = actor->lastCmd & ~CMD_BUTTON1;
+		}
+		else
+		{
+			if (roll < bot->probabilityToTrack)
+			{
+				cmd = AIHuntClosest(actor);
+				ActorSetAIState(actor, AI_STATE_HUNT);
+			}
+			else if (roll < bot->probabilityToMove)
+			{
+				cmd = DirectionToCmd(rand() & 7);
+				ActorSetAIState(actor, AI_STATE_TRACK);
+			}
+			else
+			{
+				cmd = 0;
+			}
+			actor->aiContext->Delay = bot->actionDelay * delayModifier;
+		}
+		if (!bypass)
+		{
+			if (WillFire(actor, roll))
+			{
+				cmd |= CMD_BUTTON1;
+				if (!!(actor->flags & FLAGS_FOLLOWER) &&
+					(actor->flags & FLAGS_GOOD_GUY))
+				{
+					// Shoot in a random direction away
+					for (int j = 0; j < 10; j++)
+					{
+						direction_e d =
+							(direction_e)(rand() % DIRECTION_COUNT);
+						if (!IsFacingPlayer(actor, d))
+						{
+							cmd = DirectionToCmd(d) | CMD_BUTTON1;
+							break;
+						}
+					}
+				}
+				if (actor->flags & FLAGS_RUNS_AWAY)
+				{
+					// Turn back and shoot for running away characters
+					cmd |= AIReverseDirection(AIHuntClosest(actor));
+				}
+				ActorSetAIState(actor, AI_STATE_HUNT);
+			}
+			else
+			{
+				if ((actor->flags & FLAGS_VISIBLE) == 0)
+				{
+					// I think this is some hack to make sure invisible enemies don't fire so much
+					ActorGetGun(actor)->lock = 40;
+				}
+				cmd = AvoidBlockedDirection(actor, cmd);
+			}
+		}
+	}
+	return cmd;
+}
+
 void CommandBadGuys(int ticks)
 {
 	int count = 0;
 	int delayModifier;
 	int rollLimit;
 
-	switch (ConfigGetEnum(&gConfig, "Game.Difficulty"))
+	switch (ConfigHandleGetEnum(&sGameDifficulty))
 	{
 	case DIFFICULTY_VERYEASY:
 		delayModifier = 4;
@@ -323,13 +528,12 @@ void CommandBadGuys(int ticks)
 		break;
 	}
 
-	for (int i = 0; i < (int)gActors.size; i++)
-	{
-		TActor *actor = CArrayGet(&gActors, i);
-		if (!actor->isInUse)
-		{
-			continue;
-		}
+	sTick++;
+	// Only decisions away from players count against the budget; the ones
+	// near players are made every tick regardless
+	int farThinks = 0;
+	const int maxFarThinks = ConfigHandleGetInt(&sGameAIThinksPerTick);
+	SLOT_POOL_FOREACH(TActor, actor, gActorSlots)
 		const CharBot *bot = ActorGetCharacter(actor)->bot;
 		if (!(actor->PlayerUID >= 0 || (actor->flags & FLAGS_PRISONER)))
 		{
@@ -340,142 +544,15 @@ void CommandBadGuys(int ticks)
 
 			count++;
 			int cmd = 0;
-
-			// Wake up if it can see a player
-			if ((actor->flags & FLAGS_SLEEPING) &&
-				actor->aiContext->Delay == 0)
-			{
-				if (CanSeeAPlayer(actor))
-				{
-					actor->flags &= ~FLAGS_SLEEPING;
-					ActorSetAIState(actor, AI_STATE_NONE);
-				}
-				actor->aiContext->Delay = bot->actionDelay * delayModifier;
-				// Randomly change direction
-				int newDir = (int)actor->direction + ((rand() % 2) * 2 - 1);
-				if (newDir < (int)DIRECTION_UP)
-				{
-					newDir = (int)DIRECTION_UPLEFT;
-				}
-				if (newDir == (int)DIRECTION_COUNT)
-				{
-					newDir = (int)DIRECTION_UP;
-				}
-				cmd = DirectionToCmd((int)newDir);
-			}
-			// Go to sleep if the player's too far away
-			if (!(actor->flags & FLAGS_SLEEPING) &&
-				actor->aiContext->Delay == 0 &&
-				!(actor->flags & FLAGS_AWAKEALWAYS))
+			if (AIScheduleThink(actor, &farThinks, maxFarThinks))
 			{
-				if (!IsCloseToPlayer(actor->Pos, (40 * 16) << 8))
-				{
-					actor->flags |= FLAGS_SLEEPING;
-					ActorSetAIState(actor, AI_STATE_IDLE);
-				}
+				cmd = BadGuyThink(actor, bot, delayModifier, rollLimit);
 			}
-
-			if (!actor->dead && !(actor->flags & FLAGS_SLEEPING))
+			else if (!actor->dead && !(actor->flags & FLAGS_SLEEPING))
 			{
-				bool bypass = false;
-				const int roll = rand() % rollLimit;
-				if (actor->flags & FLAGS_FOLLOWER)
-				{
-					if (IsCloseToPlayer(actor->Pos, 32 << 8))
-					{
-						cmd = 0;
-						ActorSetAIState(actor, AI_STATE_IDLE);
-					}
-					else
-					{
-						cmd = AIGoto(
-							actor, AIGetClosestPlayerPos(actor->Pos), true);
-						ActorSetAIState(actor, AI_STATE_FOLLOW);
-					}
-				}
-				else if (!!(actor->flags & FLAGS_SNEAKY) &&
-					!!(actor->flags & FLAGS_VISIBLE) &&
-					DidPlayerShoot())
-				{
-					cmd = AIHuntClosest(actor) | CMD_BUTTON1;
-					if (actor->flags & FLAGS_RUNS_AWAY)
-					{
-						// Turn back and shoot for running away characters
-						cmd = AIReverseDirection(cmd);
-					}
-					bypass = true;
-					ActorSetAIState(actor, AI_STATE_HUNT);
-				}
-				else if (actor->flags & FLAGS_DETOURING)
-				{
-					cmd = BrightWalk(actor, roll);
-					ActorSetAIState(actor, AI_STATE_TRACK);
-				}
-				else if (actor->aiContext->Delay > 0)
-				{
-					cmd = actor->lastCmd & ~CMD_BUTTON1;
-				}
-				else
-				{
-					if (roll < bot->probabilityToTrack)
-					{
-						cmd = AIHuntClosest(actor);
-						ActorSetAIState(actor, AI_STATE_HUNT);
-					}
-					else if (roll < bot->probabilityToMove)
-					{
-						cmd = DirectionToCmd(rand() & 7);
-						ActorSetAIState(actor, AI_STATE_TRACK);
-					}
-					else
-					{
-						cmd = 0;
-					}
-					actor->aiContext->Delay = bot->actionDelay * delayModifier;
-				}
-				if (!bypass)
-				{
-					if (WillFire(actor, roll))
-					{
-						cmd |= CMD_BUTTON1;
-						if (!!(actor->flags & FLAGS_FOLLOWER) &&
-							(actor->flags & FLAGS_GOOD_GUY))
-						{
-							// Shoot in a random direction away
-							for (int j = 0; j < 10; j++)
-							{
-								direction_e d =
-									(direction_e)(rand() % DIRECTION_COUNT);
-								if (!IsFacingPlayer(actor, d))
-								{
-									cmd = DirectionToCmd(d) | CMD_BUTTON1;
-									break;
-								}
-							}
-						}
-						if (actor->flags & FLAGS_RUNS_AWAY)
-						{
-							// Turn back and shoot for running away characters
-							cmd |= AIReverseDirection(AIHuntClosest(actor));
-						}
-						ActorSetAIState(actor, AI_STATE_HUNT);
-					}
-					else
-					{
-						if ((actor->flags & FLAGS_VISIBLE) == 0)
-						{
-							// I think this is some hack to make sure invisible enemies don't fire so much
-							ActorGetGun(actor)->lock = 40;
-						}
-						if (cmd && !IsDirectionOK(actor, CmdToDirection(cmd)) &&
-							(actor->flags & FLAGS_DETOURING) == 0)
-						{
-							Detour(actor);
-							cmd = 0;
-							ActorSetAIState(actor, AI_STATE_TRACK);
-						}
-					}
-				}
+				// Keep moving as last decided, unless that is now blocked
+				cmd = AvoidBlockedDirection(
+					actor, actor->lastCmd & ~CMD_BUTTON1);
 			}
 			actor->aiContext->Delay =
 				MAX(0, actor->aiContext->Delay - ticks);
@@ -485,10 +562,10 @@ void CommandBadGuys(int ticks)
 		{
 			CommandActor(actor, 0, ticks);
 		}
-	}
+	SLOT_POOL_FOREACH_END()
 	if (gMission.missionData->Enemies.size > 0 &&
 		gMission.missionData->EnemyDensity > 0 &&
-		count < MAX(1, (gMission.missionData->EnemyDensity * ConfigGetInt(&gConfig, "Game.EnemyDensity")) / 100))
+		count < MAX(1, (gMission.missionData->EnemyDensity * ConfigHandleGetInt(&sGameEnemyDensity)) / 100))
 	{
 		NActorAdd aa = NActorAdd_init_default;
 		aa.UID = ActorsGetNextUID();
@@ -499,15 +576,16 @@ void CommandBadGuys(int ticks)
 			CArrayGet(&gCampaign.Setting.characters.OtherChars, aa.CharId);
 		aa.Health = CharacterGetStartingHealth(c, true);
 		aa.FullPos = PlaceAwayFromPlayers(&gMap);
-		GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD);
-		e.u.ActorAdd = aa;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_ADD);
+		e->u.ActorAdd = aa;
+		GameEventsCommit(&gGameEvents, e);
 		gBaddieCount++;
 	}
 }
 
 void InitializeBadGuys(void)
 {
+	memset(&gAIScheduleStats, 0, sizeof gAIScheduleStats);
 	for (int i = 0; i < (int)gMission.missionData->Objectives.size; i++)
 	{
 		MissionObjective *mobj =
@@ -528,9 +606,10 @@ void InitializeBadGuys(void)
 					CArrayGet(&gCampaign.Setting.characters.OtherChars, aa.CharId);
 				aa.Health = CharacterGetStartingHealth(c, true);
 				aa.FullPos = PlaceAwayFromPlayers(&gMap);
-				GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD);
-				e.u.ActorAdd = aa;
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEvent *e =
+					GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_ADD);
+				e->u.ActorAdd = aa;
+				GameEventsCommit(&gGameEvents, e);
 
 				// Process the events that actually place the actors
 				HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
@@ -557,9 +636,10 @@ void InitializeBadGuys(void)
 				{
 					aa.FullPos = PlaceAwayFromPlayers(&gMap);
 				}
-				GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD);
-				e.u.ActorAdd = aa;
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEvent *e =
+					GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_ADD);
+				e->u.ActorAdd = aa;
+				GameEventsCommit(&gGameEvents, e);
 
 				// Process the events that actually place the actors
 				HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
@@ -579,7 +659,7 @@ void CreateEnemies(void)
 	}
 
 	for (int i = 0;
-		i < MAX(1, (gMission.missionData->EnemyDensity * ConfigGetInt(&gConfig, "Game.EnemyDensity")) / 100);
+		i < MAX(1, (gMission.missionData->EnemyDensity * ConfigHandleGetInt(&sGameEnemyDensity)) / 100);
 		i++)
 	{
 		NActorAdd aa = NActorAdd_init_default;
@@ -591,9 +671,9 @@ void CreateEnemies(void)
 		const Character *c =
 			CArrayGet(&gCampaign.Setting.characters.OtherChars, aa.CharId);
 		aa.Health = CharacterGetStartingHealth(c, true);
-		GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD);
-		e.u.ActorAdd = aa;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_ADD);
+		e->u.ActorAdd = aa;
+		GameEventsCommit(&gGameEvents, e);
 		gBaddieCount++;
 
 		// Process the events that actually place the actors
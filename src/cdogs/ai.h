@@ -51,6 +51,15 @@
 
 #include "actors.h"
 
+// Counters for how AI decisions are spread across ticks
+typedef struct
+{
+	int Thinks;	// full decisions made
+	int Skipped;	// not due yet; kept moving as last decided
+	int Deferred;	// due, but put off as the tick was out of time
+} AIScheduleStats;
+extern AIScheduleStats gAIScheduleStats;
+
 void InitializeBadGuys(void);
 void CreateEnemies(void);
 void CommandBadGuys(int ticks);
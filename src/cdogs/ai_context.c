@@ -27,6 +27,8 @@
 */
 #include "ai_context.h"
 
+static ConfigHandle sInterfaceAIChatter = CONFIG_HANDLE("Interface.AIChatter");
+
 
 AIContext *AIContextNew(void)
 {
@@ -88,7 +90,7 @@ bool AIContextSetState(AIContext *c, const AIState s)
 	if (isChange)
 	{
 		AIContextSetChatterDelay(
-			c, ConfigGetEnum(&gConfig, "Interface.AIChatter"));
+			c, ConfigHandleGetEnum(&sInterfaceAIChatter));
 	}
 	return isChange;
 }
@@ -106,6 +106,7 @@ typedef struct
 	int EnemyId;
 	double GunRangeScalar;
 	int OnGunId;
+	int LastThinkTick;	// when the last full decision was made
 } AIContext;
 
 AIContext *AIContextNew(void);
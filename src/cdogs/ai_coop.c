@@ -32,6 +32,8 @@
 #include "gamedata.h"
 #include "pickup.h"
 
+static ConfigHandle sGameAmmo = CONFIG_HANDLE("Game.Ammo");
+
 // How many ticks to stay in one confusion state
 #define CONFUSION_STATE_TICKS_MIN 25
 #define CONFUSION_STATE_TICKS_RANGE 25
@@ -141,13 +143,14 @@ static int AICoopGetCmdNormal(TActor *actor)
 			v.y <= actorTilePos.y + 1 && Vec2iIsZero(dangerBulletFullPos);
 			v.y++)
 		{
-			const Tile *t = MapGetTile(&gMap, v);
-			for (int i = 0; i < (int)t->things.size; i++)
+			const CArray *things = MapGetTileThings(&gMap, v);
+			if (things == NULL) continue;
+			for (int i = 0; i < (int)things->size; i++)
 			{
-				const ThingId *tid = CArrayGet(&t->things, i);
+				const SpatialHashEntry *e = CArrayGet(things, i);
 				// Only look for bullets
-				if (tid->Kind != KIND_MOBILEOBJECT) continue;
-				const TMobileObject *mo = CArrayGet(&gMobObjs, tid->Id);
+				if (e->Id.Kind != KIND_MOBILEOBJECT) continue;
+				const TMobileObject *mo = CArrayGet(&gMobObjs, e->Id.Id);
 				if (mo->bulletClass->HurtAlways)
 				{
 					dangerBulletFullPos = Vec2iNew(mo->x, mo->y);
@@ -164,7 +167,7 @@ static int AICoopGetCmdNormal(TActor *actor)
 
 	// Check the weapon for ammo
 	int lowAmmoGun = -1;
-	if (ConfigGetBool(&gConfig, "Game.Ammo"))
+	if (ConfigHandleGetBool(&sGameAmmo))
 	{
 		// Check all our weapons
 		// Prefer guns using ammo
@@ -642,13 +645,7 @@ static void FindObjectivesSortedByDistance(
 	}
 
 	// Look for destructibles
-	for (int i = 0; i < (int)gObjs.size; i++)
-	{
-		const TObject *o = CArrayGet(&gObjs, i);
-		if (!o->isInUse)
-		{
-			continue;
-		}
+	SLOT_POOL_FOREACH(const TObject, o, gObjSlots)
 		ClosestObjective co;
 		memset(&co, 0, sizeof co);
 		co.Pos = Vec2iNew(o->tileItem.x, o->tileItem.y);
@@ -667,16 +664,10 @@ static void FindObjectivesSortedByDistance(
 				CArrayGet(&gMission.Objectives, objective);
 		}
 		CArrayPushBack(objectives, &co);
-	}
+	SLOT_POOL_FOREACH_END()
 
 	// Look for kill or rescue objectives
-	for (int i = 0; i < (int)gActors.size; i++)
-	{
-		const TActor *a = CArrayGet(&gActors, i);
-		if (!a->isInUse)
-		{
-			continue;
-		}
+	SLOT_POOL_FOREACH(const TActor, a, gActorSlots)
 		const TTileItem *ti = &a->tileItem;
 		if (!(ti->flags & TILEITEM_OBJECTIVE))
 		{
@@ -703,7 +694,7 @@ static void FindObjectivesSortedByDistance(
 		co.Distance = DistanceSquared(actorRealPos, co.Pos);
 		co.u.Objective = CArrayGet(&gMission.Objectives, objective);
 		CArrayPushBack(objectives, &co);
-	}
+	SLOT_POOL_FOREACH_END()
 
 	// Look for explore objectives
 	for (int i = 0; i < (int)gMission.missionData->Objectives.size; i++)
@@ -741,7 +732,7 @@ static bool OnClosestPickupGun(
 	ClosestObjective *co, const Pickup *p,
 	const TActor *actor, const TActor *closestPlayer)
 {
-	if (!ConfigGetBool(&gConfig, "Game.Ammo"))
+	if (!ConfigHandleGetBool(&sGameAmmo))
 	{
 		return false;
 	}
@@ -884,7 +875,7 @@ void AICoopSelectWeapons(
 		p->weaponCount++;
 	}
 
-	if (ConfigGetBool(&gConfig, "Game.Ammo"))
+	if (ConfigHandleGetBool(&sGameAmmo))
 	{
 		// Select pistol as an infinite-ammo backup
 		const GunDescription *pistol = StrGunDescription("Pistol");
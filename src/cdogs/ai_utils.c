@@ -91,10 +91,8 @@ static TActor *AIGetClosestActor(
 	// satisfies the condition
 	TActor *closest = NULL;
 	int minDistance = -1;
-	for (int i = 0; i < (int)gActors.size; i++)
-	{
-		TActor *a = CArrayGet(&gActors, i);
-		if (!a->isInUse || a->dead)
+	SLOT_POOL_FOREACH(TActor, a, gActorSlots)
+		if (a->dead)
 		{
 			continue;
 		}
@@ -113,7 +111,7 @@ static TActor *AIGetClosestActor(
 				closest = a;
 			}
 		}
-	}
+	SLOT_POOL_FOREACH_END()
 	return closest;
 }
 
@@ -235,16 +233,20 @@ bool IsTileWalkable(Map *map, const Vec2i pos)
 	}
 	// Check if tile has a dangerous (explosive) item on it
 	// For AI, we don't want to shoot it, so just walk around
-	Tile *t = MapGetTile(map, pos);
-	for (int i = 0; i < (int)t->things.size; i++)
+	const CArray *things = MapGetTileThings(map, pos);
+	if (things == NULL)
 	{
-		ThingId *tid = CArrayGet(&t->things, i);
+		return true;
+	}
+	for (int i = 0; i < (int)things->size; i++)
+	{
+		const SpatialHashEntry *e = CArrayGet(things, i);
 		// Only look for explosive objects
-		if (tid->Kind != KIND_OBJECT)
+		if (e->Id.Kind != KIND_OBJECT)
 		{
 			continue;
 		}
-		const TObject *o = CArrayGet(&gObjs, tid->Id);
+		const TObject *o = CArrayGet(&gObjs, e->Id.Id);
 		if (ObjIsDangerous(o))
 		{
 			return false;
@@ -263,20 +265,23 @@ bool IsTileWalkableAroundObjects(Map *map, const Vec2i pos)
 		return false;
 	}
 	// Check if tile has any item on it
-	Tile *t = MapGetTile(map, pos);
-	for (int i = 0; i < (int)t->things.size; i++)
+	const CArray *things = MapGetTileThings(map, pos);
+	if (things == NULL)
+	{
+		return true;
+	}
+	for (int i = 0; i < (int)things->size; i++)
 	{
-		ThingId *tid = CArrayGet(&t->things, i);
-		if (tid->Kind == KIND_OBJECT)
+		const SpatialHashEntry *e = CArrayGet(things, i);
+		if (e->Id.Kind == KIND_OBJECT)
 		{
 			// Check that the object is not debris
-			const TObject *o = CArrayGet(&gObjs, tid->Id);
-			if (!TileItemIsDebris(&o->tileItem))
+			if (!(e->Flags & TILEITEM_IS_WRECK))
 			{
 				return false;
 			}
 		}
-		else if (tid->Kind == KIND_CHARACTER)
+		else if (e->Id.Kind == KIND_CHARACTER)
 		{
 			switch (gCollisionSystem.allyCollision)
 			{
@@ -450,7 +455,7 @@ bool AIHasPath(const Vec2i from, const Vec2i to, const bool ignoreObjects)
 		ignoreObjects ? IsTileWalkable : IsTileWalkableAroundObjects);
 	CachedPath path = PathCacheCreate(
 		&gPathCache, fromTile, toTile, ignoreObjects, true);
-	const size_t pathCount = ASPathGetCount(path.Path);
+	const size_t pathCount = CachedPathGetCount(&path);
 	CachedPathDestroy(&path);
 	return pathCount >= 1;
 }
@@ -472,7 +477,7 @@ int AIGotoDirect(const Vec2i a, const Vec2i p)
 static int AStarFollow(
 	AIGotoContext *c, Vec2i currentTile, TTileItem *i, Vec2i a)
 {
-	Vec2i *pathTile = ASPathGetNode(c->Path.Path, c->PathIndex);
+	Vec2i *pathTile = CachedPathGetNode(&c->Path, c->PathIndex);
 	c->IsFollowing = 1;
 	// Check if we need to follow the next step in the path
 	// Note: need to make sure the actor is fully within the current tile
@@ -481,7 +486,7 @@ static int AStarFollow(
 		IsTileItemInsideTile(i, currentTile))
 	{
 		c->PathIndex++;
-		pathTile = ASPathGetNode(c->Path.Path, c->PathIndex);
+		pathTile = CachedPathGetNode(&c->Path, c->PathIndex);
 	}
 	// Go directly to the center of the next tile
 	return AIGotoDirect(a, Vec2iCenterOfTile(*pathTile));
@@ -494,19 +499,19 @@ static int AStarCloseToPath(
 	Vec2i *pathTile;
 	Vec2i *pathEnd;
 	if (!c ||
-		c->PathIndex >= (int)ASPathGetCount(c->Path.Path) - 1) // at end of path
+		c->PathIndex >= (int)CachedPathGetCount(&c->Path) - 1) // at end of path
 	{
 		return 0;
 	}
 	// Check if we're too far from the current start of the path
-	pathTile = ASPathGetNode(c->Path.Path, c->PathIndex);
+	pathTile = CachedPathGetNode(&c->Path, c->PathIndex);
 	if (CHEBYSHEV_DISTANCE(
 		currentTile.x, currentTile.y, pathTile->x, pathTile->y) > 2)
 	{
 		return 0;
 	}
 	// Check if we're too far from the end of the path
-	pathEnd = ASPathGetNode(c->Path.Path, ASPathGetCount(c->Path.Path) - 1);
+	pathEnd = CachedPathGetNode(&c->Path, CachedPathGetCount(&c->Path) - 1);
 	if (CHEBYSHEV_DISTANCE(
 		goalTile.x, goalTile.y, pathEnd->x, pathEnd->y) > 0)
 	{
@@ -514,6 +519,33 @@ static int AStarCloseToPath(
 	}
 	return 1;
 }
+// Follow a flow field, by heading to the centre of the next tile once
+// fully inside the current one, like following an A* path
+static int FlowFollow(
+	const Vec2i currentTile, const Vec2i next, TTileItem *i, const Vec2i a)
+{
+	if (!IsTileItemInsideTile(i, currentTile))
+	{
+		return AIGotoDirect(a, Vec2iCenterOfTile(currentTile));
+	}
+	return AIGotoDirect(a, Vec2iCenterOfTile(next));
+}
+// Find the flow field for the living player on a tile, if any
+static const FlowField *GetPlayerFlowField(const Vec2i tile)
+{
+	CA_FOREACH(const PlayerData, pd, gPlayerDatas)
+		if (!IsPlayerAlive(pd))
+		{
+			continue;
+		}
+		const TActor *p = ActorGetByUID(pd->ActorUID);
+		if (Vec2iEqual(Vec2iToTile(Vec2iFull2Real(p->Pos)), tile))
+		{
+			return PathCacheGetFlowField(&gPathCache, pd->UID, tile);
+		}
+	CA_FOREACH_END()
+	return NULL;
+}
 int AIGoto(TActor *actor, Vec2i p, bool ignoreObjects)
 {
 	Vec2i a = Vec2iFull2Real(actor->Pos);
@@ -531,6 +563,24 @@ int AIGoto(TActor *actor, Vec2i p, bool ignoreObjects)
 		return AIGotoDirect(a, p);
 	}
 
+	// Most AI head for players; rather than each searching for its own
+	// path, they share a flow field per player
+	if (ignoreObjects)
+	{
+		const FlowField *f = GetPlayerFlowField(goalTile);
+		Vec2i next;
+		if (f != NULL &&
+			FlowFieldGetNext(&gPathCache.flow, f, currentTile, &next))
+		{
+			c->IsFollowing = false;
+			if (AIHasClearPath(a, p, ignoreObjects))
+			{
+				return AIGotoDirect(a, p);
+			}
+			return FlowFollow(currentTile, next, &actor->tileItem, a);
+		}
+	}
+
 	// If we are currently following an A* path,
 	// and it is still valid, keep following it until
 	// we have reached a new tile
@@ -561,7 +611,7 @@ int AIGoto(TActor *actor, Vec2i p, bool ignoreObjects)
 
 		// In case we can't calculate A* for some reason,
 		// try simple navigation again
-		if (ASPathGetCount(c->Path.Path) <= 1)
+		if (CachedPathGetCount(&c->Path) <= 1)
 		{
 			debug(
 				D_MAX,
@@ -273,12 +273,18 @@ static void DrawObjectivesAndKeys(Map *map, Vec2i pos, int scale, int flags)
 	{
 		for (int x = 0; x < map->Size.x; x++)
 		{
-			Tile *tile = MapGetTile(map, Vec2iNew(x, y));
-			for (int i = 0; i < (int)tile->things.size; i++)
+			const Vec2i tilePos = Vec2iNew(x, y);
+			const CArray *things = MapGetTileThings(map, tilePos);
+			if (things == NULL)
 			{
-				ThingId *tid = CArrayGet(&tile->things, i);
+				continue;
+			}
+			Tile *tile = MapGetTile(map, tilePos);
+			for (int i = 0; i < (int)things->size; i++)
+			{
+				const SpatialHashEntry *e = CArrayGet(things, i);
 				DrawTileItem(
-					ThingIdGetTileItem(tid), tile, pos, scale, flags);
+					ThingIdGetTileItem(&e->Id), tile, pos, scale, flags);
 			}
 		}
 	}
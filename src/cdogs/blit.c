@@ -52,14 +52,14 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
 
 #include <SDL.h>
 
+#include "blit_span.h"
 #include "config.h"
 #include "grafx.h"
-#include "hqx/hqx.h"
 #include "palette.h"
+#include "pic_spans.h"
 #include "utils.h" /* for debug() */
 
 
@@ -218,57 +218,46 @@ void BlitBackground(
 	}
 }
 
+// Clip a picture once, so that the blitters can work on whole rows
+static bool ClipPic(
+	const GraphicsDevice *g, const Pic *pic, const Vec2i pos, BlitSpanRect *r)
+{
+	return BlitSpanClip(
+		r, pic->size, Vec2iAdd(pos, pic->offset),
+		g->clipping.left, g->clipping.top,
+		g->clipping.right, g->clipping.bottom);
+}
+static Uint32 *BufRow(
+	const GraphicsDevice *g, const BlitSpanRect *r, const int i)
+{
+	return g->buf + (r->Dst.y + i) * g->cachedConfig.Res.x + r->Dst.x;
+}
+static const Uint32 *PicRow(const Pic *pic, const BlitSpanRect *r, const int i)
+{
+	return pic->Data + (r->Src.y + i) * pic->size.x + r->Src.x;
+}
 void Blit(GraphicsDevice *device, const Pic *pic, Vec2i pos)
 {
-	Uint32 *current = pic->Data;
-	pos = Vec2iAdd(pos, pic->offset);
-	for (int i = 0; i < pic->size.y; i++)
+	BlitSpanRect r;
+	if (!ClipPic(device, pic, pos, &r))
 	{
-		int yoff = i + pos.y;
-		if (yoff > device->clipping.bottom)
-		{
-			break;
-		}
-		if (yoff < device->clipping.top)
-		{
-			current += pic->size.x;
-			continue;
-		}
-		yoff *= device->cachedConfig.Res.x;
-		for (int j = 0; j < pic->size.x; j++)
-		{
-			Uint32 *target;
-			int xoff = j + pos.x;
-			if (xoff < device->clipping.left)
-			{
-				current++;
-				continue;
-			}
-			if (xoff > device->clipping.right)
-			{
-				current += pic->size.x - j;
-				break;
-			}
-			if ((*current & device->Amask) == 0)
-			{
-				current++;
-				continue;
-			}
-			target = device->buf + yoff + xoff;
-			*target = *current;
-			current++;
-		}
+		return;
+	}
+	if (PicSpansCanBlit(pic->Spans, device->Amask))
+	{
+		PicSpansBlit(
+			pic->Spans, pic->Data, pic->size.x,
+			device->buf, device->cachedConfig.Res.x, &r);
+		return;
+	}
+	for (int i = 0; i < r.Size.y; i++)
+	{
+		gBlitSpan.Copy(
+			BufRow(device, &r, i), PicRow(pic, &r, i), r.Size.x,
+			device->Amask);
 	}
 }
 
-static Uint32 PixelMult(Uint32 p, Uint32 m)
-{
-	return
-		((p & 0xFF) * (m & 0xFF) / 0xFF) |
-		((((p & 0xFF00) >> 8) * ((m & 0xFF00) >> 8) / 0xFF) << 8) |
-		((((p & 0xFF0000) >> 16) * ((m & 0xFF0000) >> 16) / 0xFF) << 16) |
-		((((p & 0xFF000000) >> 24) * ((m & 0xFF000000) >> 24) / 0xFF) << 24);
-}
 void BlitMasked(
 	GraphicsDevice *device,
 	const Pic *pic,
@@ -276,347 +265,66 @@ void BlitMasked(
 	color_t mask,
 	int isTransparent)
 {
-	Uint32 *current = pic->Data;
-	const Uint32 maskPixel = COLOR2PIXEL(mask);
-	int i;
-	pos = Vec2iAdd(pos, pic->offset);
-	for (i = 0; i < pic->size.y; i++)
+	BlitSpanRect r;
+	if (!ClipPic(device, pic, pos, &r))
 	{
-		int yoff = i + pos.y;
-		if (yoff > device->clipping.bottom)
-		{
-			break;
-		}
-		if (yoff < device->clipping.top)
-		{
-			current += pic->size.x;
-			continue;
-		}
-		yoff *= device->cachedConfig.Res.x;
-		for (int j = 0; j < pic->size.x; j++)
-		{
-			Uint32 *target;
-			int xoff = j + pos.x;
-			if (xoff < device->clipping.left)
-			{
-				current++;
-				continue;
-			}
-			if (xoff > device->clipping.right)
-			{
-				current += pic->size.x - j;
-				break;
-			}
-			if (isTransparent && *current == 0)
-			{
-				current++;
-				continue;
-			}
-			target = device->buf + yoff + xoff;
-			*target = PixelMult(*current, maskPixel);
-			current++;
-		}
+		return;
 	}
-}
-void BlitBlend(
-	GraphicsDevice *g, const Pic *pic, Vec2i pos, const color_t blend)
-{
-	Uint32 *current = pic->Data;
-	pos = Vec2iAdd(pos, pic->offset);
-	for (int i = 0; i < pic->size.y; i++)
+	const Uint32 maskPixel = COLOR2PIXEL(mask);
+	if (isTransparent && PicSpansCanBlit(pic->Spans, device->Amask))
 	{
-		int yoff = i + pos.y;
-		if (yoff > g->clipping.bottom)
-		{
-			break;
-		}
-		if (yoff < g->clipping.top)
-		{
-			current += pic->size.x;
-			continue;
-		}
-		yoff *= g->cachedConfig.Res.x;
-		for (int j = 0; j < pic->size.x; j++)
-		{
-			int xoff = j + pos.x;
-			if (xoff < g->clipping.left)
-			{
-				current++;
-				continue;
-			}
-			if (xoff > g->clipping.right)
-			{
-				current += pic->size.x - j;
-				break;
-			}
-			if (*current == 0)
-			{
-				current++;
-				continue;
-			}
-			Uint32 *target = g->buf + yoff + xoff;
-			const color_t currentColor = PIXEL2COLOR(*current);
-			color_t blendedColor = ColorMult(
-				currentColor, blend);
-			blendedColor.a = blend.a;
-			const color_t targetColor = PIXEL2COLOR(*target);
-			blendedColor = ColorAlphaBlend(targetColor, blendedColor);
-			*target = COLOR2PIXEL(blendedColor);
-			current++;
-		}
+		PicSpansBlitMasked(
+			pic->Spans, pic->Data, pic->size.x,
+			device->buf, device->cachedConfig.Res.x, &r, maskPixel);
+		return;
 	}
-}
-
-#define PixelIndex(x, y, w)		(y * w + x)
-
-static inline
-void Scale8(Uint32 *d, const Uint32 *s, const int w, const int h, const int sf)
-{
-	int sx;
-	int sy;
-	int f = sf;
-
-	int dx, dy, dw;
-
-	if (f > 4)
+	for (int i = 0; i < r.Size.y; i++)
 	{
-		f = 4;	/* max 4x for the moment */
-	}
-
-	dw = w * f;
-
-	for (sy = 0; sy < h; sy++) {
-		dy = f * sy;
-		for (sx = 0; sx < w; sx++)
-		{
-			Uint32 p = s[PixelIndex(sx, sy, w)];
-			dx = f * sx;
-
-			switch (f) {
-				case 4:
-					/* right side */
-					d[PixelIndex((dx + 3),	(dy + 1),	dw)] = p;
-					d[PixelIndex((dx + 3),	(dy + 2),	dw)] = p;
-					d[PixelIndex((dx + 3),	dy,		dw)] = p;
-
-					/* bottom row */
-					d[PixelIndex(dx,	(dy + 3),	dw)] = p;
-					d[PixelIndex((dx + 1),	(dy + 3),	dw)] = p;
-					d[PixelIndex((dx + 2),	(dy + 3),	dw)] = p;
-
-					/* bottom right */
-					d[PixelIndex((dx + 3),	(dy + 3),	dw)] = p;
-
-				case 3:
-					/* right side */
-					d[PixelIndex((dx + 2),	(dy + 1),	dw)] = p;
-					d[PixelIndex((dx + 2),	dy,		dw)] = p;
-
-					/* bottom row */
-					d[PixelIndex(dx,	(dy + 2),	dw)] = p;
-					d[PixelIndex((dx + 1),	(dy + 2),	dw)] = p;
-
-					/* bottom right */
-					d[PixelIndex((dx + 2),	(dy + 2),	dw)] = p;
-
-				case 2:
-					d[PixelIndex((dx + 1),	dy,		dw)] = p;
-					d[PixelIndex((dx + 1),	(dy + 1),	dw)] = p;
-					d[PixelIndex(dx,	(dy + 1),	dw)] = p;
-
-				default:
-					d[PixelIndex(dx,	dy,		dw)] = p;
-			}
-		}
+		gBlitSpan.Masked(
+			BufRow(device, &r, i), PicRow(pic, &r, i), r.Size.x,
+			maskPixel, isTransparent);
 	}
 }
-
-static Uint32 PixAvg(Uint32 p1, Uint32 p2)
+void BlitBlend(
+	GraphicsDevice *g, const Pic *pic, Vec2i pos, const color_t blend)
 {
-	union
+	BlitSpanRect r;
+	if (!ClipPic(g, pic, pos, &r))
 	{
-		Uint8 rgba[4];
-		Uint32 out;
-	} u1, u2;
-	int i;
-	u1.out = p1;
-	u2.out = p2;
-	for (i = 0; i < 4; i++)
-	{
-		u1.rgba[i] = (Uint8)CLAMP(((int)u1.rgba[i] + u2.rgba[i]) / 2, 0, 255);
+		return;
 	}
-	return u1.out;
-}
-static Uint32 Pix3rds(Uint32 p1, Uint32 p2)
-{
-	union
-	{
-		Uint8 rgba[4];
-		Uint32 out;
-	} u1, u2;
-	int i;
-	u1.out = p1;
-	u2.out = p2;
-	for (i = 0; i < 4; i++)
+	const Uint32 blendPixel = COLOR2PIXEL(blend);
+	if (PicSpansCanBlit(pic->Spans, g->Amask))
 	{
-		u1.rgba[i] = (Uint8)CLAMP(((int)u1.rgba[i] + u2.rgba[i]*2) / 3, 0, 255);
+		PicSpansBlitBlend(
+			pic->Spans, pic->Data, pic->size.x,
+			g->buf, g->cachedConfig.Res.x, &r, blendPixel, blend.a);
+		return;
 	}
-	return u1.out;
-}
-static void Bilinear(
-	Uint32 *dest, const Uint32 *src,
-	const int w, const int h,
-	const int scaleFactor)
-{
-	int sx, sy;
-	int dw = scaleFactor * w;
-	for (sy = 0; sy < h; sy++)
+	for (int i = 0; i < r.Size.y; i++)
 	{
-		int dy = scaleFactor * sy;
-		for (sx = 0; sx < w; sx++)
-		{
-			Uint32 p = src[PixelIndex(sx, sy, w)];
-			int dx = scaleFactor * sx;
-			switch (scaleFactor)
-			{
-			#define BLIT(x, y, pix) dest[PixelIndex((x), (y), dw)] = pix;
-			case 4:
-				{
-					// 0 1 2 3|g
-					// 4 5 6 7|h
-					// 8 9 a b|i
-					// c d e f|j
-					// k-l-m-n+o
-					Uint32 pg = src[PixelIndex(MIN(sx+1, w-1), sy, w)];
-					Uint32 p2 = PixAvg(p, pg);
-					Uint32 p1 = PixAvg(p, p2);
-					Uint32 p3 = PixAvg(p2, pg);
-					Uint32 pk = src[PixelIndex(sx, MIN(sy+1, h-1), w)];
-					Uint32 p8 = PixAvg(p, pk);
-					Uint32 p4 = PixAvg(p, p8);
-					Uint32 pc = PixAvg(p8, pk);
-					Uint32 po = src[PixelIndex(MIN(sx+1, w-1), MIN(sy+1, h-1), w)];
-					Uint32 pi = PixAvg(pg, po);
-					Uint32 pa = PixAvg(p8, pi);
-					Uint32 p9 = PixAvg(p8, pa);
-					Uint32 pb = PixAvg(pa, pi);
-					Uint32 p6 = PixAvg(p2, pa);
-					Uint32 p5 = PixAvg(p4, p6);
-					Uint32 pm = PixAvg(pk, po);
-					Uint32 pe = PixAvg(pa, pm);
-					Uint32 ph = PixAvg(pg, pi);
-					Uint32 p7 = PixAvg(p6, ph);
-					Uint32 pj = PixAvg(pi, po);
-					Uint32 pd = PixAvg(pc, pe);
-					Uint32 pf = PixAvg(pe, pj);
-					BLIT(dx, dy, p);
-					BLIT(dx+1, dy, p1);
-					BLIT(dx+2, dy, p2);
-					BLIT(dx+3, dy, p3);
-					BLIT(dx, dy+1, p4);
-					BLIT(dx+1, dy+1, p5);
-					BLIT(dx+2, dy+1, p6);
-					BLIT(dx+3, dy+1, p7);
-					BLIT(dx, dy+2, p8);
-					BLIT(dx+1, dy+2, p9);
-					BLIT(dx+2, dy+2, pa);
-					BLIT(dx+3, dy+2, pb);
-					BLIT(dx, dy+3, pc);
-					BLIT(dx+1, dy+3, pd);
-					BLIT(dx+2, dy+3, pe);
-					BLIT(dx+3, dy+3, pf);
-				}
-				break;
-			case 3:
-				{
-					// 0 1 2|9
-					// 3 4 5|a
-					// 6 7 8|b
-					// c-d-e+f
-					Uint32 p9 = src[PixelIndex(MIN(sx+1, w-1), sy, w)];
-					Uint32 p1 = Pix3rds(p9, p);
-					Uint32 p2 = Pix3rds(p, p9);
-					Uint32 pc = src[PixelIndex(sx, MIN(sy+1, h-1), w)];
-					Uint32 p3 = Pix3rds(pc, p);
-					Uint32 p6 = Pix3rds(p, pc);
-					Uint32 pf = src[PixelIndex(MIN(sx+1, w-1), MIN(sy+1, h-1), w)];
-					Uint32 pa = Pix3rds(pf, p9);
-					Uint32 pb = Pix3rds(p9, pf);
-					Uint32 p4 = Pix3rds(pa, p3);
-					Uint32 p5 = Pix3rds(p3, pa);
-					Uint32 p7 = Pix3rds(pb, p6);
-					Uint32 p8 = Pix3rds(p6, pb);
-					BLIT(dx, dy, p);
-					BLIT(dx+1, dy, p1);
-					BLIT(dx+2, dy, p2);
-					BLIT(dx, dy+1, p3);
-					BLIT(dx+1, dy+1, p4);
-					BLIT(dx+2, dy+1, p5);
-					BLIT(dx, dy+2, p6);
-					BLIT(dx+1, dy+2, p7);
-					BLIT(dx+2, dy+2, p8);
-				}
-				break;
-			case 2:
-				{
-					// 0 1|4
-					// 2 3|5
-					// 6-7+8
-					Uint32 p4 = src[PixelIndex(MIN(sx+1, w-1), sy, w)];
-					Uint32 p1 = PixAvg(p, p4);
-					Uint32 p6 = src[PixelIndex(sx, MIN(sy+1, h-1), w)];
-					Uint32 p2 = PixAvg(p, p6);
-					Uint32 p8 = src[PixelIndex(MIN(sx+1, w-1), MIN(sy+1, h-1), w)];
-					Uint32 p5 = PixAvg(p4, p8);
-					Uint32 p3 = PixAvg(p2, p5);
-					BLIT(dx, dy, p);
-					BLIT(dx+1, dy, p1);
-					BLIT(dx, dy+1, p2);
-					BLIT(dx+1, dy+1, p3);
-				}
-				break;
-			default:
-				BLIT(dx, dy, p);
-				break;
-			#undef BLIT
-			}
-		}
+		gBlitSpan.Blend(
+			BufRow(g, &r, i), PicRow(pic, &r, i), r.Size.x,
+			blendPixel, blend.a, g->Amask);
 	}
 }
-
-static void ApplyBrightness(Uint32 *screen, Vec2i screenSize, int brightness)
+void BlitPixels(
+	GraphicsDevice *g, const Uint32 *pixels, const Vec2i size, const Vec2i pos)
 {
-	if (brightness == 0)
+	BlitSpanRect r;
+	if (!BlitSpanClip(
+		&r, size, pos,
+		g->clipping.left, g->clipping.top,
+		g->clipping.right, g->clipping.bottom))
 	{
 		return;
 	}
-	double f = pow(1.07177346254, brightness);	// 10th root of 2; i.e. n^10 = 2
-	int m = (int)(0xFF * f);
-	int y;
-	for (y = 0; y < screenSize.y; y++)
+	for (int i = 0; i < r.Size.y; i++)
 	{
-		int x;
-		for (x = 0; x < screenSize.x; x++)
-		{
-			// Semi-optimised pixel multiplcation routine
-			// Multiply each 8-bit component with the gamma mask
-			// Detect overflows by checking if there are bits above 255
-			// If so, turning into boolean (!!) and negation will create
-			// a -1 (i.e. FFFFFFFF) mask which fills all the bits with 1
-			// i.e. saturated multiply
-			int idx = x + y * screenSize.x;
-			Uint32 p = screen[idx];
-			Uint32 pp;
-			screen[idx] = 0;
-			pp = ((p & 0xFF) * m / 0xFF);
-			screen[idx] |= (pp | -!!(pp >> 8)) & 0xFF;
-			pp = (((p >> 8) & 0xFF) * m / 0xFF);
-			screen[idx] |= ((pp | -!!(pp >> 8)) & 0xFF) << 8;
-			pp = (((p >> 16) & 0xFF) * m / 0xFF);
-			screen[idx] |= ((pp | -!!(pp >> 8)) & 0xFF) << 16;
-			pp = (((p >> 24) & 0xFF) * m / 0xFF);
-			screen[idx] |= ((pp | -!!(pp >> 8)) & 0xFF) << 24;
-		}
+		memcpy(
+			BufRow(g, &r, i),
+			pixels + (r.Src.y + i) * size.x + r.Src.x,
+			r.Size.x * sizeof *pixels);
 	}
 }
 
@@ -624,10 +332,33 @@ void BlitFlip(GraphicsDevice *g)
 {
 	Uint32 *pScreen = (Uint32 *)g->screen->pixels;
 	const Vec2i size = g->cachedConfig.Res;
-	//const int memSize = size.x * size.y;
 	const int scalef = g->cachedConfig.ScaleFactor;
 
-  ApplyBrightness(g->buf, size, ConfigGetInt(&gConfig, "Graphics.Brightness"));
+	// Find what changed since the last frame; all of it if it should look
+	// different
+	if (g->presentBrightness != g->cachedConfig.Brightness ||
+		g->presentScaleMode != g->cachedConfig.ScaleMode)
+	{
+		DirtyBlocksInvalidate(&g->dirty);
+		g->presentBrightness = g->cachedConfig.Brightness;
+		g->presentScaleMode = g->cachedConfig.ScaleMode;
+	}
+	const BrightnessLUT *lut =
+		g->presentBrightness != 0 ? &g->brightnessLUT : NULL;
+	if (!g->dirty.IsValid)
+	{
+		BrightnessLUTInit(&g->brightnessLUT, g->presentBrightness);
+#if defined(__RS97__)
+		Present16LUTInit(&g->present16LUT, g->ScreenSurface->format, lut);
+		if (g->present16 == NULL)
+		{
+			CMALLOC(g->present16, size.x * size.y * sizeof *g->present16);
+		}
+#endif
+	}
+	g->PixelsPushed = DirtyBlocksUpdate(&g->dirty, g->buf);
+	const Rect2i *rects = g->dirty.Rects;
+	const int numRects = g->dirty.NumRects;
 	if (SDL_LockSurface(g->screen) == -1)
 	{
 		printf("Couldn't lock surface; not drawing\n");
@@ -637,49 +368,72 @@ void BlitFlip(GraphicsDevice *g)
 	if (scalef == 1)
 	{
     #if !defined(__RS97__)
-      memcpy(pScreen, g->buf, sizeof *pScreen * memSize);
+      for (int i = 0; i < numRects; i++)
+      {
+        PresentCopy(pScreen, g->buf, size.x, rects[i], lut);
+      }
     #else
-      int x, y;
-      uint32_t col;
-      uint8_t Size_buffer[(320*240)*2];
-      uint32_t *s = (uint32_t*)g->buf;
-      //uint16_t *d = (uint16_t*)g->ScreenSurface->pixels;
-      uint16_t *d = (uint16_t*)Size_buffer;
-      for(y=0; y<240; y++){
-        for(x=0; x<320; x++){
-          col = *s++;
-          *d++ = SDL_MapRGB(g->ScreenSurface->format, (col & 0xff0000) >> 16, (col & 0xff00) >> 8, col & 0xff);
-        }   
-        //d+= 320;
+      for (int i = 0; i < numRects; i++)
+      {
+        PresentTo16(g->present16, g->buf, size.x, rects[i], &g->present16LUT);
       }
-      memmove(g->ScreenSurface->pixels,Size_buffer,(320*240)*2); 
+      // The screen is triple buffered, so the whole frame has to be copied
+      // to whichever buffer is next
+      memmove(g->ScreenSurface->pixels, g->present16, size.x * size.y * sizeof *g->present16);
     #endif
 	}
-	else if (ConfigGetEnum(&gConfig, "Graphics.ScaleMode") == SCALE_MODE_BILINEAR)
+	else if (g->cachedConfig.ScaleMode == SCALE_MODE_BILINEAR)
 	{
-		Bilinear(pScreen, g->buf, size.x, size.y, scalef);
+		// Each pixel is blended into several, so brighten it just once
+		Uint32 *src = g->buf;
+		if (lut != NULL)
+		{
+			for (int i = 0; i < numRects; i++)
+			{
+				PresentCopy(g->present, g->buf, size.x, rects[i], lut);
+			}
+			src = g->present;
+		}
+		for (int i = 0; i < numRects; i++)
+		{
+			PresentBilinear(pScreen, src, size.x, size.y, rects[i], scalef);
+		}
 	}
-	else if (ConfigGetEnum(&gConfig, "Graphics.ScaleMode") == SCALE_MODE_HQX)
+	else if (g->cachedConfig.ScaleMode == SCALE_MODE_HQX)
 	{
-		switch (scalef)
+		Uint32 *src = g->buf;
+		if (lut != NULL)
 		{
-		case 2:
-			hq2x_32(g->buf, pScreen, size.x, size.y);
-			break;
-		case 3:
-			hq3x_32(g->buf, pScreen, size.x, size.y);
-			break;
-		case 4:
-			hq4x_32(g->buf, pScreen, size.x, size.y);
-			break;
-		default:
-			assert(0);
-			break;
+			for (int i = 0; i < numRects; i++)
+			{
+				PresentCopy(g->present, g->buf, size.x, rects[i], lut);
+			}
+			src = g->present;
+		}
+		// hqx looks at the pixels all around, so rescale every row next
+		// to a dirty one
+		int yStart = size.y;
+		int yEnd = 0;
+		for (int i = 0; i < numRects; i++)
+		{
+			yStart = MIN(yStart, rects[i].Pos.y - 1);
+			yEnd = MAX(yEnd, rects[i].Pos.y + rects[i].Size.y + 1);
+		}
+		yStart = MAX(yStart, 0);
+		yEnd = MIN(yEnd, size.y);
+		if (yStart < yEnd)
+		{
+			g->PixelsPushed = size.x * (yEnd - yStart);
+			HqxPoolScale(
+				&g->hqxPool, scalef, src, pScreen, size, yStart, yEnd);
 		}
 	}
 	else
 	{
-		Scale8(pScreen, g->buf, size.x, size.y, scalef);
+		for (int i = 0; i < numRects; i++)
+		{
+			PresentScale(pScreen, g->buf, size.x, rects[i], scalef, lut);
+		}
 	}
 
 	SDL_UnlockSurface(g->screen);
@@ -71,6 +71,9 @@ void BlitMasked(
 	int isTransparent);
 void BlitBlend(
 	GraphicsDevice *g, const Pic *pic, Vec2i pos, const color_t blend);
+// Copy a block of opaque pixels
+void BlitPixels(
+	GraphicsDevice *g, const Uint32 *pixels, const Vec2i size, const Vec2i pos);
 void BlitPicHighlight(
 	GraphicsDevice *g, const Pic *pic, const Vec2i pos, const color_t color);
 /* DrawPic - simply draws a rectangular picture to screen. I do not
@@ -0,0 +1,239 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "blit_span.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "utils.h"
+
+// Exact x / 255 for 0 <= x <= 255 * 255, without dividing
+#define DIV255(_x) (((_x) + 1 + ((_x) >> 8)) >> 8)
+
+
+static void CopyPortable(
+	Uint32 *dst, const Uint32 *src, const int n, const Uint32 aMask)
+{
+	for (int i = 0; i < n; i++)
+	{
+		if (src[i] & aMask)
+		{
+			dst[i] = src[i];
+		}
+	}
+}
+static Uint32 PixelMult(const Uint32 p, const Uint32 m)
+{
+	Uint32 out = 0;
+	for (int shift = 0; shift < 32; shift += 8)
+	{
+		const Uint32 x = ((p >> shift) & 0xFF) * ((m >> shift) & 0xFF);
+		out |= DIV255(x) << shift;
+	}
+	return out;
+}
+static void MaskedPortable(
+	Uint32 *dst, const Uint32 *src, const int n,
+	const Uint32 mask, const bool isTransparent)
+{
+	for (int i = 0; i < n; i++)
+	{
+		if (isTransparent && src[i] == 0)
+		{
+			continue;
+		}
+		dst[i] = PixelMult(src[i], mask);
+	}
+}
+// Blend two channels at a time, in alternate bytes; each product fits in
+// 16 bits so they don't overflow into each other
+static Uint32 Blend2(const Uint32 d, const Uint32 c, const Uint32 a)
+{
+	const Uint32 x = (d & 0x00FF00FF) * (255 - a) + (c & 0x00FF00FF) * a;
+	return ((x + 0x00010001 + ((x >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+}
+static void BlendPortable(
+	Uint32 *dst, const Uint32 *src, const int n,
+	const Uint32 blend, const Uint8 alpha, const Uint32 aMask)
+{
+	for (int i = 0; i < n; i++)
+	{
+		if (src[i] == 0)
+		{
+			continue;
+		}
+		const Uint32 c = PixelMult(src[i], blend);
+		dst[i] = Blend2(dst[i], c, alpha) |
+			(Blend2(dst[i] >> 8, c >> 8, alpha) << 8) |
+			aMask;
+	}
+}
+
+#ifdef __SSE2__
+// DIV255 on 16-bit lanes
+static __m128i Div255SSE2(const __m128i x)
+{
+	return _mm_srli_epi16(
+		_mm_add_epi16(
+			_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)),
+		8);
+}
+// Take new where keep is clear, old where set
+static __m128i SelectSSE2(
+	const __m128i keep, const __m128i oldPx, const __m128i newPx)
+{
+	return _mm_or_si128(
+		_mm_and_si128(keep, oldPx), _mm_andnot_si128(keep, newPx));
+}
+static void CopySSE2(
+	Uint32 *dst, const Uint32 *src, const int n, const Uint32 aMask)
+{
+	const __m128i am = _mm_set1_epi32((int)aMask);
+	const __m128i zero = _mm_setzero_si128();
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+		const __m128i keep = _mm_cmpeq_epi32(_mm_and_si128(s, am), zero);
+		_mm_storeu_si128((__m128i *)(dst + i), SelectSSE2(keep, d, s));
+	}
+	CopyPortable(dst + i, src + i, n - i, aMask);
+}
+static __m128i PixelMultSSE2(const __m128i s, const __m128i m16)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lo = Div255SSE2(
+		_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), m16));
+	const __m128i hi = Div255SSE2(
+		_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), m16));
+	return _mm_packus_epi16(lo, hi);
+}
+static void MaskedSSE2(
+	Uint32 *dst, const Uint32 *src, const int n,
+	const Uint32 mask, const bool isTransparent)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i m16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)mask), zero);
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i r = PixelMultSSE2(s, m16);
+		if (isTransparent)
+		{
+			const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+			r = SelectSSE2(_mm_cmpeq_epi32(s, zero), d, r);
+		}
+		_mm_storeu_si128((__m128i *)(dst + i), r);
+	}
+	MaskedPortable(dst + i, src + i, n - i, mask, isTransparent);
+}
+static void BlendSSE2(
+	Uint32 *dst, const Uint32 *src, const int n,
+	const Uint32 blend, const Uint8 alpha, const Uint32 aMask)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i b16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)blend), zero);
+	const __m128i a16 = _mm_set1_epi16(alpha);
+	const __m128i na16 = _mm_set1_epi16((short)(255 - alpha));
+	const __m128i am = _mm_set1_epi32((int)aMask);
+	int i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+		const __m128i c = PixelMultSSE2(s, b16);
+		const __m128i lo = Div255SSE2(_mm_add_epi16(
+			_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), na16),
+			_mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), a16)));
+		const __m128i hi = Div255SSE2(_mm_add_epi16(
+			_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), na16),
+			_mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), a16)));
+		const __m128i r = _mm_or_si128(_mm_packus_epi16(lo, hi), am);
+		_mm_storeu_si128(
+			(__m128i *)(dst + i),
+			SelectSSE2(_mm_cmpeq_epi32(s, zero), d, r));
+	}
+	BlendPortable(dst + i, src + i, n - i, blend, alpha, aMask);
+}
+#endif
+
+static const BlitSpanFuncs sImpls[BLIT_SPAN_COUNT] =
+{
+	{ "portable", CopyPortable, MaskedPortable, BlendPortable },
+#ifdef __SSE2__
+	{ "SSE2", CopySSE2, MaskedSSE2, BlendSSE2 },
+#else
+	{ NULL, NULL, NULL, NULL },
+#endif
+};
+BlitSpanFuncs gBlitSpan =
+{
+	"portable", CopyPortable, MaskedPortable, BlendPortable
+};
+
+const char *BlitSpanImplStr(const BlitSpanImpl impl)
+{
+	switch (impl)
+	{
+		T2S(BLIT_SPAN_PORTABLE, "portable");
+		T2S(BLIT_SPAN_SSE2, "SSE2");
+	default:
+		return "";
+	}
+}
+
+bool BlitSpanIsCompiled(const BlitSpanImpl impl)
+{
+	return impl >= 0 && impl < BLIT_SPAN_COUNT && sImpls[impl].Name != NULL;
+}
+void BlitSpanUse(const BlitSpanImpl impl)
+{
+	CASSERT(BlitSpanIsCompiled(impl), "blitter not compiled in");
+	gBlitSpan = sImpls[impl];
+}
+
+bool BlitSpanClip(
+	BlitSpanRect *r, const Vec2i size, const Vec2i pos,
+	const int left, const int top, const int right, const int bottom)
+{
+	const int x0 = MAX(pos.x, left);
+	const int y0 = MAX(pos.y, top);
+	const int x1 = MIN(pos.x + size.x - 1, right);
+	const int y1 = MIN(pos.y + size.y - 1, bottom);
+	if (x1 < x0 || y1 < y0)
+	{
+		return false;
+	}
+	r->Src = Vec2iNew(x0 - pos.x, y0 - pos.y);
+	r->Dst = Vec2iNew(x0, y0);
+	r->Size = Vec2iNew(x1 - x0 + 1, y1 - y0 + 1);
+	return true;
+}
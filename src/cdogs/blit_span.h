@@ -0,0 +1,85 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include <SDL_stdinc.h>
+
+#include "vector.h"
+
+// Inner loops for the blitters, run on spans of pixels that have already
+// been clipped
+// Pixels are 32-bit with 8-bit channels; the functions treat all channels
+// alike except for alpha, given by its mask.
+typedef struct
+{
+	const char *Name;
+	// Copy pixels that aren't fully transparent
+	void (*Copy)(
+		Uint32 *dst, const Uint32 *src, const int n, const Uint32 aMask);
+	// Copy pixels multiplied channel-wise by a mask; if isTransparent,
+	// skip zero pixels
+	void (*Masked)(
+		Uint32 *dst, const Uint32 *src, const int n,
+		const Uint32 mask, const bool isTransparent);
+	// Alpha blend non-zero pixels, multiplied by a colour, over the
+	// destination; the result is opaque
+	void (*Blend)(
+		Uint32 *dst, const Uint32 *src, const int n,
+		const Uint32 blend, const Uint8 alpha, const Uint32 aMask);
+} BlitSpanFuncs;
+
+typedef enum
+{
+	BLIT_SPAN_PORTABLE,
+	BLIT_SPAN_SSE2,
+	BLIT_SPAN_COUNT
+} BlitSpanImpl;
+const char *BlitSpanImplStr(const BlitSpanImpl impl);
+
+// The implementation used by the blitters; portable until one is chosen
+extern BlitSpanFuncs gBlitSpan;
+
+// Whether an implementation was compiled in; it may still need checking
+// that the CPU supports it
+bool BlitSpanIsCompiled(const BlitSpanImpl impl);
+void BlitSpanUse(const BlitSpanImpl impl);
+
+// Part of a picture that is inside the clipping rectangle
+typedef struct
+{
+	Vec2i Src;	// first visible pixel in the picture
+	Vec2i Dst;	// where it goes in the buffer
+	Vec2i Size;
+} BlitSpanRect;
+// Clip a picture to an inclusive rectangle
+// Returns false if none of it is visible
+bool BlitSpanClip(
+	BlitSpanRect *r, const Vec2i size, const Vec2i pos,
+	const int left, const int top, const int right, const int bottom);
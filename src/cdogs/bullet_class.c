@@ -65,28 +65,23 @@ BulletClasses gBulletClasses;
 #define SPECIAL_LOCK 12
 
 
-// TODO: use map structure?
 BulletClass *StrBulletClass(const char *s)
 {
 	if (s == NULL || strlen(s) == 0)
 	{
 		return NULL;
 	}
-	for (int i = 0; i < (int)gBulletClasses.CustomClasses.size; i++)
+	// Custom bullets shadow built-in ones
+	BulletClass *b = NameIndexGet(
+		&gBulletClasses.CustomClassIndex, &gBulletClasses.CustomClasses, s);
+	if (b == NULL)
 	{
-		BulletClass *b = CArrayGet(&gBulletClasses.CustomClasses, i);
-		if (strcmp(s, b->Name) == 0)
-		{
-			return b;
-		}
+		b = NameIndexGet(
+			&gBulletClasses.ClassIndex, &gBulletClasses.Classes, s);
 	}
-	for (int i = 0; i < (int)gBulletClasses.Classes.size; i++)
+	if (b != NULL)
 	{
-		BulletClass *b = CArrayGet(&gBulletClasses.Classes, i);
-		if (strcmp(s, b->Name) == 0)
-		{
-			return b;
-		}
+		return b;
 	}
 	CASSERT(false, "cannot parse bullet name");
 	return NULL;
@@ -270,21 +265,21 @@ bool UpdateBullet(TMobileObject *obj, const int ticks)
 	}
 	if (hitWall || hitItem != HIT_NONE)
 	{
-		GameEvent b = GameEventNew(GAME_EVENT_BULLET_BOUNCE);
-		b.u.BulletBounce.UID = obj->UID;
+		GameEvent *b = GameEventsAdd(&gGameEvents, GAME_EVENT_BULLET_BOUNCE);
+		b->u.BulletBounce.UID = obj->UID;
 		if (hitWall && !Vec2iIsZero(obj->vel))
 		{
-			b.u.BulletBounce.HitType = (int)HIT_WALL;
+			b->u.BulletBounce.HitType = (int)HIT_WALL;
 		}
 		else
 		{
-			b.u.BulletBounce.HitType = (int)hitItem;
+			b->u.BulletBounce.HitType = (int)hitItem;
 		}
 		bool alive = true;
 		if ((hitWall && !obj->bulletClass->WallBounces) ||
 			((hitItem != HIT_NONE) && obj->bulletClass->HitsObjects))
 		{
-			b.u.BulletBounce.Spark = true;
+			b->u.BulletBounce.Spark = true;
 			CASSERT(!gCampaign.IsClient, "Cannot process bounces as client");
 			FireGuns(obj, &obj->bulletClass->HitGuns);
 			if (hitWall || !obj->bulletClass->Persists)
@@ -292,18 +287,18 @@ bool UpdateBullet(TMobileObject *obj, const int ticks)
 				alive = false;
 			}
 		}
-		b.u.BulletBounce.BouncePos = Vec2i2Net(pos);
-		b.u.BulletBounce.BounceVel = Vec2i2Net(obj->vel);
+		b->u.BulletBounce.BouncePos = Vec2i2Net(pos);
+		b->u.BulletBounce.BounceVel = Vec2i2Net(obj->vel);
 		if (hitWall && !Vec2iIsZero(obj->vel))
 		{
 			// Bouncing
 			Vec2i bounceVel = obj->vel;
 			pos = GetWallBounceFullPos(objPos, pos, &bounceVel);
-			b.u.BulletBounce.BouncePos = Vec2i2Net(pos);
-			b.u.BulletBounce.BounceVel = Vec2i2Net(bounceVel);
+			b->u.BulletBounce.BouncePos = Vec2i2Net(pos);
+			b->u.BulletBounce.BounceVel = Vec2i2Net(bounceVel);
 			obj->vel = bounceVel;
 		}
-		GameEventsEnqueue(&gGameEvents, b);
+		GameEventsCommit(&gGameEvents, b);
 		if (!alive)
 		{
 			return false;
@@ -345,7 +340,7 @@ bool UpdateBullet(TMobileObject *obj, const int ticks)
 					{
 						continue;
 					}
-					if (TileHasCharacter(MapGetTile(&gMap, dtv)))
+					if (MapTileHasCharacter(&gMap, dtv))
 					{
 						FireGuns(obj, &obj->bulletClass->ProximityGuns);
 						return false;
@@ -452,11 +447,17 @@ bail:
 #define VERSION 1
 static void LoadBullet(
 	BulletClass *b, json_t *node, const BulletClass *defaultBullet);
+static const char *BulletClassGetName(const void *b)
+{
+	return ((const BulletClass *)b)->Name;
+}
 void BulletInitialize(BulletClasses *bullets)
 {
 	memset(bullets, 0, sizeof *bullets);
 	CArrayInit(&bullets->Classes, sizeof(BulletClass));
 	CArrayInit(&bullets->CustomClasses, sizeof(BulletClass));
+	NameIndexInit(&bullets->ClassIndex, BulletClassGetName);
+	NameIndexInit(&bullets->CustomClassIndex, BulletClassGetName);
 }
 static void BulletClassFree(BulletClass *b);
 void BulletLoadJSON(
@@ -700,6 +701,8 @@ void BulletTerminate(BulletClasses *bullets)
 	CArrayTerminate(&bullets->Classes);
 	BulletClassesClear(&bullets->CustomClasses);
 	CArrayTerminate(&bullets->CustomClasses);
+	NameIndexTerminate(&bullets->ClassIndex);
+	NameIndexTerminate(&bullets->CustomClassIndex);
 }
 void BulletClassesClear(CArray *classes)
 {
@@ -709,6 +712,11 @@ void BulletClassesClear(CArray *classes)
 	}
 	CArrayClear(classes);
 }
+void BulletClassesClearCustom(BulletClasses *bullets)
+{
+	BulletClassesClear(&bullets->CustomClasses);
+	NameIndexClear(&bullets->CustomClassIndex);
+}
 static void BulletClassFree(BulletClass *b)
 {
 	CFREE(b->Name);
@@ -725,28 +733,8 @@ void BulletAdd(const NAddBullet add)
 {
 	const Vec2i pos = Net2Vec2i(add.MuzzlePos);
 
-	// Find an empty slot in mobobj list
-	TMobileObject *obj = NULL;
-	int i;
-	for (i = 0; i < (int)gMobObjs.size; i++)
-	{
-		TMobileObject *m = CArrayGet(&gMobObjs, i);
-		if (!m->isInUse)
-		{
-			obj = m;
-			break;
-		}
-	}
-	if (obj == NULL)
-	{
-		TMobileObject m;
-		memset(&m, 0, sizeof m);
-		CArrayPushBack(&gMobObjs, &m);
-		i = (int)gMobObjs.size - 1;
-		obj = CArrayGet(&gMobObjs, i);
-	}
-	memset(obj, 0, sizeof *obj);
-	obj->UID = add.UID;
+	TMobileObject *obj = MobObjAdd(add.UID);
+	const int i = obj->tileItem.id;
 	obj->bulletClass = StrBulletClass(add.BulletClass);
 	obj->x = pos.x;
 	obj->y = pos.y;
@@ -773,7 +761,6 @@ void BulletAdd(const NAddBullet add)
 	}
 
 	obj->tileItem.kind = KIND_MOBILEOBJECT;
-	obj->tileItem.id = i;
 	obj->isInUse = true;
 	obj->tileItem.x = obj->tileItem.y = -1;
 	obj->tileItem.getPicFunc = NULL;
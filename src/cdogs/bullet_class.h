@@ -52,6 +52,7 @@
 
 #include "proto/msg.pb.h"
 
+#include "name_index.h"
 #include "particle.h"
 #include "sounds.h"
 #include "tile.h"
@@ -104,6 +105,8 @@ typedef struct
 	CArray Classes;	// of BulletClass
 	BulletClass Default;
 	CArray CustomClasses;	// of BulletClass
+	NameIndex ClassIndex;
+	NameIndex CustomClassIndex;
 	json_t *root;
 } BulletClasses;
 extern BulletClasses gBulletClasses;
@@ -116,6 +119,7 @@ void BulletLoadJSON(
 // 2-step initialisation since bullet and weapon reference each other
 void BulletLoadWeapons(BulletClasses *bullets);
 void BulletClassesClear(CArray *classes);
+void BulletClassesClearCustom(BulletClasses *bullets);
 void BulletTerminate(BulletClasses *bullets);
 
 void BulletAdd(const NAddBullet add);
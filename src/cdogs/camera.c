@@ -33,6 +33,10 @@
 #include "font.h"
 #include "los.h"
 #include "player.h"
+#include "profiler.h"
+
+static ConfigHandle sInterfaceSplitscreen =
+	CONFIG_HANDLE("Interface.Splitscreen");
 
 
 #define PAN_SPEED 4
@@ -436,12 +440,14 @@ static void DoBuffer(
 {
 	DrawBufferSetFromMap(b, &gMap, Vec2iAdd(center, noise), w);
 	DrawBufferFix(b);
+	PROFILE_BEGIN(PROFILE_DRAW_BUFFER);
 	DrawBufferDraw(b, offset, NULL);
+	PROFILE_END(PROFILE_DRAW_BUFFER);
 }
 
 bool CameraIsSingleScreen(void)
 {
-	if (ConfigGetEnum(&gConfig, "Interface.Splitscreen") == SPLITSCREEN_ALWAYS)
+	if (ConfigHandleGetEnum(&sInterfaceSplitscreen) == SPLITSCREEN_ALWAYS)
 	{
 		return false;
 	}
@@ -177,16 +177,16 @@ bool IsCollisionDiamond(const Map *map, const Vec2i pos, const Vec2i fullSize)
 }
 
 static bool ItemsCollide(
-	const TTileItem *item1, const TTileItem *item2, const Vec2i pos)
+	const TTileItem *item1, const SpatialHashEntry *e2, const Vec2i pos)
 {
-	int dx = abs(pos.x - item2->x);
-	int dy = abs(pos.y - item2->y);
-	const Vec2i r = Vec2iScaleDiv(Vec2iAdd(item1->size, item2->size), 2);
+	int dx = abs(pos.x - e2->Pos.x);
+	int dy = abs(pos.y - e2->Pos.y);
+	const Vec2i r = Vec2iScaleDiv(Vec2iAdd(item1->size, e2->Size), 2);
 
 	if (dx < r.x && dy < r.y)
 	{
-		int odx = abs(item1->x - item2->x);
-		int ody = abs(item1->y - item2->y);
+		int odx = abs(item1->x - e2->Pos.x);
+		int ody = abs(item1->y - e2->Pos.y);
 
 		if (dx <= odx || dy <= ody)
 		{
@@ -203,24 +203,62 @@ bool AreasCollide(
 	return d.x < r.x && d.y < r.y;
 }
 
-bool CollisionIsOnSameTeam(
-	const TTileItem *i, const CollisionTeam team, const bool isPVP)
+static bool IsOnSameTeam(
+	const CollisionTeam itemTeam, const CollisionTeam team, const bool isPVP)
 {
 	if (gCollisionSystem.allyCollision == ALLYCOLLISION_NORMAL)
 	{
 		return false;
 	}
+	return
+		team != COLLISIONTEAM_NONE &&
+		itemTeam != COLLISIONTEAM_NONE &&
+		team == itemTeam &&
+		!isPVP;
+}
+bool CollisionIsOnSameTeam(
+	const TTileItem *i, const CollisionTeam team, const bool isPVP)
+{
 	CollisionTeam itemTeam = COLLISIONTEAM_NONE;
 	if (i->kind == KIND_CHARACTER)
 	{
 		const TActor *a = CArrayGet(&gActors, i->id);
 		itemTeam = CalcCollisionTeam(1, a);
 	}
-	return
-		team != COLLISIONTEAM_NONE &&
-		itemTeam != COLLISIONTEAM_NONE &&
-		team == itemTeam &&
-		!isPVP;
+	return IsOnSameTeam(itemTeam, team, isPVP);
+}
+
+// Broadphase results, of SpatialHashEntry
+// This is used as a stack: each query pushes its results and pops them when
+// done, so that collision callbacks can themselves run collision queries
+static CArray sQueryEntries;
+static int CollisionQuery(const Vec2i pos, const int mask)
+{
+	if (sQueryEntries.elemSize == 0)
+	{
+		CArrayInit(&sQueryEntries, sizeof(SpatialHashEntry));
+		CArrayReserve(&sQueryEntries, 64);
+	}
+	const int start = (int)sQueryEntries.size;
+	// Check collisions with all other items on this tile, in all 8 directions
+	SpatialHashQuery(&gMap.Things, pos, 1, mask, &sQueryEntries);
+	return start;
+}
+static TTileItem *CollisionQueryGetItem(
+	const int idx, const TTileItem *item,
+	const CollisionTeam team, const bool isPVP)
+{
+	const SpatialHashEntry *e = CArrayGet(&sQueryEntries, idx);
+	// Don't collide if items are on the same team
+	if (IsOnSameTeam(e->Team, team, isPVP)) return NULL;
+	// No same-item collision
+	if (item != NULL && e->Id.Kind == item->kind && e->Id.Id == item->id)
+	{
+		return NULL;
+	}
+	// Skip items that have been removed by earlier callbacks
+	if (SpatialHashGet(&gMap.Things, e->Id) == NULL) return NULL;
+	return ThingIdGetTileItem(&e->Id);
 }
 
 void CollideTileItems(
@@ -228,36 +266,21 @@ void CollideTileItems(
 	const int mask, const CollisionTeam team, const bool isPVP,
 	CollideItemFunc func, void *data)
 {
-	const Vec2i tv = Vec2iToTile(pos);
-	Vec2i dv;
-	// Check collisions with all other items on this tile, in all 8 directions
-	for (dv.y = -1; dv.y <= 1; dv.y++)
+	const int start = CollisionQuery(pos, mask);
+	const int end = (int)sQueryEntries.size;
+	for (int i = start; i < end; i++)
 	{
-		for (dv.x = -1; dv.x <= 1; dv.x++)
+		const SpatialHashEntry *e = CArrayGet(&sQueryEntries, i);
+		if (!ItemsCollide(item, e, pos)) continue;
+		TTileItem *ti = CollisionQueryGetItem(i, item, team, isPVP);
+		if (ti == NULL) continue;
+		// Collision callback and check continue
+		if (!func(ti, data))
 		{
-			const Vec2i dtv = Vec2iAdd(tv, dv);
-			if (!MapIsTileIn(&gMap, dtv))
-			{
-				continue;
-			}
-			CArray *tileThings = &MapGetTile(&gMap, dtv)->things;
-			for (int i = 0; i < (int)tileThings->size; i++)
-			{
-				TTileItem *ti = ThingIdGetTileItem(CArrayGet(tileThings, i));
-				// Don't collide if items are on the same team
-				if (CollisionIsOnSameTeam(ti, team, isPVP)) continue;
-				// No same-item collision
-				if (item == ti) continue;
-				if (mask != 0 && !(ti->flags & mask)) continue;
-				if (!ItemsCollide(item, ti, pos)) continue;
-				// Collision callback and check continue
-				if (!func(ti, data))
-				{
-					return;
-				}
-			}
+			break;
 		}
 	}
+	sQueryEntries.size = start;
 }
 static bool CollideGetFirstItemCallback(TTileItem *ti, void *data);
 TTileItem *CollideGetFirstItem(
@@ -277,42 +300,22 @@ static bool CollideGetFirstItemCallback(TTileItem *ti, void *data)
 	return false;
 }
 
-// TODO: refactor with Collide functions
 TTileItem *OverlapGetFirstItem(
 	const TTileItem *item, const Vec2i pos, const Vec2i size,
 	const int mask, const CollisionTeam team, const bool isPVP)
 {
-	const Vec2i tv = Vec2iToTile(pos);
-	Vec2i dv;
-	// Check collisions with all other items on this tile, in all 8 directions
-	for (dv.y = -1; dv.y <= 1; dv.y++)
+	const int start = CollisionQuery(pos, mask);
+	const int end = (int)sQueryEntries.size;
+	TTileItem *ti = NULL;
+	for (int i = start; i < end && ti == NULL; i++)
 	{
-		for (dv.x = -1; dv.x <= 1; dv.x++)
-		{
-			const Vec2i dtv = Vec2iAdd(tv, dv);
-			if (!MapIsTileIn(&gMap, dtv))
-			{
-				continue;
-			}
-			CArray *tileThings = &MapGetTile(&gMap, dtv)->things;
-			for (int i = 0; i < (int)tileThings->size; i++)
-			{
-				TTileItem *ti = ThingIdGetTileItem(CArrayGet(tileThings, i));
-				// Don't collide if items are on the same team
-				if (CollisionIsOnSameTeam(ti, team, isPVP)) continue;
-				// No same-item collision
-				if (item == ti) continue;
-				if (mask != 0 && !(ti->flags & mask)) continue;
-				if (!AreasCollide(pos, Vec2iNew(ti->x, ti->y), size, ti->size))
-				{
-					continue;
-				}
-				// Overlaps
-				return ti;
-			}
-		}
+		const SpatialHashEntry *e = CArrayGet(&sQueryEntries, i);
+		if (!AreasCollide(pos, e->Pos, size, e->Size)) continue;
+		// Overlaps
+		ti = CollisionQueryGetItem(i, item, team, isPVP);
 	}
-	return NULL;
+	sQueryEntries.size = start;
+	return ti;
 }
 
 Vec2i GetWallBounceFullPos(
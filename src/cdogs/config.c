@@ -290,6 +290,7 @@ static Config ConfigNew(const char *name, const ConfigType type)
 void ConfigDestroy(Config *c)
 {
 	CFREE(c->Name);
+	CArrayTerminate(&c->Listeners);
 	if (c->Type == CONFIG_TYPE_GROUP)
 	{
 		for (int i = 0; i < (int)c->u.Group.size; i++)
@@ -306,6 +307,38 @@ void ConfigGroupAdd(Config *group, Config child)
 	CArrayPushBack(&group->u.Group, &child);
 }
 
+void ConfigAddListener(Config *c, ConfigChangeFunc func, void *data)
+{
+	if (c->Listeners.elemSize == 0)
+	{
+		CArrayInit(&c->Listeners, sizeof(ConfigListener));
+	}
+	ConfigListener l;
+	l.Func = func;
+	l.Data = data;
+	CArrayPushBack(&c->Listeners, &l);
+}
+void ConfigRemoveListener(Config *c, ConfigChangeFunc func, void *data)
+{
+	for (int i = 0; i < (int)c->Listeners.size; i++)
+	{
+		const ConfigListener *l = CArrayGet(&c->Listeners, i);
+		if (l->Func == func && l->Data == data)
+		{
+			CArrayDelete(&c->Listeners, i);
+			return;
+		}
+	}
+}
+static void NotifyListeners(const Config *c)
+{
+	for (int i = 0; i < (int)c->Listeners.size; i++)
+	{
+		const ConfigListener *l = CArrayGet(&c->Listeners, i);
+		l->Func(c, l->Data);
+	}
+}
+
 int ConfigGetVersion(FILE *f)
 {
 	if (ConfigIsOld(f))
@@ -318,21 +351,23 @@ int ConfigGetVersion(FILE *f)
 
 Config *ConfigGet(Config *c, const char *name)
 {
-	char *nameCopy;
-	CSTRDUP(nameCopy, name);
-	char *pch = strtok(nameCopy, ".");
-	while (pch != NULL)
+	// Match each dot-separated part in place; don't allocate
+	const char *pch = name;
+	while (*pch != '\0')
 	{
+		const char *end = strchr(pch, '.');
+		const size_t len = end != NULL ? (size_t)(end - pch) : strlen(pch);
 		if (c->Type != CONFIG_TYPE_GROUP)
 		{
 			CASSERT(false, "Invalid config type");
-			goto bail;
+			break;
 		}
 		bool found = false;
 		for (int i = 0; i < (int)c->u.Group.size; i++)
 		{
 			Config *child = CArrayGet(&c->u.Group, i);
-			if (strcmp(child->Name, pch) == 0)
+			if (strncmp(child->Name, pch, len) == 0 &&
+				child->Name[len] == '\0')
 			{
 				c = child;
 				found = true;
@@ -342,12 +377,14 @@ Config *ConfigGet(Config *c, const char *name)
 		if (!found)
 		{
 			CASSERT(false, "Config not found");
-			goto bail;
+			break;
+		}
+		pch += len;
+		if (*pch == '.')
+		{
+			pch++;
 		}
-		pch = strtok(NULL, ".");
 	}
-bail:
-	CFREE(nameCopy);
 	return c;
 }
 
@@ -414,6 +451,7 @@ void ConfigResetChanged(Config *c)
 
 void ConfigSetChanged(Config *c)
 {
+	const bool changed = ConfigChanged(c);
 	switch (c->Type)
 	{
 	case CONFIG_TYPE_STRING:
@@ -442,6 +480,10 @@ void ConfigSetChanged(Config *c)
 		CASSERT(false, "Unknown config type");
 		break;
 	}
+	if (changed)
+	{
+		NotifyListeners(c);
+	}
 }
 
 void ConfigResetDefault(Config *c)
@@ -513,6 +555,33 @@ CArray *ConfigGetGroup(Config *c, const char *name)
 	return &c->u.Group;
 }
 
+Config *ConfigHandleGet(ConfigHandle *h)
+{
+	if (h->Entry == NULL)
+	{
+		h->Entry = ConfigGet(&gConfig, h->Name);
+	}
+	return h->Entry;
+}
+int ConfigHandleGetInt(ConfigHandle *h)
+{
+	const Config *c = ConfigHandleGet(h);
+	CASSERT(c->Type == CONFIG_TYPE_INT, "wrong config type");
+	return c->u.Int.Value;
+}
+bool ConfigHandleGetBool(ConfigHandle *h)
+{
+	const Config *c = ConfigHandleGet(h);
+	CASSERT(c->Type == CONFIG_TYPE_BOOL, "wrong config type");
+	return c->u.Bool.Value;
+}
+int ConfigHandleGetEnum(ConfigHandle *h)
+{
+	const Config *c = ConfigHandleGet(h);
+	CASSERT(c->Type == CONFIG_TYPE_ENUM, "wrong config type");
+	return c->u.Enum.Value;
+}
+
 Config ConfigDefault(void)
 {
 	Config root = ConfigNewGroup(NULL);
@@ -557,6 +626,13 @@ Config ConfigDefault(void)
 	ConfigGroupAdd(&game, ConfigNewEnum(
 		"LaserSight", LASER_SIGHT_NONE, LASER_SIGHT_NONE, LASER_SIGHT_ALL,
 		StrLaserSight, LaserSightStr));
+	// Decisions per tick for AI away from players; 0 for no limit
+	ConfigGroupAdd(&game,
+		ConfigNewInt("AIThinksPerTick", 16, 0, 256, 4, NULL, NULL));
+	// Tiles around a net client's players that it gets effects and actor
+	// movement for; 0 for the whole map
+	ConfigGroupAdd(&game,
+		ConfigNewInt("NetRelevance", 24, 0, 100, 4, NULL, NULL));
 	ConfigGroupAdd(&root, game);
 
 	Config dm = ConfigNewGroup("Deathmatch");
@@ -627,6 +703,7 @@ Config ConfigDefault(void)
 
 	Config itf = ConfigNewGroup("Interface");
 	ConfigGroupAdd(&itf, ConfigNewBool("ShowFPS", false));
+	ConfigGroupAdd(&itf, ConfigNewBool("ShowProfiler", false));
 	ConfigGroupAdd(&itf, ConfigNewBool("ShowTime", false));
 	ConfigGroupAdd(&itf, ConfigNewBool("ShowHUDMap", true));
 	ConfigGroupAdd(&itf, ConfigNewEnum(
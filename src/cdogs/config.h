@@ -138,6 +138,7 @@ typedef struct
 {
 	char *Name;
 	ConfigType Type;
+	CArray Listeners;	// of ConfigListener
 	union
 	{
 #define VALUES(_name, _type) \
@@ -192,6 +193,19 @@ bool ConfigChangedAndApply(Config *c);
 
 void ConfigGroupAdd(Config *group, Config child);
 
+// Change notification
+// Listeners are called when a changed value is applied (ConfigSetChanged),
+// e.g. when the user edits an option in the menu.
+// Listeners on groups are called if any of their children changed.
+typedef void (*ConfigChangeFunc)(const Config *c, void *data);
+typedef struct
+{
+	ConfigChangeFunc Func;
+	void *Data;
+} ConfigListener;
+void ConfigAddListener(Config *c, ConfigChangeFunc func, void *data);
+void ConfigRemoveListener(Config *c, ConfigChangeFunc func, void *data);
+
 extern Config gConfig;
 
 Config ConfigDefault(void);
@@ -225,5 +239,21 @@ bool ConfigGetBool(Config *c, const char *name);
 int ConfigGetEnum(Config *c, const char *name);
 CArray *ConfigGetGroup(Config *c, const char *name);
 
+// Handle to an entry in gConfig, for hot paths
+// The name is looked up once, on first use; after that values are read
+// straight from the entry.
+// Declare handles as statics, e.g.
+// static ConfigHandle sFoo = CONFIG_HANDLE("Game.Foo");
+typedef struct
+{
+	const char *Name;
+	Config *Entry;
+} ConfigHandle;
+#define CONFIG_HANDLE(_name) { _name, NULL }
+Config *ConfigHandleGet(ConfigHandle *h);
+int ConfigHandleGetInt(ConfigHandle *h);
+bool ConfigHandleGetBool(ConfigHandle *h);
+int ConfigHandleGetEnum(ConfigHandle *h);
+
 bool ConfigApply(Config *config);
 int ConfigGetVersion(FILE *f);
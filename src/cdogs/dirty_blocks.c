@@ -0,0 +1,153 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "dirty_blocks.h"
+
+#include <string.h>
+
+#include "utils.h"
+
+
+void DirtyBlocksInit(DirtyBlocks *d, const Vec2i size)
+{
+	memset(d, 0, sizeof *d);
+	d->Size = size;
+	d->Blocks = Vec2iNew(
+		(size.x + DIRTY_BLOCK_SIZE - 1) / DIRTY_BLOCK_SIZE,
+		(size.y + DIRTY_BLOCK_SIZE - 1) / DIRTY_BLOCK_SIZE);
+	CMALLOC(d->Last, size.x * size.y * sizeof *d->Last);
+	CMALLOC(d->Rects, d->Blocks.x * d->Blocks.y * sizeof *d->Rects);
+}
+void DirtyBlocksTerminate(DirtyBlocks *d)
+{
+	CFREE(d->Last);
+	CFREE(d->Rects);
+	memset(d, 0, sizeof *d);
+}
+void DirtyBlocksInvalidate(DirtyBlocks *d)
+{
+	d->IsValid = false;
+}
+
+// Compare a block, and copy it if it changed
+static bool UpdateBlock(
+	DirtyBlocks *d, const Uint32 *frame, const Rect2i block)
+{
+	const size_t rowSize = block.Size.x * sizeof *frame;
+	const int start = block.Pos.y * d->Size.x + block.Pos.x;
+	int y = 0;
+	for (; y < block.Size.y; y++)
+	{
+		const int i = start + y * d->Size.x;
+		if (memcmp(d->Last + i, frame + i, rowSize) != 0)
+		{
+			break;
+		}
+	}
+	if (y == block.Size.y)
+	{
+		return false;
+	}
+	for (; y < block.Size.y; y++)
+	{
+		const int i = start + y * d->Size.x;
+		memcpy(d->Last + i, frame + i, rowSize);
+	}
+	return true;
+}
+static Rect2i GetBlock(const DirtyBlocks *d, const int bx, const int by)
+{
+	Rect2i r;
+	r.Pos = Vec2iNew(bx * DIRTY_BLOCK_SIZE, by * DIRTY_BLOCK_SIZE);
+	r.Size = Vec2iNew(
+		MIN(DIRTY_BLOCK_SIZE, d->Size.x - r.Pos.x),
+		MIN(DIRTY_BLOCK_SIZE, d->Size.y - r.Pos.y));
+	return r;
+}
+static void AddRect(DirtyBlocks *d, const Rect2i r);
+int DirtyBlocksUpdate(DirtyBlocks *d, const Uint32 *frame)
+{
+	d->NumRects = 0;
+	if (!d->IsValid)
+	{
+		memcpy(d->Last, frame, d->Size.x * d->Size.y * sizeof *frame);
+		d->IsValid = true;
+		d->Rects[0].Pos = Vec2iZero();
+		d->Rects[0].Size = d->Size;
+		d->NumRects = 1;
+		return d->Size.x * d->Size.y;
+	}
+	int pixels = 0;
+	for (int by = 0; by < d->Blocks.y; by++)
+	{
+		// Merge runs of dirty blocks in this row
+		Rect2i run = { { 0, 0 }, { 0, 0 } };
+		for (int bx = 0; bx < d->Blocks.x; bx++)
+		{
+			const Rect2i block = GetBlock(d, bx, by);
+			if (!UpdateBlock(d, frame, block))
+			{
+				continue;
+			}
+			pixels += block.Size.x * block.Size.y;
+			if (run.Size.x > 0 && run.Pos.x + run.Size.x == block.Pos.x)
+			{
+				run.Size.x += block.Size.x;
+			}
+			else
+			{
+				if (run.Size.x > 0)
+				{
+					AddRect(d, run);
+				}
+				run = block;
+			}
+		}
+		if (run.Size.x > 0)
+		{
+			AddRect(d, run);
+		}
+	}
+	return pixels;
+}
+// Add a run of dirty blocks, extending a rectangle that ends just above it
+// if it spans the same columns
+static void AddRect(DirtyBlocks *d, const Rect2i r)
+{
+	for (int i = 0; i < d->NumRects; i++)
+	{
+		Rect2i *above = &d->Rects[i];
+		if (above->Pos.x == r.Pos.x && above->Size.x == r.Size.x &&
+			above->Pos.y + above->Size.y == r.Pos.y)
+		{
+			above->Size.y += r.Size.y;
+			return;
+		}
+	}
+	d->Rects[d->NumRects] = r;
+	d->NumRects++;
+}
@@ -0,0 +1,59 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include <SDL_stdinc.h>
+
+#include "vector.h"
+
+// Finds which parts of a frame changed since the last one, so that only
+// those need presenting
+// Frames are compared in square blocks; changed blocks are merged into
+// rectangles.
+#define DIRTY_BLOCK_SIZE 16
+
+typedef struct
+{
+	Vec2i Size;	// of frames, in pixels
+	Vec2i Blocks;
+	Uint32 *Last;	// last frame seen
+	bool IsValid;	// whether Last holds a frame
+	Rect2i *Rects;
+	int NumRects;
+} DirtyBlocks;
+
+void DirtyBlocksInit(DirtyBlocks *d, const Vec2i size);
+void DirtyBlocksTerminate(DirtyBlocks *d);
+// Make the next update mark the whole frame dirty
+void DirtyBlocksInvalidate(DirtyBlocks *d);
+
+// Compare a frame with the last one and find the dirty rectangles
+// Returns the number of dirty pixels
+int DirtyBlocksUpdate(DirtyBlocks *d, const Uint32 *frame);
@@ -59,7 +59,7 @@
 static int GetDoorCountInGroup(
 	const Map *map, const Vec2i v, const bool isHorizontal);
 static NamedPic *GetDoorBasePic(
-	const PicManager *pm, const char *style, const bool isHorizontal);
+	PicManager *pm, const char *style, const bool isHorizontal);
 static TWatch *CreateCloseDoorWatch(
 	Map *map, const Mission *m, const Vec2i v,
 	const bool isHorizontal, const int doorGroupCount,
@@ -340,7 +340,7 @@ static void TileAddTrigger(Tile *t, Trigger *tr)
 }
 
 static NamedPic *GetDoorBasePic(
-	const PicManager *pm, const char *style, const bool isHorizontal)
+	PicManager *pm, const char *style, const bool isHorizontal)
 {
 	return GetDoorPic(pm, style, "open", isHorizontal);
 }
@@ -412,7 +412,7 @@ typedef struct
 #define DOORSTYLE_COUNT 4
 
 NamedPic *GetDoorPic(
-	const PicManager *pm, const char *style, const char *key,
+	PicManager *pm, const char *style, const char *key,
 	const bool isHorizontal)
 {
 	char buf[CDOGS_FILENAME_MAX];
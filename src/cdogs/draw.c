@@ -64,6 +64,10 @@
 #include "blit.h"
 #include "pic_manager.h"
 
+static ConfigHandle sGameFPS = CONFIG_HANDLE("Game.FPS");
+static ConfigHandle sGameFog = CONFIG_HANDLE("Game.Fog");
+static ConfigHandle sGameLaserSight = CONFIG_HANDLE("Game.LaserSight");
+
 //#define DEBUG_DRAW_BOUNDS
 
 
@@ -79,7 +83,7 @@ static color_t GetTileLOSMask(Tile *tile)
 	}
 	if (tile->flags & MAPTILE_OUT_OF_SIGHT)
 	{
-		if (ConfigGetBool(&gConfig, "Game.Fog"))
+		if (ConfigHandleGetBool(&sGameFog))
 		{
 			color_t mask = { 96, 96, 96, 255 };
 			return mask;
@@ -109,6 +113,13 @@ void DrawWallColumn(int y, Vec2i pos, Tile *tile)
 }
 
 
+// Get the things on a tile in the draw buffer; NULL if none
+static const CArray *GetThings(const DrawBuffer *b, const int x, const int y)
+{
+	return MapGetTileThings(&gMap, Vec2iNew(b->xStart + x, b->yStart + y));
+}
+
+
 static void DrawFloor(DrawBuffer *b, Vec2i offset);
 static void DrawDebris(DrawBuffer *b, Vec2i offset);
 static void DrawWallsAndThings(DrawBuffer *b, Vec2i offset);
@@ -140,6 +151,7 @@ static void DrawFloor(DrawBuffer *b, Vec2i offset)
 	int x, y;
 	Vec2i pos;
 	Tile *tile = &b->tiles[0][0];
+	FloorCache *fc = DrawBufferGetFloorCache(b, offset);
 	for (y = 0, pos.y = b->dy + offset.y;
 		 y < Y_TILES;
 		 y++, pos.y += TILE_HEIGHT)
@@ -148,15 +160,24 @@ static void DrawFloor(DrawBuffer *b, Vec2i offset)
 			x < b->Size.x;
 			x++, tile++, pos.x += TILE_WIDTH)
 		{
-			if (tile->pic != NULL && tile->pic->pic.Data != NULL &&
-				!(tile->flags & MAPTILE_IS_WALL))
+			if (tile->pic == NULL || tile->pic->pic.Data == NULL ||
+				(tile->flags & MAPTILE_IS_WALL))
 			{
-				BlitMasked(
-					&gGraphicsDevice,
-					&tile->pic->pic,
-					pos,
-					GetTileLOSMask(tile),
-					0);
+				continue;
+			}
+			const color_t mask = GetTileLOSMask(tile);
+			const Uint32 *pixels = FloorCacheGet(
+				fc, Vec2iNew(b->xStart + x, b->yStart + y),
+				&tile->pic->pic, COLOR2PIXEL(mask));
+			if (pixels != NULL)
+			{
+				BlitPixels(
+					&gGraphicsDevice, pixels,
+					Vec2iNew(TILE_WIDTH, TILE_HEIGHT), pos);
+			}
+			else
+			{
+				BlitMasked(&gGraphicsDevice, &tile->pic->pic, pos, mask, 0);
 			}
 		}
 		tile += X_TILES - b->Size.x;
@@ -177,10 +198,15 @@ static void DrawDebris(DrawBuffer *b, Vec2i offset)
 			{
 				continue;
 			}
-			for (int i = 0; i < (int)tile->things.size; i++)
+			const CArray *things = GetThings(b, x, y);
+			if (things == NULL)
+			{
+				continue;
+			}
+			for (int i = 0; i < (int)things->size; i++)
 			{
-				const TTileItem *ti =
-					ThingIdGetTileItem(CArrayGet(&tile->things, i));
+				const SpatialHashEntry *e = CArrayGet(things, i);
+				const TTileItem *ti = ThingIdGetTileItem(&e->Id);
 				if (TileItemIsDebris(ti))
 				{
 					CArrayPushBack(&b->displaylist, &ti);
@@ -241,10 +267,15 @@ static void DrawWallsAndThings(DrawBuffer *b, Vec2i offset)
 			{
 				continue;
 			}
-			for (int i = 0; i < (int)tile->things.size; i++)
+			const CArray *things = GetThings(b, x, y);
+			if (things == NULL)
+			{
+				continue;
+			}
+			for (int i = 0; i < (int)things->size; i++)
 			{
-				const TTileItem *ti =
-					ThingIdGetTileItem(CArrayGet(&tile->things, i));
+				const SpatialHashEntry *e = CArrayGet(things, i);
+				const TTileItem *ti = ThingIdGetTileItem(&e->Id);
 				// Don't draw debris, they are drawn later
 				if (TileItemIsDebris(ti))
 				{
@@ -369,8 +400,8 @@ static void DrawActorPics(const TTileItem *t, const Vec2i picPos)
 		const TActor *a = CArrayGet(&gActors, t->id);
 
 		// Draw weapon indicators
-		if (ConfigGetEnum(&gConfig, "Game.LaserSight") == LASER_SIGHT_ALL ||
-			(ConfigGetEnum(&gConfig, "Game.LaserSight") == LASER_SIGHT_PLAYERS && a->PlayerUID >= 0))
+		if (ConfigHandleGetEnum(&sGameLaserSight) == LASER_SIGHT_ALL ||
+			(ConfigHandleGetEnum(&sGameLaserSight) == LASER_SIGHT_PLAYERS && a->PlayerUID >= 0))
 		{
 			DrawLaserSight(a, picPos);
 		}
@@ -423,10 +454,15 @@ static void DrawObjectiveHighlights(DrawBuffer *b, Vec2i offset)
 		for (int x = 0; x < b->Size.x; x++, tile++)
 		{
 			// Draw the items that are in LOS
-			for (int i = 0; i < (int)tile->things.size; i++)
+			const CArray *things = GetThings(b, x, y);
+			if (things == NULL)
 			{
-				TTileItem *ti =
-					ThingIdGetTileItem(CArrayGet(&tile->things, i));
+				continue;
+			}
+			for (int i = 0; i < (int)things->size; i++)
+			{
+				const SpatialHashEntry *e = CArrayGet(things, i);
+				TTileItem *ti = ThingIdGetTileItem(&e->Id);
 				DrawObjectiveHighlight(ti, tile, b, offset);
 			}
 		}
@@ -456,7 +492,7 @@ static void DrawObjectiveHighlight(
 		ti->x - b->xTop + offset.x, ti->y - b->yTop + offset.y);
 	const ObjectiveDef *o = CArrayGet(&gMission.Objectives, objective);
 	color_t color = o->color;
-	const int pulsePeriod = ConfigGetInt(&gConfig, "Game.FPS");
+	const int pulsePeriod = ConfigHandleGetInt(&sGameFPS);
 	int alphaUnscaled =
 		(gMission.time % pulsePeriod) * 255 / (pulsePeriod / 2);
 	if (alphaUnscaled > 255)
@@ -499,10 +535,15 @@ static void DrawChatters(DrawBuffer *b, Vec2i offset)
 	{
 		for (int x = 0; x < b->Size.x; x++, tile++)
 		{
-			for (int i = 0; i < (int)tile->things.size; i++)
+			const CArray *things = GetThings(b, x, y);
+			if (things == NULL)
+			{
+				continue;
+			}
+			for (int i = 0; i < (int)things->size; i++)
 			{
-				const TTileItem *ti =
-					ThingIdGetTileItem(CArrayGet(&tile->things, i));
+				const SpatialHashEntry *e = CArrayGet(things, i);
+				const TTileItem *ti = ThingIdGetTileItem(&e->Id);
 				if (ti->getActorPicsFunc == NULL)
 				{
 					continue;
@@ -67,6 +67,7 @@ void DrawBufferInit(DrawBuffer *b, Vec2i size, GraphicsDevice *g)
 	b->g = g;
 	CArrayInit(&b->displaylist, sizeof(const TTileItem *));
 	CArrayReserve(&b->displaylist, 32);
+	CArrayInit(&b->floorCaches, sizeof(FloorCache));
 	debug(D_MAX, "Initialised draw buffer %dx%d\n", size.x, size.y);
 }
 void DrawBufferTerminate(DrawBuffer *b)
@@ -74,6 +75,24 @@ void DrawBufferTerminate(DrawBuffer *b)
 	CFREE(b->tiles[0]);
 	CFREE(b->tiles);
 	CArrayTerminate(&b->displaylist);
+	CA_FOREACH(FloorCache, fc, b->floorCaches)
+		FloorCacheTerminate(fc);
+	CA_FOREACH_END()
+	CArrayTerminate(&b->floorCaches);
+}
+FloorCache *DrawBufferGetFloorCache(DrawBuffer *b, const Vec2i offset)
+{
+	CA_FOREACH(FloorCache, fc, b->floorCaches)
+		if (Vec2iEqual(fc->View, offset))
+		{
+			return fc;
+		}
+	CA_FOREACH_END()
+	FloorCache fc;
+	FloorCacheInit(
+		&fc, offset, b->OrigSize, Vec2iNew(TILE_WIDTH, TILE_HEIGHT));
+	CArrayPushBack(&b->floorCaches, &fc);
+	return CArrayGet(&b->floorCaches, b->floorCaches.size - 1);
 }
 
 void DrawBufferSetFromMap(
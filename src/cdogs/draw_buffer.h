@@ -49,6 +49,7 @@
 #ifndef __DRAW_BUFFER
 #define __DRAW_BUFFER
 
+#include "floor_cache.h"
 #include "map.h"
 
 typedef struct
@@ -61,10 +62,13 @@ typedef struct
 	Vec2i Size;	// size in tiles
 	Tile **tiles;
 	CArray displaylist;	// of const TTileItem *, to determine draw order
+	CArray floorCaches;	// of FloorCache, one per view
 } DrawBuffer;
 
 void DrawBufferInit(DrawBuffer *b, Vec2i size, GraphicsDevice *g);
 void DrawBufferTerminate(DrawBuffer *b);
+// Get the floor cache for a view drawn at a screen offset
+FloorCache *DrawBufferGetFloorCache(DrawBuffer *b, const Vec2i offset);
 
 void DrawBufferSetFromMap(
 	DrawBuffer *buffer, Map *map, Vec2i origin, int width);
@@ -55,6 +55,8 @@
 #include "blit.h"
 #include "grafx.h"
 
+static ConfigHandle sGameShadows = CONFIG_HANDLE("Game.Shadows");
+
 
 void Draw_Point(const int x, const int y, color_t c)
 {
@@ -265,7 +267,7 @@ void DrawShadow(GraphicsDevice *device, Vec2i pos, Vec2i size)
 {
 	Vec2i drawPos;
 	HSV tint = { -1.0, 1.0, 0.0 };
-	if (!ConfigGetBool(&gConfig, "Game.Shadows"))
+	if (!ConfigHandleGetBool(&sGameShadows))
 	{
 		return;
 	}
@@ -0,0 +1,178 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "event_queue.h"
+
+#include <string.h>
+
+#include "utils.h"
+
+#define ALIGN_UP(_x) \
+	(((_x) + EVENT_QUEUE_ALIGN - 1) & ~(size_t)(EVENT_QUEUE_ALIGN - 1))
+
+
+void EventQueueInit(EventQueue *q)
+{
+	memset(q, 0, sizeof *q);
+	CArrayInit(&q->Blocks, sizeof(EventQueueBlock));
+}
+void EventQueueTerminate(EventQueue *q)
+{
+	CA_FOREACH(EventQueueBlock, b, q->Blocks)
+		CFREE(b->Data);
+	CA_FOREACH_END()
+	CArrayTerminate(&q->Blocks);
+	memset(q, 0, sizeof *q);
+}
+bool EventQueueIsInit(const EventQueue *q)
+{
+	return q->Blocks.elemSize != 0;
+}
+
+// Records are a header holding the record's size, then the data
+static size_t RecordSize(const size_t size)
+{
+	return EVENT_QUEUE_ALIGN + ALIGN_UP(size);
+}
+static Uint32 RecordGetSize(const Uint8 *record)
+{
+	Uint32 size;
+	memcpy(&size, record, sizeof size);
+	return size;
+}
+static void *RecordInit(Uint8 *record, const size_t recordSize)
+{
+	const Uint32 size = (Uint32)recordSize;
+	memcpy(record, &size, sizeof size);
+	return record + EVENT_QUEUE_ALIGN;
+}
+
+void *EventQueueAdd(EventQueue *q, const size_t size)
+{
+	const size_t recordSize = RecordSize(size);
+	EventQueueBlock *b = NULL;
+	for (; q->Current < (int)q->Blocks.size; q->Current++)
+	{
+		b = CArrayGet(&q->Blocks, q->Current);
+		if (b->Size + recordSize <= b->Cap)
+		{
+			break;
+		}
+		b = NULL;
+	}
+	if (b == NULL)
+	{
+		EventQueueBlock nb;
+		nb.Cap = MAX(EVENT_QUEUE_BLOCK_SIZE, recordSize);
+		CMALLOC(nb.Data, nb.Cap);
+		nb.Size = 0;
+		CArrayPushBack(&q->Blocks, &nb);
+		q->Current = (int)q->Blocks.size - 1;
+		b = CArrayGet(&q->Blocks, q->Current);
+	}
+	Uint8 *record = b->Data + b->Size;
+	b->Size += recordSize;
+	memset(record, 0, recordSize);
+	q->Adds++;
+	q->BytesAdded += recordSize;
+	return RecordInit(record, recordSize);
+}
+
+EventQueueIter EventQueueBegin(void)
+{
+	EventQueueIter it;
+	it.Block = 0;
+	it.Offset = 0;
+	return it;
+}
+void *EventQueueNext(const EventQueue *q, EventQueueIter *it)
+{
+	for (; it->Block < (int)q->Blocks.size; it->Block++, it->Offset = 0)
+	{
+		const EventQueueBlock *b = CArrayGet(&q->Blocks, it->Block);
+		if (it->Offset < b->Size)
+		{
+			Uint8 *record = b->Data + it->Offset;
+			it->Offset += RecordGetSize(record);
+			return record + EVENT_QUEUE_ALIGN;
+		}
+	}
+	return NULL;
+}
+
+void EventQueueRemoveIf(EventQueue *q, bool (*removeIf)(const void *))
+{
+	// Like CArrayRemoveIf, move the records that stay towards the front
+	// The write position never passes the read position, as a record that
+	// fits where it is also fits in the same block further forward
+	int dstBlock = 0;
+	size_t dstOffset = 0;
+	EventQueueIter it = EventQueueBegin();
+	for (;;)
+	{
+		const int srcBlock = it.Block;
+		const size_t srcOffset = it.Offset;
+		const void *data = EventQueueNext(q, &it);
+		if (data == NULL)
+		{
+			break;
+		}
+		if (removeIf(data))
+		{
+			continue;
+		}
+		const Uint8 *record = (const Uint8 *)data - EVENT_QUEUE_ALIGN;
+		const Uint32 recordSize = RecordGetSize(record);
+		EventQueueBlock *dst = CArrayGet(&q->Blocks, dstBlock);
+		while (dstOffset + recordSize > dst->Cap)
+		{
+			dst->Size = dstOffset;
+			dstBlock++;
+			dstOffset = 0;
+			dst = CArrayGet(&q->Blocks, dstBlock);
+		}
+		if (dstBlock != srcBlock || dstOffset != srcOffset)
+		{
+			memmove(dst->Data + dstOffset, record, recordSize);
+		}
+		dstOffset += recordSize;
+	}
+	// Everything after the write position is now empty
+	for (int i = dstBlock; i < (int)q->Blocks.size; i++)
+	{
+		EventQueueBlock *b = CArrayGet(&q->Blocks, i);
+		b->Size = i == dstBlock ? dstOffset : 0;
+	}
+	q->Current = dstBlock;
+}
+void EventQueueClear(EventQueue *q)
+{
+	CA_FOREACH(EventQueueBlock, b, q->Blocks)
+		b->Size = 0;
+	CA_FOREACH_END()
+	q->Current = 0;
+}
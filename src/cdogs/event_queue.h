@@ -0,0 +1,83 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <SDL_stdinc.h>
+
+#include "c_array.h"
+
+// Queue of variable-size records, bump allocated back to back in blocks
+// Records never move while the queue is being added to or read, so they
+// can be filled in place, and read while more are added.
+// Blocks are kept when the queue is emptied, so a queue that is emptied
+// every tick stops allocating once it has grown to its busiest tick.
+#define EVENT_QUEUE_BLOCK_SIZE 4096
+// Records are aligned to this, and each has a header of this size
+#define EVENT_QUEUE_ALIGN 8
+
+typedef struct
+{
+	Uint8 *Data;
+	size_t Size;	// bytes in use
+	size_t Cap;
+} EventQueueBlock;
+
+typedef struct
+{
+	CArray Blocks;	// of EventQueueBlock
+	int Current;	// block being added to; later blocks are empty
+	// Totals since init, for profiling
+	int Adds;
+	size_t BytesAdded;
+} EventQueue;
+
+// Position of the next record to read
+typedef struct
+{
+	int Block;
+	size_t Offset;
+} EventQueueIter;
+
+void EventQueueInit(EventQueue *q);
+void EventQueueTerminate(EventQueue *q);
+bool EventQueueIsInit(const EventQueue *q);
+
+// Add a zeroed record; it stays where it is until the queue is cleared
+void *EventQueueAdd(EventQueue *q, const size_t size);
+
+EventQueueIter EventQueueBegin(void);
+// Get the next record, or NULL if there are no more
+// Records added while iterating are also returned.
+void *EventQueueNext(const EventQueue *q, EventQueueIter *it);
+
+// Remove records, packing the rest to the front in the same order
+void EventQueueRemoveIf(EventQueue *q, bool (*removeIf)(const void *));
+void EventQueueClear(EventQueue *q);
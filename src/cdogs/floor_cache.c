@@ -0,0 +1,85 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "floor_cache.h"
+
+#include <string.h>
+
+#include "blit_span.h"
+#include "utils.h"
+
+
+void FloorCacheInit(
+	FloorCache *c, const Vec2i view, const Vec2i size, const Vec2i tileSize)
+{
+	memset(c, 0, sizeof *c);
+	c->View = view;
+	c->Size = size;
+	c->TileSize = tileSize;
+	CMALLOC(c->Pixels,
+		size.x * size.y * tileSize.x * tileSize.y * sizeof *c->Pixels);
+	CCALLOC(c->Cells, size.x * size.y * sizeof *c->Cells);
+}
+void FloorCacheTerminate(FloorCache *c)
+{
+	debug(D_VERBOSE, "floor cache (%d, %d): %d hits, %d draws\n",
+		c->View.x, c->View.y, c->Hits, c->Draws);
+	CFREE(c->Pixels);
+	CFREE(c->Cells);
+}
+
+static int Wrap(const int x, const int n)
+{
+	const int m = x % n;
+	return m < 0 ? m + n : m;
+}
+const Uint32 *FloorCacheGet(
+	FloorCache *c, const Vec2i tile, const Pic *pic, const Uint32 mask)
+{
+	if (!Vec2iEqual(pic->size, c->TileSize) || !Vec2iIsZero(pic->offset))
+	{
+		return NULL;
+	}
+	const int i = Wrap(tile.x, c->Size.x) + Wrap(tile.y, c->Size.y) * c->Size.x;
+	FloorCacheCell *cell = &c->Cells[i];
+	const int tilePixels = c->TileSize.x * c->TileSize.y;
+	Uint32 *pixels = c->Pixels + i * tilePixels;
+	if (cell->IsValid && Vec2iEqual(cell->Tile, tile) &&
+		cell->Pic == pic && cell->Mask == mask)
+	{
+		c->Hits++;
+		return pixels;
+	}
+	// Same as an opaque BlitMasked
+	gBlitSpan.Masked(pixels, pic->Data, tilePixels, mask, false);
+	cell->Tile = tile;
+	cell->Pic = pic;
+	cell->Mask = mask;
+	cell->IsValid = true;
+	c->Draws++;
+	return pixels;
+}
@@ -0,0 +1,68 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include <SDL_stdinc.h>
+
+#include "pic.h"
+#include "vector.h"
+
+// Pre-rendered floor tiles for a view, so that unchanged floors are copied
+// instead of masked every frame
+// Cells are indexed by map tile modulo the cache size, so scrolling only
+// draws the tiles that come into view. A cell is redrawn when the tile,
+// pic or LOS mask it was drawn with changes. Pics are not changed in place
+// while a draw buffer, and so its caches, exist.
+typedef struct
+{
+	Vec2i Tile;
+	const Pic *Pic;
+	Uint32 Mask;
+	bool IsValid;
+} FloorCacheCell;
+typedef struct
+{
+	Vec2i View;	// screen offset, to tell split screen views apart
+	Vec2i Size;	// in tiles
+	Vec2i TileSize;
+	Uint32 *Pixels;
+	FloorCacheCell *Cells;
+	int Hits;
+	int Draws;
+} FloorCache;
+
+void FloorCacheInit(
+	FloorCache *c, const Vec2i view, const Vec2i size, const Vec2i tileSize);
+void FloorCacheTerminate(FloorCache *c);
+
+// Get the pixels of a floor tile masked by a colour, drawing them if needed
+// Returns NULL if the pic can't be cached, i.e. it doesn't fill the tile
+const Uint32 *FloorCacheGet(
+	FloorCache *c, const Vec2i tile, const Pic *pic, const Uint32 mask);
@@ -0,0 +1,262 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "flow_field.h"
+
+#include <float.h>
+#include <string.h>
+
+#include "grid_path.h"
+#include "utils.h"
+
+
+void FlowFieldsInit(
+	FlowFields *ff, const Vec2i size, TileSelectFunc isTileOk)
+{
+	memset(ff, 0, sizeof *ff);
+	ff->Size = size;
+	ff->isTileOk = isTileOk;
+	CArrayInit(&ff->fields, sizeof(FlowField));
+	const int count = MAX(size.x * size.y, 1);
+	CMALLOC(ff->heap, count * sizeof *ff->heap);
+	CMALLOC(ff->heapIndex, count * sizeof *ff->heapIndex);
+	CMALLOC(ff->walkable, count * sizeof *ff->walkable);
+}
+void FlowFieldsTerminate(FlowFields *ff)
+{
+	CA_FOREACH(FlowField, f, ff->fields)
+		CFREE(f->Cost);
+		CFREE(f->Next);
+	CA_FOREACH_END()
+	CArrayTerminate(&ff->fields);
+	CFREE(ff->heap);
+	CFREE(ff->heapIndex);
+	CFREE(ff->walkable);
+	memset(ff, 0, sizeof *ff);
+}
+
+void FlowFieldsInvalidate(FlowFields *ff)
+{
+	CA_FOREACH(FlowField, f, ff->fields)
+		f->IsValid = false;
+	CA_FOREACH_END()
+	ff->walkableValid = false;
+}
+
+static void Build(FlowFields *ff, Map *map, FlowField *f);
+const FlowField *FlowFieldsGet(
+	FlowFields *ff, Map *map, const int uid, const Vec2i target)
+{
+	if (target.x < 0 || target.x >= ff->Size.x ||
+		target.y < 0 || target.y >= ff->Size.y)
+	{
+		return NULL;
+	}
+	ff->Lookups++;
+	FlowField *f = NULL;
+	CA_FOREACH(FlowField, field, ff->fields)
+		if (field->UID == uid)
+		{
+			f = field;
+			break;
+		}
+	CA_FOREACH_END()
+	if (f == NULL)
+	{
+		FlowField field;
+		memset(&field, 0, sizeof field);
+		field.UID = uid;
+		const int count = MAX(ff->Size.x * ff->Size.y, 1);
+		CMALLOC(field.Cost, count * sizeof *field.Cost);
+		CMALLOC(field.Next, count * sizeof *field.Next);
+		CArrayPushBack(&ff->fields, &field);
+		f = CArrayGet(&ff->fields, (int)ff->fields.size - 1);
+	}
+	if (!f->IsValid || !Vec2iEqual(f->Target, target))
+	{
+		f->Target = target;
+		Build(ff, map, f);
+	}
+	return f;
+}
+
+void FlowFieldsRemove(FlowFields *ff, const int uid)
+{
+	CA_FOREACH(FlowField, f, ff->fields)
+		if (f->UID == uid)
+		{
+			CFREE(f->Cost);
+			CFREE(f->Next);
+			CArrayDelete(&ff->fields, i);
+			break;
+		}
+	CA_FOREACH_END()
+}
+
+// Binary heap of open tiles, ordered by cost
+static void HeapSet(FlowFields *ff, const int pos, const int i)
+{
+	ff->heap[pos] = i;
+	ff->heapIndex[i] = pos;
+}
+static void HeapSiftUp(FlowFields *ff, const FlowField *f, int pos)
+{
+	const int i = ff->heap[pos];
+	const float cost = f->Cost[i];
+	while (pos > 0)
+	{
+		const int parent = (pos - 1) / 2;
+		if (f->Cost[ff->heap[parent]] <= cost) break;
+		HeapSet(ff, pos, ff->heap[parent]);
+		pos = parent;
+	}
+	HeapSet(ff, pos, i);
+}
+static void HeapSiftDown(
+	FlowFields *ff, const FlowField *f, int pos, const int heapSize)
+{
+	const int i = ff->heap[pos];
+	const float cost = f->Cost[i];
+	for (;;)
+	{
+		int child = pos * 2 + 1;
+		if (child >= heapSize) break;
+		if (child + 1 < heapSize &&
+			f->Cost[ff->heap[child + 1]] < f->Cost[ff->heap[child]])
+		{
+			child++;
+		}
+		if (f->Cost[ff->heap[child]] >= cost) break;
+		HeapSet(ff, pos, ff->heap[child]);
+		pos = child;
+	}
+	HeapSet(ff, pos, i);
+}
+
+static bool IsWalkable(const FlowFields *ff, const Vec2i v)
+{
+	return v.x >= 0 && v.x < ff->Size.x && v.y >= 0 && v.y < ff->Size.y &&
+		ff->walkable[v.y * ff->Size.x + v.x];
+}
+static void Build(FlowFields *ff, Map *map, FlowField *f)
+{
+	const Vec2i size = ff->Size;
+	const int count = size.x * size.y;
+	ff->Builds++;
+	f->IsValid = true;
+	if (!ff->walkableValid)
+	{
+		Vec2i v;
+		for (v.y = 0; v.y < size.y; v.y++)
+		{
+			for (v.x = 0; v.x < size.x; v.x++)
+			{
+				ff->walkable[v.y * size.x + v.x] = ff->isTileOk(map, v);
+			}
+		}
+		ff->walkableValid = true;
+	}
+	for (int i = 0; i < count; i++)
+	{
+		f->Cost[i] = FLT_MAX;
+		f->Next[i] = -1;
+		ff->heapIndex[i] = -1;
+	}
+	if (!IsWalkable(ff, f->Target))
+	{
+		return;
+	}
+
+	// Dijkstra outwards from the target; since moves are symmetric, the
+	// tile each one is reached from is its next step towards the target
+	const int target = f->Target.y * size.x + f->Target.x;
+	f->Cost[target] = 0;
+	f->Next[target] = target;
+	int heapSize = 0;
+	HeapSet(ff, heapSize++, target);
+	while (heapSize > 0)
+	{
+		const int current = ff->heap[0];
+		ff->heapIndex[current] = -2;	// closed
+		heapSize--;
+		if (heapSize > 0)
+		{
+			HeapSet(ff, 0, ff->heap[heapSize]);
+			HeapSiftDown(ff, f, 0, heapSize);
+		}
+		const Vec2i v = Vec2iNew(current % size.x, current / size.x);
+		Vec2i d;
+		for (d.y = v.y - 1; d.y <= v.y + 1; d.y++)
+		{
+			for (d.x = v.x - 1; d.x <= v.x + 1; d.x++)
+			{
+				if (d.x == v.x && d.y == v.y) continue;
+				// Same moves as A*: diagonals need both the axis-aligned
+				// neighbours to be clear
+				if (!IsWalkable(ff, d) ||
+					!IsWalkable(ff, Vec2iNew(v.x, d.y)) ||
+					!IsWalkable(ff, Vec2iNew(d.x, v.y)))
+				{
+					continue;
+				}
+				const int neighbor = d.y * size.x + d.x;
+				if (ff->heapIndex[neighbor] == -2) continue;
+				const float cost = f->Cost[current] + GridPathStepCost(v, d);
+				if (cost >= f->Cost[neighbor]) continue;
+				f->Cost[neighbor] = cost;
+				f->Next[neighbor] = current;
+				if (ff->heapIndex[neighbor] >= 0)
+				{
+					HeapSiftUp(ff, f, ff->heapIndex[neighbor]);
+				}
+				else
+				{
+					HeapSet(ff, heapSize, neighbor);
+					heapSize++;
+					HeapSiftUp(ff, f, heapSize - 1);
+				}
+			}
+		}
+	}
+}
+
+bool FlowFieldGetNext(
+	const FlowFields *ff, const FlowField *f, const Vec2i tile, Vec2i *next)
+{
+	if (tile.x < 0 || tile.x >= ff->Size.x ||
+		tile.y < 0 || tile.y >= ff->Size.y)
+	{
+		return false;
+	}
+	const int i = f->Next[tile.y * ff->Size.x + tile.x];
+	if (i < 0)
+	{
+		return false;
+	}
+	*next = Vec2iNew(i % ff->Size.x, i / ff->Size.x);
+	return true;
+}
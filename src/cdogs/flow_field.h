@@ -0,0 +1,77 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include "c_array.h"
+#include "map.h"
+#include "vector.h"
+
+// Flow fields lead from every tile to a shared target, so that any number
+// of actors heading to the same place can look up their next step without
+// their own path search
+typedef struct
+{
+	int UID;	// whose tile the field leads to
+	Vec2i Target;
+	bool IsValid;
+	float *Cost;	// path cost to the target, FLT_MAX if unreachable
+	int *Next;	// next tile index towards the target, -1 if none
+} FlowField;
+typedef struct
+{
+	Vec2i Size;
+	TileSelectFunc isTileOk;
+	CArray fields;	// of FlowField
+	// Scratch space for building fields
+	int *heap;
+	int *heapIndex;
+	bool *walkable;	// shared by all fields until invalidated
+	bool walkableValid;
+
+	int Builds;
+	int Lookups;
+} FlowFields;
+
+void FlowFieldsInit(
+	FlowFields *ff, const Vec2i size, TileSelectFunc isTileOk);
+void FlowFieldsTerminate(FlowFields *ff);
+
+// Mark all fields as needing a rebuild, e.g. if walkability has changed
+void FlowFieldsInvalidate(FlowFields *ff);
+
+// Get the field for a target; it is rebuilt only if the target has moved
+// to a different tile or the field has been invalidated
+const FlowField *FlowFieldsGet(
+	FlowFields *ff, Map *map, const int uid, const Vec2i target);
+// Free the field for a target that has gone, e.g. a dead player
+void FlowFieldsRemove(FlowFields *ff, const int uid);
+
+// Get the next tile to move to, towards the target of the field
+// Returns false if the target can't be reached from the tile
+bool FlowFieldGetNext(
+	const FlowFields *ff, const FlowField *f, const Vec2i tile, Vec2i *next);
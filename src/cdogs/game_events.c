@@ -28,130 +28,197 @@
 */
 #include "game_events.h"
 
+#include <stddef.h>
 #include <string.h>
 
 #include "actors.h"
+#include "net_batch.h"
 #include "net_client.h"
 #include "net_server.h"
 #include "utils.h"
 
 
-CArray gGameEvents;
+EventQueue gGameEvents;
 
-void GameEventsInit(CArray *store)
+void GameEventsInit(EventQueue *store)
 {
-	CArrayInit(store, sizeof(GameEvent));
+	EventQueueInit(store);
 }
-void GameEventsTerminate(CArray *store)
+void GameEventsTerminate(EventQueue *store)
 {
-	CArrayTerminate(store);
+	EventQueueTerminate(store);
 }
 
 
+// Size of an event with a payload, as stored in the queue
+#define SIZE(_member) \
+	(offsetof(GameEvent, u) + sizeof(((GameEvent *)NULL)->u._member))
+#define SIZE_NONE offsetof(GameEvent, u)
+
 // Array indexed by GameEvent
 static GameEventEntry sGameEventEntries[] =
 {
-	{ GAME_EVENT_NONE, false, false, false, false, NULL },
-
-	{ GAME_EVENT_CLIENT_CONNECT, false, false, false, false, NULL },
-	{ GAME_EVENT_CLIENT_ID, false, false, false, false, NClientId_fields },
-	{ GAME_EVENT_CAMPAIGN_DEF, false, false, false, false, NCampaignDef_fields },
-	{ GAME_EVENT_PLAYER_DATA, true, false, true, false, NPlayerData_fields },
-	{ GAME_EVENT_TILE_SET, true, false, true, true, NTileSet_fields },
-	{ GAME_EVENT_MAP_OBJECT_ADD, true, false, true, true, NMapObjectAdd_fields },
-	{ GAME_EVENT_MAP_OBJECT_DAMAGE, true, false, true, true, NMapObjectDamage_fields },
-	{ GAME_EVENT_CLIENT_READY, false, false, false, false, NULL },
-	{ GAME_EVENT_NET_GAME_START, false, false, false, false, NULL },
-
-	{ GAME_EVENT_SCORE, true, true, true, true, NULL },
-	{ GAME_EVENT_SOUND_AT, true, false, true, true, NSound_fields },
-	{ GAME_EVENT_SCREEN_SHAKE, false, false, true, true, NULL },
-	{ GAME_EVENT_SET_MESSAGE, false, false, true, true, NULL },
-
-	{ GAME_EVENT_GAME_START, true, false, true, true, NULL },
-
-	{ GAME_EVENT_ACTOR_ADD, true, false, true, true, NActorAdd_fields },
-	{ GAME_EVENT_ACTOR_MOVE, true, true, true, true, NActorMove_fields },
-	{ GAME_EVENT_ACTOR_STATE, true, true, true, true, NActorState_fields },
-	{ GAME_EVENT_ACTOR_DIR, true, true, true, true, NActorDir_fields },
-	{ GAME_EVENT_ACTOR_SLIDE, true, true, true, true, NActorSlide_fields },
-	{ GAME_EVENT_ACTOR_IMPULSE, true, false, true, true, NActorImpulse_fields },
-	{ GAME_EVENT_ACTOR_SWITCH_GUN, true, true, true, true, NActorSwitchGun_fields },
-	{ GAME_EVENT_ACTOR_PICKUP_ALL, false, true, true, true, NActorPickupAll_fields },
-	{ GAME_EVENT_ACTOR_REPLACE_GUN, true, false, true, true, NActorReplaceGun_fields },
-	{ GAME_EVENT_ACTOR_HEAL, true, false, true, true, NActorHeal_fields },
-	{ GAME_EVENT_ACTOR_HIT, true, false, true, true, NActorHit_fields },
-	{ GAME_EVENT_ACTOR_ADD_AMMO, true, false, true, true, NActorAddAmmo_fields },
-	{ GAME_EVENT_ACTOR_USE_AMMO, true, true, true, true, NActorUseAmmo_fields },
-	{ GAME_EVENT_ACTOR_DIE, true, false, true, true, NActorDie_fields },
-	{ GAME_EVENT_ACTOR_MELEE, true, true, true, true, NActorMelee_fields },
-
-	{ GAME_EVENT_ADD_PICKUP, true, false, true, true, NAddPickup_fields },
-	{ GAME_EVENT_REMOVE_PICKUP, true, false, true, true, NRemovePickup_fields },
-
-	{ GAME_EVENT_BULLET_BOUNCE, true, false, true, true, NBulletBounce_fields },
-	{ GAME_EVENT_REMOVE_BULLET, true, false, true, true, NRemoveBullet_fields },
-	{ GAME_EVENT_PARTICLE_REMOVE, false, false, true, true, NULL },
-	{ GAME_EVENT_GUN_FIRE, true, true, true, true, NGunFire_fields },
-	{ GAME_EVENT_GUN_RELOAD, true, true, true, true, NGunReload_fields },
-	{ GAME_EVENT_GUN_STATE, true, true, true, true, NGunState_fields },
-	{ GAME_EVENT_ADD_BULLET, true, false, true, true, NAddBullet_fields },
-	{ GAME_EVENT_ADD_PARTICLE, false, false, true, true, NULL },
-	{ GAME_EVENT_TRIGGER, true, false, true, true, NTrigger_fields },
-	{ GAME_EVENT_EXPLORE_TILES, true, false, true, true, NExploreTiles_fields },
-	{ GAME_EVENT_RESCUE_CHARACTER, true, false, true, true, NRescueCharacter_fields },
-	{ GAME_EVENT_OBJECTIVE_UPDATE, true, false, true, true, NObjectiveUpdate_fields },
-	{ GAME_EVENT_ADD_KEYS, true, false, true, true, NAddKeys_fields },
-
-	{ GAME_EVENT_MISSION_COMPLETE, true, false, true, true, NMissionComplete_fields },
-
-	{ GAME_EVENT_MISSION_INCOMPLETE, true, false, true, true, NULL },
-	{ GAME_EVENT_MISSION_PICKUP, true, false, true, true, NULL },
-	{ GAME_EVENT_MISSION_END, true, false, true, true, NULL }
+	{ GAME_EVENT_NONE, false, false, false, false, NULL, SIZE_NONE, NET_DELIVERY_RELIABLE },
+
+	{ GAME_EVENT_CLIENT_CONNECT, false, false, false, false, NULL, SIZE_NONE, NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_CLIENT_ID, false, false, false, false, NClientId_fields, SIZE_NONE, NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_CAMPAIGN_DEF, false, false, false, false, NCampaignDef_fields, SIZE_NONE, NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_PLAYER_DATA, true, false, true, false, NPlayerData_fields, SIZE(PlayerData), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_TILE_SET, true, false, true, true, NTileSet_fields, SIZE(TileSet), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_MAP_OBJECT_ADD, true, false, true, true, NMapObjectAdd_fields, SIZE(MapObjectAdd), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_MAP_OBJECT_DAMAGE, true, false, true, true, NMapObjectDamage_fields, SIZE(MapObjectDamage), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_CLIENT_READY, false, false, false, false, NULL, SIZE_NONE, NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_NET_GAME_START, false, false, false, false, NULL, SIZE_NONE, NET_DELIVERY_RELIABLE },
+	// Only the snapshot for joining is sent this way; see NetOutboxFlush
+	{ GAME_EVENT_SNAPSHOT, false, false, false, false, NULL, SIZE_NONE, NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_SNAPSHOT_ACK, false, false, false, false, NULL, SIZE_NONE, NET_DELIVERY_LATEST },
+
+	{ GAME_EVENT_SCORE, true, true, true, true, NULL, SIZE(Score), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_SOUND_AT, true, false, true, true, NSound_fields, SIZE(SoundAt), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_SCREEN_SHAKE, false, false, true, true, NULL, SIZE(ShakeAmount), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_SET_MESSAGE, false, false, true, true, NULL, SIZE(SetMessage), NET_DELIVERY_RELIABLE },
+
+	{ GAME_EVENT_GAME_START, true, false, true, true, NULL, SIZE_NONE, NET_DELIVERY_RELIABLE },
+
+	{ GAME_EVENT_ACTOR_ADD, true, false, true, true, NActorAdd_fields, SIZE(ActorAdd), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ACTOR_MOVE, true, true, true, true, NActorMove_fields, SIZE(ActorMove), NET_DELIVERY_LATEST },
+	{ GAME_EVENT_ACTOR_STATE, true, true, true, true, NActorState_fields, SIZE(ActorState), NET_DELIVERY_LATEST },
+	{ GAME_EVENT_ACTOR_DIR, true, true, true, true, NActorDir_fields, SIZE(ActorDir), NET_DELIVERY_LATEST },
+	{ GAME_EVENT_ACTOR_SLIDE, true, true, true, true, NActorSlide_fields, SIZE(ActorSlide), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ACTOR_IMPULSE, true, false, true, true, NActorImpulse_fields, SIZE(ActorImpulse), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ACTOR_SWITCH_GUN, true, true, true, true, NActorSwitchGun_fields, SIZE(ActorSwitchGun), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ACTOR_PICKUP_ALL, false, true, true, true, NActorPickupAll_fields, SIZE(ActorPickupAll), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ACTOR_REPLACE_GUN, true, false, true, true, NActorReplaceGun_fields, SIZE(ActorReplaceGun), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ACTOR_HEAL, true, false, true, true, NActorHeal_fields, SIZE(Heal), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ACTOR_HIT, true, false, true, true, NActorHit_fields, SIZE(ActorHit), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ACTOR_ADD_AMMO, true, false, true, true, NActorAddAmmo_fields, SIZE(AddAmmo), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ACTOR_USE_AMMO, true, true, true, true, NActorUseAmmo_fields, SIZE(UseAmmo), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ACTOR_DIE, true, false, true, true, NActorDie_fields, SIZE(ActorDie), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ACTOR_MELEE, true, true, true, true, NActorMelee_fields, SIZE(Melee), NET_DELIVERY_RELIABLE },
+
+	{ GAME_EVENT_ADD_PICKUP, true, false, true, true, NAddPickup_fields, SIZE(AddPickup), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_REMOVE_PICKUP, true, false, true, true, NRemovePickup_fields, SIZE(RemovePickup), NET_DELIVERY_RELIABLE },
+
+	{ GAME_EVENT_BULLET_BOUNCE, true, false, true, true, NBulletBounce_fields, SIZE(BulletBounce), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_REMOVE_BULLET, true, false, true, true, NRemoveBullet_fields, SIZE(RemoveBullet), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_PARTICLE_REMOVE, false, false, true, true, NULL, SIZE(ParticleRemove), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_GUN_FIRE, true, true, true, true, NGunFire_fields, SIZE(GunFire), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_GUN_RELOAD, true, true, true, true, NGunReload_fields, SIZE(GunReload), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_GUN_STATE, true, true, true, true, NGunState_fields, SIZE(GunState), NET_DELIVERY_LATEST },
+	{ GAME_EVENT_ADD_BULLET, true, false, true, true, NAddBullet_fields, SIZE(AddBullet), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ADD_PARTICLE, false, false, true, true, NULL, SIZE(AddParticle), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_TRIGGER, true, false, true, true, NTrigger_fields, SIZE(TriggerEvent), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_EXPLORE_TILES, true, false, true, true, NExploreTiles_fields, SIZE(ExploreTiles), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_RESCUE_CHARACTER, true, false, true, true, NRescueCharacter_fields, SIZE(Rescue), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_OBJECTIVE_UPDATE, true, false, true, true, NObjectiveUpdate_fields, SIZE(ObjectiveUpdate), NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_ADD_KEYS, true, false, true, true, NAddKeys_fields, SIZE(AddKeys), NET_DELIVERY_RELIABLE },
+
+	{ GAME_EVENT_MISSION_COMPLETE, true, false, true, true, NMissionComplete_fields, SIZE(MissionComplete), NET_DELIVERY_RELIABLE },
+
+	{ GAME_EVENT_MISSION_INCOMPLETE, true, false, true, true, NULL, SIZE_NONE, NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_MISSION_PICKUP, true, false, true, true, NULL, SIZE_NONE, NET_DELIVERY_RELIABLE },
+	{ GAME_EVENT_MISSION_END, true, false, true, true, NULL, SIZE_NONE, NET_DELIVERY_RELIABLE }
 };
+// Latest-delivery payloads are kept in fixed buffers until sent
+PB_STATIC_ASSERT(NActorMove_size <= NET_LATEST_MAX_SIZE, ACTOR_MOVE_TOO_BIG)
+PB_STATIC_ASSERT(NActorState_size <= NET_LATEST_MAX_SIZE, ACTOR_STATE_TOO_BIG)
+PB_STATIC_ASSERT(NActorDir_size <= NET_LATEST_MAX_SIZE, ACTOR_DIR_TOO_BIG)
+PB_STATIC_ASSERT(NGunState_size <= NET_LATEST_MAX_SIZE, GUN_STATE_TOO_BIG)
 GameEventEntry GameEventGetEntry(const GameEventType e)
 {
 	return sGameEventEntries[(int)e];
 }
+uint32_t GameEventLatestUID(const GameEventType e, const void *data)
+{
+	switch (e)
+	{
+	case GAME_EVENT_ACTOR_MOVE: return ((const NActorMove *)data)->UID;
+	case GAME_EVENT_ACTOR_STATE: return ((const NActorState *)data)->UID;
+	case GAME_EVENT_ACTOR_DIR: return ((const NActorDir *)data)->UID;
+	case GAME_EVENT_GUN_STATE: return ((const NGunState *)data)->ActorUID;
+	case GAME_EVENT_SNAPSHOT_ACK: return 0;
+	default:
+		CASSERT(false, "not a latest-delivery event");
+		return 0;
+	}
+}
+bool GameEventPos(const GameEventType e, const void *data, Vec2i *pos)
+{
+	switch (e)
+	{
+	case GAME_EVENT_SOUND_AT:
+		*pos = Net2Vec2i(((const NSound *)data)->Pos);
+		return true;
+	case GAME_EVENT_BULLET_BOUNCE:
+		*pos = Vec2iFull2Real(
+			Net2Vec2i(((const NBulletBounce *)data)->BouncePos));
+		return true;
+	case GAME_EVENT_GUN_FIRE:
+		*pos = Vec2iFull2Real(
+			Net2Vec2i(((const NGunFire *)data)->MuzzleFullPos));
+		return true;
+	case GAME_EVENT_ADD_BULLET:
+		*pos = Vec2iFull2Real(
+			Net2Vec2i(((const NAddBullet *)data)->MuzzlePos));
+		return true;
+	default:
+		return false;
+	}
+}
 
-void GameEventsEnqueue(CArray *store, GameEvent e)
+GameEvent *GameEventsAdd(EventQueue *store, const GameEventType type)
+{
+	// Events added without a store are filled in then dropped
+	static GameEvent discard;
+	if (!EventQueueIsInit(store))
+	{
+		memset(&discard, 0, sizeof discard);
+		discard.Type = type;
+		return &discard;
+	}
+	GameEvent *e = EventQueueAdd(store, sGameEventEntries[type].Size);
+	e->Type = type;
+	return e;
+}
+void GameEventsCommit(EventQueue *store, const GameEvent *e)
 {
-	if (store->elemSize == 0)
+	if (!EventQueueIsInit(store))
 	{
 		return;
 	}
 	// If we're the server, broadcast any events that clients need
 	// If we're the client, pass along to server, but only if it's for a local player
 	// Otherwise we'd ping-pong the same updates from the server
-	const GameEventEntry gee = sGameEventEntries[e.Type];
-	if (gee.Broadcast)
+	const GameEventEntry gee = sGameEventEntries[e->Type];
+	// Latest state reaches clients in snapshots instead
+	if (gee.Broadcast && gee.Delivery != NET_DELIVERY_LATEST)
 	{
-		NetServerSendMsg(&gNetServer, NET_SERVER_BCAST, gee.Type, &e.u);
+		NetServerSendMsg(&gNetServer, NET_SERVER_BCAST, gee.Type, &e->u);
 	}
 	if (gee.Submit)
 	{
 		int actorUID = -1;
 		bool actorIsLocal = false;
-		switch (e.Type)
+		switch (e->Type)
 		{
-		case GAME_EVENT_ACTOR_MOVE: actorUID = e.u.ActorMove.UID; break;
-		case GAME_EVENT_ACTOR_STATE: actorUID = e.u.ActorState.UID; break;
-		case GAME_EVENT_ACTOR_DIR: actorUID = e.u.ActorDir.UID; break;
-		case GAME_EVENT_ACTOR_SLIDE: actorUID = e.u.ActorSlide.UID; break;
-		case GAME_EVENT_ACTOR_SWITCH_GUN: actorUID = e.u.ActorSwitchGun.UID; break;
-		case GAME_EVENT_ACTOR_PICKUP_ALL: actorUID = e.u.ActorPickupAll.UID; break;
-		case GAME_EVENT_ACTOR_USE_AMMO: actorUID = e.u.UseAmmo.UID; break;
-		case GAME_EVENT_ACTOR_MELEE: actorUID = e.u.Melee.UID; break;
+		case GAME_EVENT_ACTOR_MOVE: actorUID = e->u.ActorMove.UID; break;
+		case GAME_EVENT_ACTOR_STATE: actorUID = e->u.ActorState.UID; break;
+		case GAME_EVENT_ACTOR_DIR: actorUID = e->u.ActorDir.UID; break;
+		case GAME_EVENT_ACTOR_SLIDE: actorUID = e->u.ActorSlide.UID; break;
+		case GAME_EVENT_ACTOR_SWITCH_GUN: actorUID = e->u.ActorSwitchGun.UID; break;
+		case GAME_EVENT_ACTOR_PICKUP_ALL: actorUID = e->u.ActorPickupAll.UID; break;
+		case GAME_EVENT_ACTOR_USE_AMMO: actorUID = e->u.UseAmmo.UID; break;
+		case GAME_EVENT_ACTOR_MELEE: actorUID = e->u.Melee.UID; break;
 		case GAME_EVENT_GUN_FIRE:
-			if (e.u.GunFire.IsGun)
+			if (e->u.GunFire.IsGun)
 			{
-				actorIsLocal = PlayerIsLocal(e.u.GunFire.PlayerUID);
+				actorIsLocal = PlayerIsLocal(e->u.GunFire.PlayerUID);
 			}
 			break;
 		case GAME_EVENT_GUN_RELOAD:
-			actorIsLocal = PlayerIsLocal(e.u.GunReload.PlayerUID);
+			actorIsLocal = PlayerIsLocal(e->u.GunReload.PlayerUID);
 			break;
-		case GAME_EVENT_GUN_STATE: actorUID = e.u.GunState.ActorUID; break;
+		case GAME_EVENT_GUN_STATE: actorUID = e->u.GunState.ActorUID; break;
 		default: break;
 		}
 		if (actorUID >= 0)
@@ -160,16 +227,20 @@ void GameEventsEnqueue(CArray *store, GameEvent e)
 		}
 		if (actorIsLocal)
 		{
-			NetClientSendMsg(&gNetClient, gee.Type, &e.u);
+			NetClientSendMsg(&gNetClient, gee.Type, &e->u);
 		}
 	}
-
-	CArrayPushBack(store, &e);
+}
+void GameEventsEnqueue(EventQueue *store, const GameEvent *e)
+{
+	GameEvent *copy = GameEventsAdd(store, e->Type);
+	memcpy(copy, e, sGameEventEntries[e->Type].Size);
+	GameEventsCommit(store, copy);
 }
 static bool EventComplete(const void *elem);
-void GameEventsClear(CArray *store)
+void GameEventsClear(EventQueue *store)
 {
-	CArrayRemoveIf(store, EventComplete);
+	EventQueueRemoveIf(store, EventComplete);
 }
 static bool EventComplete(const void *elem)
 {
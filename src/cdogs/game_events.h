@@ -29,6 +29,7 @@
 #pragma once
 
 #include "c_array.h"
+#include "event_queue.h"
 #include "particle.h"
 #include "proto/msg.pb.h"
 
@@ -51,6 +52,10 @@ typedef enum
 	GAME_EVENT_MAP_OBJECT_DAMAGE,
 	GAME_EVENT_CLIENT_READY,
 	GAME_EVENT_NET_GAME_START,
+	// World state for clients, as deltas against snapshots they have acked;
+	// encoded by hand, see net_snapshot.h
+	GAME_EVENT_SNAPSHOT,
+	GAME_EVENT_SNAPSHOT_ACK,
 
 	GAME_EVENT_SCORE,
 	GAME_EVENT_SOUND_AT,
@@ -106,6 +111,16 @@ typedef enum
 	GAME_EVENT_MISSION_END
 } GameEventType;
 
+// How game events are sent over the network
+typedef enum
+{
+	// In order, resent until received
+	NET_DELIVERY_RELIABLE,
+	// Only the latest per entity is sent each tick, and it isn't resent;
+	// for state that is soon stale, like positions
+	NET_DELIVERY_LATEST
+} NetDelivery;
+
 // Which game events should be passed along to server or client
 typedef struct
 {
@@ -117,9 +132,21 @@ typedef struct
 	// Whether to broadcast these events only after game start
 	bool GameStart;
 	const pb_field_t *Fields;
+	// Size of the event with its payload, as stored in the queue
+	size_t Size;
+	NetDelivery Delivery;
 } GameEventEntry;
 GameEventEntry GameEventGetEntry(const GameEventType e);
-
+// UID of the entity a NET_DELIVERY_LATEST event is for, given its payload
+// Snapshot acks have no payload struct and are one per connection.
+uint32_t GameEventLatestUID(const GameEventType e, const void *data);
+// Where in the world an event happens, in real coordinates, for events that
+// only matter to players nearby; false for the rest
+bool GameEventPos(const GameEventType e, const void *data, Vec2i *pos);
+
+// Events are stored in the queue only as big as their payload, so only
+// read and write the union member for the event's type, and don't copy
+// queued events by value
 typedef struct
 {
 	GameEventType Type;
@@ -162,7 +189,12 @@ typedef struct
 		} ObjectSetCounter;
 		NBulletBounce BulletBounce;
 		NRemoveBullet RemoveBullet;
-		int ParticleRemoveId;
+		struct
+		{
+			int Id;
+			// Slot generation, so stale removals are ignored
+			int Generation;
+		} ParticleRemove;
 		NGunFire GunFire;
 		NGunReload GunReload;
 		NGunState GunState;
@@ -177,11 +209,17 @@ typedef struct
 	} u;
 } GameEvent;
 
-extern CArray gGameEvents;	// of GameEvent
-
-void GameEventsInit(CArray *store);
-void GameEventsTerminate(CArray *store);
-void GameEventsEnqueue(CArray *store, GameEvent e);
-void GameEventsClear(CArray *store);
+extern EventQueue gGameEvents;	// of GameEvent
+
+void GameEventsInit(EventQueue *store);
+void GameEventsTerminate(EventQueue *store);
+// Add an event to fill in; then call GameEventsCommit to send it on to the
+// server or clients as needed
+// The event stays put until the store is cleared.
+GameEvent *GameEventsAdd(EventQueue *store, const GameEventType type);
+void GameEventsCommit(EventQueue *store, const GameEvent *e);
+// Add and commit a copy of an event that was filled in elsewhere
+void GameEventsEnqueue(EventQueue *store, const GameEvent *e);
+void GameEventsClear(EventQueue *store);
 
 GameEvent GameEventNew(GameEventType type);
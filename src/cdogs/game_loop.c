@@ -35,8 +35,13 @@
 #include "music.h"
 #include "net_client.h"
 #include "net_server.h"
+#include "profiler.h"
 #include "sounds.h"
 
+#if !defined(__RS97__)
+static ConfigHandle sStartServer = CONFIG_HANDLE("StartServer");
+#endif
+
 
 GameLoopData GameLoopDataNew(
 	void *updateData, GameLoopResult (*updateFunc)(void *),
@@ -52,8 +57,14 @@ GameLoopData GameLoopDataNew(
 	return g;
 }
 
+static void GameLoopHeadless(GameLoopData *data);
 void GameLoop(GameLoopData *data)
 {
+	if (data->Headless)
+	{
+		GameLoopHeadless(data);
+		return;
+	}
 	EventReset(
 		&gEventHandlers,
 		gEventHandlers.mouse.cursor, gEventHandlers.mouse.trail);
@@ -76,7 +87,7 @@ void GameLoop(GameLoopData *data)
 		}
 
     #if !defined(__RS97__)
-		if (!gCampaign.IsClient && !ConfigGetBool(&gConfig, "StartServer"))
+		if (!gCampaign.IsClient && !ConfigHandleGetBool(&sStartServer))
 		{
 			MusicSetPlaying(
 				&gSoundDevice, SDL_GetAppState() & SDL_APPINPUTFOCUS);
@@ -126,6 +137,10 @@ void GameLoop(GameLoopData *data)
 		if ((int)ticksElapsed > 1000 / data->FPS && framesSkipped < maxFrameskip)
 		{
 			framesSkipped++;
+			if (gProfiler.Enabled)
+			{
+				ProfilerFrameEnd(&gProfiler);
+			}
 			continue;
 		}
 		framesSkipped = 0;
@@ -137,8 +152,28 @@ void GameLoop(GameLoopData *data)
 			{
 				data->DrawFunc(data->DrawData);
 			}
+			PROFILE_BEGIN(PROFILE_BLIT);
 			BlitFlip(&gGraphicsDevice);
+			PROFILE_END(PROFILE_BLIT);
 			data->HasDrawnFirst = true;
 		}
+		if (gProfiler.Enabled)
+		{
+			ProfilerFrameEnd(&gProfiler);
+		}
+	}
+}
+static void GameLoopHeadless(GameLoopData *data)
+{
+	GameLoopResult result = UPDATE_RESULT_OK;
+	while (result != UPDATE_RESULT_EXIT &&
+		(data->MaxFrames == 0 || data->Frames < data->MaxFrames))
+	{
+		result = data->UpdateFunc(data->UpdateData);
+		data->Frames++;
+		if (gProfiler.Enabled)
+		{
+			ProfilerFrameEnd(&gProfiler);
+		}
 	}
 }
@@ -53,6 +53,9 @@ typedef struct
 	bool InputEverySecondFrame;
 	int Frames;		// total frames looped
 	bool HasDrawnFirst;
+	// Run updates as fast as possible, with no input or drawing
+	bool Headless;
+	int MaxFrames;	// exit after this many frames; 0 for no limit
 } GameLoopData;
 
 GameLoopData GameLoopDataNew(
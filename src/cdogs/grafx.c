@@ -57,10 +57,10 @@
 #include <SDL_mouse.h>
 
 #include "blit.h"
+#include "blit_span.h"
 #include "config.h"
 #include "defs.h"
 #include "grafx_bg.h"
-#include "hqx/hqx.h"
 #include "log.h"
 #include "palette.h"
 #include "files.h"
@@ -157,6 +157,16 @@ static void AddGraphicsMode(
 	mode->ScaleFactor = scaleFactor;
 }
 
+static void OnBrightnessChange(const Config *c, void *data)
+{
+	GraphicsDevice *device = data;
+	device->cachedConfig.Brightness = c->u.Int.Value;
+}
+static void OnScaleModeChange(const Config *c, void *data)
+{
+	GraphicsDevice *device = data;
+	device->cachedConfig.ScaleMode = (ScaleMode)c->u.Enum.Value;
+}
 void GraphicsInit(GraphicsDevice *device, Config *c)
 {
 	device->IsInitialized = 0;
@@ -177,8 +187,24 @@ void GraphicsInit(GraphicsDevice *device, Config *c)
 	// AddGraphicsMode(device, 320, 240, 2);
 	device->buf = NULL;
 	device->bkg = NULL;
-	hqxInit();
+	memset(&device->dirty, 0, sizeof device->dirty);
+	device->present = NULL;
+	device->present16 = NULL;
+	device->PixelsPushed = 0;
+	HqxPoolInit(&device->hqxPool, HQX_POOL_WORKERS);
+	// Use the fastest blitters the CPU supports
+	if (BlitSpanIsCompiled(BLIT_SPAN_SSE2) && SDL_HasSSE2())
+	{
+		BlitSpanUse(BLIT_SPAN_SSE2);
+	}
+	debug(D_NORMAL, "Using %s blitters\n", gBlitSpan.Name);
 	GraphicsConfigSetFromConfig(&device->cachedConfig, c);
+	Config *brightness = ConfigGet(c, "Graphics.Brightness");
+	OnBrightnessChange(brightness, device);
+	ConfigAddListener(brightness, OnBrightnessChange, device);
+	Config *scaleMode = ConfigGet(c, "Graphics.ScaleMode");
+	OnScaleModeChange(scaleMode, device);
+	ConfigAddListener(scaleMode, OnScaleModeChange, device);
 }
 
 void AddSupportedModesForBPP(GraphicsDevice *device, int bpp)
@@ -234,6 +260,46 @@ void AddSupportedGraphicsModes(GraphicsDevice *device)
 	// AddSupportedModesForBPP(device, 32);
 }
 
+// Create the offscreen surface and buffers that everything draws to
+static bool CreateScreen(GraphicsDevice *g, const int rw, const int rh)
+{
+	SDL_FreeSurface(g->screen);
+	g->screen = SDL_CreateRGBSurface(SDL_SWSURFACE, rw, rh, 32, 0, 0, 0, 0);
+	if (g->screen == NULL)
+	{
+		printf("ERROR: InitVideo: %s\n", SDL_GetError());
+		return false;
+	}
+	SDL_PixelFormat *f = g->screen->format;
+	g->Amask = -1 & ~(f->Rmask | f->Gmask | f->Bmask);
+	Uint32 aMask = g->Amask;
+	g->Ashift = 0;
+	while (aMask != 0xff)
+	{
+		g->Ashift += 8;
+		aMask >>= 8;
+	}
+
+	CFREE(g->buf);
+	CCALLOC(g->buf, GraphicsGetMemSize(&g->cachedConfig));
+	CFREE(g->bkg);
+	CCALLOC(g->bkg, GraphicsGetMemSize(&g->cachedConfig));
+	DirtyBlocksTerminate(&g->dirty);
+	DirtyBlocksInit(&g->dirty, g->cachedConfig.Res);
+	CFREE(g->present);
+	CCALLOC(g->present, GraphicsGetMemSize(&g->cachedConfig));
+	CFREE(g->present16);
+	g->present16 = NULL;
+
+	debug(D_NORMAL, "Changed video mode...\n");
+
+	GraphicsSetBlitClip(
+		g, 0, 0, g->cachedConfig.Res.x - 1, g->cachedConfig.Res.y - 1);
+	debug(D_NORMAL, "Internal dimensions:\t%dx%d\n",
+		g->cachedConfig.Res.x, g->cachedConfig.Res.y);
+	return true;
+}
+
 // Initialises the video subsystem.
 // To prevent needless screen flickering, config is compared with cache
 // to see if anything changed. If not, don't recreate the screen.
@@ -299,38 +365,14 @@ void GraphicsInitialize(GraphicsDevice *g, const bool force)
 
 	LOG(LM_MAIN, LL_INFO, "graphics mode(%dx%d %dx) actual(%dx%d)",
 		w, h, g->cachedConfig.ScaleFactor, rw, rh);
-	SDL_FreeSurface(g->screen);
 	//g->screen = SDL_SetVideoMode(rw, rh, 32, sdl_flags);
 	// g->ScreenSurface = SDL_SetVideoMode(320, 240, 16, SDL_SWSURFACE);
 	g->ScreenSurface = SDL_SetVideoMode(320, 240, 16, SDL_HWSURFACE | SDL_TRIPLEBUF);
-	g->screen = SDL_CreateRGBSurface(SDL_SWSURFACE, rw, rh, 32, 0, 0, 0, 0);
 	// g->screen = SDL_SetVideoMode(320, 240, 16, SDL_HWSURFACE | SDL_TRIPLEBUF);
-	if (g->screen == NULL)
+	if (!CreateScreen(g, rw, rh))
 	{
-		printf("ERROR: InitVideo: %s\n", SDL_GetError());
 		return;
 	}
-	SDL_PixelFormat *f = g->screen->format;
-	g->Amask = -1 & ~(f->Rmask | f->Gmask | f->Bmask);
-	Uint32 aMask = g->Amask;
-	g->Ashift = 0;
-	while (aMask != 0xff)
-	{
-		g->Ashift += 8;
-		aMask >>= 8;
-	}
-
-	CFREE(g->buf);
-	CCALLOC(g->buf, GraphicsGetMemSize(&g->cachedConfig));
-	CFREE(g->bkg);
-	CCALLOC(g->bkg, GraphicsGetMemSize(&g->cachedConfig));
-
-	debug(D_NORMAL, "Changed video mode...\n");
-
-	GraphicsSetBlitClip(
-		g, 0, 0, g->cachedConfig.Res.x - 1, g->cachedConfig.Res.y - 1);
-	debug(D_NORMAL, "Internal dimensions:\t%dx%d\n",
-		g->cachedConfig.Res.x, g->cachedConfig.Res.y);
 
 	g->IsInitialized = true;
 	g->IsWindowInitialized = true;
@@ -339,6 +381,15 @@ void GraphicsInitialize(GraphicsDevice *g, const bool force)
 	g->cachedConfig.needRestart = false;
 }
 
+// Set up the screen buffers without opening a window or touching the video
+// subsystem; pics and fonts need the screen format even if nothing is drawn
+void GraphicsInitializeHeadless(GraphicsDevice *g)
+{
+	g->IsInitialized = CreateScreen(
+		g, g->cachedConfig.Res.x, g->cachedConfig.Res.y);
+	g->cachedConfig.needRestart = false;
+}
+
 void GraphicsTerminate(GraphicsDevice *device)
 {
 	debug(D_NORMAL, "Shutting down video...\n");
@@ -347,6 +398,10 @@ void GraphicsTerminate(GraphicsDevice *device)
 	SDL_VideoQuit();
 	CFREE(device->buf);
 	CFREE(device->bkg);
+	DirtyBlocksTerminate(&device->dirty);
+	CFREE(device->present);
+	CFREE(device->present16);
+	HqxPoolTerminate(&device->hqxPool);
 }
 
 int GraphicsGetScreenSize(GraphicsConfig *config)
@@ -55,7 +55,10 @@
 #include "c_array.h"
 #include "color.h"
 #include "config.h"
+#include "dirty_blocks.h"
+#include "hqx_pool.h"
 #include "pic_file.h"
+#include "present.h"
 #include "vector.h"
 #include "sys_specifics.h"
 
@@ -65,6 +68,9 @@ typedef struct
 	bool Fullscreen;
 	int ScaleFactor;
 	bool IsEditor;
+	// Read every frame; kept up to date by config listeners
+	int Brightness;
+	ScaleMode ScaleMode;
 
 	bool needRestart;
 } GraphicsConfig;
@@ -100,12 +106,24 @@ typedef struct
 	int modeIndex;
 	Uint32 *buf;
 	Uint32 *bkg;
+
+	// Only the parts of buf that changed since the last frame are presented
+	DirtyBlocks dirty;
+	Uint32 *present;	// frame with brightness applied, for hqx
+	Uint16 *present16;	// frame converted for 16-bit screens
+	int presentBrightness;
+	ScaleMode presentScaleMode;
+	BrightnessLUT brightnessLUT;
+	Present16LUT present16LUT;
+	HqxPool hqxPool;
+	int PixelsPushed;	// in the last frame
 } GraphicsDevice;
 
 extern GraphicsDevice gGraphicsDevice;
 
 void GraphicsInit(GraphicsDevice *device, Config *c);
 void GraphicsInitialize(GraphicsDevice *g, const bool force);
+void GraphicsInitializeHeadless(GraphicsDevice *g);
 void GraphicsTerminate(GraphicsDevice *device);
 int GraphicsGetScreenSize(GraphicsConfig *config);
 int GraphicsGetMemSize(GraphicsConfig *config);
@@ -0,0 +1,263 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "grid_path.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "utils.h"
+
+enum
+{
+	WALKABLE_UNKNOWN,
+	WALKABLE_YES,
+	WALKABLE_NO
+};
+
+
+void GridPathInit(GridPath *g, const Vec2i size)
+{
+	memset(g, 0, sizeof *g);
+	g->Size = size;
+	const int count = MAX(size.x * size.y, 1);
+	CCALLOC(g->nodes, count * sizeof *g->nodes);
+	CMALLOC(g->heap, count * sizeof *g->heap);
+}
+void GridPathTerminate(GridPath *g)
+{
+	CFREE(g->nodes);
+	CFREE(g->heap);
+	memset(g, 0, sizeof *g);
+}
+
+float GridPathStepCost(const Vec2i a, const Vec2i b)
+{
+	// Note that there are different horizontal and vertical costs,
+	// due to the tiles being non-square
+	// Slightly prefer axes instead of diagonals
+	if (a.x != b.x && a.y != b.y)
+	{
+		return TILE_WIDTH * 1.1f;
+	}
+	else if (a.x != b.x)
+	{
+		return TILE_WIDTH;
+	}
+	return TILE_HEIGHT;
+}
+
+static GridPathNode *GetNode(GridPath *g, const int i)
+{
+	GridPathNode *n = &g->nodes[i];
+	if (n->Stamp != g->generation)
+	{
+		n->Stamp = g->generation;
+		n->Cost = FLT_MAX;
+		n->Rank = FLT_MAX;
+		n->Heuristic = -1;
+		n->Parent = -1;
+		n->HeapIndex = -1;
+		n->Walkable = WALKABLE_UNKNOWN;
+	}
+	return n;
+}
+static Vec2i IndexToTile(const GridPath *g, const int i)
+{
+	return Vec2iNew(i % g->Size.x, i / g->Size.x);
+}
+
+// Binary heap of open nodes
+static void HeapSet(GridPath *g, const int pos, const int i)
+{
+	g->heap[pos] = i;
+	g->nodes[i].HeapIndex = pos;
+}
+static void HeapSiftUp(GridPath *g, int pos)
+{
+	const int i = g->heap[pos];
+	const float rank = g->nodes[i].Rank;
+	while (pos > 0)
+	{
+		const int parent = (pos - 1) / 2;
+		if (g->nodes[g->heap[parent]].Rank <= rank) break;
+		HeapSet(g, pos, g->heap[parent]);
+		pos = parent;
+	}
+	HeapSet(g, pos, i);
+}
+static void HeapSiftDown(GridPath *g, int pos)
+{
+	const int i = g->heap[pos];
+	const float rank = g->nodes[i].Rank;
+	for (;;)
+	{
+		int child = pos * 2 + 1;
+		if (child >= g->heapSize) break;
+		if (child + 1 < g->heapSize &&
+			g->nodes[g->heap[child + 1]].Rank < g->nodes[g->heap[child]].Rank)
+		{
+			child++;
+		}
+		if (g->nodes[g->heap[child]].Rank >= rank) break;
+		HeapSet(g, pos, g->heap[child]);
+		pos = child;
+	}
+	HeapSet(g, pos, i);
+}
+static void HeapPush(GridPath *g, const int i)
+{
+	g->heapSize++;
+	HeapSet(g, g->heapSize - 1, i);
+	HeapSiftUp(g, g->heapSize - 1);
+}
+static int HeapPop(GridPath *g)
+{
+	const int top = g->heap[0];
+	g->nodes[top].HeapIndex = -1;
+	g->heapSize--;
+	if (g->heapSize > 0)
+	{
+		HeapSet(g, 0, g->heap[g->heapSize]);
+		HeapSiftDown(g, 0);
+	}
+	return top;
+}
+
+static bool IsWalkable(
+	GridPath *g, Map *map, TileSelectFunc isTileOk, const Vec2i v)
+{
+	if (v.x < 0 || v.x >= g->Size.x || v.y < 0 || v.y >= g->Size.y)
+	{
+		return false;
+	}
+	GridPathNode *n = GetNode(g, v.y * g->Size.x + v.x);
+	if (n->Walkable == WALKABLE_UNKNOWN)
+	{
+		n->Walkable = isTileOk(map, v) ? WALKABLE_YES : WALKABLE_NO;
+	}
+	return n->Walkable == WALKABLE_YES;
+}
+static float Heuristic(GridPathNode *n, const Vec2i v, const Vec2i goal)
+{
+	// Simple Euclidean
+	if (n->Heuristic < 0)
+	{
+		n->Heuristic = (float)sqrt(DistanceSquared(
+			Vec2iCenterOfTile(v), Vec2iCenterOfTile(goal)));
+	}
+	return n->Heuristic;
+}
+static ASPath MakePath(GridPath *g, const int goal);
+ASPath GridPathFind(
+	GridPath *g, Map *map, TileSelectFunc isTileOk,
+	const Vec2i from, const Vec2i to)
+{
+	const Vec2i size = g->Size;
+	if (from.x < 0 || from.x >= size.x || from.y < 0 || from.y >= size.y ||
+		to.x < 0 || to.x >= size.x || to.y < 0 || to.y >= size.y)
+	{
+		return NULL;
+	}
+
+	g->generation++;
+	if (g->generation == 0)
+	{
+		// Stamps have wrapped around; reset them all
+		memset(g->nodes, 0, size.x * size.y * sizeof *g->nodes);
+		g->generation = 1;
+	}
+	g->heapSize = 0;
+
+	const int start = from.y * size.x + from.x;
+	const int goal = to.y * size.x + to.x;
+	GridPathNode *n = GetNode(g, start);
+	n->Cost = 0;
+	n->Rank = Heuristic(n, from, to);
+	HeapPush(g, start);
+
+	while (g->heapSize > 0)
+	{
+		const int current = HeapPop(g);
+		if (current == goal)
+		{
+			return MakePath(g, goal);
+		}
+		const Vec2i v = IndexToTile(g, current);
+		const float currentCost = g->nodes[current].Cost;
+		Vec2i d;
+		for (d.y = v.y - 1; d.y <= v.y + 1; d.y++)
+		{
+			for (d.x = v.x - 1; d.x <= v.x + 1; d.x++)
+			{
+				if (d.x == v.x && d.y == v.y) continue;
+				// if we're moving diagonally,
+				// need to check the axis-aligned neighbours are also clear
+				if (!IsWalkable(g, map, isTileOk, d) ||
+					!IsWalkable(g, map, isTileOk, Vec2iNew(v.x, d.y)) ||
+					!IsWalkable(g, map, isTileOk, Vec2iNew(d.x, v.y)))
+				{
+					continue;
+				}
+				const float cost = currentCost + GridPathStepCost(v, d);
+				const int neighbor = d.y * size.x + d.x;
+				n = GetNode(g, neighbor);
+				if (cost >= n->Cost) continue;
+				// Found a better route; (re)open the node
+				n->Cost = cost;
+				n->Rank = cost + Heuristic(n, d, to);
+				n->Parent = current;
+				if (n->HeapIndex >= 0)
+				{
+					HeapSiftUp(g, n->HeapIndex);
+				}
+				else
+				{
+					HeapPush(g, neighbor);
+				}
+			}
+		}
+	}
+	return NULL;
+}
+static ASPath MakePath(GridPath *g, const int goal)
+{
+	size_t count = 0;
+	for (int i = goal; i >= 0; i = g->nodes[i].Parent)
+	{
+		count++;
+	}
+	ASPath path = ASPathNew(sizeof(Vec2i), count, g->nodes[goal].Cost);
+	size_t idx = count;
+	for (int i = goal; i >= 0; i = g->nodes[i].Parent)
+	{
+		idx--;
+		*(Vec2i *)ASPathGetNode(path, idx) = IndexToTile(g, i);
+	}
+	return path;
+}
@@ -0,0 +1,67 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include "AStar.h"
+#include "map.h"
+#include "vector.h"
+
+// A* pathfinding specialised for the tile grid
+// The node arrays are sized to the map and reused between searches; each
+// search bumps a generation stamp instead of clearing them.
+typedef struct
+{
+	unsigned Stamp;	// generation the rest of the node is valid for
+	float Cost;
+	float Rank;	// cost plus heuristic
+	float Heuristic;	// negative if not calculated yet
+	int Parent;
+	int HeapIndex;	// -1 if not in the open set
+	int Walkable;	// tile walkability, evaluated once per search
+} GridPathNode;
+typedef struct
+{
+	Vec2i Size;
+	GridPathNode *nodes;
+	int *heap;	// open set, binary heap of node indices by rank
+	int heapSize;
+	unsigned generation;
+} GridPath;
+
+void GridPathInit(GridPath *g, const Vec2i size);
+void GridPathTerminate(GridPath *g);
+
+// Cost of moving between adjacent tiles
+float GridPathStepCost(const Vec2i a, const Vec2i b);
+
+// Find a path between tiles, moving in 8 directions, where diagonal moves
+// also need both adjacent tiles to be walkable
+// Returns NULL if there is no path
+ASPath GridPathFind(
+	GridPath *g, Map *map, TileSelectFunc isTileOk,
+	const Vec2i from, const Vec2i to);
@@ -29,10 +29,11 @@
 
 #include "c_array.h"
 #include "camera.h"
+#include "event_queue.h"
 #include "powerup.h"
 
 void HandleGameEvents(
-	CArray *store,
+	EventQueue *store,
 	Camera *camera,
 	PowerupSpawner *healthSpawner,
 	CArray *ammoSpawners);
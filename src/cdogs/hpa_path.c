@@ -0,0 +1,643 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "hpa_path.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "grid_path.h"
+#include "utils.h"
+
+// Long runs of open tiles along a border get a portal at each end
+#define PORTAL_SPLIT_LENGTH 6
+
+// Open set entry; entries made stale by a cheaper route are skipped
+typedef struct
+{
+	float Rank;
+	float Cost;
+	int Index;
+} HeapItem;
+
+
+void HPAPathInit(HPAPath *h, const Vec2i size, TileSelectFunc isTileOk)
+{
+	memset(h, 0, sizeof *h);
+	h->Size = size;
+	h->isTileOk = isTileOk;
+	h->ClusterCount = Vec2iNew(
+		(size.x + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE,
+		(size.y + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE);
+	const int clusterCount = MAX(h->ClusterCount.x * h->ClusterCount.y, 1);
+	CCALLOC(h->clusters, clusterCount * sizeof *h->clusters);
+	for (int i = 0; i < clusterCount; i++)
+	{
+		CArrayInit(&h->clusters[i].Nodes, sizeof(int));
+	}
+	CMALLOC(h->walkable, MAX(size.x * size.y, 1) * sizeof *h->walkable);
+	CArrayInit(&h->nodes, sizeof(HPANode));
+	CArrayInit(&h->freeNodes, sizeof(int));
+	const int clusterTiles = HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE;
+	CMALLOC(h->localCost, clusterTiles * sizeof *h->localCost);
+	CMALLOC(h->localParent, clusterTiles * sizeof *h->localParent);
+	CArrayInit(&h->heap, sizeof(HeapItem));
+	CArrayInit(&h->cost, sizeof(float));
+	CArrayInit(&h->parent, sizeof(int));
+	CArrayInit(&h->goalEdges, sizeof(HPAEdge));
+	CArrayInit(&h->trace, sizeof(Vec2i));
+}
+void HPAPathTerminate(HPAPath *h)
+{
+	const int clusterCount = MAX(h->ClusterCount.x * h->ClusterCount.y, 1);
+	for (int i = 0; i < clusterCount && h->clusters != NULL; i++)
+	{
+		CArrayTerminate(&h->clusters[i].Nodes);
+	}
+	CFREE(h->clusters);
+	CFREE(h->walkable);
+	CA_FOREACH(HPANode, n, h->nodes)
+		if (n->Cluster >= 0)
+		{
+			CArrayTerminate(&n->Edges);
+		}
+	CA_FOREACH_END()
+	CArrayTerminate(&h->nodes);
+	CArrayTerminate(&h->freeNodes);
+	CFREE(h->localCost);
+	CFREE(h->localParent);
+	CArrayTerminate(&h->heap);
+	CArrayTerminate(&h->cost);
+	CArrayTerminate(&h->parent);
+	CArrayTerminate(&h->goalEdges);
+	CArrayTerminate(&h->trace);
+	memset(h, 0, sizeof *h);
+}
+
+static void HeapPush(
+	CArray *heap, const float rank, const float cost, const int index)
+{
+	const HeapItem item = { rank, cost, index };
+	CArrayPushBack(heap, &item);
+	HeapItem *items = heap->data;
+	int pos = (int)heap->size - 1;
+	while (pos > 0)
+	{
+		const int parent = (pos - 1) / 2;
+		if (items[parent].Rank <= rank) break;
+		items[pos] = items[parent];
+		pos = parent;
+	}
+	items[pos] = item;
+}
+static HeapItem HeapPop(CArray *heap)
+{
+	HeapItem *items = heap->data;
+	const HeapItem top = items[0];
+	const int size = (int)heap->size - 1;
+	const HeapItem last = items[size];
+	CArrayDelete(heap, size);
+	if (size > 0)
+	{
+		int pos = 0;
+		for (;;)
+		{
+			int child = pos * 2 + 1;
+			if (child >= size) break;
+			if (child + 1 < size && items[child + 1].Rank < items[child].Rank)
+			{
+				child++;
+			}
+			if (items[child].Rank >= last.Rank) break;
+			items[pos] = items[child];
+			pos = child;
+		}
+		items[pos] = last;
+	}
+	return top;
+}
+
+static HPANode *GetNode(const HPAPath *h, const int i)
+{
+	return CArrayGet(&h->nodes, i);
+}
+static int ClusterAt(const HPAPath *h, const Vec2i tile)
+{
+	return (tile.y / HPA_CLUSTER_SIZE) * h->ClusterCount.x +
+		tile.x / HPA_CLUSTER_SIZE;
+}
+static Vec2i ClusterOrigin(const HPAPath *h, const int c)
+{
+	return Vec2iNew(
+		(c % h->ClusterCount.x) * HPA_CLUSTER_SIZE,
+		(c / h->ClusterCount.x) * HPA_CLUSTER_SIZE);
+}
+static bool IsInCluster(const HPAPath *h, const Vec2i origin, const Vec2i v)
+{
+	return v.x >= origin.x && v.x < origin.x + HPA_CLUSTER_SIZE &&
+		v.y >= origin.y && v.y < origin.y + HPA_CLUSTER_SIZE &&
+		v.x < h->Size.x && v.y < h->Size.y;
+}
+static int LocalIndex(const Vec2i origin, const Vec2i v)
+{
+	return (v.y - origin.y) * HPA_CLUSTER_SIZE + v.x - origin.x;
+}
+static bool IsWalkable(const HPAPath *h, const Vec2i v)
+{
+	return v.x >= 0 && v.x < h->Size.x && v.y >= 0 && v.y < h->Size.y &&
+		h->walkable[v.y * h->Size.x + v.x];
+}
+
+// Find the costs from a tile to the rest of its cluster, without leaving it
+// If goal is in the cluster, stop once it has been reached
+static void LocalSearch(
+	HPAPath *h, const int c, const Vec2i from, const Vec2i goal)
+{
+	const Vec2i origin = ClusterOrigin(h, c);
+	for (int i = 0; i < HPA_CLUSTER_SIZE * HPA_CLUSTER_SIZE; i++)
+	{
+		h->localCost[i] = FLT_MAX;
+		h->localParent[i] = -1;
+	}
+	const int start = LocalIndex(origin, from);
+	const int goalIndex =
+		IsInCluster(h, origin, goal) ? LocalIndex(origin, goal) : -1;
+	h->localCost[start] = 0;
+	CArrayClear(&h->heap);
+	HeapPush(&h->heap, 0, 0, start);
+	while (h->heap.size > 0)
+	{
+		const HeapItem item = HeapPop(&h->heap);
+		if (item.Index == goalIndex) break;
+		if (item.Cost > h->localCost[item.Index]) continue;
+		const Vec2i v = Vec2iNew(
+			origin.x + item.Index % HPA_CLUSTER_SIZE,
+			origin.y + item.Index / HPA_CLUSTER_SIZE);
+		Vec2i d;
+		for (d.y = v.y - 1; d.y <= v.y + 1; d.y++)
+		{
+			for (d.x = v.x - 1; d.x <= v.x + 1; d.x++)
+			{
+				if (d.x == v.x && d.y == v.y) continue;
+				// Same moves as the full search; since the cluster is a
+				// rectangle, the axis-aligned neighbours are in it too
+				if (!IsInCluster(h, origin, d) ||
+					!IsWalkable(h, d) ||
+					!IsWalkable(h, Vec2iNew(v.x, d.y)) ||
+					!IsWalkable(h, Vec2iNew(d.x, v.y)))
+				{
+					continue;
+				}
+				const float cost = item.Cost + GridPathStepCost(v, d);
+				const int i = LocalIndex(origin, d);
+				if (cost >= h->localCost[i]) continue;
+				h->localCost[i] = cost;
+				h->localParent[i] = item.Index;
+				HeapPush(&h->heap, cost, cost, i);
+			}
+		}
+	}
+}
+// Append the tiles of the last local search leading to a tile, excluding
+// where the search started from
+static void LocalTrace(HPAPath *h, const int c, const Vec2i to, CArray *tiles)
+{
+	const Vec2i origin = ClusterOrigin(h, c);
+	CArrayClear(&h->trace);
+	for (int i = LocalIndex(origin, to); h->localParent[i] >= 0;
+		i = h->localParent[i])
+	{
+		const Vec2i v = Vec2iNew(
+			origin.x + i % HPA_CLUSTER_SIZE, origin.y + i / HPA_CLUSTER_SIZE);
+		CArrayPushBack(&h->trace, &v);
+	}
+	for (int i = (int)h->trace.size - 1; i >= 0; i--)
+	{
+		CArrayPushBack(tiles, CArrayGet(&h->trace, i));
+	}
+}
+
+static int NodeAt(HPAPath *h, const Vec2i tile)
+{
+	const int c = ClusterAt(h, tile);
+	HPACluster *cluster = &h->clusters[c];
+	CA_FOREACH(const int, ni, cluster->Nodes)
+		if (Vec2iEqual(GetNode(h, *ni)->Tile, tile))
+		{
+			return *ni;
+		}
+	CA_FOREACH_END()
+	HPANode n;
+	n.Tile = tile;
+	n.Cluster = c;
+	CArrayInit(&n.Edges, sizeof(HPAEdge));
+	int i;
+	if (h->freeNodes.size > 0)
+	{
+		i = *(int *)CArrayGet(&h->freeNodes, (int)h->freeNodes.size - 1);
+		CArrayDelete(&h->freeNodes, (int)h->freeNodes.size - 1);
+		memcpy(GetNode(h, i), &n, sizeof n);
+	}
+	else
+	{
+		i = (int)h->nodes.size;
+		CArrayPushBack(&h->nodes, &n);
+	}
+	CArrayPushBack(&cluster->Nodes, &i);
+	return i;
+}
+static void AddEdge(HPAPath *h, const int from, const int to, const float cost)
+{
+	const HPAEdge e = { to, cost };
+	CArrayPushBack(&GetNode(h, from)->Edges, &e);
+}
+// Remove edges from the nodes of a cluster to the nodes of another
+static void RemoveEdges(HPAPath *h, const int c, const int toCluster)
+{
+	CA_FOREACH(const int, ni, h->clusters[c].Nodes)
+		CArray *edges = &GetNode(h, *ni)->Edges;
+		for (int j = (int)edges->size - 1; j >= 0; j--)
+		{
+			const HPAEdge *e = CArrayGet(edges, j);
+			if (GetNode(h, e->To)->Cluster == toCluster)
+			{
+				CArrayDelete(edges, j);
+			}
+		}
+	CA_FOREACH_END()
+}
+// Nodes only exist for portals; remove those that no longer lead anywhere
+static void RemoveUnusedNodes(HPAPath *h, const int c)
+{
+	CArray *nodes = &h->clusters[c].Nodes;
+	for (int j = (int)nodes->size - 1; j >= 0; j--)
+	{
+		const int ni = *(int *)CArrayGet(nodes, j);
+		HPANode *n = GetNode(h, ni);
+		bool hasPortal = false;
+		CA_FOREACH(const HPAEdge, e, n->Edges)
+			if (GetNode(h, e->To)->Cluster != c)
+			{
+				hasPortal = true;
+				break;
+			}
+		CA_FOREACH_END()
+		if (hasPortal) continue;
+		CArrayTerminate(&n->Edges);
+		n->Cluster = -1;
+		CArrayPushBack(&h->freeNodes, &ni);
+		CArrayDelete(nodes, j);
+		// Only nodes of the same cluster can still lead here; remove those
+		// edges now as the node may be reused
+		CA_FOREACH(const int, nj, *nodes)
+			CArray *edges = &GetNode(h, *nj)->Edges;
+			for (int k = (int)edges->size - 1; k >= 0; k--)
+			{
+				if (((const HPAEdge *)CArrayGet(edges, k))->To == ni)
+				{
+					CArrayDelete(edges, k);
+				}
+			}
+		CA_FOREACH_END()
+	}
+}
+static void AddPortal(HPAPath *h, const Vec2i a, const Vec2i b)
+{
+	const int na = NodeAt(h, a);
+	const int nb = NodeAt(h, b);
+	const float cost = GridPathStepCost(a, b);
+	AddEdge(h, na, nb, cost);
+	AddEdge(h, nb, na, cost);
+}
+// Recalculate the portals between a cluster and the one to its right or
+// below it; the edges within both clusters need rebuilding afterwards
+static void BuildBorder(HPAPath *h, const int c, const bool isDown)
+{
+	const Vec2i origin = ClusterOrigin(h, c);
+	const Vec2i dv = isDown ? Vec2iNew(1, 0) : Vec2iNew(0, 1);
+	const Vec2i across = isDown ? Vec2iNew(0, 1) : Vec2iNew(1, 0);
+	const Vec2i start = Vec2iAdd(
+		origin, Vec2iScale(across, HPA_CLUSTER_SIZE - 1));
+	const Vec2i other = Vec2iAdd(start, across);
+	if (other.x >= h->Size.x || other.y >= h->Size.y)
+	{
+		return;
+	}
+	const int n = ClusterAt(h, other);
+	RemoveEdges(h, c, n);
+	RemoveEdges(h, n, c);
+	RemoveUnusedNodes(h, c);
+	RemoveUnusedNodes(h, n);
+
+	const int length = isDown ?
+		MIN(HPA_CLUSTER_SIZE, h->Size.x - origin.x) :
+		MIN(HPA_CLUSTER_SIZE, h->Size.y - origin.y);
+	int runStart = -1;
+	for (int i = 0; i <= length; i++)
+	{
+		const Vec2i a = Vec2iAdd(start, Vec2iScale(dv, i));
+		const bool isOpen = i < length &&
+			IsWalkable(h, a) && IsWalkable(h, Vec2iAdd(a, across));
+		if (isOpen && runStart < 0)
+		{
+			runStart = i;
+		}
+		else if (!isOpen && runStart >= 0)
+		{
+			const int runEnd = i - 1;
+			if (runEnd - runStart + 1 >= PORTAL_SPLIT_LENGTH)
+			{
+				const Vec2i a1 = Vec2iAdd(start, Vec2iScale(dv, runStart));
+				const Vec2i a2 = Vec2iAdd(start, Vec2iScale(dv, runEnd));
+				AddPortal(h, a1, Vec2iAdd(a1, across));
+				AddPortal(h, a2, Vec2iAdd(a2, across));
+			}
+			else
+			{
+				const Vec2i am = Vec2iAdd(
+					start, Vec2iScale(dv, (runStart + runEnd) / 2));
+				AddPortal(h, am, Vec2iAdd(am, across));
+			}
+			runStart = -1;
+		}
+	}
+}
+// Recalculate the costs between the portals of a cluster
+static void BuildClusterEdges(HPAPath *h, const int c)
+{
+	const CArray *nodes = &h->clusters[c].Nodes;
+	RemoveEdges(h, c, c);
+	const Vec2i origin = ClusterOrigin(h, c);
+	for (int i = 0; i < (int)nodes->size; i++)
+	{
+		const int ni = *(int *)CArrayGet(nodes, i);
+		LocalSearch(h, c, GetNode(h, ni)->Tile, Vec2iNew(-1, -1));
+		for (int j = 0; j < (int)nodes->size; j++)
+		{
+			const int nj = *(int *)CArrayGet(nodes, j);
+			if (ni == nj) continue;
+			const float cost =
+				h->localCost[LocalIndex(origin, GetNode(h, nj)->Tile)];
+			if (cost < FLT_MAX)
+			{
+				AddEdge(h, ni, nj, cost);
+			}
+		}
+	}
+}
+static void Build(HPAPath *h, Map *map)
+{
+	Vec2i v;
+	for (v.y = 0; v.y < h->Size.y; v.y++)
+	{
+		for (v.x = 0; v.x < h->Size.x; v.x++)
+		{
+			h->walkable[v.y * h->Size.x + v.x] = h->isTileOk(map, v);
+		}
+	}
+	const int clusterCount = h->ClusterCount.x * h->ClusterCount.y;
+	for (int c = 0; c < clusterCount; c++)
+	{
+		BuildBorder(h, c, false);
+		BuildBorder(h, c, true);
+	}
+	for (int c = 0; c < clusterCount; c++)
+	{
+		BuildClusterEdges(h, c);
+	}
+	h->IsBuilt = true;
+}
+
+void HPAPathUpdateTile(HPAPath *h, Map *map, const Vec2i tile)
+{
+	if (!h->IsBuilt ||
+		tile.x < 0 || tile.x >= h->Size.x || tile.y < 0 || tile.y >= h->Size.y)
+	{
+		return;
+	}
+	bool *walkable = &h->walkable[tile.y * h->Size.x + tile.x];
+	const bool isWalkable = h->isTileOk(map, tile);
+	if (*walkable == isWalkable)
+	{
+		return;
+	}
+	*walkable = isWalkable;
+
+	// Only tiles on the edges of the cluster can change its portals
+	const int c = ClusterAt(h, tile);
+	const Vec2i origin = ClusterOrigin(h, c);
+	const int cx = c % h->ClusterCount.x;
+	const int cy = c / h->ClusterCount.x;
+	if (tile.x == origin.x && cx > 0)
+	{
+		BuildBorder(h, c - 1, false);
+		BuildClusterEdges(h, c - 1);
+	}
+	if (tile.x == origin.x + HPA_CLUSTER_SIZE - 1 &&
+		cx < h->ClusterCount.x - 1)
+	{
+		BuildBorder(h, c, false);
+		BuildClusterEdges(h, c + 1);
+	}
+	if (tile.y == origin.y && cy > 0)
+	{
+		BuildBorder(h, c - h->ClusterCount.x, true);
+		BuildClusterEdges(h, c - h->ClusterCount.x);
+	}
+	if (tile.y == origin.y + HPA_CLUSTER_SIZE - 1 &&
+		cy < h->ClusterCount.y - 1)
+	{
+		BuildBorder(h, c, true);
+		BuildClusterEdges(h, c + h->ClusterCount.x);
+	}
+	BuildClusterEdges(h, c);
+}
+
+static float Heuristic(const Vec2i a, const Vec2i b)
+{
+	return (float)sqrt(DistanceSquared(
+		Vec2iCenterOfTile(a), Vec2iCenterOfTile(b)));
+}
+static ASPath Refine(HPAPath *h, const Vec2i from, const Vec2i to, int goal);
+ASPath HPAPathFind(HPAPath *h, Map *map, const Vec2i from, const Vec2i to)
+{
+	if (from.x < 0 || from.x >= h->Size.x ||
+		from.y < 0 || from.y >= h->Size.y ||
+		to.x < 0 || to.x >= h->Size.x || to.y < 0 || to.y >= h->Size.y)
+	{
+		return NULL;
+	}
+	if (!h->IsBuilt)
+	{
+		Build(h, map);
+	}
+	if (!IsWalkable(h, to))
+	{
+		return NULL;
+	}
+
+	// Search the portals, plus the start and goal
+	const int start = (int)h->nodes.size;
+	const int goal = start + 1;
+	const float maxCost = FLT_MAX;
+	const int noParent = -1;
+	CArrayClear(&h->cost);
+	CArrayClear(&h->parent);
+	CArrayResize(&h->cost, goal + 1, &maxCost);
+	CArrayResize(&h->parent, goal + 1, &noParent);
+	float *cost = h->cost.data;
+	int *parent = h->parent.data;
+	CArrayClear(&h->heap);
+
+	// Connect the goal to the portals of its cluster
+	const int toCluster = ClusterAt(h, to);
+	const Vec2i toOrigin = ClusterOrigin(h, toCluster);
+	CArrayClear(&h->goalEdges);
+	LocalSearch(h, toCluster, to, Vec2iNew(-1, -1));
+	CA_FOREACH(const int, ni, h->clusters[toCluster].Nodes)
+		const HPAEdge e = {
+			*ni, h->localCost[LocalIndex(toOrigin, GetNode(h, *ni)->Tile)]
+		};
+		if (e.Cost < FLT_MAX)
+		{
+			CArrayPushBack(&h->goalEdges, &e);
+		}
+	CA_FOREACH_END()
+	// Connect the start to the portals of its cluster, and to the goal
+	// directly if they share a cluster
+	const int fromCluster = ClusterAt(h, from);
+	const Vec2i fromOrigin = ClusterOrigin(h, fromCluster);
+	LocalSearch(h, fromCluster, from, Vec2iNew(-1, -1));
+	cost[start] = 0;
+	CA_FOREACH(const int, ni, h->clusters[fromCluster].Nodes)
+		const float c =
+			h->localCost[LocalIndex(fromOrigin, GetNode(h, *ni)->Tile)];
+		if (c < FLT_MAX)
+		{
+			cost[*ni] = c;
+			parent[*ni] = start;
+			HeapPush(
+				&h->heap, c + Heuristic(GetNode(h, *ni)->Tile, to), c, *ni);
+		}
+	CA_FOREACH_END()
+	if (fromCluster == toCluster)
+	{
+		const float c = h->localCost[LocalIndex(fromOrigin, to)];
+		if (c < FLT_MAX)
+		{
+			cost[goal] = c;
+			parent[goal] = start;
+			HeapPush(&h->heap, c, c, goal);
+		}
+	}
+
+	while (h->heap.size > 0)
+	{
+		const HeapItem item = HeapPop(&h->heap);
+		if (item.Index == goal)
+		{
+			return Refine(h, from, to, goal);
+		}
+		if (item.Cost > cost[item.Index]) continue;
+		const HPANode *n = GetNode(h, item.Index);
+		CA_FOREACH(const HPAEdge, e, n->Edges)
+			const float c = item.Cost + e->Cost;
+			if (c >= cost[e->To]) continue;
+			cost[e->To] = c;
+			parent[e->To] = item.Index;
+			HeapPush(
+				&h->heap, c + Heuristic(GetNode(h, e->To)->Tile, to), c, e->To);
+		CA_FOREACH_END()
+		if (n->Cluster == toCluster)
+		{
+			CA_FOREACH(const HPAEdge, e, h->goalEdges)
+				if (e->To != item.Index) continue;
+				const float c = item.Cost + e->Cost;
+				if (c < cost[goal])
+				{
+					cost[goal] = c;
+					parent[goal] = item.Index;
+					HeapPush(&h->heap, c, c, goal);
+				}
+				break;
+			CA_FOREACH_END()
+		}
+	}
+	return NULL;
+}
+// Turn the route through the portals into tiles
+static ASPath Refine(HPAPath *h, const Vec2i from, const Vec2i to, int goal)
+{
+	const int start = goal - 1;
+	const int *parent = h->parent.data;
+	// Collect the portals from the goal backwards
+	CArray route;
+	CArrayInit(&route, sizeof(Vec2i));
+	CArrayPushBack(&route, &to);
+	for (int i = parent[goal]; i != start; i = parent[i])
+	{
+		CArrayPushBack(&route, &GetNode(h, i)->Tile);
+	}
+
+	CArray tiles;
+	CArrayInit(&tiles, sizeof(Vec2i));
+	CArrayPushBack(&tiles, &from);
+	Vec2i prev = from;
+	for (int i = (int)route.size - 1; i >= 0; i--)
+	{
+		const Vec2i next = *(const Vec2i *)CArrayGet(&route, i);
+		const int c = ClusterAt(h, next);
+		if (c != ClusterAt(h, prev))
+		{
+			// Crossing a portal
+			CArrayPushBack(&tiles, &next);
+		}
+		else
+		{
+			LocalSearch(h, c, prev, next);
+			LocalTrace(h, c, next, &tiles);
+		}
+		prev = next;
+	}
+
+	float cost = 0;
+	for (int i = 1; i < (int)tiles.size; i++)
+	{
+		cost += GridPathStepCost(
+			*(const Vec2i *)CArrayGet(&tiles, i - 1),
+			*(const Vec2i *)CArrayGet(&tiles, i));
+	}
+	ASPath path = ASPathNew(sizeof(Vec2i), tiles.size, cost);
+	for (int i = 0; i < (int)tiles.size; i++)
+	{
+		*(Vec2i *)ASPathGetNode(path, i) = *(Vec2i *)CArrayGet(&tiles, i);
+	}
+	CArrayTerminate(&route);
+	CArrayTerminate(&tiles);
+	return path;
+}
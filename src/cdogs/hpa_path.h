@@ -0,0 +1,88 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include "AStar.h"
+#include "c_array.h"
+#include "map.h"
+#include "vector.h"
+
+// Hierarchical pathfinding (HPA*)
+// The map is split into square clusters, joined by portals where walkable
+// tiles meet across cluster borders. Costs between the portals within each
+// cluster are precomputed, so that long paths can be found by searching the
+// small graph of portals, then refining each step within its cluster.
+// Paths found this way are close to, but may be a little longer than, the
+// shortest path.
+#define HPA_CLUSTER_SIZE 16
+
+typedef struct
+{
+	int To;
+	float Cost;
+} HPAEdge;
+typedef struct
+{
+	Vec2i Tile;
+	int Cluster;	// -1 if removed
+	CArray Edges;	// of HPAEdge
+} HPANode;
+typedef struct
+{
+	CArray Nodes;	// of int, indices of the cluster's HPANode
+} HPACluster;
+typedef struct
+{
+	Vec2i Size;
+	Vec2i ClusterCount;
+	TileSelectFunc isTileOk;
+	bool IsBuilt;
+	bool *walkable;
+	HPACluster *clusters;
+	CArray nodes;	// of HPANode
+	CArray freeNodes;	// of int, removed nodes that can be reused
+
+	// Scratch space for searches
+	float *localCost;
+	int *localParent;
+	CArray heap;
+	CArray cost;	// of float
+	CArray parent;	// of int
+	CArray goalEdges;	// of HPAEdge
+	CArray trace;	// of Vec2i
+} HPAPath;
+
+void HPAPathInit(HPAPath *h, const Vec2i size, TileSelectFunc isTileOk);
+void HPAPathTerminate(HPAPath *h);
+
+// Update the clusters around a tile whose walkability may have changed
+void HPAPathUpdateTile(HPAPath *h, Map *map, const Vec2i tile);
+
+// Find a path between tiles; the clusters are built on first use
+// Returns NULL if there is no path
+ASPath HPAPathFind(HPAPath *h, Map *map, const Vec2i from, const Vec2i to);
@@ -20,24 +20,6 @@
  */
 #include "common.h"
 
-uint32_t rgb_to_yuv(uint32_t c)
-{
-    // Mask against MASK_RGB to discard the alpha channel
-    return RGBtoYUV[MASK_RGB & c];
-}
-
-/* Test if there is difference in color */
-int yuv_diff(uint32_t yuv1, uint32_t yuv2) {
-    return ((yuv1 & Ymask) - (yuv2 & Ymask) > trY ||
-            (yuv1 & Umask) - (yuv2 & Umask) > trU ||
-            (yuv1 & Vmask) - (yuv2 & Vmask) > trV );
-}
-
-int Diff(uint32_t c1, uint32_t c2)
-{
-    return yuv_diff(rgb_to_yuv(c1), rgb_to_yuv(c2));
-}
-
 /* Interpolate functions */
 uint32_t Interpolate_2(uint32_t c1, int w1, uint32_t c2, int w2, int s)
 {
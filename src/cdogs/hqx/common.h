@@ -24,6 +24,9 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define MASK_2     0x0000FF00
 #define MASK_13    0x00FF00FF
@@ -40,12 +43,81 @@
 /* RGB to YUV lookup table */
 extern uint32_t RGBtoYUV[16777216];
 
-uint32_t rgb_to_yuv(uint32_t c);
+static inline uint32_t rgb_to_yuv(uint32_t c)
+{
+    // Mask against MASK_RGB to discard the alpha channel
+    return RGBtoYUV[MASK_RGB & c];
+}
 
 /* Test if there is difference in color */
-int yuv_diff(uint32_t yuv1, uint32_t yuv2);
+static inline int yuv_diff(uint32_t yuv1, uint32_t yuv2) {
+    return ((yuv1 & Ymask) - (yuv2 & Ymask) > trY ||
+            (yuv1 & Umask) - (yuv2 & Umask) > trU ||
+            (yuv1 & Vmask) - (yuv2 & Vmask) > trV );
+}
+
+static inline int Diff(uint32_t c1, uint32_t c2)
+{
+    return yuv_diff(rgb_to_yuv(c1), rgb_to_yuv(c2));
+}
+
+#ifdef __SSE2__
+/* yuv_diff of one centre against four neighbours, as a 4-bit mask */
+static inline int yuv_diff4(__m128i yuv1, __m128i yuv2)
+{
+    // Unsigned compares are signed compares with the top bit flipped
+    const __m128i bias = _mm_set1_epi32((int)0x80000000);
+    const __m128i ym = _mm_set1_epi32(Ymask);
+    const __m128i um = _mm_set1_epi32(Umask);
+    const __m128i vm = _mm_set1_epi32(Vmask);
+    const __m128i dy = _mm_sub_epi32(
+        _mm_and_si128(yuv1, ym), _mm_and_si128(yuv2, ym));
+    const __m128i du = _mm_sub_epi32(
+        _mm_and_si128(yuv1, um), _mm_and_si128(yuv2, um));
+    const __m128i dv = _mm_sub_epi32(
+        _mm_and_si128(yuv1, vm), _mm_and_si128(yuv2, vm));
+    const __m128i gt = _mm_or_si128(_mm_or_si128(
+        _mm_cmpgt_epi32(_mm_xor_si128(dy, bias),
+                        _mm_set1_epi32((int)(trY ^ 0x80000000))),
+        _mm_cmpgt_epi32(_mm_xor_si128(du, bias),
+                        _mm_set1_epi32((int)(trU ^ 0x80000000)))),
+        _mm_cmpgt_epi32(_mm_xor_si128(dv, bias),
+                        _mm_set1_epi32((int)(trV ^ 0x80000000))));
+    return _mm_movemask_ps(_mm_castsi128_ps(gt));
+}
+#endif
 
-int Diff(uint32_t c1, uint32_t c2);
+/* Pattern of neighbours w[1..9] (skipping w[5]) that differ from w[5] */
+static inline int hqx_pattern(const uint32_t *w)
+{
+#ifdef __SSE2__
+    const __m128i yuv1 = _mm_set1_epi32((int)rgb_to_yuv(w[5]));
+    const __m128i lo = _mm_setr_epi32(
+        (int)rgb_to_yuv(w[1]), (int)rgb_to_yuv(w[2]),
+        (int)rgb_to_yuv(w[3]), (int)rgb_to_yuv(w[4]));
+    const __m128i hi = _mm_setr_epi32(
+        (int)rgb_to_yuv(w[6]), (int)rgb_to_yuv(w[7]),
+        (int)rgb_to_yuv(w[8]), (int)rgb_to_yuv(w[9]));
+    return yuv_diff4(yuv1, lo) | (yuv_diff4(yuv1, hi) << 4);
+#else
+    int pattern = 0;
+    int flag = 1;
+    int k;
+    const uint32_t yuv1 = rgb_to_yuv(w[5]);
+    for (k=1; k<=9; k++)
+    {
+        if (k==5) continue;
+
+        if ( w[k] != w[5] )
+        {
+            if (yuv_diff(yuv1, rgb_to_yuv(w[k])))
+                pattern |= flag;
+        }
+        flag <<= 1;
+    }
+    return pattern;
+#endif
+}
 
 /* Interpolate functions */
 uint32_t Interpolate_2(uint32_t c1, int w1, uint32_t c2, int w2, int s);
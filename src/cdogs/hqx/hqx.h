@@ -52,4 +52,10 @@ HQX_API void HQX_CALLCONV hq2x_32_rb( uint32_t * src, uint32_t src_rowBytes, uin
 HQX_API void HQX_CALLCONV hq3x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height );
 HQX_API void HQX_CALLCONV hq4x_32_rb( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height );
 
+/* Scale only source rows [yStart, yEnd) of a width x height image; src and
+ * dest still point at the whole image so edge rows are read correctly */
+HQX_API void HQX_CALLCONV hq2x_32_rb_rows( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int yStart, int yEnd );
+HQX_API void HQX_CALLCONV hq3x_32_rb_rows( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int yStart, int yEnd );
+HQX_API void HQX_CALLCONV hq4x_32_rb_rows( uint32_t * src, uint32_t src_rowBytes, uint32_t * dest, uint32_t dest_rowBytes, int width, int height, int yStart, int yEnd );
+
 #endif
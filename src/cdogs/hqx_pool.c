@@ -0,0 +1,157 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "hqx_pool.h"
+
+#include <string.h>
+
+#include "hqx/hqx.h"
+#include "utils.h"
+
+
+void HqxPoolInit(HqxPool *p, const int numWorkers)
+{
+	memset(p, 0, sizeof *p);
+	p->NumWorkers = numWorkers;
+}
+void HqxPoolTerminate(HqxPool *p)
+{
+	if (p->Workers != NULL)
+	{
+		p->IsQuitting = true;
+		for (int i = 0; i < p->NumWorkers; i++)
+		{
+			SDL_SemPost(p->Workers[i].Start);
+		}
+		for (int i = 0; i < p->NumWorkers; i++)
+		{
+			SDL_WaitThread(p->Workers[i].Thread, NULL);
+			SDL_DestroySemaphore(p->Workers[i].Start);
+		}
+		CFREE(p->Workers);
+		SDL_DestroySemaphore(p->Done);
+	}
+	memset(p, 0, sizeof *p);
+}
+
+// Scale one of NumWorkers + 1 bands of the current job
+static void ScaleBand(HqxPool *p, const int band)
+{
+	const int rows = p->YEnd - p->YStart;
+	const int numBands = p->NumWorkers + 1;
+	const int yStart = p->YStart + rows * band / numBands;
+	const int yEnd = p->YStart + rows * (band + 1) / numBands;
+	if (yStart == yEnd)
+	{
+		return;
+	}
+	const Uint32 srb = p->Size.x * sizeof *p->Src;
+	const Uint32 drb = srb * p->Scale;
+	switch (p->Scale)
+	{
+	case 2:
+		hq2x_32_rb_rows(
+			p->Src, srb, p->Dst, drb, p->Size.x, p->Size.y, yStart, yEnd);
+		break;
+	case 3:
+		hq3x_32_rb_rows(
+			p->Src, srb, p->Dst, drb, p->Size.x, p->Size.y, yStart, yEnd);
+		break;
+	case 4:
+		hq4x_32_rb_rows(
+			p->Src, srb, p->Dst, drb, p->Size.x, p->Size.y, yStart, yEnd);
+		break;
+	default:
+		CASSERT(false, "unsupported hqx scale");
+		break;
+	}
+}
+
+static int WorkerMain(void *data)
+{
+	HqxWorker *w = data;
+	for (;;)
+	{
+		SDL_SemWait(w->Start);
+		if (w->Pool->IsQuitting)
+		{
+			break;
+		}
+		ScaleBand(w->Pool, w->Band);
+		SDL_SemPost(w->Pool->Done);
+	}
+	return 0;
+}
+
+static void StartWorkers(HqxPool *p)
+{
+	CCALLOC(p->Workers, p->NumWorkers * sizeof *p->Workers);
+	p->Done = SDL_CreateSemaphore(0);
+	for (int i = 0; i < p->NumWorkers; i++)
+	{
+		HqxWorker *w = &p->Workers[i];
+		w->Pool = p;
+		w->Band = i + 1;
+		w->Start = SDL_CreateSemaphore(0);
+		w->Thread = SDL_CreateThread(WorkerMain, w);
+		if (w->Thread == NULL)
+		{
+			// Make do with the workers we have
+			debug(D_NORMAL, "cannot start hqx worker %d\n", i);
+			SDL_DestroySemaphore(w->Start);
+			p->NumWorkers = i;
+			break;
+		}
+	}
+}
+
+void HqxPoolScale(
+	HqxPool *p, const int scale, Uint32 *src, Uint32 *dst, const Vec2i size,
+	const int yStart, const int yEnd)
+{
+	// The YUV table is large; only build it once hqx is actually used
+	hqxInit();
+	if (p->NumWorkers > 0 && p->Workers == NULL)
+	{
+		StartWorkers(p);
+	}
+	p->Scale = scale;
+	p->Src = src;
+	p->Dst = dst;
+	p->Size = size;
+	p->YStart = yStart;
+	p->YEnd = yEnd;
+	for (int i = 0; i < p->NumWorkers; i++)
+	{
+		SDL_SemPost(p->Workers[i].Start);
+	}
+	ScaleBand(p, 0);
+	for (int i = 0; i < p->NumWorkers; i++)
+	{
+		SDL_SemWait(p->Done);
+	}
+}
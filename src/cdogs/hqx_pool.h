@@ -0,0 +1,81 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include <SDL_mutex.h>
+#include <SDL_stdinc.h>
+#include <SDL_thread.h>
+
+#include "vector.h"
+
+// Runs hqx scaling over bands of rows, with the bands shared between the
+// calling thread and a small pool of worker threads
+// hqx reads the rows either side of each one it scales, so every band
+// reads from the whole source frame; output is the same as scaling the
+// frame in one go.
+#ifdef __GCWZERO__
+// Handhelds have a single core; scale on the calling thread only
+#define HQX_POOL_WORKERS 0
+#else
+#define HQX_POOL_WORKERS 3
+#endif
+
+struct HqxPool;
+typedef struct
+{
+	struct HqxPool *Pool;
+	int Band;
+	SDL_Thread *Thread;
+	SDL_sem *Start;
+} HqxWorker;
+
+typedef struct HqxPool
+{
+	int NumWorkers;
+	HqxWorker *Workers;	// started on first use
+	SDL_sem *Done;
+	bool IsQuitting;
+	// Current job
+	int Scale;
+	Uint32 *Src;
+	Uint32 *Dst;
+	Vec2i Size;
+	int YStart;
+	int YEnd;
+} HqxPool;
+
+void HqxPoolInit(HqxPool *p, const int numWorkers);
+void HqxPoolTerminate(HqxPool *p);
+
+// Scale source rows [yStart, yEnd) of the size.x * size.y frame src by
+// scale (2-4) into dst, which is the whole scaled frame
+void HqxPoolScale(
+	HqxPool *p, const int scale, Uint32 *src, Uint32 *dst, const Vec2i size,
+	const int yStart, const int yEnd);
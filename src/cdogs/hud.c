@@ -62,6 +62,17 @@
 #include "game_events.h"
 #include "mission.h"
 #include "pic_manager.h"
+#include "profiler.h"
+
+static ConfigHandle sGameAmmo = CONFIG_HANDLE("Game.Ammo");
+static ConfigHandle sInterfaceShowFPS = CONFIG_HANDLE("Interface.ShowFPS");
+static ConfigHandle sInterfaceShowHUDMap =
+	CONFIG_HANDLE("Interface.ShowHUDMap");
+static ConfigHandle sInterfaceShowProfiler =
+	CONFIG_HANDLE("Interface.ShowProfiler");
+static ConfigHandle sInterfaceShowTime = CONFIG_HANDLE("Interface.ShowTime");
+static ConfigHandle sInterfaceSplitscreen =
+	CONFIG_HANDLE("Interface.Splitscreen");
 
 
 // Total number of milliseconds that the numeric update lasts for
@@ -75,6 +86,8 @@ void FPSCounterInit(FPSCounter *counter)
 	counter->elapsed = 0;
 	counter->framesDrawn = 0;
 	counter->fps = 0;
+	counter->pixelsPushed = 0;
+	counter->pixelsPerFrame = 0;
 }
 void FPSCounterUpdate(FPSCounter *counter, int ms)
 {
@@ -82,7 +95,10 @@ void FPSCounterUpdate(FPSCounter *counter, int ms)
 	if (counter->elapsed > 1000)
 	{
 		counter->fps = counter->framesDrawn;
+		counter->pixelsPerFrame = counter->framesDrawn > 0 ?
+			counter->pixelsPushed / counter->framesDrawn : 0;
 		counter->framesDrawn = 0;
+		counter->pixelsPushed = 0;
 		counter->elapsed -= 1000;
 	}
 }
@@ -90,7 +106,8 @@ void FPSCounterDraw(FPSCounter *counter)
 {
 	char s[50];
 	counter->framesDrawn++;
-	sprintf(s, "FPS: %d", counter->fps);
+	counter->pixelsPushed += gGraphicsDevice.PixelsPushed;
+	sprintf(s, "FPS: %d px: %d", counter->fps, counter->pixelsPerFrame);
 
 	FontOpts opts = FontOptsNew();
 	opts.HAlign = ALIGN_END;
@@ -100,6 +117,57 @@ void FPSCounterDraw(FPSCounter *counter)
 	FontStrOpt(s, Vec2iZero(), opts);
 }
 
+// Stacked bar graph of the top-level sections for recent frames, with the
+// average of each section over those frames
+#define PROFILER_GRAPH_HEIGHT 40
+#define PROFILER_GRAPH_US_PER_PIXEL 1000
+static void ProfilerGraphDraw(const Profiler *p)
+{
+	const ProfileSection sections[] =
+	{
+		PROFILE_UPDATE, PROFILE_DRAW, PROFILE_BLIT
+	};
+	const color_t colors[] = { colorGreen, colorCyan, colorYellow };
+	const int numSections = sizeof sections / sizeof sections[0];
+	const Vec2i res = gGraphicsDevice.cachedConfig.Res;
+	const int right = res.x - 10;
+	const int bottom = res.y - 5 - FontH() * 2;
+	const int top = bottom - PROFILER_GRAPH_HEIGHT;
+
+	uint32_t sums[PROFILE_COUNT] = { 0 };
+	for (int n = 0; n < p->HistoryCount && n < right; n++)
+	{
+		const int x = right - n;
+		int y = bottom;
+		for (int i = 0; i < numSections; i++)
+		{
+			const uint32_t us = ProfilerHistoryGet(p, n, sections[i]);
+			sums[sections[i]] += us;
+			const int h = (int)(us / PROFILER_GRAPH_US_PER_PIXEL);
+			if (h == 0) continue;
+			const int y2 = MAX(y - h + 1, top);
+			Draw_Line(x, y, x, y2, colors[i]);
+			y = y2 - 1;
+			if (y < top) break;
+		}
+	}
+	// Top of the graph, PROFILER_GRAPH_HEIGHT ms
+	Draw_Line(
+		right - PROFILER_HISTORY + 1, top, right, top, colorGray);
+
+	if (p->HistoryCount == 0) return;
+	Vec2i pos = Vec2iNew(right - PROFILER_HISTORY + 1, top - FontH());
+	for (int i = numSections - 1; i >= 0; i--)
+	{
+		char buf[32];
+		sprintf(buf, "%s %.1fms",
+			ProfileSectionStr(sections[i]),
+			sums[sections[i]] / 1000.0 / p->HistoryCount);
+		FontStrMask(buf, pos, colors[i]);
+		pos.y -= FontH();
+	}
+}
+
 void WallClockSetTime(WallClock *wc)
 {
 	time_t t = time(NULL);
@@ -365,7 +433,7 @@ static void DrawWeaponStatus(
 	opts.Area = gGraphicsDevice.cachedConfig.Res;
 	opts.Pad = Vec2iNew(pos.x + GUN_ICON_PAD, pos.y);
 	char buf[128];
-	if (ConfigGetBool(&gConfig, "Game.Ammo") && weapon->Gun->AmmoId >= 0)
+	if (ConfigHandleGetBool(&sGameAmmo) && weapon->Gun->AmmoId >= 0)
 	{
 		// Include ammo counter
 		sprintf(buf, "%s %d/%d",
@@ -619,7 +687,7 @@ static void DrawPlayerStatus(
 	char s[50];
 	if (IsScoreNeeded(gCampaign.Entry.Mode))
 	{
-		if (ConfigGetBool(&gConfig, "Game.Ammo"))
+		if (ConfigHandleGetBool(&sGameAmmo))
 		{
 			// Display money instead of ammo
 			sprintf(s, "Cash: $%d", data->score);
@@ -657,7 +725,7 @@ static void DrawPlayerStatus(
 		FontStrOpt(s, Vec2iZero(), opts);
 	}
 
-	if (ConfigGetBool(&gConfig, "Interface.ShowHUDMap") &&
+	if (ConfigHandleGetBool(&sInterfaceShowHUDMap) &&
 		!(flags & HUDFLAGS_SHARE_SCREEN) &&
 		IsAutoMapEnabled(gCampaign.Entry.Mode))
 	{
@@ -687,10 +755,15 @@ static void DrawObjectiveCompass(
 		for (tilePos.x = 0; tilePos.x < map->Size.x; tilePos.x++)
 		{
 			Tile *tile = MapGetTile(map, tilePos);
-			for (int i = 0; i < (int)tile->things.size; i++)
+			const CArray *things = MapGetTileThings(map, tilePos);
+			if (things == NULL)
 			{
-				TTileItem *ti =
-					ThingIdGetTileItem(CArrayGet(&tile->things, i));
+				continue;
+			}
+			for (int i = 0; i < (int)things->size; i++)
+			{
+				const SpatialHashEntry *e = CArrayGet(things, i);
+				TTileItem *ti = ThingIdGetTileItem(&e->Id);
 				if (!(ti->flags & TILEITEM_OBJECTIVE))
 				{
 					continue;
@@ -852,7 +925,7 @@ void HUDDraw(HUD *hud, const input_device_e pausingDevice)
 		flags = 0;
 	}
 	else if (
-		ConfigGetEnum(&gConfig, "Interface.Splitscreen") == SPLITSCREEN_NEVER)
+		ConfigHandleGetEnum(&sInterfaceSplitscreen) == SPLITSCREEN_NEVER)
 	{
 		flags |= HUDFLAGS_SHARE_SCREEN;
 	}
@@ -904,7 +977,7 @@ void HUDDraw(HUD *hud, const input_device_e pausingDevice)
 		DrawAmmoUpdate(&hud->ammoUpdates[idx], drawFlags);
 	}
 	// Only draw radar once if shared
-	if (ConfigGetBool(&gConfig, "Interface.ShowHUDMap") &&
+	if (ConfigHandleGetBool(&sInterfaceShowHUDMap) &&
 		(flags & HUDFLAGS_SHARE_SCREEN) &&
 		IsAutoMapEnabled(gCampaign.Entry.Mode))
 	{
@@ -972,11 +1045,15 @@ void HUDDraw(HUD *hud, const input_device_e pausingDevice)
 		FontStrMask(hud->message, pos, colorCyan);
 	}
 
-	if (ConfigGetBool(&gConfig, "Interface.ShowFPS"))
+	if (ConfigHandleGetBool(&sInterfaceShowFPS))
 	{
 		FPSCounterDraw(&hud->fpsCounter);
 	}
-	if (ConfigGetBool(&gConfig, "Interface.ShowTime"))
+	if (ConfigHandleGetBool(&sInterfaceShowProfiler) && gProfiler.Enabled)
+	{
+		ProfilerGraphDraw(&gProfiler);
+	}
+	if (ConfigHandleGetBool(&sInterfaceShowTime))
 	{
 		WallClockDraw(&hud->clock);
 	}
@@ -37,6 +37,8 @@ typedef struct
 	int elapsed;
 	int framesDrawn;
 	int fps;
+	int pixelsPushed;
+	int pixelsPerFrame;	// average presented last second
 } FPSCounter;
 
 void FPSCounterInit(FPSCounter *counter);
@@ -27,58 +27,150 @@
 */
 #include "los.h"
 
+#include <string.h>
+
 #include "algorithms.h"
 #include "game_events.h"
 #include "net_util.h"
 
+static ConfigHandle sGameSightRange = CONFIG_HANDLE("Game.SightRange");
+
+
+#define BITS_PER_WORD 32
+static bool BitGet(const uint32_t *bits, const int i)
+{
+	return (bits[i / BITS_PER_WORD] >> (i % BITS_PER_WORD)) & 1;
+}
+static void BitSet(uint32_t *bits, const int i)
+{
+	bits[i / BITS_PER_WORD] |= 1u << (i % BITS_PER_WORD);
+}
+static void BitClear(uint32_t *bits, const int i)
+{
+	bits[i / BITS_PER_WORD] &= ~(1u << (i % BITS_PER_WORD));
+}
+static size_t BitsetSize(const Vec2i size)
+{
+	const int words = (size.x * size.y + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	return MAX(words, 1) * sizeof(uint32_t);
+}
+
+
+// A viewer's LOS, kept between frames
+typedef struct
+{
+	int UID;
+	Vec2i Tile;
+	int SightRange;
+	int OpacityVersion;
+	uint32_t *Visible;
+} LOSCacheEntry;
+
 
 void LOSInit(Map *map, const Vec2i size)
 {
-	CArrayInit(&map->LOS.LOS, sizeof(bool));
-	CArrayInit(&map->LOS.Explored, sizeof(bool));
-	Vec2i v;
-	for (v.y = 0; v.y < size.y; v.y++)
-	{
-		for (v.x = 0; v.x < size.x; v.x++)
-		{
-			const bool f = false;
-			CArrayPushBack(&map->LOS.LOS, &f);
-			CArrayPushBack(&map->LOS.Explored, &f);
-		}
-	}
+	map->LOS.Size = size;
+	CCALLOC(map->LOS.LOS, BitsetSize(size));
+	CCALLOC(map->LOS.Explored, BitsetSize(size));
+	map->LOS.OpacityVersion = 0;
+	CArrayInit(&map->LOS.Cache, sizeof(LOSCacheEntry));
 }
 void LOSTerminate(LineOfSight *los)
 {
-	CArrayTerminate(&los->LOS);
-	CArrayTerminate(&los->Explored);
+	CFREE(los->LOS);
+	los->LOS = NULL;
+	CFREE(los->Explored);
+	los->Explored = NULL;
+	CA_FOREACH(LOSCacheEntry, e, los->Cache)
+		CFREE(e->Visible);
+	CA_FOREACH_END()
+	CArrayTerminate(&los->Cache);
 }
 
 // Reset lines of sight by setting all cells to unseen
 void LOSReset(LineOfSight *los)
 {
-	CArrayFillZero(&los->LOS);
-	CArrayFillZero(&los->Explored);
+	memset(los->LOS, 0, BitsetSize(los->Size));
+	memset(los->Explored, 0, BitsetSize(los->Size));
+}
+
+void LOSInvalidate(LineOfSight *los)
+{
+	los->OpacityVersion++;
 }
+
 typedef struct
 {
 	Map *Map;
+	uint32_t *Visible;
 	Vec2i Center;
 	int SightRange2;
 	bool Explore;
 } LOSData;
 // Calculate LOS cells from a certain start position
 // Sight range based on config
-static void SetLOSVisible(Map *map, const Vec2i pos, const bool explore);
-static bool IsNextTileBlockedAndSetVisibility(void *data, Vec2i pos);
-static void SetObstructionVisible(
-	Map *map, const Vec2i pos, const bool explore);
+static void CalcFrom(
+	Map *map, uint32_t *visible, const Vec2i pos, const int sightRange,
+	const bool explore);
 void LOSCalcFrom(Map *map, const Vec2i pos, const bool explore)
 {
-	// Perform LOS by casting rays from the centre to the edges, terminating
-	// whenever an obstruction or out-of-range is reached.
+	CalcFrom(
+		map, map->LOS.LOS, pos, ConfigHandleGetInt(&sGameSightRange),
+		explore);
+}
+void LOSCalcFromCached(
+	Map *map, const int uid, const Vec2i pos, const bool explore)
+{
+	LOSCacheEntry *e = NULL;
+	CA_FOREACH(LOSCacheEntry, entry, map->LOS.Cache)
+		if (entry->UID == uid)
+		{
+			e = entry;
+			break;
+		}
+	CA_FOREACH_END()
+	if (e == NULL)
+	{
+		LOSCacheEntry entry;
+		memset(&entry, 0, sizeof entry);
+		entry.UID = uid;
+		entry.SightRange = -1;
+		CCALLOC(entry.Visible, BitsetSize(map->LOS.Size));
+		CArrayPushBack(&map->LOS.Cache, &entry);
+		e = CArrayGet(&map->LOS.Cache, (int)map->LOS.Cache.size - 1);
+	}
 
-	CArrayFillZero(&map->LOS.Explored);
+	// Recalculate if anything that affects the result has changed
+	// Note: tiles explored last time have been marked as visited by now,
+	// so there is nothing new to explore if nothing has changed
+	const int sightRange = ConfigHandleGetInt(&sGameSightRange);
+	if (!Vec2iEqual(e->Tile, pos) || e->SightRange != sightRange ||
+		e->OpacityVersion != map->LOS.OpacityVersion)
+	{
+		memset(e->Visible, 0, BitsetSize(map->LOS.Size));
+		CalcFrom(map, e->Visible, pos, sightRange, explore);
+		e->Tile = pos;
+		e->SightRange = sightRange;
+		e->OpacityVersion = map->LOS.OpacityVersion;
+	}
 
+	// Add to the union of all viewers' LOS
+	const size_t words = BitsetSize(map->LOS.Size) / sizeof(uint32_t);
+	for (size_t i = 0; i < words; i++)
+	{
+		map->LOS.LOS[i] |= e->Visible[i];
+	}
+}
+static void SetLOSVisible(
+	Map *map, uint32_t *visible, const Vec2i pos, const bool explore);
+static bool IsNextTileBlockedAndSetVisibility(void *data, Vec2i pos);
+static void SetObstructionVisible(
+	Map *map, uint32_t *visible, const Vec2i pos, const bool explore);
+static void AddExploreRuns(Map *map, const Vec2i boxMin, const Vec2i boxMax);
+static void CalcFrom(
+	Map *map, uint32_t *visible, const Vec2i pos, const int sightRangeIn,
+	const bool explore)
+{
 	// First mark center tile and all adjacent tiles as visible
 	// +-+-+-+
 	// |V|V|V|
@@ -92,35 +184,40 @@ void LOSCalcFrom(Map *map, const Vec2i pos, const bool explore)
 	{
 		for (end.y = pos.y - 1; end.y <= pos.y + 1; end.y++)
 		{
-			SetLOSVisible(map, end, explore);
+			SetLOSVisible(map, visible, end, explore);
 		}
 	}
 
-	const int sightRange = ConfigGetInt(&gConfig, "Game.SightRange");
-	if (sightRange == 0) return;
-
-	// Limit the perimeter to the sight range
-	const Vec2i origin = Vec2iNew(pos.x - sightRange, pos.y - sightRange);
-	const Vec2i perimSize = Vec2iScale(Vec2iMinus(pos, origin), 2);
+	// All tiles touched are within the sight box
+	const int sightRange = MAX(sightRangeIn, 1);
+	const Vec2i boxMin = Vec2iNew(
+		MAX(pos.x - sightRange, 0), MAX(pos.y - sightRange, 0));
+	const Vec2i boxMax = Vec2iNew(
+		MIN(pos.x + sightRange, map->Size.x - 1),
+		MIN(pos.y + sightRange, map->Size.y - 1));
 
+	// Cast rays from the centre to the edges of the sight box, terminating
+	// whenever an obstruction or out-of-range is reached
 	LOSData data;
 	data.Map = map;
+	data.Visible = visible;
 	data.Center = pos;
 	data.SightRange2 = sightRange * sightRange;
 	data.Explore = explore;
-
-	// Start from the top-left cell, and proceed clockwise around
-	end = origin;
 	HasClearLineData lineData;
 	lineData.IsBlocked = IsNextTileBlockedAndSetVisibility;
 	lineData.data = &data;
+	// Start from the top-left cell, and proceed clockwise around
+	const Vec2i origin = Vec2iNew(pos.x - sightRange, pos.y - sightRange);
+	const int perimSize = sightRange * 2;
+	end = origin;
 	// Top edge
-	for (; end.x < origin.x + perimSize.x; end.x++)
+	for (; end.x < origin.x + perimSize; end.x++)
 	{
 		HasClearLineXiaolinWu(pos, end, &lineData);
 	}
 	// right edge
-	for (; end.y < origin.y + perimSize.y; end.y++)
+	for (; end.y < origin.y + perimSize; end.y++)
 	{
 		HasClearLineXiaolinWu(pos, end, &lineData);
 	}
@@ -138,9 +235,10 @@ void LOSCalcFrom(Map *map, const Vec2i pos, const bool explore)
 	// Second pass: make any non-visible obstructions that are adjacent to
 	// visible non-obstructions visible too
 	// This is to ensure runs of walls stay visible
-	for (end.y = origin.y; end.y < origin.y + perimSize.y; end.y++)
+	const int sightRange2 = data.SightRange2;
+	for (end.y = boxMin.y; end.y <= boxMax.y; end.y++)
 	{
-		for (end.x = origin.x; end.x < origin.x + perimSize.x; end.x++)
+		for (end.x = boxMin.x; end.x <= boxMax.x; end.x++)
 		{
 			const Tile *tile = MapGetTile(map, end);
 			if (!tile || !(tile->flags & MAPTILE_NO_SEE))
@@ -148,49 +246,30 @@ void LOSCalcFrom(Map *map, const Vec2i pos, const bool explore)
 				continue;
 			}
 			// Check sight range
-			if (DistanceSquared(pos, end) >= data.SightRange2)
+			if (DistanceSquared(pos, end) >= sightRange2)
 			{
 				continue;
 			}
-			SetObstructionVisible(map, end, explore);
+			SetObstructionVisible(map, visible, end, explore);
 		}
 	}
 
-	// Find all the newly visible tiles and set events for them
-	GameEvent e = GameEventNew(GAME_EVENT_EXPLORE_TILES);
-	e.u.ExploreTiles.Runs_count = 0;
-	e.u.ExploreTiles.Runs[0].Run = 0;
-	bool run = false;
-	for (end.y = 0; end.y < map->Size.y; end.y++)
-	{
-		for (end.x = 0; end.x < map->Size.x; end.x++)
-		{
-			if (LOSAddRun(
-				&e.u.ExploreTiles, &run, end,
-				*((bool *)CArrayGet(&map->LOS.Explored, end.y * map->Size.x + end.x))))
-			{
-				GameEventsEnqueue(&gGameEvents, e);
-				e.u.ExploreTiles.Runs_count = 0;
-				e.u.ExploreTiles.Runs[0].Run = 0;
-				run = false;
-			}
-		}
-	}
-	if (e.u.ExploreTiles.Runs_count > 0)
+	if (explore)
 	{
-		GameEventsEnqueue(&gGameEvents, e);
+		AddExploreRuns(map, boxMin, boxMax);
 	}
-	CArrayFillZero(&map->LOS.Explored);
 }
-static void SetLOSVisible(Map *map, const Vec2i pos, const bool explore)
+static void SetLOSVisible(
+	Map *map, uint32_t *visible, const Vec2i pos, const bool explore)
 {
 	const Tile *t = MapGetTile(map, pos);
 	if (t == NULL) return;
-	*((bool *)CArrayGet(&map->LOS.LOS, pos.y * map->Size.x + pos.x)) = true;
+	const int i = pos.y * map->Size.x + pos.x;
+	BitSet(visible, i);
 	if (!t->isVisited && explore)
 	{
 		// Cache the newly explored tile
-		*((bool *)CArrayGet(&map->LOS.Explored, pos.y * map->Size.x + pos.x)) = true;
+		BitSet(map->LOS.Explored, i);
 	}
 }
 static bool IsNextTileBlockedAndSetVisibility(void *data, Vec2i pos)
@@ -201,32 +280,77 @@ static bool IsNextTileBlockedAndSetVisibility(void *data, Vec2i pos)
 	// Check map range
 	const Tile *t = MapGetTile(lData->Map, pos);
 	if (t == NULL) return true;
-	SetLOSVisible(lData->Map, pos, lData->Explore);
+	SetLOSVisible(lData->Map, lData->Visible, pos, lData->Explore);
 	// Check if this tile is an obstruction
 	return t->flags & MAPTILE_NO_SEE;
 }
-static bool IsTileVisibleNonObstruction(Map *map, const Vec2i pos);
+static bool IsTileVisibleNonObstruction(
+	Map *map, const uint32_t *visible, const Vec2i pos);
 static void SetObstructionVisible(
-	Map *map, const Vec2i pos, const bool explore)
+	Map *map, uint32_t *visible, const Vec2i pos, const bool explore)
 {
 	Vec2i d;
 	for (d.x = -1; d.x < 2; d.x++)
 	{
 		for (d.y = -1; d.y < 2; d.y++)
 		{
-			if (IsTileVisibleNonObstruction(map, Vec2iAdd(pos, d)))
+			if (IsTileVisibleNonObstruction(map, visible, Vec2iAdd(pos, d)))
 			{
-				SetLOSVisible(map, pos, explore);
+				SetLOSVisible(map, visible, pos, explore);
 				return;
 			}
 		}
 	}
 }
-static bool IsTileVisibleNonObstruction(Map *map, const Vec2i pos)
+static bool IsTileVisibleNonObstruction(
+	Map *map, const uint32_t *visible, const Vec2i pos)
 {
 	const Tile *t = MapGetTile(map, pos);
 	if (t == NULL) return false;
-	return !(t->flags & MAPTILE_NO_SEE) && LOSTileIsVisible(map, pos);
+	return !(t->flags & MAPTILE_NO_SEE) &&
+		BitGet(visible, pos.y * map->Size.x + pos.x);
+}
+static void EnqueueExploreTiles(const NExploreTiles *runs)
+{
+	GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_EXPLORE_TILES);
+	e->u.ExploreTiles = *runs;
+	GameEventsCommit(&gGameEvents, e);
+}
+// Find all the newly visible tiles and set events for them
+// Runs are split at the box edges, and the box is cleared for the next call
+static void AddExploreRuns(Map *map, const Vec2i boxMin, const Vec2i boxMax)
+{
+	NExploreTiles runs;
+	memset(&runs, 0, sizeof runs);
+	bool run = false;
+	Vec2i v;
+	for (v.y = boxMin.y; v.y <= boxMax.y; v.y++)
+	{
+		// Add one past the end of the row to terminate any run
+		for (v.x = boxMin.x; v.x <= boxMax.x + 1; v.x++)
+		{
+			const bool explored = v.x <= boxMax.x &&
+				BitGet(map->LOS.Explored, v.y * map->Size.x + v.x);
+			if (LOSAddRun(&runs, &run, v, explored))
+			{
+				EnqueueExploreTiles(&runs);
+				runs.Runs_count = 0;
+				runs.Runs[0].Run = 0;
+				run = false;
+			}
+		}
+	}
+	if (runs.Runs_count > 0)
+	{
+		EnqueueExploreTiles(&runs);
+	}
+	for (v.y = boxMin.y; v.y <= boxMax.y; v.y++)
+	{
+		for (v.x = boxMin.x; v.x <= boxMax.x; v.x++)
+		{
+			BitClear(map->LOS.Explored, v.y * map->Size.x + v.x);
+		}
+	}
 }
 
 bool LOSAddRun(
@@ -260,5 +384,5 @@ bool LOSAddRun(
 bool LOSTileIsVisible(Map *map, const Vec2i pos)
 {
 	if (MapGetTile(map, pos) == NULL) return false;
-	return *((bool *)CArrayGet(&map->LOS.LOS, pos.y * map->Size.x + pos.x));
+	return BitGet(map->LOS.LOS, pos.y * map->Size.x + pos.x);
 }
@@ -36,6 +36,12 @@ void LOSInit(Map *map, const Vec2i size);
 void LOSTerminate(LineOfSight *los);
 void LOSReset(LineOfSight *los);
 void LOSCalcFrom(Map *map, const Vec2i pos, const bool explore);
+// Add the LOS of a viewer, identified by a unique ID, reusing the last
+// result if the viewer hasn't changed tile and no tile's opacity has changed
+void LOSCalcFromCached(
+	Map *map, const int uid, const Vec2i pos, const bool explore);
+// Call when tiles change opacity
+void LOSInvalidate(LineOfSight *los);
 
 // Helper function for populating explore tiles runs
 // Returns true if the runs have filled
@@ -149,13 +149,22 @@ bool MapIsTileInExit(const Map *map, const TTileItem *ti)
 		ti->y / TILE_HEIGHT <= map->ExitEnd.y;
 }
 
-static Tile *MapGetTileOfItem(Map *map, TTileItem *t)
+static SpatialHashEntry TileItemToEntry(const TTileItem *t)
 {
-	Vec2i pos = Vec2iToTile(Vec2iNew(t->x, t->y));
-	return MapGetTile(map, pos);
+	SpatialHashEntry e;
+	e.Id.Id = t->id;
+	e.Id.Kind = t->kind;
+	e.Pos = Vec2iNew(t->x, t->y);
+	e.Size = t->size;
+	e.Flags = t->flags;
+	e.Team = COLLISIONTEAM_NONE;
+	if (t->kind == KIND_CHARACTER)
+	{
+		e.Team = CalcCollisionTeam(true, CArrayGet(&gActors, t->id));
+	}
+	return e;
 }
 
-static void AddItemToTile(TTileItem *t, Tile *tile);
 bool MapTryMoveTileItem(Map *map, TTileItem *t, Vec2i pos)
 {
 	// Check if we can move to new position
@@ -163,60 +172,70 @@ bool MapTryMoveTileItem(Map *map, TTileItem *t, Vec2i pos)
 	{
 		return false;
 	}
-	// When first initialised, position is -1
-	bool doRemove = t->x >= 0 && t->y >= 0;
-	Vec2i t1 = Vec2iToTile(Vec2iNew(t->x, t->y));
-	Vec2i t2 = Vec2iToTile(pos);
-	// If we'll be in the same tile, do nothing
-	if (Vec2iEqual(t1, t2) && doRemove)
-	{
-		t->x = pos.x;
-		t->y = pos.y;
-		return true;
-	}
-	// Moving; remove from old tile...
-	if (doRemove)
-	{
-		MapRemoveTileItem(map, t);
-	}
-	// ...move and add to new tile
 	t->x = pos.x;
 	t->y = pos.y;
-	AddItemToTile(t, MapGetTile(map, t2));
+	// Moves within the same cell are updated in place; otherwise this is
+	// an O(1) remove and add
+	const SpatialHashEntry e = TileItemToEntry(t);
+	SpatialHashUpdate(&map->Things, &e);
 	return true;
 }
-static void AddItemToTile(TTileItem *t, Tile *tile)
+
+void MapRemoveTileItem(Map *map, TTileItem *t)
 {
-	// Lazy initialisation
-	if (tile->things.elemSize == 0)
-	{
-		CArrayInit(&tile->things, sizeof(ThingId));
-	}
 	ThingId tid;
 	tid.Id = t->id;
 	tid.Kind = t->kind;
-	CASSERT(tid.Id >= 0, "invalid ThingId");
-	CASSERT(tid.Kind >= 0 && tid.Kind <= KIND_PICKUP, "unknown thing kind");
-	CArrayPushBack(&tile->things, &tid);
+	SpatialHashRemove(&map->Things, tid);
 }
 
-void MapRemoveTileItem(Map *map, TTileItem *t)
+void MapUpdateTileItem(Map *map, const TTileItem *t)
 {
-	if (!MapIsRealPosIn(map, Vec2iNew(t->x, t->y)))
+	ThingId tid;
+	tid.Id = t->id;
+	tid.Kind = t->kind;
+	SpatialHashEntry *e = SpatialHashGet(&map->Things, tid);
+	if (e != NULL)
 	{
-		return;
+		*e = TileItemToEntry(t);
 	}
-	Tile *tile = MapGetTileOfItem(map, t);
-	for (int i = 0; i < (int)tile->things.size; i++)
+}
+
+const CArray *MapGetTileThings(const Map *map, const Vec2i pos)
+{
+	return SpatialHashGetCellEntries(&map->Things, pos);
+}
+
+bool MapTileIsClear(Map *map, const Vec2i pos)
+{
+	// Check if tile is normal floor
+	const int normalFloorFlags =
+		MAPTILE_IS_NORMAL_FLOOR | MAPTILE_IS_DRAINAGE | MAPTILE_OFFSET_PIC;
+	const Tile *t = MapGetTile(map, pos);
+	if (t->flags & ~normalFloorFlags) return false;
+	// Check if tile has no things on it, excluding particles
+	const CArray *things = MapGetTileThings(map, pos);
+	if (things == NULL) return true;
+	for (int i = 0; i < (int)things->size; i++)
+	{
+		const SpatialHashEntry *e = CArrayGet(things, i);
+		if (e->Id.Kind != KIND_PARTICLE) return false;
+	}
+	return true;
+}
+bool MapTileHasCharacter(const Map *map, const Vec2i pos)
+{
+	const CArray *things = MapGetTileThings(map, pos);
+	if (things == NULL) return false;
+	for (int i = 0; i < (int)things->size; i++)
 	{
-		ThingId *tid = CArrayGet(&tile->things, i);
-		if (tid->Id == t->id && tid->Kind == t->kind)
+		const SpatialHashEntry *e = CArrayGet(things, i);
+		if (e->Id.Kind == KIND_CHARACTER)
 		{
-			CArrayDelete(&tile->things, i);
-			return;
+			return true;
 		}
 	}
-	CASSERT(false, "Did not find element to delete");
+	return false;
 }
 
 static Vec2i GuessCoords(Map *map)
@@ -377,10 +396,9 @@ bool MapTryPlaceOneObject(
 	}
 	Vec2i realPos = Vec2iCenterOfTile(v);
 	int tileFlags = 0;
-	Tile *t = MapGetTile(map, v);
 	unsigned short iMap = IMapGet(map, v);
 
-	const bool isEmpty = TileIsClear(t);
+	const bool isEmpty = MapTileIsClear(map, v);
 	if (isStrictMode && !MapObjectIsTileOKStrict(
 			mo, iMap, isEmpty,
 			IMapGet(map, Vec2iNew(v.x, v.y - 1)),
@@ -431,10 +449,10 @@ bool MapTryPlaceOneObject(
 
 void MapPlaceWreck(Map *map, const Vec2i v, const MapObject *mo)
 {
-	Tile *t = MapGetTile(map, v);
 	unsigned short iMap = IMapGet(map, v);
 	if (!MapObjectIsTileOK(
-		mo, iMap, TileIsClear(t), IMapGet(map, Vec2iNew(v.x, v.y - 1))))
+		mo, iMap, MapTileIsClear(map, v),
+		IMapGet(map, Vec2iNew(v.x, v.y - 1))))
 	{
 		return;
 	}
@@ -464,14 +482,14 @@ void MapPlaceCollectible(
 	const struct MissionOptions *mo, const int objective, const Vec2i realPos)
 {
 	const ObjectiveDef *o = CArrayGet(&mo->Objectives, objective);
-	GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
-	e.u.AddPickup.UID = PickupsGetNextUID();
-	strcpy(e.u.AddPickup.PickupClass, o->pickupClass->Name);
-	e.u.AddPickup.IsRandomSpawned = false;
-	e.u.AddPickup.SpawnerUID = -1;
-	e.u.AddPickup.TileItemFlags = ObjectiveToTileItem(objective);
-	e.u.AddPickup.Pos = Vec2i2Net(realPos);
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ADD_PICKUP);
+	e->u.AddPickup.UID = PickupsGetNextUID();
+	strcpy(e->u.AddPickup.PickupClass, o->pickupClass->Name);
+	e->u.AddPickup.IsRandomSpawned = false;
+	e->u.AddPickup.SpawnerUID = -1;
+	e->u.AddPickup.TileItemFlags = ObjectiveToTileItem(objective);
+	e->u.AddPickup.Pos = Vec2i2Net(realPos);
+	GameEventsCommit(&gGameEvents, e);
 }
 static int MapTryPlaceCollectible(
 	Map *map, const Mission *mission, const struct MissionOptions *mo,
@@ -550,16 +568,16 @@ void MapPlaceKey(
 	const int keyIndex)
 {
 	UNUSED(map);
-	GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
-	e.u.AddPickup.UID = PickupsGetNextUID();
+	GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ADD_PICKUP);
+	e->u.AddPickup.UID = PickupsGetNextUID();
 	strcpy(
-		e.u.AddPickup.PickupClass,
+		e->u.AddPickup.PickupClass,
 		KeyPickupClass(mo->keyStyle, keyIndex)->Name);
-	e.u.AddPickup.IsRandomSpawned = false;
-	e.u.AddPickup.SpawnerUID = -1;
-	e.u.AddPickup.TileItemFlags = 0;
-	e.u.AddPickup.Pos = Vec2i2Net(Vec2iCenterOfTile(pos));
-	GameEventsEnqueue(&gGameEvents, e);
+	e->u.AddPickup.IsRandomSpawned = false;
+	e->u.AddPickup.SpawnerUID = -1;
+	e->u.AddPickup.TileItemFlags = 0;
+	e->u.AddPickup.Pos = Vec2i2Net(Vec2iCenterOfTile(pos));
+	GameEventsCommit(&gGameEvents, e);
 }
 
 static void MapPlaceCard(Map *map, int keyIndex, int map_access)
@@ -567,16 +585,13 @@ static void MapPlaceCard(Map *map, int keyIndex, int map_access)
 	for (;;)
 	{
 		Vec2i v = GuessCoords(map);
-		Tile *t;
-		Tile *tBelow;
 		unsigned short iMap;
-		t = MapGetTile(map, v);
 		iMap = IMapGet(map, v);
-		tBelow = MapGetTile(map, Vec2iNew(v.x, v.y + 1));
-		if (TileIsClear(t) &&
+		const Vec2i vBelow = Vec2iNew(v.x, v.y + 1);
+		if (MapTileIsClear(map, v) &&
 			(iMap & 0xF00) == map_access &&
 			(iMap & MAP_MASKACCESS) == MAP_ROOM &&
-			TileIsClear(tBelow))
+			MapIsTileIn(map, vBelow) && MapTileIsClear(map, vBelow))
 		{
 			MapPlaceKey(map, &gMission, v, keyIndex);
 			return;
@@ -669,6 +684,7 @@ void MapTerminate(Map *map)
 	CArrayTerminate(&map->Tiles);
 	CArrayTerminate(&map->iMap);
 	LOSTerminate(&map->LOS);
+	SpatialHashTerminate(&map->Things);
 	PathCacheTerminate(&gPathCache);
 }
 void MapLoad(
@@ -683,6 +699,10 @@ void MapLoad(
 	const Mission *mission = mo->missionData;
 	map->Size = mission->Size;
 	LOSInit(map, map->Size);
+	SpatialHashInit(
+		&map->Things,
+		Vec2iNew(map->Size.x * TILE_WIDTH, map->Size.y * TILE_HEIGHT),
+		Vec2iNew(TILE_WIDTH, TILE_HEIGHT));
 	CArrayInit(&map->triggers, sizeof(Trigger *));
 	PathCacheInit(&gPathCache, map);
 
@@ -876,13 +896,15 @@ bool MapIsTileAreaClear(Map *map, const Vec2i fullPos, const Vec2i size)
 			{
 				continue;
 			}
-			const CArray *tileThings = &MapGetTile(map, dtv)->things;
+			const CArray *tileThings = MapGetTileThings(map, dtv);
+			if (tileThings == NULL)
+			{
+				continue;
+			}
 			for (int i = 0; i < (int)tileThings->size; i++)
 			{
-				const TTileItem *ti =
-					ThingIdGetTileItem(CArrayGet(tileThings, i));
-				if (AreasCollide(
-						realPos, Vec2iNew(ti->x, ti->y), size, ti->size))
+				const SpatialHashEntry *e = CArrayGet(tileThings, i);
+				if (AreasCollide(realPos, e->Pos, size, e->Size))
 				{
 					return false;
 				}
@@ -49,11 +49,13 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "campaigns.h"
 #include "map_object.h"
 #include "mission.h"
 #include "pic.h"
+#include "spatial_hash.h"
 #include "tile.h"
 #include "triggers.h"
 #include "vector.h"
@@ -84,11 +86,15 @@ IMapType StrIMapType(const char *s);
 
 typedef struct
 {
-	// Array of bools to set lines of sight
-	CArray LOS;	// of bool
-
-	// Array of bools for tracking new tiles in line of sight, for delayed messaging
-	CArray Explored; // of bool
+	Vec2i Size;
+	// Bitsets, one bit per tile in row-major order
+	// Tiles in line of sight
+	uint32_t *LOS;
+	// New tiles in line of sight, for delayed messaging
+	uint32_t *Explored;
+	// Bumped whenever a tile's opacity changes, invalidating the cache
+	int OpacityVersion;
+	CArray Cache;	// of per-viewer LOS, see LOSCalcFromCached
 } LineOfSight;
 
 typedef struct
@@ -101,6 +107,9 @@ typedef struct
 
 	LineOfSight LOS;
 
+	// Broadphase of all tile items on the map, one cell per tile
+	SpatialHash Things;
+
 	CArray triggers;	// of Trigger *; owner
 	int triggerId;
 
@@ -129,6 +138,14 @@ int MapGetDoorKeycardFlag(Map *map, Vec2i pos);
 // Return false if cannot move to new position
 bool MapTryMoveTileItem(Map *map, TTileItem *t, Vec2i pos);
 void MapRemoveTileItem(Map *map, TTileItem *t);
+// Refresh the broadphase after changing a tile item's flags or size,
+// or its owner's collision team
+void MapUpdateTileItem(Map *map, const TTileItem *t);
+// Get the things on a tile, of SpatialHashEntry; NULL if none
+const CArray *MapGetTileThings(const Map *map, const Vec2i pos);
+// Tile is normal floor with nothing but particles on it
+bool MapTileIsClear(Map *map, const Vec2i pos);
+bool MapTileHasCharacter(const Map *map, const Vec2i pos);
 
 void MapTerminate(Map *map);
 void MapLoad(
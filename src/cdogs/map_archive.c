@@ -90,14 +90,14 @@ int MapNewLoadArchive(const char *filename, CampaignSetting *c)
 
 
 	// Unload previous custom data
-	SoundClear(&gSoundDevice.customSounds);
+	SoundClearCustom(&gSoundDevice);
 	PicManagerClearCustom(&gPicManager);
-	ParticleClassesClear(&gParticleClasses.CustomClasses);
+	ParticleClassesClearCustom(&gParticleClasses);
 	AmmoClassesClear(&gAmmo.CustomAmmo);
-	BulletClassesClear(&gBulletClasses.CustomClasses);
-	WeaponClassesClear(&gGunDescriptions.CustomGuns);
-	PickupClassesClear(&gPickupClasses.CustomClasses);
-	MapObjectsClear(&gMapObjects.CustomClasses);
+	BulletClassesClearCustom(&gBulletClasses);
+	WeaponClassesClearCustom(&gGunDescriptions);
+	PickupClassesClearCustom(&gPickupClasses);
+	MapObjectsClearCustom(&gMapObjects);
 
 	// Load any custom data
 	LoadArchiveSounds(&gSoundDevice, filename, "sounds");
@@ -97,21 +97,16 @@ MapObject *StrMapObject(const char *s)
 	{
 		return NULL;
 	}
-	for (int i = 0; i < (int)gMapObjects.CustomClasses.size; i++)
+	// Custom classes shadow built-in ones
+	MapObject *c = NameIndexGet(
+		&gMapObjects.CustomClassIndex, &gMapObjects.CustomClasses, s);
+	if (c == NULL)
 	{
-		MapObject *c = CArrayGet(&gMapObjects.CustomClasses, i);
-		if (strcmp(s, c->Name) == 0)
-		{
-			return c;
-		}
+		c = NameIndexGet(&gMapObjects.ClassIndex, &gMapObjects.Classes, s);
 	}
-	for (int i = 0; i < (int)gMapObjects.Classes.size; i++)
+	if (c != NULL)
 	{
-		MapObject *c = CArrayGet(&gMapObjects.Classes, i);
-		if (strcmp(s, c->Name) == 0)
-		{
-			return c;
-		}
+		return c;
 	}
 	return NULL;
 }
@@ -148,24 +143,28 @@ MapObject *IndexMapObject(const int i)
 	}
 	return CArrayGet(&gMapObjects.CustomClasses, i - gMapObjects.Classes.size);
 }
+// Index of an element if it is in the array, otherwise -1
+static int IndexInArray(const CArray *a, const MapObject *mo)
+{
+	const MapObject *first = a->data;
+	if (a->size == 0 || mo < first || mo >= first + a->size)
+	{
+		return -1;
+	}
+	return (int)(mo - first);
+}
 int MapObjectIndex(const MapObject *mo)
 {
-	int idx = 0;
-	for (int i = 0; i < (int)gMapObjects.Classes.size; i++, idx++)
+	// Classes are stored by value, so this is just pointer arithmetic
+	int idx = IndexInArray(&gMapObjects.Classes, mo);
+	if (idx >= 0)
 	{
-		const MapObject *c = CArrayGet(&gMapObjects.Classes, i);
-		if (c == mo)
-		{
-			return idx;
-		}
+		return idx;
 	}
-	for (int i = 0; i < (int)gMapObjects.CustomClasses.size; i++, idx++)
+	idx = IndexInArray(&gMapObjects.CustomClasses, mo);
+	if (idx >= 0)
 	{
-		const MapObject *c = CArrayGet(&gMapObjects.CustomClasses, i);
-		if (c == mo)
-		{
-			return idx;
-		}
+		return (int)gMapObjects.Classes.size + idx;
 	}
 	CASSERT(false, "cannot find map object");
 	return -1;
@@ -179,10 +178,16 @@ MapObject *RandomBloodMapObject(const MapObjects *mo)
 
 #define VERSION 1
 
+static const char *MapObjectGetName(const void *mo)
+{
+	return ((const MapObject *)mo)->Name;
+}
 void MapObjectsInit(MapObjects *classes, const char *filename)
 {
 	CArrayInit(&classes->Classes, sizeof(MapObject));
 	CArrayInit(&classes->CustomClasses, sizeof(MapObject));
+	NameIndexInit(&classes->ClassIndex, MapObjectGetName);
+	NameIndexInit(&classes->CustomClassIndex, MapObjectGetName);
 	CArrayInit(&classes->Destructibles, sizeof(char *));
 	CArrayInit(&classes->Bloods, sizeof(char *));
 
@@ -398,12 +403,19 @@ void MapObjectsClear(CArray *classes)
 	}
 	CArrayClear(classes);
 }
+void MapObjectsClearCustom(MapObjects *classes)
+{
+	MapObjectsClear(&classes->CustomClasses);
+	NameIndexClear(&classes->CustomClassIndex);
+}
 void MapObjectsTerminate(MapObjects *classes)
 {
 	MapObjectsClear(&classes->Classes);
 	CArrayTerminate(&classes->Classes);
 	MapObjectsClear(&classes->CustomClasses);
 	CArrayTerminate(&classes->CustomClasses);
+	NameIndexTerminate(&classes->ClassIndex);
+	NameIndexTerminate(&classes->CustomClassIndex);
 	for (int i = 0; i < (int)classes->Destructibles.size; i++)
 	{
 		char **s = CArrayGet(&classes->Destructibles, i);
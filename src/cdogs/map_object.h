@@ -50,6 +50,7 @@
 
 #include <json/json.h>
 #include "ammo.h"
+#include "name_index.h"
 #include "pic_manager.h"
 #include "pickup_class.h"
 
@@ -104,6 +105,8 @@ typedef struct
 {
 	CArray Classes;	// of MapObject
 	CArray CustomClasses;	// of MapObject
+	NameIndex ClassIndex;
+	NameIndex CustomClassIndex;
 	// Names of special types of map objects; for editor support
 	// Reset on load
 	CArray Destructibles;	// of char *
@@ -117,7 +120,7 @@ MapObject *StrMapObject(const char *s);
 MapObject *IntMapObject(const int m);
 // Get map object by index; used by editor
 MapObject *IndexMapObject(const int i);
-// Get index of map object; used by editor
+// Get index of map object; used by editor and net snapshots
 int MapObjectIndex(const MapObject *mo);
 MapObject *RandomBloodMapObject(const MapObjects *mo);
 
@@ -126,6 +129,7 @@ void MapObjectsLoadJSON(CArray *classes, json_t *root);
 void MapObjectsLoadAmmoAndGunSpawners(
 	MapObjects *classes, const AmmoClasses *ammo, const GunClasses *guns);
 void MapObjectsClear(CArray *classes);
+void MapObjectsClearCustom(MapObjects *classes);
 void MapObjectsTerminate(MapObjects *classes);
 int MapObjectsCount(const MapObjects *classes);
 
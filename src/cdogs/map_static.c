@@ -133,9 +133,9 @@ static void AddCharacters(const CArray *characters)
 			const Vec2i fullPos = Vec2iReal2Full(Vec2iCenterOfTile(*pos));
 			aa.FullPos.x = fullPos.x;
 			aa.FullPos.y = fullPos.y;
-			GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD);
-			e.u.ActorAdd = aa;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_ADD);
+			e->u.ActorAdd = aa;
+			GameEventsCommit(&gGameEvents, e);
 
 			// Process the events that actually place the players
 			HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
@@ -170,9 +170,10 @@ static void AddObjectives(
 					CArrayGet(&gCampaign.Setting.characters.OtherChars, aa.CharId);
 				aa.Health = CharacterGetStartingHealth(c, true);
 				aa.FullPos = Vec2i2Net(fullPos);
-				GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD);
-				e.u.ActorAdd = aa;
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEvent *e =
+					GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_ADD);
+				e->u.ActorAdd = aa;
+				GameEventsCommit(&gGameEvents, e);
 			}
 			break;
 			case OBJECTIVE_COLLECT:
@@ -195,9 +196,10 @@ static void AddObjectives(
 					CArrayGet(&gCampaign.Setting.characters.OtherChars, aa.CharId);
 				aa.Health = CharacterGetStartingHealth(c, true);
 				aa.FullPos = Vec2i2Net(fullPos);
-				GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD);
-				e.u.ActorAdd = aa;
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEvent *e =
+					GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_ADD);
+				e->u.ActorAdd = aa;
+				GameEventsCommit(&gGameEvents, e);
 			}
 			break;
 			default:
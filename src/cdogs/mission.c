@@ -333,9 +333,10 @@ void MissionSetMessageIfComplete(struct MissionOptions *options)
 {
 	if (!gCampaign.IsClient && CanCompleteMission(options))
 	{
-		GameEvent msg = GameEventNew(GAME_EVENT_MISSION_COMPLETE);
-		msg.u.MissionComplete.ShowMsg = MissionHasRequiredObjectives(options);
-		GameEventsEnqueue(&gGameEvents, msg);
+		GameEvent *msg =
+			GameEventsAdd(&gGameEvents, GAME_EVENT_MISSION_COMPLETE);
+		msg->u.MissionComplete.ShowMsg = MissionHasRequiredObjectives(options);
+		GameEventsCommit(&gGameEvents, msg);
 	}
 }
 bool MissionHasRequiredObjectives(const struct MissionOptions *mo)
@@ -362,10 +363,10 @@ void UpdateMissionObjective(
 	}
 	if (!gCampaign.IsClient)
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_OBJECTIVE_UPDATE);
-		e.u.ObjectiveUpdate.ObjectiveId = idx;
-		e.u.ObjectiveUpdate.Count = 1;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_OBJECTIVE_UPDATE);
+		e->u.ObjectiveUpdate.ObjectiveId = idx;
+		e->u.ObjectiveUpdate.Count = 1;
+		GameEventsCommit(&gGameEvents, e);
 	}
 }
 
@@ -435,14 +436,13 @@ bool IsMissionComplete(const struct MissionOptions *options)
 	if (rescuesRequired > 0)
 	{
 		int prisonersRescued = 0;
-		CA_FOREACH(const TActor, a, gActors)
-			if (!a->isInUse) continue;
+		SLOT_POOL_FOREACH(const TActor, a, gActorSlots)
 			if (CharacterIsPrisoner(&gCampaign.Setting.characters, ActorGetCharacter(a)) &&
 				MapIsTileInExit(&gMap, &a->tileItem))
 			{
 				prisonersRescued++;
 			}
-		CA_FOREACH_END()
+		SLOT_POOL_FOREACH_END()
 		if (prisonersRescued < rescuesRequired)
 		{
 			return 0;
@@ -54,6 +54,9 @@
 #include "blit.h"
 #include "config.h"
 
+static ConfigHandle sGraphicsScaleFactor =
+	CONFIG_HANDLE("Graphics.ScaleFactor");
+
 #define MOUSE_REPEAT_TICKS 150
 #define MOUSE_MOVE_DEAD_ZONE 12
 #define TRAIL_NUM_DOTS 4
@@ -83,7 +86,7 @@ void MousePrePoll(Mouse *mouse)
 	mouse->previousPos = mouse->currentPos;
 	SDL_GetMouseState(&mouse->currentPos.x, &mouse->currentPos.y);
 	mouse->currentPos = Vec2iScaleDiv(
-		mouse->currentPos, ConfigGetInt(&gConfig, "Graphics.ScaleFactor"));
+		mouse->currentPos, ConfigHandleGetInt(&sGraphicsScaleFactor));
 }
 
 
@@ -0,0 +1,158 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "name_index.h"
+
+#include <string.h>
+
+#include "utils.h"
+
+#define NAME_INDEX_INITIAL_SIZE 64
+// Grow when more than 1/2 full; lookups are far more common than inserts
+#define NAME_INDEX_IS_FULL(_count, _size) ((_count) * 2 >= (int)(_size))
+
+
+static void Rehash(NameIndex *ni, const int size);
+
+void NameIndexInit(NameIndex *ni, NameIndexGetNameFunc getName)
+{
+	CArrayInit(&ni->Entries, sizeof(NameIndexEntry));
+	ni->GetName = getName;
+	ni->Count = 0;
+}
+void NameIndexTerminate(NameIndex *ni)
+{
+	CArrayTerminate(&ni->Entries);
+	ni->Count = 0;
+}
+void NameIndexClear(NameIndex *ni)
+{
+	for (int i = 0; i < (int)ni->Entries.size; i++)
+	{
+		NameIndexEntry *e = CArrayGet(&ni->Entries, i);
+		e->Index = -1;
+	}
+	ni->Count = 0;
+}
+
+static unsigned Hash(const char *name)
+{
+	// FNV-1a
+	unsigned h = 2166136261u;
+	for (const char *c = name; *c; c++)
+	{
+		h ^= (unsigned char)*c;
+		h *= 16777619u;
+	}
+	return h;
+}
+// Find the entry for name, or the empty entry where it would go
+static NameIndexEntry *FindEntry(
+	const NameIndex *ni, const CArray *items,
+	const char *name, const unsigned hash)
+{
+	const int mask = (int)ni->Entries.size - 1;
+	for (int i = (int)hash & mask;; i = (i + 1) & mask)
+	{
+		NameIndexEntry *e = CArrayGet(&ni->Entries, i);
+		if (e->Index == -1)
+		{
+			return e;
+		}
+		if (e->Hash == hash &&
+			strcmp(ni->GetName(CArrayGet(items, e->Index)), name) == 0)
+		{
+			return e;
+		}
+	}
+}
+static void Sync(NameIndex *ni, const CArray *items)
+{
+	if ((int)items->size < ni->Count)
+	{
+		// Items have been removed; start again
+		NameIndexClear(ni);
+	}
+	if (ni->Entries.size == 0 && items->size > 0)
+	{
+		Rehash(ni, NAME_INDEX_INITIAL_SIZE);
+	}
+	for (; ni->Count < (int)items->size; ni->Count++)
+	{
+		const char *name = ni->GetName(CArrayGet(items, ni->Count));
+		const unsigned hash = Hash(name);
+		NameIndexEntry *e = FindEntry(ni, items, name, hash);
+		// Keep the first item for duplicate names
+		if (e->Index != -1) continue;
+		e->Hash = hash;
+		e->Index = ni->Count;
+		if (NAME_INDEX_IS_FULL(ni->Count + 1, ni->Entries.size))
+		{
+			Rehash(ni, (int)ni->Entries.size * 2);
+		}
+	}
+}
+
+int NameIndexFind(NameIndex *ni, const CArray *items, const char *name)
+{
+	if (name == NULL) return -1;
+	Sync(ni, items);
+	if (ni->Count == 0) return -1;
+	return FindEntry(ni, items, name, Hash(name))->Index;
+}
+void *NameIndexGet(NameIndex *ni, const CArray *items, const char *name)
+{
+	const int idx = NameIndexFind(ni, items, name);
+	return idx >= 0 ? CArrayGet(items, idx) : NULL;
+}
+
+static void Rehash(NameIndex *ni, const int size)
+{
+	CArray old = ni->Entries;
+	CArrayInit(&ni->Entries, sizeof(NameIndexEntry));
+	NameIndexEntry empty;
+	empty.Hash = 0;
+	empty.Index = -1;
+	CArrayResize(&ni->Entries, size, &empty);
+	const int mask = size - 1;
+	for (int i = 0; i < (int)old.size; i++)
+	{
+		const NameIndexEntry *e = CArrayGet(&old, i);
+		if (e->Index == -1) continue;
+		// Entries are unique so just find the first empty slot
+		for (int j = (int)e->Hash & mask;; j = (j + 1) & mask)
+		{
+			NameIndexEntry *dst = CArrayGet(&ni->Entries, j);
+			if (dst->Index == -1)
+			{
+				*dst = *e;
+				break;
+			}
+		}
+	}
+	CArrayTerminate(&old);
+}
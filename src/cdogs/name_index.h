@@ -0,0 +1,61 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include "c_array.h"
+
+// Hash index from item name to array index, for registries of named items
+// (pics, sounds, guns, bullets etc.) that would otherwise be scanned with
+// strcmp on every lookup.
+// The index does not own the names; it caches each name's hash plus the
+// array index, and compares against the item itself on lookup.
+// Items appended to the array are indexed lazily on the next lookup, so
+// loaders don't need to know about the index. Anything that removes,
+// reorders or renames items must call NameIndexClear.
+// Duplicate names resolve to the first item, same as a linear scan.
+typedef const char *(*NameIndexGetNameFunc)(const void *);
+typedef struct
+{
+	unsigned Hash;
+	int Index;
+} NameIndexEntry;
+typedef struct
+{
+	CArray Entries;	// of NameIndexEntry; size is always a power of 2
+	NameIndexGetNameFunc GetName;
+	int Count;	// number of leading items that have been indexed
+} NameIndex;
+
+void NameIndexInit(NameIndex *ni, NameIndexGetNameFunc getName);
+void NameIndexTerminate(NameIndex *ni);
+void NameIndexClear(NameIndex *ni);
+
+// Find the index of the first item in items with this name, or -1
+int NameIndexFind(NameIndex *ni, const CArray *items, const char *name);
+// As above but returns the item, or NULL
+void *NameIndexGet(NameIndex *ni, const CArray *items, const char *name);
@@ -0,0 +1,202 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "net_batch.h"
+
+#include <string.h>
+
+#include "utils.h"
+
+
+void NetBatchInit(NetBatch *b)
+{
+	CArrayInit(&b->Data, sizeof(uint8_t));
+	CArrayReserve(&b->Data, NET_BATCH_FRAME_SIZE);
+	b->Msgs = 0;
+}
+void NetBatchTerminate(NetBatch *b)
+{
+	CArrayTerminate(&b->Data);
+	b->Msgs = 0;
+}
+
+bool NetBatchIsEmpty(const NetBatch *b)
+{
+	return b->Msgs == 0;
+}
+
+static size_t VarintSize(uint32_t v)
+{
+	size_t size = 1;
+	while (v >= 0x80)
+	{
+		v >>= 7;
+		size++;
+	}
+	return size;
+}
+static size_t RecordSize(const uint32_t msg, const size_t len)
+{
+	return VarintSize(msg) + VarintSize((uint32_t)len) + len;
+}
+
+bool NetBatchHasRoom(const NetBatch *b, const uint32_t msg, const size_t len)
+{
+	return NetBatchIsEmpty(b) ||
+		b->Data.size + RecordSize(msg, len) <= NET_BATCH_FRAME_SIZE;
+}
+
+uint8_t *NetBatchWriteVarint(uint8_t *p, uint32_t v)
+{
+	while (v >= 0x80)
+	{
+		*p++ = (uint8_t)(v | 0x80);
+		v >>= 7;
+	}
+	*p++ = (uint8_t)v;
+	return p;
+}
+void NetBatchAdd(
+	NetBatch *b, const uint32_t msg, const uint8_t *payload, const size_t len)
+{
+	const size_t start = b->Data.size;
+	CArrayResize(&b->Data, start + RecordSize(msg, len), NULL);
+	uint8_t *p = (uint8_t *)b->Data.data + start;
+	p = NetBatchWriteVarint(p, msg);
+	p = NetBatchWriteVarint(p, (uint32_t)len);
+	if (len > 0)
+	{
+		memcpy(p, payload, len);
+	}
+	b->Msgs++;
+}
+
+void NetBatchClear(NetBatch *b)
+{
+	CArrayClear(&b->Data);
+	b->Msgs = 0;
+}
+
+
+// Key for the latest index; message types fit in the low bits
+#define LATEST_MSG_BITS 6
+void NetLatestInit(NetLatest *l)
+{
+	CArrayInit(&l->Msgs, sizeof(NetLatestMsg));
+	UIDMapInit(&l->Index);
+}
+void NetLatestTerminate(NetLatest *l)
+{
+	CArrayTerminate(&l->Msgs);
+	UIDMapTerminate(&l->Index);
+}
+
+void NetLatestSet(
+	NetLatest *l, const uint32_t msg, const uint32_t uid,
+	const uint8_t *payload, const size_t len)
+{
+	CASSERT(msg < (1 << LATEST_MSG_BITS), "message type too big for key");
+	if (len > NET_LATEST_MAX_SIZE)
+	{
+		CASSERT(false, "latest message too big");
+		return;
+	}
+	const int key = (int)((uid << LATEST_MSG_BITS) | msg);
+	const int idx = UIDMapGet(&l->Index, key);
+	NetLatestMsg *m;
+	if (idx >= 0)
+	{
+		m = CArrayGet(&l->Msgs, idx);
+	}
+	else
+	{
+		UIDMapSet(&l->Index, key, (int)l->Msgs.size);
+		CArrayResize(&l->Msgs, l->Msgs.size + 1, NULL);
+		m = CArrayGet(&l->Msgs, (int)l->Msgs.size - 1);
+	}
+	m->Msg = msg;
+	m->Len = (uint32_t)len;
+	memcpy(m->Data, payload, len);
+}
+
+void NetLatestClear(NetLatest *l)
+{
+	if (l->Msgs.size == 0)
+	{
+		return;
+	}
+	CArrayClear(&l->Msgs);
+	UIDMapClear(&l->Index);
+}
+
+
+NetBatchReader NetBatchReaderNew(uint8_t *data, const size_t len)
+{
+	NetBatchReader r;
+	r.Cur = data;
+	r.End = data + len;
+	return r;
+}
+
+bool NetBatchReadVarint(NetBatchReader *r, uint32_t *v)
+{
+	*v = 0;
+	for (int i = 0; i < NET_BATCH_VARINT_MAX; i++)
+	{
+		if (r->Cur == r->End)
+		{
+			return false;
+		}
+		const uint8_t byte = *r->Cur++;
+		*v |= (uint32_t)(byte & 0x7F) << (7 * i);
+		if (!(byte & 0x80))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+bool NetBatchNext(
+	NetBatchReader *r, uint32_t *msg, uint8_t **payload, size_t *len)
+{
+	if (r->Cur == r->End)
+	{
+		return false;
+	}
+	uint8_t *start = r->Cur;
+	uint32_t len32;
+	if (!NetBatchReadVarint(r, msg) || !NetBatchReadVarint(r, &len32) ||
+		len32 > (size_t)(r->End - r->Cur))
+	{
+		r->Cur = start;
+		return false;
+	}
+	*payload = r->Cur;
+	*len = len32;
+	r->Cur += len32;
+	return true;
+}
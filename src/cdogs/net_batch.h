@@ -0,0 +1,116 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "c_array.h"
+#include "proto/msg.pb.h"
+#include "uid_map.h"
+#include "utils.h"
+
+// Outgoing messages are coalesced into frames, each sent as one packet.
+// A frame is a run of records, each:
+// - varint message type
+// - varint payload length
+// - payload (nanopb-encoded message)
+// Frames are kept under this size so that ENet doesn't fragment them;
+// a record too big for an empty frame gets a frame to itself.
+#define NET_BATCH_FRAME_SIZE 1200
+// Longest a varint can be for 32-bit values
+#define NET_BATCH_VARINT_MAX 5
+
+typedef struct
+{
+	CArray Data;	// of uint8_t; the frame being filled
+	int Msgs;		// records in the frame
+} NetBatch;
+
+// Counters for what went over the wire
+typedef struct
+{
+	int Packets;
+	int Msgs;
+	size_t Bytes;
+} NetStats;
+
+void NetBatchInit(NetBatch *b);
+void NetBatchTerminate(NetBatch *b);
+
+bool NetBatchIsEmpty(const NetBatch *b);
+// Whether a record fits in the current frame; an empty frame always has room
+bool NetBatchHasRoom(const NetBatch *b, const uint32_t msg, const size_t len);
+void NetBatchAdd(
+	NetBatch *b, const uint32_t msg, const uint8_t *payload, const size_t len);
+void NetBatchClear(NetBatch *b);
+
+// Messages that are only worth sending as the latest for their entity,
+// like positions; a newer one replaces one that hasn't been sent yet
+// These are sent unreliable, so their payloads are kept small; this fits
+// the largest of them (snapshot acks are a varint)
+#define NET_LATEST_MAX_SIZE\
+	MAX(MAX(NActorMove_size, NActorDir_size),\
+		MAX(NActorState_size, MAX(NGunState_size, NET_BATCH_VARINT_MAX)))
+typedef struct
+{
+	uint32_t Msg;
+	uint32_t Len;
+	uint8_t Data[NET_LATEST_MAX_SIZE];
+} NetLatestMsg;
+typedef struct
+{
+	CArray Msgs;	// of NetLatestMsg, in the order first set
+	UIDMap Index;	// from message type and entity to Msgs index
+} NetLatest;
+
+void NetLatestInit(NetLatest *l);
+void NetLatestTerminate(NetLatest *l);
+// Set the latest message of a type for an entity
+void NetLatestSet(
+	NetLatest *l, const uint32_t msg, const uint32_t uid,
+	const uint8_t *payload, const size_t len);
+void NetLatestClear(NetLatest *l);
+
+// Walks the records of a received frame
+typedef struct
+{
+	uint8_t *Cur;
+	uint8_t *End;
+} NetBatchReader;
+
+NetBatchReader NetBatchReaderNew(uint8_t *data, const size_t len);
+// Varints as used in frames, for payloads that are encoded by hand
+// Write to a buffer of at least NET_BATCH_VARINT_MAX; returns the end
+uint8_t *NetBatchWriteVarint(uint8_t *p, uint32_t v);
+bool NetBatchReadVarint(NetBatchReader *r, uint32_t *v);
+// Get the next record; false if there are no more, or the frame is
+// malformed, in which case the reader stops short of the end
+bool NetBatchNext(
+	NetBatchReader *r, uint32_t *msg, uint8_t **payload, size_t *len);
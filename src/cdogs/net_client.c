@@ -53,7 +53,11 @@ void NetClientInit(NetClient *n)
 {
 	memset(n, 0, sizeof *n);
 	n->ClientId = -1;	// -1 is unset
-	n->client = enet_host_create(NULL, 1, 2,
+	NetOutboxInit(&n->Out);
+	NetSnapshotHistoryInit(&n->Snapshots);
+	NetSnapshotInit(&n->Snapshot);
+	CArrayInit(&n->JoinSnapshot, sizeof(uint8_t));
+	n->client = enet_host_create(NULL, 1, NET_CHANNELS,
 		57600 / 8 /* 56K modem with 56 Kbps downstream bandwidth */,
 		14400 / 8 /* 56K modem with 14 Kbps upstream bandwidth */);
 	if (n->client == NULL)
@@ -67,6 +71,15 @@ void NetClientTerminate(NetClient *n)
 	n->peer = NULL;
 	enet_host_destroy(n->client);
 	n->client = NULL;
+	LOG(LM_NET, LL_INFO,
+		"sent %d msgs in %d packets (%u bytes), "
+		"recv %d msgs in %d packets (%u bytes)",
+		n->Sent.Msgs, n->Sent.Packets, (unsigned)n->Sent.Bytes,
+		n->Recv.Msgs, n->Recv.Packets, (unsigned)n->Recv.Bytes);
+	NetOutboxTerminate(&n->Out);
+	NetSnapshotHistoryTerminate(&n->Snapshots);
+	NetSnapshotTerminate(&n->Snapshot);
+	CArrayTerminate(&n->JoinSnapshot);
 }
 
 void NetClientFindLANServers(NetClient *n)
@@ -88,7 +101,7 @@ void NetClientFindLANServers(NetClient *n)
 	n->FoundLANServer = false;
 
 	ENetAddress addr = NetClientLANAddress();
-	n->peer = enet_host_connect(n->client, &addr, 2, 0);
+	n->peer = enet_host_connect(n->client, &addr, NET_CHANNELS, 0);
 	if (n->peer == NULL)
 	{
 		LOG(LM_NET, LL_INFO, "failed to connect to LAN servers");
@@ -102,7 +115,7 @@ void NetClientConnect(NetClient *n, const ENetAddress addr)
 	NetClientDisconnect(n);
 
 	/* Initiate the connection, allocating the two channels 0 and 1. */
-	n->peer = enet_host_connect(n->client, &addr, 2, 0);
+	n->peer = enet_host_connect(n->client, &addr, NET_CHANNELS, 0);
 	if (n->peer == NULL)
 	{
 		LOG(LM_NET, LL_WARN, "No server connection found");
@@ -130,6 +143,7 @@ void NetClientConnect(NetClient *n, const ENetAddress addr)
 
 	// Tell the server that this is a proper connection request
 	NetClientSendMsg(n, GAME_EVENT_CLIENT_CONNECT, NULL);
+	NetClientFlush(n);
 
 	return;
 
@@ -144,17 +158,29 @@ void NetClientDisconnect(NetClient *n)
 		enet_peer_disconnect_now(n->peer, 0);
 		n->peer = NULL;
 	}
+	// Drop anything unsent; it was for the old connection
+	NetOutboxClear(&n->Out);
+	NetSnapshotHistoryClear(&n->Snapshots);
+	n->SnapshotSeq = 0;
+	CArrayClear(&n->JoinSnapshot);
 	n->ClientId = -1;	// -1 is unset
 	n->Ready = false;
 }
 
 static void OnReceive(NetClient *n, ENetEvent event);
+static void OnSnapshot(NetClient *n, uint8_t *payload, const size_t len);
 void NetClientPoll(NetClient *n)
 {
 	if (!n->client || !n->peer)
 	{
 		return;
 	}
+	// Apply the join snapshot that came before the game started
+	if (gMission.HasStarted && n->JoinSnapshot.size > 0)
+	{
+		OnSnapshot(n, n->JoinSnapshot.data, n->JoinSnapshot.size);
+		CArrayClear(&n->JoinSnapshot);
+	}
 	// Service the connection
 	int check;
 	do
@@ -198,9 +224,35 @@ void NetClientPoll(NetClient *n)
 		}
 	} while (check > 0);
 }
+static void OnReceiveMsg(
+	NetClient *n, const GameEventType msg,
+	uint8_t *payload, const size_t len);
 static void OnReceive(NetClient *n, ENetEvent event)
 {
-	const GameEventType msg = (GameEventType)*(uint32_t *)event.packet->data;
+	n->Recv.Packets++;
+	n->Recv.Bytes += event.packet->dataLength;
+	// Each packet is a frame of batched messages
+	NetBatchReader r = NetBatchReaderNew(
+		event.packet->data, event.packet->dataLength);
+	uint32_t msg;
+	uint8_t *payload;
+	size_t len;
+	while (NetBatchNext(&r, &msg, &payload, &len))
+	{
+		n->Recv.Msgs++;
+		OnReceiveMsg(n, (GameEventType)msg, payload, len);
+	}
+	if (r.Cur != r.End)
+	{
+		LOG(LM_NET, LL_ERROR, "malformed packet; dropped %d bytes",
+			(int)(r.End - r.Cur));
+	}
+	enet_packet_destroy(event.packet);
+}
+static void OnReceiveMsg(
+	NetClient *n, const GameEventType msg,
+	uint8_t *payload, const size_t len)
+{
 	LOG(LM_NET, LL_TRACE, "recv msg(%u)", msg);
 	const GameEventEntry gee = GameEventGetEntry(msg);
 	if (gee.Enqueue)
@@ -217,7 +269,7 @@ static void OnReceive(NetClient *n, ENetEvent event)
 			GameEvent e = GameEventNew(gee.Type);
 			if (gee.Fields != NULL)
 			{
-				NetDecode(event.packet, &e.u, gee.Fields);
+				NetDecode(payload, len, &e.u, gee.Fields);
 			}
 
 			// For actor events, check if UID is not for local player
@@ -259,7 +311,7 @@ static void OnReceive(NetClient *n, ENetEvent event)
 			}
 			else
 			{
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEventsEnqueue(&gGameEvents, &e);
 			}
 		}
 	}
@@ -273,7 +325,7 @@ static void OnReceive(NetClient *n, ENetEvent event)
 					n->ClientId == -1,
 					"unexpected client ID message, already set");
 				NClientId cid;
-				NetDecode(event.packet, &cid, NClientId_fields);
+				NetDecode(payload, len, &cid, NClientId_fields);
 				LOG(LM_NET, LL_DEBUG, "recv clientId(%u) uid(%u)",
 					cid.Id, cid.FirstPlayerUID);
 				n->ClientId = (int)cid.Id;
@@ -289,7 +341,7 @@ static void OnReceive(NetClient *n, ENetEvent event)
 			{
 				LOG(LM_NET, LL_DEBUG, "NetClient: received campaign def, loading...");
 				NCampaignDef def;
-				NetDecode(event.packet, &def, NCampaignDef_fields);
+				NetDecode(payload, len, &def, NCampaignDef_fields);
 				gCampaign.Entry.Mode = (GameMode)def.GameMode;
 				CampaignEntry entry;
 				if (CampaignEntryTryLoad(
@@ -306,6 +358,9 @@ static void OnReceive(NetClient *n, ENetEvent event)
 				}
 			}
 			break;
+		case GAME_EVENT_SNAPSHOT:
+			OnSnapshot(n, payload, len);
+			break;
 		case GAME_EVENT_NET_GAME_START:
 			LOG(LM_NET, LL_DEBUG, "NetClient: received game start");
 			// Don't ready-up unless we're ready
@@ -319,12 +374,84 @@ static void OnReceive(NetClient *n, ENetEvent event)
 			break;
 		}
 	}
-	enet_packet_destroy(event.packet);
+}
+
+static void OnSnapshot(NetClient *n, uint8_t *payload, const size_t len)
+{
+	uint32_t seq, baseSeq, flags;
+	if (!NetSnapshotReadHeader(payload, len, &seq, &baseSeq, &flags))
+	{
+		LOG(LM_NET, LL_ERROR, "malformed snapshot");
+		return;
+	}
+	const bool join = flags & NET_SNAPSHOT_JOIN;
+	if (!gMission.HasStarted)
+	{
+		// The server waits for our ack of the join snapshot before sending
+		// deltas, so keep it until the game starts
+		if (join)
+		{
+			LOG(LM_NET, LL_TRACE, "keep join snapshot(%u) for game start",
+				seq);
+			CArrayClear(&n->JoinSnapshot);
+			for (size_t i = 0; i < len; i++)
+			{
+				CArrayPushBack(&n->JoinSnapshot, &payload[i]);
+			}
+		}
+		else
+		{
+			LOG(LM_NET, LL_TRACE, "ignore snapshot before game start");
+		}
+		return;
+	}
+	if (join)
+	{
+		// New game; old snapshots are for old entities
+		NetSnapshotHistoryClear(&n->Snapshots);
+		n->SnapshotSeq = 0;
+	}
+	else if (seq <= n->SnapshotSeq)
+	{
+		return;
+	}
+	const NetSnapshot *base = NetSnapshotHistoryGet(&n->Snapshots, baseSeq);
+	if (baseSeq != 0 && base == NULL)
+	{
+		// The join snapshot hasn't arrived yet, or the server hasn't seen
+		// our recent acks; wait for a snapshot we can use
+		LOG(LM_NET, LL_TRACE, "no baseline(%u) for snapshot(%u)",
+			baseSeq, seq);
+		return;
+	}
+	if (!NetSnapshotDecode(&n->Snapshot, base, payload, len))
+	{
+		LOG(LM_NET, LL_ERROR, "failed to decode snapshot(%u)", seq);
+		return;
+	}
+	LOG(LM_NET, LL_TRACE, "recv snapshot(%u) base(%u) entities(%d)",
+		seq, baseSeq, (int)n->Snapshot.Entities.size);
+	NetSnapshotApply(
+		&n->Snapshot, NetSnapshotHistoryGet(&n->Snapshots, n->SnapshotSeq),
+		join);
+	NetSnapshotHistoryAdd(&n->Snapshots, &n->Snapshot);
+	n->SnapshotSeq = seq;
+
+	// Ack it so that the server can make deltas against it
+	uint8_t buf[NET_BATCH_VARINT_MAX];
+	const size_t ackLen = (size_t)(NetBatchWriteVarint(buf, seq) - buf);
+	NetOutboxAdd(
+		&n->Out, n->peer, &n->Sent, GAME_EVENT_SNAPSHOT_ACK, NULL,
+		buf, ackLen);
 }
 
 void NetClientFlush(NetClient *n)
 {
 	if (n->client == NULL) return;
+	if (n->peer != NULL)
+	{
+		NetOutboxFlush(&n->Out, n->peer, &n->Sent);
+	}
 	enet_host_flush(n->client);
 }
 
@@ -336,7 +463,9 @@ void NetClientSendMsg(NetClient *n, const GameEventType e, const void *data)
 	}
 
 	LOG(LM_NET, LL_TRACE, "NetClient: send msg type %d", (int)e);
-	enet_peer_send(n->peer, 0, NetEncode(e, data));
+	uint8_t buf[NET_MSG_MAX_SIZE];
+	const size_t len = NetEncode(e, data, buf);
+	NetOutboxAdd(&n->Out, n->peer, &n->Sent, e, data, buf, len);
 }
 
 bool NetClientIsConnected(const NetClient *n)
@@ -41,6 +41,14 @@ typedef struct
 	bool Ready;
 	bool FoundLANServer;
 	bool FindingLANServer;
+	NetOutbox Out;	// messages to send on the next flush
+	NetStats Sent;
+	NetStats Recv;
+	// Snapshots received, as baselines for the server's deltas
+	NetSnapshotHistory Snapshots;
+	NetSnapshot Snapshot;	// being decoded
+	uint32_t SnapshotSeq;	// latest applied
+	CArray JoinSnapshot;	// of uint8_t, received before the game started
 } NetClient;
 
 extern NetClient gNetClient;
@@ -55,8 +63,9 @@ void NetClientFindLANServers(NetClient *n);
 void NetClientConnect(NetClient *n, const ENetAddress addr);
 void NetClientDisconnect(NetClient *n);
 void NetClientPoll(NetClient *n);
+// Send the batched messages
 void NetClientFlush(NetClient *n);
-// Send a command to the server
+// Send a command to the server; it is batched until the next flush
 void NetClientSendMsg(NetClient *n, const GameEventType e, const void *data);
 
 bool NetClientIsConnected(const NetClient *n);
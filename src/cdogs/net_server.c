@@ -35,6 +35,7 @@
 #include "actor_placement.h"
 #include "ai_utils.h"
 #include "campaign_entry.h"
+#include "config.h"
 #include "events.h"
 #include "game_events.h"
 #include "gamedata.h"
@@ -54,6 +55,9 @@ void NetServerInit(NetServer *n)
     return;
   #endif
 	memset(n, 0, sizeof *n);
+	NetSnapshotInit(&n->World);
+	CArrayInit(&n->SnapshotBuf, sizeof(uint8_t));
+	NetSnapshotInit(&n->PeerWorld);
 }
 
 void NetServerTerminate(NetServer *n)
@@ -62,6 +66,9 @@ void NetServerTerminate(NetServer *n)
     return;
   #endif
 	NetServerClose(n);
+	NetSnapshotTerminate(&n->World);
+	CArrayTerminate(&n->SnapshotBuf);
+	NetSnapshotTerminate(&n->PeerWorld);
 }
 
 void NetServerReset(NetServer *n)
@@ -90,7 +97,7 @@ void NetServerOpen(NetServer *n)
 	n->server = enet_host_create(
 		&address /* the address to bind the server host to */,
 		NET_SERVER_MAX_CLIENTS,
-		2      /* allow up to 2 channels to be used, 0 and 1 */,
+		NET_CHANNELS /* reliable, and latest state */,
 		0      /* assume any amount of incoming bandwidth */,
 		0      /* assume any amount of outgoing bandwidth */);
 	if (n->server == NULL)
@@ -103,6 +110,15 @@ void NetServerOpen(NetServer *n)
 		(int)n->server->address.port);
 }
 
+static void PeerDataFree(ENetPeer *peer)
+{
+	if (peer->data == NULL) return;
+	NetOutboxTerminate(&((NetPeerData *)peer->data)->Out);
+	NetSnapshotHistoryTerminate(&((NetPeerData *)peer->data)->Snapshots);
+	CFREE(peer->data);
+	peer->data = NULL;
+}
+
 void NetServerClose(NetServer *n)
 {
   #if defined(__RS97__)
@@ -114,13 +130,19 @@ void NetServerClose(NetServer *n)
 		{
 			ENetPeer *peer = n->server->peers + i;
 			enet_peer_disconnect_now(peer, 0);
+			PeerDataFree(peer);
 		}
 		enet_host_destroy(n->server);
+		LOG(LM_NET, LL_INFO,
+			"sent %d msgs in %d packets (%u bytes), "
+			"recv %d msgs in %d packets (%u bytes)",
+			n->Sent.Msgs, n->Sent.Packets, (unsigned)n->Sent.Bytes,
+			n->Recv.Msgs, n->Recv.Packets, (unsigned)n->Recv.Bytes);
 	}
 	n->server = NULL;
 }
 
-static void OnConnect(NetServer *n, ENetEvent event);
+static void OnConnect(NetServer *n, ENetPeer *peer);
 static void OnReceive(NetServer *n, ENetEvent event);
 void NetServerPoll(NetServer *n)
 {
@@ -165,8 +187,7 @@ void NetServerPoll(NetServer *n)
 					if (event.peer->data != NULL)
 					{
 						peerId = ((NetPeerData *)event.peer->data)->Id;
-						CFREE(event.peer->data);
-						event.peer->data = NULL;
+						PeerDataFree(event.peer);
 					}
 					LOG(LM_NET, LL_INFO, "peerId(%d) disconnected %u.%u.%u.%u:%d",
 						peerId,
@@ -191,18 +212,22 @@ void NetServerPoll(NetServer *n)
 	NetServerFlush(n);
 }
 
-static void OnConnect(NetServer *n, ENetEvent event)
+static void OnConnect(NetServer *n, ENetPeer *peer)
 {
   #if defined(__RS97__)
     return;
   #endif
 	LOG(LM_NET, LL_INFO, "new client connected from %u.%u.%u.%u:%d",
-		NET_IP_TO_CIDR_FORMAT(event.peer->address.host),
-		(int)event.peer->address.port);
+		NET_IP_TO_CIDR_FORMAT(peer->address.host),
+		(int)peer->address.port);
 	/* Store any relevant client information here. */
-	CMALLOC(event.peer->data, sizeof(NetPeerData));
+	NetPeerData *pd;
+	CCALLOC(pd, sizeof *pd);
+	peer->data = pd;
 	const int peerId = n->peerId;
-	((NetPeerData *)event.peer->data)->Id = peerId;
+	pd->Id = peerId;
+	NetOutboxInit(&pd->Out);
+	NetSnapshotHistoryInit(&pd->Snapshots);
 	n->peerId++;
 
 	// Send the client ID
@@ -223,17 +248,43 @@ static void OnConnect(NetServer *n, ENetEvent event)
 	NetServerFlush(n);
 }
 
+static void OnReceiveMsg(
+	NetServer *n, ENetPeer *peer, const GameEventType msg,
+	uint8_t *payload, const size_t len);
 static void OnReceive(NetServer *n, ENetEvent event)
 {
   #if defined(__RS97__)
     return;
   #endif
-	const GameEventType msg = (GameEventType)*(uint32_t *)event.packet->data;
+	n->Recv.Packets++;
+	n->Recv.Bytes += event.packet->dataLength;
+	// Each packet is a frame of batched messages
+	NetBatchReader r = NetBatchReaderNew(
+		event.packet->data, event.packet->dataLength);
+	uint32_t msg;
+	uint8_t *payload;
+	size_t len;
+	while (NetBatchNext(&r, &msg, &payload, &len))
+	{
+		n->Recv.Msgs++;
+		OnReceiveMsg(n, event.peer, (GameEventType)msg, payload, len);
+	}
+	if (r.Cur != r.End)
+	{
+		LOG(LM_NET, LL_ERROR, "malformed packet; dropped %d bytes",
+			(int)(r.End - r.Cur));
+	}
+	enet_packet_destroy(event.packet);
+}
+static void OnReceiveMsg(
+	NetServer *n, ENetPeer *peer, const GameEventType msg,
+	uint8_t *payload, const size_t len)
+{
 	int peerId = -1;
-	if (event.peer->data != NULL)
+	if (peer->data != NULL)
 	{
 		// We may not have assigned peer ID
-		peerId = ((NetPeerData *)event.peer->data)->Id;
+		peerId = ((NetPeerData *)peer->data)->Id;
 		LOG(LM_NET, LL_TRACE, "recv message from peerId(%d) msg(%d)",
 			peerId, (int)msg);
 	}
@@ -242,16 +293,30 @@ static void OnReceive(NetServer *n, ENetEvent event)
 	{
 		// Game event message; decode and add to event queue
 		LOG(LM_NET, LL_TRACE, "recv gameEvent(%d)", (int)gee.Type);
-		GameEvent e = GameEventNew(gee.Type);
-		NetDecode(event.packet, &e.u, gee.Fields);
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, gee.Type);
+		NetDecode(payload, len, &e->u, gee.Fields);
+		GameEventsCommit(&gGameEvents, e);
 	}
 	else
 	{
 		switch (gee.Type)
 		{
 		case GAME_EVENT_CLIENT_CONNECT:
-			OnConnect(n, event);
+			OnConnect(n, peer);
+			break;
+		case GAME_EVENT_SNAPSHOT_ACK:
+			{
+				NetPeerData *pd = peer->data;
+				NetBatchReader r = NetBatchReaderNew(payload, len);
+				uint32_t seq;
+				// Only move forward, to snapshots we still have
+				if (pd != NULL && NetBatchReadVarint(&r, &seq) &&
+					seq > pd->AckedSeq &&
+					NetSnapshotHistoryGet(&pd->Snapshots, seq) != NULL)
+				{
+					pd->AckedSeq = seq;
+				}
+			}
 			break;
 		case GAME_EVENT_CLIENT_READY:
 			CASSERT(peerId >= 0, "peer id unset");
@@ -263,9 +328,10 @@ static void OnReceive(NetServer *n, ENetEvent event)
 				const int cid = (peerId + 1) * MAX_LOCAL_PLAYERS + i;
 				const PlayerData *pData = PlayerDataGetByUID(cid);
 				if (pData == NULL) continue;
-				GameEvent e = GameEventNew(GAME_EVENT_PLAYER_DATA);
-				e.u.PlayerData = PlayerDataMissionReset(pData);
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEvent *e =
+					GameEventsAdd(&gGameEvents, GAME_EVENT_PLAYER_DATA);
+				e->u.PlayerData = PlayerDataMissionReset(pData);
+				GameEventsCommit(&gGameEvents, e);
 			}
 			// Flush game events to make sure we reset player data
 			HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
@@ -300,7 +366,64 @@ static void OnReceive(NetServer *n, ENetEvent event)
 			break;
 		}
 	}
-	enet_packet_destroy(event.packet);
+}
+
+// Send each peer in a game the world as a delta against what it has acked
+static ConfigHandle sGameNetRelevance = CONFIG_HANDLE("Game.NetRelevance");
+// Centres of what a peer's players can see, in real coordinates, and how
+// far around them is relevant; returns the number of centres
+// Everything is relevant if the relevance radius is 0 or the peer has no
+// live players.
+static int PeerViews(const NetPeerData *pd, Vec2i *views, Vec2i *extent)
+{
+	const int radius = ConfigHandleGetInt(&sGameNetRelevance);
+	*extent = Vec2iNew(radius * TILE_WIDTH, radius * TILE_HEIGHT);
+	int numViews = 0;
+	if (radius == 0) return 0;
+	for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+	{
+		const int cid = (pd->Id + 1) * MAX_LOCAL_PLAYERS + i;
+		const PlayerData *p = PlayerDataGetByUID(cid);
+		if (p == NULL || p->ActorUID < 0) continue;
+		const TActor *a = ActorGetByUID(p->ActorUID);
+		if (a == NULL || !a->isInUse) continue;
+		views[numViews++] = Vec2iFull2Real(a->Pos);
+	}
+	return numViews;
+}
+
+static void MakeSnapshots(NetServer *n)
+{
+	if (!gMission.HasStarted) return;
+	bool made = false;
+	for (int i = 0; i < (int)n->server->peerCount; i++)
+	{
+		NetPeerData *pd = n->server->peers[i].data;
+		if (pd == NULL || pd->AckedSeq == 0) continue;
+		if (!made)
+		{
+			NetSnapshotMakeWorld(&n->World);
+			made = true;
+		}
+		// If the acked snapshot is too old, use the empty baseline
+		const NetSnapshot *base =
+			NetSnapshotHistoryGet(&pd->Snapshots, pd->AckedSeq);
+		pd->SnapshotSeq++;
+		n->World.Seq = pd->SnapshotSeq;
+		// Leave out actors far from the peer's players; when they come
+		// near again they are in the delta as adds, with all their state
+		const NetSnapshot *world = &n->World;
+		Vec2i views[MAX_LOCAL_PLAYERS];
+		Vec2i extent;
+		const int numViews = PeerViews(pd, views, &extent);
+		if (numViews > 0)
+		{
+			NetSnapshotFilter(&n->PeerWorld, world, views, numViews, extent);
+			world = &n->PeerWorld;
+		}
+		NetSnapshotEncode(&pd->Out.Snapshot, world, base, 0);
+		NetSnapshotHistoryAdd(&pd->Snapshots, world);
+	}
 }
 
 void NetServerFlush(NetServer *n)
@@ -309,9 +432,43 @@ void NetServerFlush(NetServer *n)
     return;
   #endif
 	if (n->server == NULL) return;
+	MakeSnapshots(n);
+	for (int i = 0; i < (int)n->server->peerCount; i++)
+	{
+		ENetPeer *peer = n->server->peers + i;
+		if (peer->data == NULL) continue;
+		NetOutboxFlush(&((NetPeerData *)peer->data)->Out, peer, &n->Sent);
+	}
 	enet_host_flush(n->server);
 }
 
+// Send the world as a delta against the empty baseline; this is sent
+// reliably, and deltas only start once the peer acks it
+static void SendJoinSnapshot(NetServer *n, const int peerId)
+{
+	if (!n->server) return;
+	NetSnapshotMakeWorld(&n->World);
+	for (int i = 0; i < (int)n->server->peerCount; i++)
+	{
+		ENetPeer *peer = n->server->peers + i;
+		NetPeerData *pd = peer->data;
+		if (pd == NULL || (peerId >= 0 && pd->Id != peerId)) continue;
+		pd->SnapshotSeq++;
+		n->World.Seq = pd->SnapshotSeq;
+		NetSnapshotEncode(
+			&n->SnapshotBuf, &n->World, NULL, NET_SNAPSHOT_JOIN);
+		NetSnapshotHistoryClear(&pd->Snapshots);
+		NetSnapshotHistoryAdd(&pd->Snapshots, &n->World);
+		pd->AckedSeq = 0;
+		LOG(LM_NET, LL_DEBUG, "send join snapshot to peerId(%d): %d entities, "
+			"%d bytes", pd->Id, (int)n->World.Entities.size,
+			(int)n->SnapshotBuf.size);
+		NetOutboxAdd(
+			&pd->Out, peer, &n->Sent, GAME_EVENT_SNAPSHOT, NULL,
+			n->SnapshotBuf.data, n->SnapshotBuf.size);
+	}
+}
+
 void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 {
   #if defined(__RS97__)
@@ -329,28 +486,6 @@ void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 
 	NetServerSendMsg(n, peerId, GAME_EVENT_NET_GAME_START, NULL);
 
-	// Send all actors
-	for (int i = 0; i < (int)gActors.size; i++)
-	{
-		const TActor *a = CArrayGet(&gActors, i);
-		if (!a->isInUse)
-		{
-			continue;
-		}
-		NActorAdd aa = NActorAdd_init_default;
-		aa.UID = a->uid;
-		aa.CharId = a->charId;
-		aa.Health = a->health;
-		aa.Direction = (int32_t)a->direction;
-		aa.PlayerUID = a->PlayerUID;
-		aa.TileItemFlags = a->tileItem.flags;
-		aa.FullPos.x = a->Pos.x;
-		aa.FullPos.y = a->Pos.y;
-		LOG(LM_NET, LL_DEBUG, "send add player UID(%d) playerUID(%d)",
-			(int)aa.UID, (int)aa.PlayerUID);
-		NetServerSendMsg(n, peerId, GAME_EVENT_ACTOR_ADD, &aa);
-	}
-
 	// Send key state
 	NAddKeys ak = NAddKeys_init_default;
 	ak.KeyFlags = gMission.KeyFlags;
@@ -407,34 +542,8 @@ void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 		NetServerSendMsg(n, peerId, GAME_EVENT_EXPLORE_TILES, &et);
 	}
 
-	// Send all pickups
-	for (int i = 0; i < (int)gPickups.size; i++)
-	{
-		const Pickup *p = CArrayGet(&gPickups, i);
-		if (!p->isInUse) continue;
-		NAddPickup api = NAddPickup_init_default;
-		api.UID = p->UID;
-		strcpy(api.PickupClass, p->class->Name);
-		api.IsRandomSpawned = p->IsRandomSpawned;
-		api.SpawnerUID = p->SpawnerUID;
-		api.TileItemFlags = p->tileItem.flags;
-		api.Pos = Vec2i2Net(Vec2iNew(p->tileItem.x, p->tileItem.y));
-		NetServerSendMsg(n, peerId, GAME_EVENT_ADD_PICKUP, &api);
-	}
-
-	// Send all map objects
-	for (int i = 0; i < (int)gObjs.size; i++)
-	{
-		const TObject *o = CArrayGet(&gObjs, i);
-		if (!o->isInUse) continue;
-		NMapObjectAdd amo = NMapObjectAdd_init_default;
-		amo.UID = o->uid;
-		strcpy(amo.MapObjectClass, o->Class->Name);
-		amo.Pos = Vec2i2Net(Vec2iNew(o->tileItem.x, o->tileItem.y));
-		amo.TileItemFlags = o->tileItem.flags;
-		amo.Health = o->Health;
-		NetServerSendMsg(n, peerId, GAME_EVENT_MAP_OBJECT_ADD, &amo);
-	}
+	// Send all actors, pickups and map objects
+	SendJoinSnapshot(n, peerId);
 
 	// If mission complete already, send message
 	if (CanCompleteMission(&gMission))
@@ -453,27 +562,39 @@ void NetServerSendMsg(
   #endif
 	if (!n->server) return;
 
+	uint8_t buf[NET_MSG_MAX_SIZE];
+	const size_t len = NetEncode(e, data, buf);
+	// Effects like sounds and bullets only go to peers with players nearby
+	Vec2i pos;
+	const bool positional = peerId < 0 && GameEventPos(e, data, &pos);
 	if (peerId >= 0)
 	{
 		LOG(LM_NET, LL_TRACE, "send msg(%d) to peers(%d)",
 			(int)e, (int)n->server->connectedPeers);
-		// Find the peer and send
-		for (int i = 0; i < (int)n->server->peerCount; i++)
-		{
-			ENetPeer *peer = n->server->peers + i;
-			if (peer->data != NULL &&
-				((NetPeerData *)peer->data)->Id == peerId)
-			{
-				enet_peer_send(peer, 0, NetEncode(e, data));
-				return;
-			}
-		}
-		CASSERT(false, "Cannot find peer by id");
 	}
 	else
 	{
 		LOG(LM_NET, LL_TRACE, "bcast msg(%d) to peers(%d)",
 			(int)e, (int)n->server->connectedPeers);
-		enet_host_broadcast(n->server, 0, NetEncode(e, data));
 	}
+	// Broadcasts are batched per peer too, so that they stay in order with
+	// messages to single peers
+	bool found = false;
+	for (int i = 0; i < (int)n->server->peerCount; i++)
+	{
+		ENetPeer *peer = n->server->peers + i;
+		NetPeerData *pd = peer->data;
+		if (pd == NULL || (peerId >= 0 && pd->Id != peerId)) continue;
+		if (positional)
+		{
+			Vec2i views[MAX_LOCAL_PLAYERS];
+			Vec2i extent;
+			const int numViews = PeerViews(pd, views, &extent);
+			if (!NetIsInView(views, numViews, extent, pos)) continue;
+		}
+		NetOutboxAdd(&pd->Out, peer, &n->Sent, e, data, buf, len);
+		found = true;
+		if (peerId >= 0) break;
+	}
+	CASSERT(found || peerId < 0, "Cannot find peer by id");
 }
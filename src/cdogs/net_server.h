@@ -43,6 +43,11 @@ typedef struct
 	int PrevCmd;
 	int Cmd;
 	int peerId;	// auto-incrementing id for the next connected peer
+	NetStats Sent;
+	NetStats Recv;
+	NetSnapshot World;	// built on flush, shared by all peers
+	CArray SnapshotBuf;	// of uint8_t; for encoding join snapshots
+	NetSnapshot PeerWorld;	// the world as relevant to one peer
 } NetServer;
 
 extern NetServer gNetServer;
@@ -50,6 +55,11 @@ extern NetServer gNetServer;
 typedef struct
 {
 	int Id;
+	NetOutbox Out;	// messages to send on the next flush
+	// Snapshots sent, and the latest acked, which deltas are made against
+	NetSnapshotHistory Snapshots;
+	uint32_t SnapshotSeq;
+	uint32_t AckedSeq;	// 0 until the peer acks its join snapshot
 } NetPeerData;
 
 void NetServerInit(NetServer *n);
@@ -61,8 +71,10 @@ void NetServerOpen(NetServer *n);
 void NetServerClose(NetServer *n);
 // Service the recv buffer; if data is received then activate this device
 void NetServerPoll(NetServer *n);
+// Send each peer's batched messages, and a snapshot to peers in a game
 void NetServerFlush(NetServer *n);
 
+// Messages are batched per peer until the next flush
 // If peerId is -1, broadcast
 void NetServerSendMsg(
 	NetServer *n, const int peerId, const GameEventType e, const void *data);
@@ -0,0 +1,393 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "net_snapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "net_batch.h"
+#include "utils.h"
+
+typedef enum
+{
+	OP_CHANGE,
+	OP_ADD,
+	OP_REMOVE
+} Op;
+
+
+void NetSnapshotInit(NetSnapshot *s)
+{
+	s->Seq = 0;
+	CArrayInit(&s->Entities, sizeof(NetSnapshotEntity));
+}
+void NetSnapshotTerminate(NetSnapshot *s)
+{
+	CArrayTerminate(&s->Entities);
+}
+void NetSnapshotClear(NetSnapshot *s)
+{
+	s->Seq = 0;
+	CArrayClear(&s->Entities);
+}
+void NetSnapshotCopy(NetSnapshot *dst, const NetSnapshot *src)
+{
+	dst->Seq = src->Seq;
+	CArrayResize(&dst->Entities, src->Entities.size, NULL);
+	if (src->Entities.size > 0)
+	{
+		memcpy(
+			dst->Entities.data, src->Entities.data,
+			src->Entities.size * sizeof(NetSnapshotEntity));
+	}
+}
+
+NetSnapshotEntity *NetSnapshotAdd(
+	NetSnapshot *s, const NetSnapshotKind kind, const uint32_t uid)
+{
+	CArrayResize(&s->Entities, s->Entities.size + 1, NULL);
+	NetSnapshotEntity *e =
+		CArrayGet(&s->Entities, (int)s->Entities.size - 1);
+	memset(e, 0, sizeof *e);
+	e->Kind = (uint32_t)kind;
+	e->UID = uid;
+	return e;
+}
+
+static int CompareKey(
+	const uint32_t kind1, const uint32_t uid1,
+	const uint32_t kind2, const uint32_t uid2)
+{
+	if (kind1 != kind2)
+	{
+		return kind1 < kind2 ? -1 : 1;
+	}
+	if (uid1 != uid2)
+	{
+		return uid1 < uid2 ? -1 : 1;
+	}
+	return 0;
+}
+static int CompareEntity(const void *v1, const void *v2)
+{
+	const NetSnapshotEntity *e1 = v1;
+	const NetSnapshotEntity *e2 = v2;
+	return CompareKey(e1->Kind, e1->UID, e2->Kind, e2->UID);
+}
+void NetSnapshotSort(NetSnapshot *s)
+{
+	qsort(
+		s->Entities.data, s->Entities.size, sizeof(NetSnapshotEntity),
+		CompareEntity);
+}
+
+const NetSnapshotEntity *NetSnapshotFind(
+	const NetSnapshot *s, const NetSnapshotKind kind, const uint32_t uid)
+{
+	int lo = 0;
+	int hi = (int)s->Entities.size - 1;
+	while (lo <= hi)
+	{
+		const int mid = (lo + hi) / 2;
+		const NetSnapshotEntity *e = CArrayGet(&s->Entities, mid);
+		const int c = CompareKey(e->Kind, e->UID, (uint32_t)kind, uid);
+		if (c == 0)
+		{
+			return e;
+		}
+		if (c < 0)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid - 1;
+		}
+	}
+	return NULL;
+}
+void NetSnapshotGetRemoved(
+	CArray *out, const NetSnapshot *s, const NetSnapshot *prev,
+	const NetSnapshotKind kind)
+{
+	CArrayClear(out);
+	CA_FOREACH(const NetSnapshotEntity, e, prev->Entities)
+		if (e->Kind == (uint32_t)kind &&
+			NetSnapshotFind(s, kind, e->UID) == NULL)
+		{
+			CArrayPushBack(out, e);
+		}
+	CA_FOREACH_END()
+}
+
+
+// Differences are stored zigzagged, so small negatives are small varints
+static uint32_t ZigZag(const int32_t v)
+{
+	return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+static int32_t UnZigZag(const uint32_t v)
+{
+	return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static void PushVarint(CArray *out, const uint32_t v)
+{
+	uint8_t buf[NET_BATCH_VARINT_MAX];
+	const size_t len = (size_t)(NetBatchWriteVarint(buf, v) - buf);
+	const size_t start = out->size;
+	CArrayResize(out, start + len, NULL);
+	memcpy((uint8_t *)out->data + start, buf, len);
+}
+static void PushRecord(
+	CArray *out, const Op op, const NetSnapshotEntity *e,
+	const NetSnapshotEntity *base)
+{
+	uint32_t mask = 0;
+	uint32_t values[NET_SNAPSHOT_FIELDS];
+	if (op != OP_REMOVE)
+	{
+		for (int i = 0; i < NET_SNAPSHOT_FIELDS; i++)
+		{
+			// Wrapping difference; a full-range change is still exact
+			const int32_t from = base != NULL ? base->Fields[i] : 0;
+			const int32_t d =
+				(int32_t)((uint32_t)e->Fields[i] - (uint32_t)from);
+			if (d != 0)
+			{
+				values[i] = ZigZag(d);
+				mask |= 1u << i;
+			}
+		}
+		if (op == OP_CHANGE && mask == 0)
+		{
+			return;
+		}
+	}
+	PushVarint(out, (uint32_t)op | (e->Kind << 2));
+	PushVarint(out, e->UID);
+	if (op == OP_REMOVE)
+	{
+		return;
+	}
+	PushVarint(out, mask);
+	for (int i = 0; i < NET_SNAPSHOT_FIELDS; i++)
+	{
+		if (mask & (1u << i))
+		{
+			PushVarint(out, values[i]);
+		}
+	}
+}
+
+void NetSnapshotEncode(
+	CArray *out, const NetSnapshot *s, const NetSnapshot *base,
+	const uint32_t flags)
+{
+	CArrayClear(out);
+	PushVarint(out, s->Seq);
+	PushVarint(out, base != NULL ? base->Seq : 0);
+	PushVarint(out, flags);
+	// Walk both in entity order
+	const int nBase = base != NULL ? (int)base->Entities.size : 0;
+	int bi = 0;
+	CA_FOREACH(const NetSnapshotEntity, e, s->Entities)
+		for (; bi < nBase; bi++)
+		{
+			const NetSnapshotEntity *b = CArrayGet(&base->Entities, bi);
+			if (CompareEntity(b, e) >= 0)
+			{
+				break;
+			}
+			PushRecord(out, OP_REMOVE, b, NULL);
+		}
+		const NetSnapshotEntity *b =
+			bi < nBase ? CArrayGet(&base->Entities, bi) : NULL;
+		if (b != NULL && CompareEntity(b, e) == 0)
+		{
+			PushRecord(out, OP_CHANGE, e, b);
+			bi++;
+		}
+		else
+		{
+			PushRecord(out, OP_ADD, e, NULL);
+		}
+	CA_FOREACH_END()
+	for (; bi < nBase; bi++)
+	{
+		PushRecord(out, OP_REMOVE, CArrayGet(&base->Entities, bi), NULL);
+	}
+}
+
+bool NetSnapshotReadHeader(
+	uint8_t *data, const size_t len,
+	uint32_t *seq, uint32_t *baseSeq, uint32_t *flags)
+{
+	NetBatchReader r = NetBatchReaderNew(data, len);
+	return NetBatchReadVarint(&r, seq) &&
+		NetBatchReadVarint(&r, baseSeq) &&
+		NetBatchReadVarint(&r, flags);
+}
+
+bool NetSnapshotDecode(
+	NetSnapshot *s, const NetSnapshot *base, uint8_t *data, const size_t len)
+{
+	NetBatchReader r = NetBatchReaderNew(data, len);
+	uint32_t seq, baseSeq, flags;
+	if (!NetBatchReadVarint(&r, &seq) ||
+		!NetBatchReadVarint(&r, &baseSeq) ||
+		!NetBatchReadVarint(&r, &flags) ||
+		baseSeq != (base != NULL ? base->Seq : 0))
+	{
+		return false;
+	}
+	NetSnapshotClear(s);
+	s->Seq = seq;
+	// Merge the base with the records, which are in entity order
+	const int nBase = base != NULL ? (int)base->Entities.size : 0;
+	int bi = 0;
+	bool hasLast = false;
+	uint32_t lastKind = 0, lastUID = 0;
+	while (r.Cur != r.End)
+	{
+		uint32_t opKind, uid;
+		if (!NetBatchReadVarint(&r, &opKind) ||
+			!NetBatchReadVarint(&r, &uid))
+		{
+			return false;
+		}
+		const Op op = (Op)(opKind & 3);
+		const uint32_t kind = opKind >> 2;
+		if (op > OP_REMOVE ||
+			(hasLast && CompareKey(lastKind, lastUID, kind, uid) >= 0))
+		{
+			return false;
+		}
+		lastKind = kind;
+		lastUID = uid;
+		hasLast = true;
+		// Copy base entities before this one as is
+		const NetSnapshotEntity *b = NULL;
+		for (; bi < nBase; bi++)
+		{
+			b = CArrayGet(&base->Entities, bi);
+			const int c = CompareKey(b->Kind, b->UID, kind, uid);
+			if (c >= 0)
+			{
+				if (c > 0)
+				{
+					b = NULL;
+				}
+				break;
+			}
+			CArrayPushBack(&s->Entities, b);
+			b = NULL;
+		}
+		if ((op == OP_ADD) != (b == NULL))
+		{
+			return false;
+		}
+		if (b != NULL)
+		{
+			bi++;
+		}
+		if (op == OP_REMOVE)
+		{
+			continue;
+		}
+		uint32_t mask;
+		if (!NetBatchReadVarint(&r, &mask) ||
+			mask >= (1u << NET_SNAPSHOT_FIELDS))
+		{
+			return false;
+		}
+		NetSnapshotEntity *e = NetSnapshotAdd(s, (NetSnapshotKind)kind, uid);
+		if (b != NULL)
+		{
+			memcpy(e->Fields, b->Fields, sizeof e->Fields);
+		}
+		for (int i = 0; i < NET_SNAPSHOT_FIELDS; i++)
+		{
+			uint32_t v;
+			if (!(mask & (1u << i)))
+			{
+				continue;
+			}
+			if (!NetBatchReadVarint(&r, &v))
+			{
+				return false;
+			}
+			e->Fields[i] =
+				(int32_t)((uint32_t)e->Fields[i] + (uint32_t)UnZigZag(v));
+		}
+	}
+	for (; bi < nBase; bi++)
+	{
+		CArrayPushBack(&s->Entities, CArrayGet(&base->Entities, bi));
+	}
+	return true;
+}
+
+
+void NetSnapshotHistoryInit(NetSnapshotHistory *h)
+{
+	for (int i = 0; i < NET_SNAPSHOT_HISTORY; i++)
+	{
+		NetSnapshotInit(&h->Snapshots[i]);
+	}
+}
+void NetSnapshotHistoryTerminate(NetSnapshotHistory *h)
+{
+	for (int i = 0; i < NET_SNAPSHOT_HISTORY; i++)
+	{
+		NetSnapshotTerminate(&h->Snapshots[i]);
+	}
+}
+void NetSnapshotHistoryClear(NetSnapshotHistory *h)
+{
+	for (int i = 0; i < NET_SNAPSHOT_HISTORY; i++)
+	{
+		NetSnapshotClear(&h->Snapshots[i]);
+	}
+}
+
+const NetSnapshot *NetSnapshotHistoryGet(
+	const NetSnapshotHistory *h, const uint32_t seq)
+{
+	if (seq == 0)
+	{
+		return NULL;
+	}
+	const NetSnapshot *s = &h->Snapshots[seq % NET_SNAPSHOT_HISTORY];
+	return s->Seq == seq ? s : NULL;
+}
+
+void NetSnapshotHistoryAdd(NetSnapshotHistory *h, const NetSnapshot *s)
+{
+	NetSnapshotCopy(&h->Snapshots[s->Seq % NET_SNAPSHOT_HISTORY], s);
+}
@@ -0,0 +1,116 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "c_array.h"
+
+// Snapshots of world state for net clients, as flat integer fields per
+// entity, so that they can be sent as field-level deltas against a
+// snapshot the client already has (its baseline).
+// Delta format, all varints:
+// - seq, baseline seq (0 for the empty baseline), flags
+// - records in entity order, each:
+//   - op | kind << 2, UID
+//   - for changes and adds: mask of fields, then each field in the mask
+//     (for changes, the zigzag difference; for adds, the zigzag value)
+#define NET_SNAPSHOT_FIELDS 12
+// Snapshots kept as possible baselines; a client that hasn't acked any
+// of these gets a delta against the empty baseline
+#define NET_SNAPSHOT_HISTORY 16
+// Flag: the snapshot is for a client joining, so missing entities should be
+// added; sent reliably, in order with other messages
+#define NET_SNAPSHOT_JOIN 1
+
+typedef enum
+{
+	NET_SNAPSHOT_ACTOR,
+	NET_SNAPSHOT_OBJECT,
+	NET_SNAPSHOT_PICKUP
+} NetSnapshotKind;
+
+typedef struct
+{
+	uint32_t Kind;
+	uint32_t UID;
+	int32_t Fields[NET_SNAPSHOT_FIELDS];
+} NetSnapshotEntity;
+
+typedef struct
+{
+	uint32_t Seq;	// 0 is the empty baseline
+	CArray Entities;	// of NetSnapshotEntity, by kind then UID
+} NetSnapshot;
+
+void NetSnapshotInit(NetSnapshot *s);
+void NetSnapshotTerminate(NetSnapshot *s);
+void NetSnapshotClear(NetSnapshot *s);
+void NetSnapshotCopy(NetSnapshot *dst, const NetSnapshot *src);
+// Add a zeroed entity; sort once all are added
+NetSnapshotEntity *NetSnapshotAdd(
+	NetSnapshot *s, const NetSnapshotKind kind, const uint32_t uid);
+void NetSnapshotSort(NetSnapshot *s);
+// NULL if not found
+const NetSnapshotEntity *NetSnapshotFind(
+	const NetSnapshot *s, const NetSnapshotKind kind, const uint32_t uid);
+// Entities of a kind in prev but not in s, e.g. actors that have left a
+// client's view, copied into out (of NetSnapshotEntity, cleared first)
+void NetSnapshotGetRemoved(
+	CArray *out, const NetSnapshot *s, const NetSnapshot *prev,
+	const NetSnapshotKind kind);
+
+// Encode s as a delta against base, which may be NULL for empty, into out
+// (of uint8_t, cleared first)
+void NetSnapshotEncode(
+	CArray *out, const NetSnapshot *s, const NetSnapshot *base,
+	const uint32_t flags);
+bool NetSnapshotReadHeader(
+	uint8_t *data, const size_t len,
+	uint32_t *seq, uint32_t *baseSeq, uint32_t *flags);
+// Decode a delta against base, which may be NULL for empty, into s
+// Returns false if it is malformed or base is not its baseline.
+bool NetSnapshotDecode(
+	NetSnapshot *s, const NetSnapshot *base, uint8_t *data, const size_t len);
+
+// Ring of recent snapshots by seq
+typedef struct
+{
+	NetSnapshot Snapshots[NET_SNAPSHOT_HISTORY];
+} NetSnapshotHistory;
+
+void NetSnapshotHistoryInit(NetSnapshotHistory *h);
+void NetSnapshotHistoryTerminate(NetSnapshotHistory *h);
+void NetSnapshotHistoryClear(NetSnapshotHistory *h);
+// NULL if not kept
+const NetSnapshot *NetSnapshotHistoryGet(
+	const NetSnapshotHistory *h, const uint32_t seq);
+// Keep a copy of a snapshot, replacing the oldest
+void NetSnapshotHistoryAdd(NetSnapshotHistory *h, const NetSnapshot *s);
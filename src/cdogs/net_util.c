@@ -31,28 +31,386 @@
 #include "proto/nanopb/pb_decode.h"
 #include "proto/nanopb/pb_encode.h"
 
+#include "actors.h"
+#include "map_object.h"
+#include "objs.h"
+#include "pickup.h"
 
-ENetPacket *NetEncode(const GameEventType e, const void *data)
+
+// Snapshot fields, per kind
+enum
+{
+	ACTOR_POS_X,
+	ACTOR_POS_Y,
+	ACTOR_VEL_X,
+	ACTOR_VEL_Y,
+	ACTOR_DIR,
+	ACTOR_STATE,
+	ACTOR_GUN_STATE,
+	ACTOR_HEALTH,
+	ACTOR_CHAR_ID,
+	ACTOR_PLAYER_UID,
+	ACTOR_FLAGS
+};
+enum
+{
+	OBJECT_POS_X,
+	OBJECT_POS_Y,
+	OBJECT_CLASS,
+	OBJECT_FLAGS,
+	OBJECT_HEALTH
+};
+enum
+{
+	PICKUP_POS_X,
+	PICKUP_POS_Y,
+	PICKUP_CLASS,
+	PICKUP_FLAGS,
+	PICKUP_IS_RANDOM_SPAWNED,
+	PICKUP_SPAWNER_UID
+};
+
+void NetSnapshotMakeWorld(NetSnapshot *s)
+{
+	NetSnapshotClear(s);
+	SLOT_POOL_FOREACH(const TActor, a, gActorSlots)
+		int32_t *f = NetSnapshotAdd(s, NET_SNAPSHOT_ACTOR, a->uid)->Fields;
+		f[ACTOR_POS_X] = a->Pos.x;
+		f[ACTOR_POS_Y] = a->Pos.y;
+		f[ACTOR_VEL_X] = a->MoveVel.x;
+		f[ACTOR_VEL_Y] = a->MoveVel.y;
+		f[ACTOR_DIR] = (int32_t)a->direction;
+		f[ACTOR_STATE] = (int32_t)a->anim.Type;
+		f[ACTOR_GUN_STATE] = (int32_t)ActorGetGun(a)->state;
+		f[ACTOR_HEALTH] = a->health;
+		f[ACTOR_CHAR_ID] = a->charId;
+		f[ACTOR_PLAYER_UID] = a->PlayerUID;
+		f[ACTOR_FLAGS] = a->tileItem.flags;
+	SLOT_POOL_FOREACH_END()
+	SLOT_POOL_FOREACH(const TObject, o, gObjSlots)
+		int32_t *f = NetSnapshotAdd(s, NET_SNAPSHOT_OBJECT, o->uid)->Fields;
+		f[OBJECT_POS_X] = o->tileItem.x;
+		f[OBJECT_POS_Y] = o->tileItem.y;
+		f[OBJECT_CLASS] = MapObjectIndex(o->Class);
+		f[OBJECT_FLAGS] = o->tileItem.flags;
+		f[OBJECT_HEALTH] = o->Health;
+	SLOT_POOL_FOREACH_END()
+	CA_FOREACH(const Pickup, p, gPickups)
+		if (!p->isInUse) continue;
+		int32_t *f = NetSnapshotAdd(s, NET_SNAPSHOT_PICKUP, p->UID)->Fields;
+		f[PICKUP_POS_X] = p->tileItem.x;
+		f[PICKUP_POS_Y] = p->tileItem.y;
+		f[PICKUP_CLASS] = StrPickupClassId(p->class->Name);
+		f[PICKUP_FLAGS] = p->tileItem.flags;
+		f[PICKUP_IS_RANDOM_SPAWNED] = p->IsRandomSpawned;
+		f[PICKUP_SPAWNER_UID] = p->SpawnerUID;
+	CA_FOREACH_END()
+	NetSnapshotSort(s);
+}
+
+bool NetIsInView(
+	const Vec2i *views, const int numViews, const Vec2i extent,
+	const Vec2i pos)
+{
+	for (int i = 0; i < numViews; i++)
+	{
+		const Vec2i d = Vec2iMinus(pos, views[i]);
+		if (abs(d.x) <= extent.x && abs(d.y) <= extent.y)
+		{
+			return true;
+		}
+	}
+	return numViews == 0;
+}
+
+void NetSnapshotFilter(
+	NetSnapshot *dst, const NetSnapshot *world,
+	const Vec2i *views, const int numViews, const Vec2i extent)
+{
+	NetSnapshotClear(dst);
+	dst->Seq = world->Seq;
+	// The world is sorted, so the copy is too
+	CA_FOREACH(const NetSnapshotEntity, e, world->Entities)
+		if (e->Kind == NET_SNAPSHOT_ACTOR &&
+			!NetIsInView(
+				views, numViews, extent,
+				Vec2iFull2Real(Vec2iNew(
+					e->Fields[ACTOR_POS_X], e->Fields[ACTOR_POS_Y]))))
+		{
+			continue;
+		}
+		CArrayPushBack(&dst->Entities, e);
+	CA_FOREACH_END()
+}
+
+// Events from snapshots came from the server; committing them passes
+// nothing on, since they are never for local players
+static void ApplyActor(
+	const NetSnapshotEntity *e, const NetSnapshotEntity *prev,
+	const bool join);
+static void StopActor(const NetSnapshotEntity *prev);
+static void ApplyObject(const NetSnapshotEntity *e);
+static void ApplyPickup(const NetSnapshotEntity *e);
+void NetSnapshotApply(
+	const NetSnapshot *s, const NetSnapshot *prev, const bool join)
+{
+	CA_FOREACH(const NetSnapshotEntity, e, s->Entities)
+		switch (e->Kind)
+		{
+		case NET_SNAPSHOT_ACTOR:
+			ApplyActor(
+				e,
+				prev != NULL ?
+				NetSnapshotFind(prev, NET_SNAPSHOT_ACTOR, e->UID) : NULL,
+				join);
+			break;
+		case NET_SNAPSHOT_OBJECT:
+			// Objects and pickups only change through reliable events
+			if (join) ApplyObject(e);
+			break;
+		case NET_SNAPSHOT_PICKUP:
+			if (join) ApplyPickup(e);
+			break;
+		default:
+			CASSERT(false, "unknown snapshot entity kind");
+			break;
+		}
+	CA_FOREACH_END()
+
+	// Actors that have left our view are no longer updated, so stop them
+	// where they were last seen rather than extrapolating them forever
+	if (prev != NULL && !join)
+	{
+		CArray removed;
+		CArrayInit(&removed, sizeof(NetSnapshotEntity));
+		NetSnapshotGetRemoved(&removed, s, prev, NET_SNAPSHOT_ACTOR);
+		CA_FOREACH(const NetSnapshotEntity, e, removed)
+			StopActor(e);
+		CA_FOREACH_END()
+		CArrayTerminate(&removed);
+	}
+}
+static void ApplyActor(
+	const NetSnapshotEntity *e, const NetSnapshotEntity *prev,
+	const bool join)
 {
-	uint8_t buffer[1024];
-	pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof buffer);
+	const int32_t *f = e->Fields;
+	const TActor *a = ActorGetByUID((int)e->UID);
+	if (a != NULL && !a->isInUse)
+	{
+		a = NULL;
+	}
+	if (a == NULL)
+	{
+		if (!join) return;
+		GameEvent *ev = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_ADD);
+		ev->u.ActorAdd.UID = e->UID;
+		ev->u.ActorAdd.CharId = (uint32_t)f[ACTOR_CHAR_ID];
+		ev->u.ActorAdd.Direction = f[ACTOR_DIR];
+		ev->u.ActorAdd.Health = f[ACTOR_HEALTH];
+		ev->u.ActorAdd.PlayerUID = f[ACTOR_PLAYER_UID];
+		ev->u.ActorAdd.TileItemFlags = (uint32_t)f[ACTOR_FLAGS];
+		ev->u.ActorAdd.FullPos.x = f[ACTOR_POS_X];
+		ev->u.ActorAdd.FullPos.y = f[ACTOR_POS_Y];
+		GameEventsCommit(&gGameEvents, ev);
+		prev = NULL;
+	}
+	// Local players are ours to move
+	if (PlayerIsLocal(f[ACTOR_PLAYER_UID]))
+	{
+		return;
+	}
+
+	// Positions are extrapolated locally, so only send them on when they
+	// change on the server; the rest only change when told to
+	if (prev == NULL ||
+		f[ACTOR_POS_X] != prev->Fields[ACTOR_POS_X] ||
+		f[ACTOR_POS_Y] != prev->Fields[ACTOR_POS_Y] ||
+		f[ACTOR_VEL_X] != prev->Fields[ACTOR_VEL_X] ||
+		f[ACTOR_VEL_Y] != prev->Fields[ACTOR_VEL_Y])
+	{
+		GameEvent *ev = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_MOVE);
+		ev->u.ActorMove.UID = e->UID;
+		ev->u.ActorMove.Pos.x = f[ACTOR_POS_X];
+		ev->u.ActorMove.Pos.y = f[ACTOR_POS_Y];
+		ev->u.ActorMove.MoveVel.x = f[ACTOR_VEL_X];
+		ev->u.ActorMove.MoveVel.y = f[ACTOR_VEL_Y];
+		GameEventsCommit(&gGameEvents, ev);
+	}
+	if (a == NULL || f[ACTOR_DIR] != (int32_t)a->direction)
+	{
+		GameEvent *ev = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_DIR);
+		ev->u.ActorDir.UID = e->UID;
+		ev->u.ActorDir.Dir = f[ACTOR_DIR];
+		GameEventsCommit(&gGameEvents, ev);
+	}
+	if (a == NULL || f[ACTOR_STATE] != (int32_t)a->anim.Type)
+	{
+		GameEvent *ev = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_STATE);
+		ev->u.ActorState.UID = e->UID;
+		ev->u.ActorState.State = f[ACTOR_STATE];
+		GameEventsCommit(&gGameEvents, ev);
+	}
+	if (a == NULL || f[ACTOR_GUN_STATE] != (int32_t)ActorGetGun(a)->state)
+	{
+		GameEvent *ev = GameEventsAdd(&gGameEvents, GAME_EVENT_GUN_STATE);
+		ev->u.GunState.ActorUID = e->UID;
+		ev->u.GunState.State = f[ACTOR_GUN_STATE];
+		GameEventsCommit(&gGameEvents, ev);
+	}
+}
+static void StopActor(const NetSnapshotEntity *prev)
+{
+	const int32_t *f = prev->Fields;
+	const TActor *a = ActorGetByUID((int)prev->UID);
+	if (a == NULL || !a->isInUse || PlayerIsLocal(f[ACTOR_PLAYER_UID]))
+	{
+		return;
+	}
+	GameEvent *ev = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_MOVE);
+	ev->u.ActorMove.UID = prev->UID;
+	ev->u.ActorMove.Pos.x = f[ACTOR_POS_X];
+	ev->u.ActorMove.Pos.y = f[ACTOR_POS_Y];
+	ev->u.ActorMove.MoveVel.x = 0;
+	ev->u.ActorMove.MoveVel.y = 0;
+	GameEventsCommit(&gGameEvents, ev);
+}
+static void ApplyObject(const NetSnapshotEntity *e)
+{
+	const TObject *o = ObjTryGetByUID((int)e->UID);
+	if (o != NULL && o->isInUse) return;
+	const int32_t *f = e->Fields;
+	GameEvent *ev = GameEventsAdd(&gGameEvents, GAME_EVENT_MAP_OBJECT_ADD);
+	NMapObjectAdd *amo = &ev->u.MapObjectAdd;
+	amo->UID = e->UID;
+	strcpy(amo->MapObjectClass, IndexMapObject(f[OBJECT_CLASS])->Name);
+	amo->Pos.x = f[OBJECT_POS_X];
+	amo->Pos.y = f[OBJECT_POS_Y];
+	amo->TileItemFlags = (uint32_t)f[OBJECT_FLAGS];
+	amo->Health = f[OBJECT_HEALTH];
+	GameEventsCommit(&gGameEvents, ev);
+}
+static void ApplyPickup(const NetSnapshotEntity *e)
+{
+	const Pickup *p = PickupGetByUID((int)e->UID);
+	if (p != NULL && p->isInUse) return;
+	const int32_t *f = e->Fields;
+	GameEvent *ev = GameEventsAdd(&gGameEvents, GAME_EVENT_ADD_PICKUP);
+	NAddPickup *ap = &ev->u.AddPickup;
+	ap->UID = e->UID;
+	strcpy(
+		ap->PickupClass,
+		PickupClassGetById(&gPickupClasses, f[PICKUP_CLASS])->Name);
+	ap->IsRandomSpawned = f[PICKUP_IS_RANDOM_SPAWNED];
+	ap->SpawnerUID = f[PICKUP_SPAWNER_UID];
+	ap->TileItemFlags = (uint32_t)f[PICKUP_FLAGS];
+	ap->Pos.x = f[PICKUP_POS_X];
+	ap->Pos.y = f[PICKUP_POS_Y];
+	GameEventsCommit(&gGameEvents, ev);
+}
+
+size_t NetEncode(const GameEventType e, const void *data, uint8_t *buf)
+{
+	pb_ostream_t stream = pb_ostream_from_buffer(buf, NET_MSG_MAX_SIZE);
 	const pb_field_t *fields = GameEventGetEntry(e).Fields;
 	const bool status =
 		(data && fields) ? pb_encode(&stream, fields, data) : true;
 	CASSERT(status, "Failed to encode pb");
-	int msgId = (int)e;
-	ENetPacket *packet = enet_packet_create(
-		&msgId, NET_MSG_SIZE + stream.bytes_written,
-		ENET_PACKET_FLAG_RELIABLE);
-	memcpy(packet->data + NET_MSG_SIZE, buffer, stream.bytes_written);
-	return packet;
+	return stream.bytes_written;
+}
+
+void NetOutboxInit(NetOutbox *o)
+{
+	NetBatchInit(&o->Batch);
+	NetLatestInit(&o->Latest);
+	CArrayInit(&o->Snapshot, sizeof(uint8_t));
+}
+void NetOutboxTerminate(NetOutbox *o)
+{
+	NetBatchTerminate(&o->Batch);
+	NetLatestTerminate(&o->Latest);
+	CArrayTerminate(&o->Snapshot);
+}
+void NetOutboxClear(NetOutbox *o)
+{
+	NetBatchClear(&o->Batch);
+	NetLatestClear(&o->Latest);
+	CArrayClear(&o->Snapshot);
+}
+
+// Send the frame being filled, if any
+static void SendFrame(
+	NetBatch *b, ENetPeer *peer, NetStats *stats,
+	const enet_uint8 channel, const enet_uint32 flags)
+{
+	if (NetBatchIsEmpty(b))
+	{
+		return;
+	}
+	ENetPacket *packet =
+		enet_packet_create(b->Data.data, b->Data.size, flags);
+	stats->Packets++;
+	stats->Msgs += b->Msgs;
+	NetBatchClear(b);
+	stats->Bytes += packet->dataLength;
+	enet_peer_send(peer, channel, packet);
+}
+
+void NetOutboxAdd(
+	NetOutbox *o, ENetPeer *peer, NetStats *stats,
+	const GameEventType e, const void *data,
+	const uint8_t *buf, const size_t len)
+{
+	if (GameEventGetEntry(e).Delivery == NET_DELIVERY_LATEST)
+	{
+		NetLatestSet(
+			&o->Latest, (uint32_t)e, GameEventLatestUID(e, data), buf, len);
+		return;
+	}
+	if (!NetBatchHasRoom(&o->Batch, (uint32_t)e, len))
+	{
+		SendFrame(
+			&o->Batch, peer, stats,
+			NET_CHANNEL_RELIABLE, ENET_PACKET_FLAG_RELIABLE);
+	}
+	NetBatchAdd(&o->Batch, (uint32_t)e, buf, len);
+}
+
+void NetOutboxFlush(NetOutbox *o, ENetPeer *peer, NetStats *stats)
+{
+	SendFrame(
+		&o->Batch, peer, stats,
+		NET_CHANNEL_RELIABLE, ENET_PACKET_FLAG_RELIABLE);
+	// The latest state goes out after the reliable messages, using the
+	// same batch for framing; if a frame is lost its state is just stale
+	// until the next tick's
+	CA_FOREACH(const NetLatestMsg, m, o->Latest.Msgs)
+		if (!NetBatchHasRoom(&o->Batch, m->Msg, m->Len))
+		{
+			SendFrame(&o->Batch, peer, stats, NET_CHANNEL_LATEST, 0);
+		}
+		NetBatchAdd(&o->Batch, m->Msg, m->Data, m->Len);
+	CA_FOREACH_END()
+	SendFrame(&o->Batch, peer, stats, NET_CHANNEL_LATEST, 0);
+	NetLatestClear(&o->Latest);
+	// Snapshots can be bigger than a frame; if any fragment is lost, the
+	// client just waits for the next one
+	if (o->Snapshot.size > 0)
+	{
+		NetBatchAdd(
+			&o->Batch, GAME_EVENT_SNAPSHOT, o->Snapshot.data, o->Snapshot.size);
+		SendFrame(
+			&o->Batch, peer, stats,
+			NET_CHANNEL_LATEST, ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
+		CArrayClear(&o->Snapshot);
+	}
 }
 
 bool NetDecode(
-	ENetPacket *packet, void *dest, const pb_field_t *fields)
+	uint8_t *data, const size_t len, void *dest,
+	const pb_field_t *fields)
 {
-	pb_istream_t stream = pb_istream_from_buffer(
-		packet->data + NET_MSG_SIZE, packet->dataLength - NET_MSG_SIZE);
+	pb_istream_t stream = pb_istream_from_buffer(data, len);
 	bool status = pb_decode(&stream, fields, dest);
 	CASSERT(status, "Failed to decode pb");
 	return status;
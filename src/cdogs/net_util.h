@@ -35,6 +35,8 @@
 
 #include "campaigns.h"
 #include "game_events.h"
+#include "net_batch.h"
+#include "net_snapshot.h"
 #include "player.h"
 
 #define NET_PORT 34219
@@ -46,14 +48,63 @@
 	((_ip) >> 16) & 0xFF, \
 	((_ip) >> 24) & 0xFF
 
+// Channels; see NetDelivery
+#define NET_CHANNEL_RELIABLE 0
+// Unreliable sequenced: ENet drops packets older than one already received
+#define NET_CHANNEL_LATEST 1
+#define NET_CHANNELS 2
+
 // Messages
 
-// All messages start with 4 bytes message type followed by the message struct
-#define NET_MSG_SIZE sizeof(uint32_t)
+// Messages are batched into frames; see net_batch.h
+#define NET_MSG_MAX_SIZE 1024
+
+// Outgoing messages for a connection, until they are flushed
+typedef struct
+{
+	NetBatch Batch;	// reliable messages, in order
+	NetLatest Latest;	// latest state per entity
+	CArray Snapshot;	// of uint8_t; latest world state delta, if any
+} NetOutbox;
+
+void NetOutboxInit(NetOutbox *o);
+void NetOutboxTerminate(NetOutbox *o);
+// Drop unsent messages
+void NetOutboxClear(NetOutbox *o);
+// Add an encoded message; data is its struct, buf its encoding
+// Reliable frames are sent to the peer as they fill up.
+void NetOutboxAdd(
+	NetOutbox *o, ENetPeer *peer, NetStats *stats,
+	const GameEventType e, const void *data,
+	const uint8_t *buf, const size_t len);
+// Send the reliable frame, then the latest state frames and the snapshot
+void NetOutboxFlush(NetOutbox *o, ENetPeer *peer, NetStats *stats);
 
+// Snapshot of the actors, map objects and pickups in the world
+void NetSnapshotMakeWorld(NetSnapshot *s);
+// Whether pos is within extent (either way) of any of the view centres;
+// with no views, e.g. a client whose players are all dead, everything is
+bool NetIsInView(
+	const Vec2i *views, const int numViews, const Vec2i extent,
+	const Vec2i pos);
+// Copy the world, leaving out actors that are not within extent (real
+// coordinates, either way) of any of the view centres
+void NetSnapshotFilter(
+	NetSnapshot *dst, const NetSnapshot *world,
+	const Vec2i *views, const int numViews, const Vec2i extent);
+// Queue game events to bring the world up to date with a snapshot, given
+// the one applied before it, if any
+// On join, entities missing from the world are added too; otherwise they
+// are left to the events that add them. Actors that were in prev but are
+// not in s, because they have left our view, are stopped.
+void NetSnapshotApply(
+	const NetSnapshot *s, const NetSnapshot *prev, const bool join);
 
-ENetPacket *NetEncode(const GameEventType e, const void *data);
-bool NetDecode(ENetPacket *packet, void *dest, const pb_field_t *fields);
+// Encode a message's struct into buf, of NET_MSG_MAX_SIZE; returns its length
+size_t NetEncode(const GameEventType e, const void *data, uint8_t *buf);
+bool NetDecode(
+	uint8_t *data, const size_t len, void *dest,
+	const pb_field_t *fields);
 
 NPlayerData NMakePlayerData(const PlayerData *p);
 NCampaignDef NMakeCampaignDef(const CampaignOptions *co);
@@ -68,12 +68,20 @@
 #include "gamedata.h"
 #include "mission.h"
 #include "game.h"
+#include "uid_map.h"
 #include "utils.h"
 
+static ConfigHandle sGameShotsPushback = CONFIG_HANDLE("Game.ShotsPushback");
+
 CArray gObjs;
 CArray gMobObjs;
+SlotPool gObjSlots;
+SlotPool gMobObjSlots;
 static unsigned int sObjUIDs = 0;
 static unsigned int sMobObjUIDs = 0;
+// Destroyed objects can still be found by UID until their slot is reused
+static UIDMap sObjIndices;
+static UIDMap sMobObjIndices;
 
 
 // Draw functions
@@ -118,10 +126,10 @@ static void DestroyObject(
 		// Extra score if objective
 		if ((o->tileItem.flags & TILEITEM_OBJECTIVE) && playerUID >= 0)
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_SCORE);
-			e.u.Score.PlayerUID = playerUID;
-			e.u.Score.Score = OBJECT_SCORE;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_SCORE);
+			e->u.Score.PlayerUID = playerUID;
+			e->u.Score.Score = OBJECT_SCORE;
+			GameEventsCommit(&gGameEvents, e);
 		}
 
 		// Weapons that go off when this object is destroyed
@@ -134,25 +142,28 @@ static void DestroyObject(
 
 		// A wreck left after the destruction of this object
 		// TODO: doesn't need to be network event
-		GameEvent e = GameEventNew(GAME_EVENT_ADD_BULLET);
-		e.u.AddBullet.UID = MobObjsObjsGetNextUID();
-		strcpy(e.u.AddBullet.BulletClass, "fireball_wreck");
-		e.u.AddBullet.MuzzlePos = Vec2i2Net(fullPos);
-		e.u.AddBullet.MuzzleHeight = 0;
-		e.u.AddBullet.Angle = 0;
-		e.u.AddBullet.Elevation = 0;
-		e.u.AddBullet.Flags = 0;
-		e.u.AddBullet.PlayerUID = -1;
-		e.u.AddBullet.ActorUID = -1;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ADD_BULLET);
+		e->u.AddBullet.UID = MobObjsObjsGetNextUID();
+		strcpy(e->u.AddBullet.BulletClass, "fireball_wreck");
+		e->u.AddBullet.MuzzlePos = Vec2i2Net(fullPos);
+		e->u.AddBullet.MuzzleHeight = 0;
+		e->u.AddBullet.Angle = 0;
+		e->u.AddBullet.Elevation = 0;
+		e->u.AddBullet.Flags = 0;
+		e->u.AddBullet.PlayerUID = -1;
+		e->u.AddBullet.ActorUID = -1;
+		GameEventsCommit(&gGameEvents, e);
 	}
 
 	SoundPlayAt(&gSoundDevice, gSoundDevice.wreckSound, realPos);
 
+	const Vec2i tile = Vec2iToTile(Vec2iNew(o->tileItem.x, o->tileItem.y));
+
 	// Turn the object into a wreck, if available
 	if (o->Class->Wreck.Pic)
 	{
 		o->tileItem.flags = TILEITEM_IS_WRECK;
+		MapUpdateTileItem(&gMap, &o->tileItem);
 	}
 	else
 	{
@@ -161,7 +172,7 @@ static void DestroyObject(
 
 	// Update pathfinding cache since this object could have blocked a path
 	// before
-	PathCacheClear(&gPathCache);
+	PathCacheInvalidateTile(&gPathCache, tile);
 }
 
 bool CanHit(const int flags, const int uid, const TTileItem *target)
@@ -229,13 +240,14 @@ void Damage(
 		break;
 	case KIND_OBJECT:
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_MAP_OBJECT_DAMAGE);
-			e.u.MapObjectDamage.UID = targetUID;
-			e.u.MapObjectDamage.Power = power;
-			e.u.MapObjectDamage.ActorUID = uid;
-			e.u.MapObjectDamage.PlayerUID = playerUID;
-			e.u.MapObjectDamage.Flags = flags;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e =
+				GameEventsAdd(&gGameEvents, GAME_EVENT_MAP_OBJECT_DAMAGE);
+			e->u.MapObjectDamage.UID = targetUID;
+			e->u.MapObjectDamage.Power = power;
+			e->u.MapObjectDamage.ActorUID = uid;
+			e->u.MapObjectDamage.PlayerUID = playerUID;
+			e->u.MapObjectDamage.Flags = flags;
+			GameEventsCommit(&gGameEvents, e);
 		}
 		break;
 	default:
@@ -256,27 +268,27 @@ static void DoDamageCharacter(
 	CASSERT(actor->isInUse, "Cannot damage nonexistent player");
 	CASSERT(CanHitCharacter(flags, uid, actor), "damaging undamageable actor");
 
-	if (ConfigGetBool(&gConfig, "Game.ShotsPushback"))
+	if (ConfigHandleGetBool(&sGameShotsPushback))
 	{
-		GameEvent ei = GameEventNew(GAME_EVENT_ACTOR_IMPULSE);
-		ei.u.ActorImpulse.UID = actor->uid;
-		ei.u.ActorImpulse.Vel = Vec2i2Net(Vec2iScaleDiv(
+		GameEvent *ei = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_IMPULSE);
+		ei->u.ActorImpulse.UID = actor->uid;
+		ei->u.ActorImpulse.Vel = Vec2i2Net(Vec2iScaleDiv(
 			Vec2iScale(hitVector, power), SHOT_IMPULSE_DIVISOR));
-		ei.u.ActorImpulse.Pos = Vec2i2Net(actor->Pos);
-		GameEventsEnqueue(&gGameEvents, ei);
+		ei->u.ActorImpulse.Pos = Vec2i2Net(actor->Pos);
+		GameEventsCommit(&gGameEvents, ei);
 	}
 
 	const bool canDamage =
 		CanDamageCharacter(flags, playerUID, uid, actor, special);
 
-	GameEvent e = GameEventNew(GAME_EVENT_ACTOR_HIT);
-	e.u.ActorHit.UID = actor->uid;
-	e.u.ActorHit.PlayerUID = actor->PlayerUID;
-	e.u.ActorHit.HitterPlayerUID = playerUID;
-	e.u.ActorHit.Special = special;
-	e.u.ActorHit.Power = canDamage ? power : 0;
-	e.u.ActorHit.Vel = Vec2i2Net(hitVector);
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_HIT);
+	e->u.ActorHit.UID = actor->uid;
+	e->u.ActorHit.PlayerUID = actor->PlayerUID;
+	e->u.ActorHit.HitterPlayerUID = playerUID;
+	e->u.ActorHit.Special = special;
+	e->u.ActorHit.Power = canDamage ? power : 0;
+	e->u.ActorHit.Vel = Vec2i2Net(hitVector);
+	GameEventsCommit(&gGameEvents, e);
 
 	if (canDamage)
 	{
@@ -288,17 +300,17 @@ static void DoDamageCharacter(
 		{
 			// Calculate score based on
 			// if they hit a penalty character
-			e = GameEventNew(GAME_EVENT_SCORE);
-			e.u.Score.PlayerUID = playerUID;
+			e = GameEventsAdd(&gGameEvents, GAME_EVENT_SCORE);
+			e->u.Score.PlayerUID = playerUID;
 			if (actor->flags & FLAGS_PENALTY)
 			{
-				e.u.Score.Score = PENALTY_MULTIPLIER * power;
+				e->u.Score.Score = PENALTY_MULTIPLIER * power;
 			}
 			else
 			{
-				e.u.Score.Score = power;
+				e->u.Score.Score = power;
 			}
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsCommit(&gGameEvents, e);
 		}
 	}
 }
@@ -306,22 +318,17 @@ static void DoDamageCharacter(
 
 void UpdateMobileObjects(int ticks)
 {
-	for (int i = 0; i < (int)gMobObjs.size; i++)
-	{
-		TMobileObject *obj = CArrayGet(&gMobObjs, i);
-		if (!obj->isInUse)
-		{
-			continue;
-		}
+	SLOT_POOL_FOREACH(TMobileObject, obj, gMobObjSlots)
 		if (!obj->updateFunc(obj, ticks) && !gCampaign.IsClient)
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_REMOVE_BULLET);
-			e.u.RemoveBullet.UID = obj->UID;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e =
+				GameEventsAdd(&gGameEvents, GAME_EVENT_REMOVE_BULLET);
+			e->u.RemoveBullet.UID = obj->UID;
+			GameEventsCommit(&gGameEvents, e);
 			continue;
 		}
 		CPicUpdate(&obj->tileItem.CPic, ticks);
-	}
+	SLOT_POOL_FOREACH_END()
 }
 
 
@@ -329,19 +336,18 @@ void ObjsInit(void)
 {
 	CArrayInit(&gObjs, sizeof(TObject));
 	CArrayReserve(&gObjs, 1024);
+	SlotPoolInit(&gObjSlots, &gObjs);
+	UIDMapInit(&sObjIndices);
 	sObjUIDs = 0;
 }
 void ObjsTerminate(void)
 {
-	for (int i = 0; i < (int)gObjs.size; i++)
-	{
-		TObject *o = CArrayGet(&gObjs, i);
-		if (o->isInUse)
-		{
-			ObjDestroy(i);
-		}
-	}
+	SLOT_POOL_FOREACH(TObject, o, gObjSlots)
+		ObjDestroy(o->tileItem.id);
+	SLOT_POOL_FOREACH_END()
 	CArrayTerminate(&gObjs);
+	SlotPoolTerminate(&gObjSlots);
+	UIDMapTerminate(&sObjIndices);
 }
 int ObjsGetNextUID(void)
 {
@@ -350,28 +356,12 @@ int ObjsGetNextUID(void)
 
 void ObjAdd(const NMapObjectAdd amo)
 {
-	// Find an empty slot in object list
-	TObject *o = NULL;
-	int i;
-	for (i = 0; i < (int)gObjs.size; i++)
-	{
-		TObject *obj = CArrayGet(&gObjs, i);
-		if (!obj->isInUse)
-		{
-			o = obj;
-			break;
-		}
-	}
-	if (o == NULL)
-	{
-		TObject obj;
-		memset(&obj, 0, sizeof obj);
-		CArrayPushBack(&gObjs, &obj);
-		i = (int)gObjs.size - 1;
-		o = CArrayGet(&gObjs, i);
-	}
+	const int i = SlotPoolAdd(&gObjSlots);
+	TObject *o = CArrayGet(&gObjs, i);
+	UIDMapRemoveIndex(&sObjIndices, o->uid, i);
 	memset(o, 0, sizeof *o);
 	o->uid = amo.UID;
+	UIDMapSet(&sObjIndices, o->uid, i);
 	o->Class = StrMapObject(amo.MapObjectClass);
 	o->Health = amo.Health;
 	o->tileItem.x = o->tileItem.y = -1;
@@ -383,6 +373,12 @@ void ObjAdd(const NMapObjectAdd amo)
 	o->tileItem.id = i;
 	MapTryMoveTileItem(&gMap, &o->tileItem, Net2Vec2i(amo.Pos));
 	o->isInUse = true;
+	if (ObjIsDangerous(o))
+	{
+		// AI avoid dangerous objects, so this may block paths
+		PathCacheInvalidateTile(
+			&gPathCache, Vec2iToTile(Net2Vec2i(amo.Pos)));
+	}
 }
 void ObjDestroy(int id)
 {
@@ -390,6 +386,7 @@ void ObjDestroy(int id)
 	CASSERT(o->isInUse, "Destroying in-use object");
 	MapRemoveTileItem(&gMap, &o->tileItem);
 	o->isInUse = false;
+	SlotPoolRemove(&gObjSlots, id);
 }
 
 bool ObjIsDangerous(const TObject *o)
@@ -400,13 +397,7 @@ bool ObjIsDangerous(const TObject *o)
 
 void UpdateObjects(const int ticks)
 {
-	for (int i = 0; i < (int)gObjs.size; i++)
-	{
-		TObject *obj = CArrayGet(&gObjs, i);
-		if (!obj->isInUse)
-		{
-			continue;
-		}
+	SLOT_POOL_FOREACH(TObject, obj, gObjSlots)
 		switch (obj->Class->Type)
 		{
 		case MAP_OBJECT_TYPE_PICKUP_SPAWNER:
@@ -422,38 +413,37 @@ void UpdateObjects(const int ticks)
 				// Deactivate spawner by setting counter to -1
 				// Spawner reactivated only when ammo taken
 				obj->counter = -1;
-				GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
-				e.u.AddPickup.UID = PickupsGetNextUID();
+				GameEvent *e =
+					GameEventsAdd(&gGameEvents, GAME_EVENT_ADD_PICKUP);
+				e->u.AddPickup.UID = PickupsGetNextUID();
 				strcpy(
-					e.u.AddPickup.PickupClass,
+					e->u.AddPickup.PickupClass,
 					obj->Class->u.PickupClass->Name);
-				e.u.AddPickup.IsRandomSpawned = false;
-				e.u.AddPickup.SpawnerUID = obj->uid;
-				e.u.AddPickup.TileItemFlags = 0;
-				e.u.AddPickup.Pos =
+				e->u.AddPickup.IsRandomSpawned = false;
+				e->u.AddPickup.SpawnerUID = obj->uid;
+				e->u.AddPickup.TileItemFlags = 0;
+				e->u.AddPickup.Pos =
 					Vec2i2Net(Vec2iNew(obj->tileItem.x, obj->tileItem.y));
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEventsCommit(&gGameEvents, e);
 			}
 			break;
 		default:
 			// Do nothing
 			break;
 		}
-	}
+	SLOT_POOL_FOREACH_END()
 }
 
 TObject *ObjGetByUID(const int uid)
 {
-	for (int i = 0; i < (int)gObjs.size; i++)
-	{
-		TObject *o = CArrayGet(&gObjs, i);
-		if (o->uid == uid)
-		{
-			return o;
-		}
-	}
-	CASSERT(false, "Cannot find object by UID");
-	return NULL;
+	TObject *o = ObjTryGetByUID(uid);
+	CASSERT(o != NULL, "Cannot find object by UID");
+	return o;
+}
+TObject *ObjTryGetByUID(const int uid)
+{
+	const int id = UIDMapGet(&sObjIndices, uid);
+	return id >= 0 ? CArrayGet(&gObjs, id) : NULL;
 }
 
 
@@ -461,39 +451,43 @@ void MobObjsInit(void)
 {
 	CArrayInit(&gMobObjs, sizeof(TMobileObject));
 	CArrayReserve(&gMobObjs, 1024);
+	SlotPoolInit(&gMobObjSlots, &gMobObjs);
+	UIDMapInit(&sMobObjIndices);
 	sMobObjUIDs = 0;
 }
 void MobObjsTerminate(void)
 {
-	for (int i = 0; i < (int)gMobObjs.size; i++)
-	{
-		TMobileObject *m = CArrayGet(&gMobObjs, i);
-		if (m->isInUse)
-		{
-			MobObjDestroy(m);
-		}
-	}
+	SLOT_POOL_FOREACH(TMobileObject, m, gMobObjSlots)
+		MobObjDestroy(m);
+	SLOT_POOL_FOREACH_END()
 	CArrayTerminate(&gMobObjs);
+	SlotPoolTerminate(&gMobObjSlots);
+	UIDMapTerminate(&sMobObjIndices);
 }
 int MobObjsObjsGetNextUID(void)
 {
 	return sMobObjUIDs++;
 }
+TMobileObject *MobObjAdd(const int uid)
+{
+	const int i = SlotPoolAdd(&gMobObjSlots);
+	TMobileObject *m = CArrayGet(&gMobObjs, i);
+	UIDMapRemoveIndex(&sMobObjIndices, m->UID, i);
+	memset(m, 0, sizeof *m);
+	m->UID = uid;
+	m->tileItem.id = i;
+	UIDMapSet(&sMobObjIndices, uid, i);
+	return m;
+}
 TMobileObject *MobObjGetByUID(const int uid)
 {
-	for (int i = 0; i < (int)gMobObjs.size; i++)
-	{
-		TMobileObject *o = CArrayGet(&gMobObjs, i);
-		if (o->UID == uid)
-		{
-			return o;
-		}
-	}
-	return NULL;
+	const int id = UIDMapGet(&sMobObjIndices, uid);
+	return id >= 0 ? CArrayGet(&gMobObjs, id) : NULL;
 }
 void MobObjDestroy(TMobileObject *m)
 {
 	CASSERT(m->isInUse, "Destroying not-in-use mobobj");
 	MapRemoveTileItem(&gMap, &m->tileItem);
 	m->isInUse = false;
+	SlotPoolRemove(&gMobObjSlots, m->tileItem.id);
 }
@@ -96,6 +96,8 @@ typedef struct MobileObject
 typedef int (*MobObjUpdateFunc)(TMobileObject *, int);
 extern CArray gMobObjs;	// of TMobileObject
 extern CArray gObjs;	// of TObject
+extern SlotPool gMobObjSlots;	// live slots of gMobObjs
+extern SlotPool gObjSlots;	// live slots of gObjs
 
 
 bool CanHit(const int flags, const int uid, const TTileItem *target);
@@ -125,6 +127,8 @@ bool ObjIsDangerous(const TObject *o);
 void UpdateObjects(const int ticks);
 
 TObject *ObjGetByUID(const int uid);
+// As above, but NULL if there is no such object
+TObject *ObjTryGetByUID(const int uid);
 
 void DamageObject(const NMapObjectDamage mod);
 
@@ -132,5 +136,7 @@ void UpdateMobileObjects(int ticks);
 void MobObjsInit(void);
 void MobObjsTerminate(void);
 int MobObjsObjsGetNextUID(void);
+// Get a cleared mobobj in a free slot, with its UID and tile item id set
+TMobileObject *MobObjAdd(const int uid);
 TMobileObject *MobObjGetByUID(const int uid);
 void MobObjDestroy(TMobileObject *m);
@@ -32,17 +32,27 @@
 #include "json_utils.h"
 #include "objs.h"
 
+static ConfigHandle sGameGore = CONFIG_HANDLE("Game.Gore");
+static ConfigHandle sGameShotsPushback = CONFIG_HANDLE("Game.ShotsPushback");
+
 
 ParticleClasses gParticleClasses;
 CArray gParticles;
+SlotPool gParticleSlots;
 
 #define VERSION 1
 
 static void LoadParticleClass(ParticleClass *c, json_t *node);
+static const char *ParticleClassGetName(const void *c)
+{
+	return ((const ParticleClass *)c)->Name;
+}
 void ParticleClassesInit(ParticleClasses *classes, const char *filename)
 {
 	CArrayInit(&classes->Classes, sizeof(ParticleClass));
 	CArrayInit(&classes->CustomClasses, sizeof(ParticleClass));
+	NameIndexInit(&classes->ClassIndex, ParticleClassGetName);
+	NameIndexInit(&classes->CustomClassIndex, ParticleClassGetName);
 
 	FILE *f = fopen(filename, "r");
 	json_t *root = NULL;
@@ -90,6 +100,8 @@ void ParticleClassesTerminate(ParticleClasses *classes)
 	CArrayTerminate(&classes->Classes);
 	ParticleClassesClear(&classes->CustomClasses);
 	CArrayTerminate(&classes->CustomClasses);
+	NameIndexTerminate(&classes->ClassIndex);
+	NameIndexTerminate(&classes->CustomClassIndex);
 }
 void ParticleClassesClear(CArray *classes)
 {
@@ -100,6 +112,11 @@ void ParticleClassesClear(CArray *classes)
 	}
 	CArrayClear(classes);
 }
+void ParticleClassesClearCustom(ParticleClasses *classes)
+{
+	ParticleClassesClear(&classes->CustomClasses);
+	NameIndexClear(&classes->CustomClassIndex);
+}
 static void LoadParticleClass(ParticleClass *c, json_t *node)
 {
 	memset(c, 0, sizeof *c);
@@ -145,27 +162,22 @@ static void LoadParticleClass(ParticleClass *c, json_t *node)
 }
 
 const ParticleClass *StrParticleClass(
-	const ParticleClasses *classes, const char *name)
+	ParticleClasses *classes, const char *name)
 {
 	if (name == NULL || strlen(name) == 0)
 	{
 		return NULL;
 	}
-	for (int i = 0; i < (int)classes->CustomClasses.size; i++)
+	// Custom classes shadow built-in ones
+	const ParticleClass *c = NameIndexGet(
+		&classes->CustomClassIndex, &classes->CustomClasses, name);
+	if (c == NULL)
 	{
-		const ParticleClass *c = CArrayGet(&classes->CustomClasses, i);
-		if (strcmp(c->Name, name) == 0)
-		{
-			return c;
-		}
+		c = NameIndexGet(&classes->ClassIndex, &classes->Classes, name);
 	}
-	for (int i = 0; i < (int)classes->Classes.size; i++)
+	if (c != NULL)
 	{
-		const ParticleClass *c = CArrayGet(&classes->Classes, i);
-		if (strcmp(c->Name, name) == 0)
-		{
-			return c;
-		}
+		return c;
 	}
 	CASSERT(false, "Cannot find particle class");
 	return NULL;
@@ -175,37 +187,35 @@ void ParticlesInit(CArray *particles)
 {
 	CArrayInit(particles, sizeof(Particle));
 	CArrayReserve(particles, 256);
+	SlotPoolInit(&gParticleSlots, particles);
 }
 void ParticlesTerminate(CArray *particles)
 {
-	for (int i = 0; i < (int)particles->size; i++)
+	for (int i = SlotPoolNext(&gParticleSlots, 0);
+		i >= 0;
+		i = SlotPoolNext(&gParticleSlots, i + 1))
 	{
-		Particle *p = CArrayGet(particles, i);
-		if (p->isInUse)
-		{
-			ParticleDestroy(particles, i);
-		}
+		ParticleDestroy(particles, i);
 	}
 	CArrayTerminate(particles);
+	SlotPoolTerminate(&gParticleSlots);
 }
 
 static bool ParticleUpdate(Particle *p, const int ticks);
 void ParticlesUpdate(CArray *particles, const int ticks)
 {
-	for (int i = 0; i < (int)particles->size; i++)
-	{
-		Particle *p = CArrayGet(particles, i);
-		if (!p->isInUse)
-		{
-			continue;
-		}
+	CASSERT(particles == gParticleSlots.Items, "unknown particles array");
+	SLOT_POOL_FOREACH(Particle, p, gParticleSlots)
 		if (!ParticleUpdate(p, ticks))
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_PARTICLE_REMOVE);
-			e.u.ParticleRemoveId = i;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e =
+				GameEventsAdd(&gGameEvents, GAME_EVENT_PARTICLE_REMOVE);
+			e->u.ParticleRemove.Id = i;
+			e->u.ParticleRemove.Generation =
+				SlotPoolGetGeneration(&gParticleSlots, i);
+			GameEventsCommit(&gGameEvents, e);
 		}
-	}
+	SLOT_POOL_FOREACH_END()
 }
 
 
@@ -241,6 +251,7 @@ static bool ParticleUpdate(Particle *p, const int ticks)
 				p->Spin = 0;
 				// Set as wreck so that it gets drawn last
 				p->tileItem.flags |= TILEITEM_IS_WRECK;
+				MapUpdateTileItem(&gMap, &p->tileItem);
 			}
 		}
 	}
@@ -285,27 +296,9 @@ static bool ParticleUpdate(Particle *p, const int ticks)
 static void DrawParticle(const Vec2i pos, const TileItemDrawFuncData *data);
 int ParticleAdd(CArray *particles, const AddParticle add)
 {
-	// Find an empty slot in list
-	Particle *p = NULL;
-	int i;
-	for (i = 0; i < (int)particles->size; i++)
-	{
-		Particle *pSlot = CArrayGet(particles, i);
-		if (!pSlot->isInUse)
-		{
-			p = pSlot;
-			break;
-		}
-	}
-	// If no empty slots, add a new one
-	if (p == NULL)
-	{
-		Particle pNew;
-		memset(&pNew, 0, sizeof pNew);
-		CArrayPushBack(particles, &pNew);
-		i = (int)particles->size - 1;
-		p = CArrayGet(particles, i);
-	}
+	CASSERT(particles == gParticleSlots.Items, "unknown particles array");
+	const int i = SlotPoolAdd(&gParticleSlots);
+	Particle *p = CArrayGet(particles, i);
 	memset(p, 0, sizeof *p);
 	p->Class = add.Class;
 	p->Pos = add.FullPos;
@@ -330,6 +323,7 @@ void ParticleDestroy(CArray *particles, const int id)
 	CASSERT(p->isInUse, "Destroying not-in-use particle");
 	MapRemoveTileItem(&gMap, &p->tileItem);
 	p->isInUse = false;
+	SlotPoolRemove(&gParticleSlots, id);
 }
 
 static void DrawParticle(const Vec2i pos, const TileItemDrawFuncData *data)
@@ -361,28 +355,28 @@ static void DrawParticle(const Vec2i pos, const TileItemDrawFuncData *data)
 void AddBloodSplatter(
 	const Vec2i fullPos, const int power, const Vec2i hitVector)
 {
-	const GoreAmount ga = ConfigGetEnum(&gConfig, "Game.Gore");
+	const GoreAmount ga = ConfigHandleGetEnum(&sGameGore);
 	if (ga == GORE_NONE) return;
 
-	GameEvent e = GameEventNew(GAME_EVENT_ADD_PARTICLE);
-	e.u.AddParticle.FullPos = fullPos;
-	e.u.AddParticle.Z = 10 * Z_FACTOR;
 	int bloodPower = power * 2;
 	int bloodSize = 1;
 	while (bloodPower > 0)
 	{
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ADD_PARTICLE);
+		e->u.AddParticle.FullPos = fullPos;
+		e->u.AddParticle.Z = 10 * Z_FACTOR;
 		switch (bloodSize)
 		{
 		case 1:
-			e.u.AddParticle.Class =
+			e->u.AddParticle.Class =
 				StrParticleClass(&gParticleClasses, "blood1");
 			break;
 		case 2:
-			e.u.AddParticle.Class =
+			e->u.AddParticle.Class =
 				StrParticleClass(&gParticleClasses, "blood2");
 			break;
 		default:
-			e.u.AddParticle.Class =
+			e->u.AddParticle.Class =
 				StrParticleClass(&gParticleClasses, "blood3");
 			break;
 		}
@@ -391,23 +385,23 @@ void AddBloodSplatter(
 		{
 			bloodSize = 1;
 		}
-		if (ConfigGetBool(&gConfig, "Game.ShotsPushback"))
+		if (ConfigHandleGetBool(&sGameShotsPushback))
 		{
-			e.u.AddParticle.Vel = Vec2iScaleDiv(
+			e->u.AddParticle.Vel = Vec2iScaleDiv(
 				Vec2iScale(hitVector, (rand() % 8 + 8) * power),
 				15 * SHOT_IMPULSE_DIVISOR);
 		}
 		else
 		{
-			e.u.AddParticle.Vel = Vec2iScaleDiv(
+			e->u.AddParticle.Vel = Vec2iScaleDiv(
 				Vec2iScale(hitVector, rand() % 8 + 8), 20);
 		}
-		e.u.AddParticle.Vel.x += (rand() % 128) - 64;
-		e.u.AddParticle.Vel.y += (rand() % 128) - 64;
-		e.u.AddParticle.Angle = RAND_DOUBLE(0, PI * 2);
-		e.u.AddParticle.DZ = (rand() % 6) + 6;
-		e.u.AddParticle.Spin = RAND_DOUBLE(-0.1, 0.1);
-		GameEventsEnqueue(&gGameEvents, e);
+		e->u.AddParticle.Vel.x += (rand() % 128) - 64;
+		e->u.AddParticle.Vel.y += (rand() % 128) - 64;
+		e->u.AddParticle.Angle = RAND_DOUBLE(0, PI * 2);
+		e->u.AddParticle.DZ = (rand() % 6) + 6;
+		e->u.AddParticle.Spin = RAND_DOUBLE(-0.1, 0.1);
+		GameEventsCommit(&gGameEvents, e);
 		switch (ga)
 		{
 		case GORE_LOW:
@@ -29,7 +29,9 @@
 
 #include <json/json.h>
 
+#include "name_index.h"
 #include "pic.h"
+#include "slot_pool.h"
 #include "tile.h"
 
 typedef struct
@@ -51,6 +53,8 @@ typedef struct
 {
 	CArray Classes;	// of ParticleClass
 	CArray CustomClasses;	// of ParticleClass
+	NameIndex ClassIndex;
+	NameIndex CustomClassIndex;
 } ParticleClasses;
 extern ParticleClasses gParticleClasses;
 
@@ -70,6 +74,7 @@ typedef struct
 	bool isInUse;
 } Particle;
 extern CArray gParticles;	// of Particle
+extern SlotPool gParticleSlots;	// live slots of gParticles
 
 typedef struct
 {
@@ -86,8 +91,9 @@ void ParticleClassesInit(ParticleClasses *classes, const char *filename);
 void ParticleClassesLoadJSON(CArray *classes, json_t *root);
 void ParticleClassesTerminate(ParticleClasses *classes);
 void ParticleClassesClear(CArray *classes);
+void ParticleClassesClearCustom(ParticleClasses *classes);
 const ParticleClass *StrParticleClass(
-	const ParticleClasses *classes, const char *name);
+	ParticleClasses *classes, const char *name);
 
 void ParticlesInit(CArray *particles);
 void ParticlesTerminate(CArray *particles);
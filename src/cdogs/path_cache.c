@@ -27,14 +27,26 @@
 */
 #include "path_cache.h"
 
-#include <math.h>
-
 #include "ai_utils.h"
 
 #define PATH_CACHE_MAX 128
+// Shorter paths are quick enough to search in full, and would be longer
+// if forced through the cluster portals
+#define HPA_MIN_DISTANCE (HPA_CLUSTER_SIZE * 2)
 
 PathCache gPathCache;
 
+typedef struct
+{
+	CachedPath Path;
+	bool IgnoreObjects;
+	float Cost;
+	int BucketNext;	// next entry in the same bucket, or free entry
+	int Prev;	// LRU list, towards most recently used
+	int Next;	// LRU list, towards least recently used
+	bool InUse;
+} PathCacheEntry;
+
 
 static CachedPath CachedPathCopy(CachedPath *c)
 {
@@ -57,49 +69,161 @@ void CachedPathDestroy(CachedPath *c)
 		CFREE(c->refs);
 	}
 }
-
-static bool CachedPathMatches(
-	const CachedPath *c, const Vec2i from, const Vec2i to)
+size_t CachedPathGetCount(const CachedPath *c)
 {
-	return Vec2iEqual(c->from, from) && Vec2iEqual(c->to, to);
+	const size_t count = ASPathGetCount(c->Path);
+	return count > c->start ? count - c->start : 0;
+}
+Vec2i *CachedPathGetNode(const CachedPath *c, const size_t index)
+{
+	return ASPathGetNode(c->Path, c->start + index);
 }
 
 
 void PathCacheInit(PathCache *pc, Map *m)
 {
-	CArrayInit(&pc->paths, sizeof(CachedPath));
-	pc->head = 0;
+	CArrayInit(&pc->entries, sizeof(PathCacheEntry));
+	CArrayReserve(&pc->entries, PATH_CACHE_MAX);
+	for (int i = 0; i < PATH_CACHE_BUCKETS; i++)
+	{
+		pc->buckets[i] = -1;
+	}
+	pc->lruHead = pc->lruTail = pc->freeHead = -1;
 	pc->map = m;
+	GridPathInit(&pc->grid, m->Size);
+	HPAPathInit(&pc->hpa, m->Size, IsTileWalkable);
+	FlowFieldsInit(&pc->flow, m->Size, IsTileWalkable);
+	pc->Hits = pc->PartialHits = pc->Misses = 0;
 }
 void PathCacheTerminate(PathCache *pc)
 {
+	debug(D_NORMAL, "Path cache: %d hits, %d partial hits, %d misses\n",
+		pc->Hits, pc->PartialHits, pc->Misses);
+	debug(D_NORMAL, "Flow fields: %d lookups, %d builds\n",
+		pc->flow.Lookups, pc->flow.Builds);
 	PathCacheClear(pc);
-	CArrayTerminate(&pc->paths);
+	CArrayTerminate(&pc->entries);
+	GridPathTerminate(&pc->grid);
+	HPAPathTerminate(&pc->hpa);
+	FlowFieldsTerminate(&pc->flow);
 }
 
 void PathCacheClear(PathCache *pc)
 {
-	for (int i = 0; i < (int)pc->paths.size; i++)
+	CA_FOREACH(PathCacheEntry, e, pc->entries)
+		if (e->InUse)
+		{
+			CachedPathDestroy(&e->Path);
+		}
+	CA_FOREACH_END()
+	CArrayClear(&pc->entries);
+	for (int i = 0; i < PATH_CACHE_BUCKETS; i++)
 	{
-		CachedPath *c = CArrayGet(&pc->paths, i);
-		CachedPathDestroy(c);
+		pc->buckets[i] = -1;
 	}
-	CArrayClear(&pc->paths);
-	pc->head = 0;
+	pc->lruHead = pc->lruTail = pc->freeHead = -1;
+	FlowFieldsInvalidate(&pc->flow);
 }
 
-typedef struct
+static int Bucket(const Vec2i to, const bool ignoreObjects)
+{
+	const unsigned h =
+		((unsigned)to.x * 73856093u) ^ ((unsigned)to.y * 19349663u) ^
+		(ignoreObjects ? 83492791u : 0);
+	return (int)(h % PATH_CACHE_BUCKETS);
+}
+static PathCacheEntry *GetEntry(PathCache *pc, const int i)
+{
+	return CArrayGet(&pc->entries, i);
+}
+static void LRUUnlink(PathCache *pc, const int i)
+{
+	PathCacheEntry *e = GetEntry(pc, i);
+	if (e->Prev >= 0) GetEntry(pc, e->Prev)->Next = e->Next;
+	else pc->lruHead = e->Next;
+	if (e->Next >= 0) GetEntry(pc, e->Next)->Prev = e->Prev;
+	else pc->lruTail = e->Prev;
+	e->Prev = e->Next = -1;
+}
+static void LRUPushFront(PathCache *pc, const int i)
+{
+	PathCacheEntry *e = GetEntry(pc, i);
+	e->Prev = -1;
+	e->Next = pc->lruHead;
+	if (pc->lruHead >= 0) GetEntry(pc, pc->lruHead)->Prev = i;
+	pc->lruHead = i;
+	if (pc->lruTail < 0) pc->lruTail = i;
+}
+static void EntryRemove(PathCache *pc, const int i)
+{
+	PathCacheEntry *e = GetEntry(pc, i);
+	// Unlink from bucket
+	int *link = &pc->buckets[Bucket(e->Path.to, e->IgnoreObjects)];
+	while (*link != i)
+	{
+		link = &GetEntry(pc, *link)->BucketNext;
+	}
+	*link = e->BucketNext;
+	LRUUnlink(pc, i);
+	CachedPathDestroy(&e->Path);
+	e->InUse = false;
+	e->BucketNext = pc->freeHead;
+	pc->freeHead = i;
+}
+static float PathCost(const CachedPath *c);
+static void EntryAdd(PathCache *pc, CachedPath *cp, const bool ignoreObjects)
 {
-	Map *Map;
-	TileSelectFunc IsTileOk;
-} AStarContext;
-static void AddTileNeighbors(
-	ASNeighborList neighbors, void *node, void *context);
-static float AStarHeuristic(void *fromNode, void *toNode, void *context);
-static ASPathNodeSource cPathNodeSource =
+	int i;
+	if (pc->freeHead >= 0)
+	{
+		i = pc->freeHead;
+		pc->freeHead = GetEntry(pc, i)->BucketNext;
+	}
+	else if ((int)pc->entries.size < PATH_CACHE_MAX)
+	{
+		PathCacheEntry e;
+		memset(&e, 0, sizeof e);
+		CArrayPushBack(&pc->entries, &e);
+		i = (int)pc->entries.size - 1;
+	}
+	else
+	{
+		// Evict the least recently used path
+		i = pc->lruTail;
+		EntryRemove(pc, i);
+		pc->freeHead = GetEntry(pc, i)->BucketNext;
+	}
+	PathCacheEntry *e = GetEntry(pc, i);
+	(*cp->refs)++;
+	e->Path = *cp;
+	e->IgnoreObjects = ignoreObjects;
+	e->Cost = PathCost(cp);
+	e->InUse = true;
+	const int b = Bucket(cp->to, ignoreObjects);
+	e->BucketNext = pc->buckets[b];
+	pc->buckets[b] = i;
+	LRUPushFront(pc, i);
+}
+// Find where a tile is on a path, or -1
+static int PathFind(const CachedPath *c, const Vec2i tile)
 {
-	sizeof(Vec2i), AddTileNeighbors, AStarHeuristic, NULL, NULL
-};
+	const int count = (int)ASPathGetCount(c->Path);
+	for (int i = 0; i < count; i++)
+	{
+		if (Vec2iEqual(*(Vec2i *)ASPathGetNode(c->Path, i), tile))
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+const FlowField *PathCacheGetFlowField(
+	PathCache *pc, const int uid, const Vec2i tile)
+{
+	return FlowFieldsGet(&pc->flow, pc->map, uid, tile);
+}
+
 CachedPath PathCacheCreate(
 	PathCache *pc, Vec2i from, Vec2i to,
 	const bool ignoreObjects, const bool cache)
@@ -108,116 +232,144 @@ CachedPath PathCacheCreate(
 		from.x, from.y, to.x, to.y);
 
 	// Search through existing cache for path
-	for (int i = 0; i < (int)pc->paths.size; i++)
+	const int b = Bucket(to, ignoreObjects);
+	for (int i = pc->buckets[b]; i >= 0; i = GetEntry(pc, i)->BucketNext)
 	{
-		CachedPath *c = CArrayGet(&pc->paths, i);
-		if (CachedPathMatches(c, from, to))
+		PathCacheEntry *e = GetEntry(pc, i);
+		if (e->IgnoreObjects == ignoreObjects &&
+			Vec2iEqual(e->Path.from, from) && Vec2iEqual(e->Path.to, to))
 		{
 			debug(D_NORMAL, "returning cached path\n");
-			return CachedPathCopy(c);
+			pc->Hits++;
+			LRUUnlink(pc, i);
+			LRUPushFront(pc, i);
+			return CachedPathCopy(&e->Path);
+		}
+	}
+	// Reuse a path to the same destination that passes through our start
+	for (int i = pc->buckets[b]; i >= 0; i = GetEntry(pc, i)->BucketNext)
+	{
+		PathCacheEntry *e = GetEntry(pc, i);
+		if (e->IgnoreObjects != ignoreObjects || !Vec2iEqual(e->Path.to, to))
+		{
+			continue;
 		}
+		const int start = PathFind(&e->Path, from);
+		if (start < 0) continue;
+		debug(D_NORMAL, "returning end of cached path\n");
+		pc->PartialHits++;
+		LRUUnlink(pc, i);
+		LRUPushFront(pc, i);
+		CachedPath cp = CachedPathCopy(&e->Path);
+		cp.from = from;
+		cp.start = (size_t)start;
+		return cp;
 	}
 
 	debug(D_NORMAL, "pathfinding\n");
+	pc->Misses++;
 
 	// Cached path not found; find the path now
+	// Use the cluster graph for long paths; it only knows about the
+	// walkability that ignores objects, which changes rarely
 	CachedPath cp;
-	AStarContext ac;
-	ac.Map = pc->map;
-	ac.IsTileOk = ignoreObjects ? IsTileWalkable : IsTileWalkableAroundObjects;
-	cp.Path = ASPathCreate(&cPathNodeSource, &ac, &from, &to);
+	cp.Path = NULL;
+	if (ignoreObjects &&
+		CHEBYSHEV_DISTANCE(from.x, from.y, to.x, to.y) >= HPA_MIN_DISTANCE)
+	{
+		cp.Path = HPAPathFind(&pc->hpa, pc->map, from, to);
+	}
+	// Fall back to the full search, which can also find the rare paths
+	// that only cross between clusters diagonally
+	if (cp.Path == NULL)
+	{
+		cp.Path = GridPathFind(
+			&pc->grid, pc->map,
+			ignoreObjects ? IsTileWalkable : IsTileWalkableAroundObjects,
+			from, to);
+	}
 	CMALLOC(cp.refs, sizeof *cp.refs);
 	(*cp.refs) = 1;
 	cp.from = from;
 	cp.to = to;
+	cp.start = 0;
 	// Cache the path, optionally
 	if (cache)
 	{
-		(*cp.refs)++;
-		// Add to the cache if we are under the max size
-		if ((int)pc->paths.size < PATH_CACHE_MAX)
-		{
-			CArrayPushBack(&pc->paths, &cp);
-		}
-		else
-		{
-			// Replace the oldest cached path with this one
-			CachedPath *oldest = CArrayGet(&pc->paths, pc->head);
-			CachedPathDestroy(oldest);
-			memcpy(oldest, &cp, sizeof cp);
-			// Move the head
-			pc->head++;
-			if (pc->head == pc->paths.size)
-			{
-				pc->head = 0;
-			}
-		}
-		debug(D_NORMAL, "Cached pathfind (%d paths)\n", (int)pc->paths.size);
+		EntryAdd(pc, &cp, ignoreObjects);
+		debug(D_NORMAL, "Cached pathfind (%d paths)\n", (int)pc->entries.size);
 	}
 	return cp;
 }
 
-static void AddTileNeighbors(
-	ASNeighborList neighbors, void *node, void *context)
+static float PathCost(const CachedPath *c)
+{
+	float cost = 0;
+	const int count = (int)ASPathGetCount(c->Path);
+	for (int i = 1; i < count; i++)
+	{
+		cost += GridPathStepCost(
+			*(Vec2i *)ASPathGetNode(c->Path, i - 1),
+			*(Vec2i *)ASPathGetNode(c->Path, i));
+	}
+	return cost;
+}
+// Lower bound on the cost of a path between two tiles
+static float MinCost(const Vec2i a, const Vec2i b)
+{
+	// Each step moves at most one tile along each axis
+	return (float)CHEBYSHEV_DISTANCE(a.x, a.y, b.x, b.y) *
+		MIN(TILE_HEIGHT, TILE_WIDTH);
+}
+static bool IsPathAffected(const PathCacheEntry *e, const Vec2i tile)
 {
-	Vec2i *v = node;
-	int y;
-	AStarContext *c = context;
-	for (y = v->y - 1; y <= v->y + 1; y++)
+	const CachedPath *c = &e->Path;
+	const int count = (int)ASPathGetCount(c->Path);
+	// Failed paths may now succeed
+	if (count <= 1) return true;
+	// Could the path be shortened by going through the tile?
+	// Paths that reuse the end of this path are covered too, by the triangle
+	// inequality
+	if (MinCost(c->from, tile) + MinCost(tile, c->to) < e->Cost) return true;
+	// Does the path pass by the tile?
+	// Diagonal moves depend on the neighbouring tiles too
+	for (int i = 0; i < count; i++)
 	{
-		int x;
-		if (y < 0 || y >= c->Map->Size.y)
+		const Vec2i *v = ASPathGetNode(c->Path, i);
+		if (CHEBYSHEV_DISTANCE(v->x, v->y, tile.x, tile.y) <= 1)
 		{
-			continue;
+			return true;
+		}
+	}
+	return false;
+}
+void PathCacheInvalidateTile(PathCache *pc, const Vec2i tile)
+{
+	HPAPathUpdateTile(&pc->hpa, pc->map, tile);
+	// Any tile can change the distances in a whole field
+	FlowFieldsInvalidate(&pc->flow);
+	for (int i = 0; i < (int)pc->entries.size; i++)
+	{
+		const PathCacheEntry *e = GetEntry(pc, i);
+		if (e->InUse && IsPathAffected(e, tile))
+		{
+			EntryRemove(pc, i);
 		}
-		for (x = v->x - 1; x <= v->x + 1; x++)
+	}
+}
+void PathCacheInvalidateKeys(PathCache *pc, const int keyFlags)
+{
+	Vec2i v;
+	for (v.y = 0; v.y < pc->map->Size.y; v.y++)
+	{
+		for (v.x = 0; v.x < pc->map->Size.x; v.x++)
 		{
-			float cost;
-			Vec2i neighbor;
-			neighbor.x = x;
-			neighbor.y = y;
-			if (x < 0 || x >= c->Map->Size.x)
-			{
-				continue;
-			}
-			if (x == v->x && y == v->y)
+			const Tile *t = MapGetTile(pc->map, v);
+			if ((t->flags & MAPTILE_OFFSET_PIC) &&
+				(MapGetDoorKeycardFlag(pc->map, v) & keyFlags))
 			{
-				continue;
+				PathCacheInvalidateTile(pc, v);
 			}
-			// if we're moving diagonally,
-			// need to check the axis-aligned neighbours are also clear
-			if (!c->IsTileOk(c->Map, Vec2iNew(x, y)) ||
-				!c->IsTileOk(c->Map, Vec2iNew(v->x, y)) ||
-				!c->IsTileOk(c->Map, Vec2iNew(x, v->y)))
-			{
-				continue;
-			}
-			// Calculate cost of direction
-			// Note that there are different horizontal and vertical costs,
-			// due to the tiles being non-square
-			// Slightly prefer axes instead of diagonals
-			if (x != v->x && y != v->y)
-			{
-				cost = TILE_WIDTH * 1.1f;
-			}
-			else if (x != v->x)
-			{
-				cost = TILE_WIDTH;
-			}
-			else
-			{
-				cost = TILE_HEIGHT;
-			}
-			ASNeighborListAdd(neighbors, &neighbor, cost);
 		}
 	}
 }
-static float AStarHeuristic(void *fromNode, void *toNode, void *context)
-{
-	// Simple Euclidean
-	Vec2i *v1 = fromNode;
-	Vec2i *v2 = toNode;
-	UNUSED(context);
-	return (float)sqrt(DistanceSquared(
-		Vec2iCenterOfTile(*v1), Vec2iCenterOfTile(*v2)));
-}
@@ -29,24 +29,44 @@
 
 #include "AStar.h"
 #include "c_array.h"
+#include "flow_field.h"
+#include "grid_path.h"
+#include "hpa_path.h"
 #include "map.h"
 #include "vector.h"
 
 // Ref-counted path reference
 // Once refs reaches zero, can then free the path
+// A reference may cover only the end of the path, starting from node start;
+// use CachedPathGetCount/CachedPathGetNode to access the nodes
 typedef struct
 {
 	ASPath Path;
 	int *refs;
 	Vec2i from;
 	Vec2i to;
+	size_t start;
 } CachedPath;
 
+#define PATH_CACHE_BUCKETS 64
 typedef struct
 {
-	CArray paths;	// of CachedPath
-	size_t head;
+	CArray entries;	// of PathCacheEntry
+	// Chains of entries with the same destination
+	int buckets[PATH_CACHE_BUCKETS];
+	int lruHead;	// most recently used entry
+	int lruTail;	// least recently used entry, evicted first
+	int freeHead;	// removed entries, available for reuse
 	Map *map;
+	GridPath grid;
+	// For long paths on big maps
+	HPAPath hpa;
+	// Shared by all AI heading to the same player
+	FlowFields flow;
+
+	int Hits;
+	int PartialHits;	// reused the end of a path to the same destination
+	int Misses;
 } PathCache;
 
 // Cache of A* paths so similar paths don't need to be recalculated
@@ -55,14 +75,25 @@ typedef struct
 extern PathCache gPathCache;
 
 void CachedPathDestroy(CachedPath *c);
+size_t CachedPathGetCount(const CachedPath *c);
+Vec2i *CachedPathGetNode(const CachedPath *c, const size_t index);
 
 void PathCacheInit(PathCache *pc, Map *m);
 void PathCacheTerminate(PathCache *pc);
 
 // Clear all entries in cache
-// This is done when the underlying map changes, changing paths
-// e.g. keys
 void PathCacheClear(PathCache *pc);
+// Remove the paths that may be affected by a change in walkability of a
+// tile: paths that pass by it, failed paths, and paths that could be
+// shortened by going through it
+void PathCacheInvalidateTile(PathCache *pc, const Vec2i tile);
+// Invalidate around the doors that can be opened by keys
+void PathCacheInvalidateKeys(PathCache *pc, const int keyFlags);
+
+// Get the flow field leading to a player's tile
+// Walkability is the same as for paths that ignore objects
+const FlowField *PathCacheGetFlowField(
+	PathCache *pc, const int uid, const Vec2i tile);
 
 CachedPath PathCacheCreate(
 	PathCache *pc, Vec2i from, Vec2i to,
@@ -31,7 +31,7 @@
 #include "palette.h"
 #include "utils.h"
 
-Pic picNone = { { 0, 0 }, { 0, 0 }, NULL };
+Pic picNone = { { 0, 0 }, { 0, 0 }, NULL, NULL };
 
 PicType StrPicType(const char *s)
 {
@@ -91,6 +91,7 @@ void PicLoad(
 			srcI += image->w - size.x;
 		}
 	}
+	p->Spans = PicSpansNew(p->Data, p->size, gGraphicsDevice.Amask);
 }
 
 void PicFromPicPaletted(Pic *pic, const PicPaletted *picP)
@@ -108,6 +109,7 @@ void PicFromPicPaletted(Pic *pic, const PicPaletted *picP)
 			pic->Data[i] = 0;
 		}
 	}
+	pic->Spans = PicSpansNew(pic->Data, pic->size, gGraphicsDevice.Amask);
 }
 
 Pic PicCopy(const Pic *src)
@@ -116,12 +118,21 @@ Pic PicCopy(const Pic *src)
 	const size_t size = p.size.x * p.size.y * sizeof *p.Data;
 	CMALLOC(p.Data, size);
 	memcpy(p.Data, src->Data, size);
+	p.Spans = PicSpansCopy(src->Spans);
 	return p;
 }
 
 void PicFree(Pic *pic)
 {
 	CFREE(pic->Data);
+	PicSpansFree(pic->Spans);
+	pic->Spans = NULL;
+}
+
+void PicUpdateSpans(Pic *pic)
+{
+	PicSpansFree(pic->Spans);
+	pic->Spans = PicSpansNew(pic->Data, pic->size, gGraphicsDevice.Amask);
 }
 
 int PicIsNotNone(Pic *pic)
@@ -182,6 +193,7 @@ void PicTrim(Pic *pic, const bool xTrim, const bool yTrim)
 	pic->Data = newData;
 	pic->size = newSize;
 	pic->offset = Vec2iZero();
+	PicUpdateSpans(pic);
 }
 
 bool PicPxIsEdge(const Pic *pic, const Vec2i pos, const bool isPixel)
@@ -32,6 +32,7 @@
 #include "defs.h"
 #include "grafx.h"
 #include "pic_file.h"
+#include "pic_spans.h"
 #include "vector.h"
 
 typedef struct
@@ -39,6 +40,8 @@ typedef struct
 	Vec2i size;
 	Vec2i offset;
 	Uint32 *Data;
+	// Optional, owned; NULL if the pic has no runs to skip transparency
+	PicSpans *Spans;
 } Pic;
 typedef struct
 {
@@ -106,6 +109,8 @@ void PicLoad(
 void PicFromPicPaletted(Pic *pic, const PicPaletted *picP);
 Pic PicCopy(const Pic *src);
 void PicFree(Pic *pic);
+// Rebuild the transparency runs; call after changing the pixels
+void PicUpdateSpans(Pic *pic);
 int PicIsNotNone(Pic *pic);
 
 // Detect unused edges and update size and offset to fit
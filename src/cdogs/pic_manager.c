@@ -50,6 +50,14 @@ static uint8_t cWhiteValues[] = { 64, 56, 46, 36, 30, 24, 20, 16 };
 static NamedPic *AddNamedPic(CArray *pics, const char *name, const Pic *p);
 
 static void SetupPalette(TPalette palette);
+static const char *NamedPicGetName(const void *p)
+{
+	return ((const NamedPic *)p)->name;
+}
+static const char *NamedSpritesGetName(const void *s)
+{
+	return ((const NamedSprites *)s)->name;
+}
 bool PicManagerTryInit(
 	PicManager *pm, const char *oldGfxFile1, const char *oldGfxFile2)
 {
@@ -58,6 +66,10 @@ bool PicManagerTryInit(
 	CArrayInit(&pm->sprites, sizeof(NamedSprites));
 	CArrayInit(&pm->customPics, sizeof(NamedPic));
 	CArrayInit(&pm->customSprites, sizeof(NamedSprites));
+	NameIndexInit(&pm->picIndex, NamedPicGetName);
+	NameIndexInit(&pm->spriteIndex, NamedSpritesGetName);
+	NameIndexInit(&pm->customPicIndex, NamedPicGetName);
+	NameIndexInit(&pm->customSpriteIndex, NamedSpritesGetName);
 	CArrayInit(&pm->drainPics, sizeof(NamedPic *));
 	CArrayInit(&pm->doorStyleNames, sizeof(char *));
 
@@ -260,6 +272,7 @@ bail:
 static void GenerateOldPics(PicManager *pm);
 static void LoadOldSprites(
 	PicManager *pm, const char *name, const TOffsetPic *pics, const int count);
+static void LogSpansMemory(const PicManager *pm);
 void PicManagerLoadDir(PicManager *pm, const char *path)
 {
 	if (!IMG_Init(IMG_INIT_PNG))
@@ -280,6 +293,8 @@ void PicManagerLoadDir(PicManager *pm, const char *path)
 	LoadOldSprites(pm, "gas_cloud", cFireBallPics + 8, 4);
 	LoadOldSprites(pm, "beam", cBeamPics[0], DIRECTION_COUNT);
 	LoadOldSprites(pm, "beam_bright", cBeamPics[1], DIRECTION_COUNT);
+
+	LogSpansMemory(pm);
 }
 static void LoadOldSprites(
 	PicManager *pm, const char *name, const TOffsetPic *pics, const int count)
@@ -299,6 +314,34 @@ static void LoadOldSprites(
 	}
 	CArrayPushBack(&pm->sprites, &ns);
 }
+static void AddPicMemory(const Pic *p, size_t *pixels, size_t *spans)
+{
+	if (p->Data != NULL)
+	{
+		*pixels += p->size.x * p->size.y * sizeof *p->Data;
+	}
+	*spans += PicSpansMemSize(p->Spans);
+}
+static void LogSpansMemory(const PicManager *pm)
+{
+	size_t pixels = 0;
+	size_t spans = 0;
+	for (int i = 0; i < PIC_MAX; i++)
+	{
+		AddPicMemory(&pm->picsFromOld[i], &pixels, &spans);
+	}
+	CA_FOREACH(const NamedPic, n, pm->pics)
+		AddPicMemory(&n->pic, &pixels, &spans);
+	CA_FOREACH_END()
+	CA_FOREACH(const NamedSprites, ns, pm->sprites)
+		for (int j = 0; j < (int)ns->pics.size; j++)
+		{
+			AddPicMemory(CArrayGet(&ns->pics, j), &pixels, &spans);
+		}
+	CA_FOREACH_END()
+	debug(D_NORMAL, "pics: %u bytes of pixels, %u bytes of spans\n",
+		(unsigned)pixels, (unsigned)spans);
+}
 static void AddMaskBasePic(
 	PicManager *pm, const char *name,
 	const char *styleName, const char *typeName, const int picIdx);
@@ -368,6 +411,7 @@ static void AddMaskBasePic(
 			p.Data[i] = COLOR2PIXEL(c);
 		}
 	}
+	PicUpdateSpans(&p);
 	AddNamedPic(&pm->pics, buf, &p);
 
 	AfterAdd(pm);
@@ -440,6 +484,8 @@ static void PicManagerClear(CArray *pics, CArray *sprites);
 void PicManagerClearCustom(PicManager *pm)
 {
 	PicManagerClear(&pm->customPics, &pm->customSprites);
+	NameIndexClear(&pm->customPicIndex);
+	NameIndexClear(&pm->customSpriteIndex);
 	FindDrainPics(pm);
 }
 void PicManagerTerminate(PicManager *pm)
@@ -461,6 +507,10 @@ void PicManagerTerminate(PicManager *pm)
 	PicManagerClearCustom(pm);
 	CArrayTerminate(&pm->customPics);
 	CArrayTerminate(&pm->customSprites);
+	NameIndexTerminate(&pm->picIndex);
+	NameIndexTerminate(&pm->spriteIndex);
+	NameIndexTerminate(&pm->customPicIndex);
+	NameIndexTerminate(&pm->customSpriteIndex);
 	CArrayTerminate(&pm->drainPics);
 	CA_FOREACH(char *, doorStyleName, pm->doorStyleNames)
 		CFREE(*doorStyleName);
@@ -500,27 +550,14 @@ Pic *PicManagerGetFromOld(PicManager *pm, int idx)
 	}
 	return &pm->picsFromOld[idx];
 }
-NamedPic *PicManagerGetNamedPic(const PicManager *pm, const char *name)
+NamedPic *PicManagerGetNamedPic(PicManager *pm, const char *name)
 {
-	for (int i = 0; i < (int)pm->customPics.size; i++)
-	{
-		NamedPic *n = CArrayGet(&pm->customPics, i);
-		if (strcmp(n->name, name) == 0)
-		{
-			return n;
-		}
-	}
-	for (int i = 0; i < (int)pm->pics.size; i++)
-	{
-		NamedPic *n = CArrayGet(&pm->pics, i);
-		if (strcmp(n->name, name) == 0)
-		{
-			return n;
-		}
-	}
-	return NULL;
+	// Custom pics shadow built-in ones
+	NamedPic *n = NameIndexGet(&pm->customPicIndex, &pm->customPics, name);
+	if (n != NULL) return n;
+	return NameIndexGet(&pm->picIndex, &pm->pics, name);
 }
-Pic *PicManagerGetPic(const PicManager *pm, const char *name)
+Pic *PicManagerGetPic(PicManager *pm, const char *name)
 {
 	NamedPic *n = PicManagerGetNamedPic(pm, name);
 	if (n != NULL) return &n->pic;
@@ -551,25 +588,12 @@ defaultPic:
 	return pic;
 }
 const NamedSprites *PicManagerGetSprites(
-	const PicManager *pm, const char *name)
+	PicManager *pm, const char *name)
 {
-	for (int i = 0; i < (int)pm->customSprites.size; i++)
-	{
-		const NamedSprites *n = CArrayGet(&pm->customSprites, i);
-		if (strcmp(n->name, name) == 0)
-		{
-			return n;
-		}
-	}
-	for (int i = 0; i < (int)pm->sprites.size; i++)
-	{
-		const NamedSprites *n = CArrayGet(&pm->sprites, i);
-		if (strcmp(n->name, name) == 0)
-		{
-			return n;
-		}
-	}
-	return NULL;
+	const NamedSprites *n = NameIndexGet(
+		&pm->customSpriteIndex, &pm->customSprites, name);
+	if (n != NULL) return n;
+	return NameIndexGet(&pm->spriteIndex, &pm->sprites, name);
 }
 
 static void GetMaskedName(
@@ -581,7 +605,7 @@ static void GetMaskedStyleName(
 // The name of the pic will be <name>_<mask>_<maskAlt>
 // Used for dynamic map tile pic colours
 static NamedPic *PicManagerGetMaskedPic(
-	const PicManager *pm, const char *name,
+	PicManager *pm, const char *name,
 	const color_t mask, const color_t maskAlt)
 {
 	char maskedName[256];
@@ -589,7 +613,7 @@ static NamedPic *PicManagerGetMaskedPic(
 	return PicManagerGetNamedPic(pm, maskedName);
 }
 NamedPic *PicManagerGetMaskedStylePic(
-	const PicManager *pm, const char *name, const int style, const int type,
+	PicManager *pm, const char *name, const int style, const int type,
 	const color_t mask, const color_t maskAlt)
 {
 	char buf[256];
@@ -634,6 +658,7 @@ void PicManagerGenerateMaskedPic(
 		p.Data[i] = COLOR2PIXEL(c);
 		// TODO: more channels
 	}
+	PicUpdateSpans(&p);
 	AddNamedPic(&pm->customPics, maskedName, &p);
 
 	AfterAdd(pm);
@@ -723,5 +748,7 @@ Pic PicFromTOffsetPic(PicManager *pm, TOffsetPic op)
 	pic.size = opPic->size;
 	pic.offset = Vec2iNew(op.dx, op.dy);
 	pic.Data = opPic->Data;
+	// Borrowed, like the pixels
+	pic.Spans = opPic->Spans;
 	return pic;
 }
@@ -27,6 +27,7 @@
 */
 #pragma once
 
+#include "name_index.h"
 #include "pic.h"
 #include "pics.h"
 
@@ -39,6 +40,10 @@ typedef struct
 	CArray sprites;	// of NamedSprites
 	CArray customPics;	// of NamedPic
 	CArray customSprites;	// of NamedSprites
+	NameIndex picIndex;
+	NameIndex spriteIndex;
+	NameIndex customPicIndex;
+	NameIndex customSpriteIndex;
 
 	CArray drainPics;	// of NamedPic *
 
@@ -58,17 +63,17 @@ void PicManagerTerminate(PicManager *pm);
 PicPaletted *PicManagerGetOldPic(PicManager *pm, int idx);
 Pic *PicManagerGetFromOld(PicManager *pm, int idx);
 // Note: return ptr to NamedPic so we can store that instead of the name
-NamedPic *PicManagerGetNamedPic(const PicManager *pm, const char *name);
-Pic *PicManagerGetPic(const PicManager *pm, const char *name);
+NamedPic *PicManagerGetNamedPic(PicManager *pm, const char *name);
+Pic *PicManagerGetPic(PicManager *pm, const char *name);
 Pic *PicManagerGet(PicManager *pm, const char *name, const int oldIdx);
 const NamedSprites *PicManagerGetSprites(
-	const PicManager *pm, const char *name);
+	PicManager *pm, const char *name);
 
 // Get a masked pic for the styled tiles: walls, floors, rooms
 // Simply calls GetMaskedPic but the name contains the relevant
 // style/type names
 NamedPic *PicManagerGetMaskedStylePic(
-	const PicManager *pm, const char *name, const int style, const int type,
+	PicManager *pm, const char *name, const int style, const int type,
 	const color_t mask, const color_t maskAlt);
 // To support dynamic colours, generate pics on request.
 void PicManagerGenerateMaskedPic(
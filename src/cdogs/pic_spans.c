@@ -0,0 +1,193 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "pic_spans.h"
+
+#include <string.h>
+
+#include "utils.h"
+
+
+// Loop over the runs of non-zero pixels in a row, as _run
+#define FOR_EACH_RUN(_data, _width, _aMask, _run, _body)\
+	for (int _x = 0; _x < (_width);)\
+	{\
+		if ((_data)[_x] == 0)\
+		{\
+			_x++;\
+			continue;\
+		}\
+		const bool _opaque = ((_data)[_x] & (_aMask)) != 0;\
+		int _end = _x + 1;\
+		while (_end < (_width) && (_data)[_end] != 0 &&\
+			(((_data)[_end] & (_aMask)) != 0) == _opaque)\
+		{\
+			_end++;\
+		}\
+		PicRun _run;\
+		_run.Start = (Uint16)_x;\
+		_run.Length = (Uint16)(_end - _x);\
+		_run.IsOpaque = _opaque;\
+		_body\
+		_x = _end;\
+	}
+
+PicSpans *PicSpansNew(const Uint32 *data, const Vec2i size, const Uint32 aMask)
+{
+	if (data == NULL || size.x <= 0 || size.y <= 0 || size.x > 0xFFFF)
+	{
+		return NULL;
+	}
+	int count = 0;
+	for (int y = 0; y < size.y; y++)
+	{
+		const Uint32 *row = data + y * size.x;
+		FOR_EACH_RUN(row, size.x, aMask, run, UNUSED(run); count++;)
+	}
+	PicSpans *s;
+	CMALLOC(s, sizeof *s);
+	s->AMask = aMask;
+	s->Height = size.y;
+	CMALLOC(s->Rows, (size.y + 1) * sizeof *s->Rows);
+	s->Runs = NULL;
+	if (count > 0)
+	{
+		CMALLOC(s->Runs, count * sizeof *s->Runs);
+	}
+	int i = 0;
+	for (int y = 0; y < size.y; y++)
+	{
+		s->Rows[y] = i;
+		const Uint32 *row = data + y * size.x;
+		FOR_EACH_RUN(row, size.x, aMask, run, s->Runs[i++] = run;)
+	}
+	s->Rows[size.y] = i;
+	return s;
+}
+PicSpans *PicSpansCopy(const PicSpans *s)
+{
+	if (s == NULL)
+	{
+		return NULL;
+	}
+	PicSpans *c;
+	CMALLOC(c, sizeof *c);
+	*c = *s;
+	const size_t rowsSize = (s->Height + 1) * sizeof *s->Rows;
+	CMALLOC(c->Rows, rowsSize);
+	memcpy(c->Rows, s->Rows, rowsSize);
+	c->Runs = NULL;
+	const int count = s->Rows[s->Height];
+	if (count > 0)
+	{
+		CMALLOC(c->Runs, count * sizeof *c->Runs);
+		memcpy(c->Runs, s->Runs, count * sizeof *c->Runs);
+	}
+	return c;
+}
+void PicSpansFree(PicSpans *s)
+{
+	if (s == NULL)
+	{
+		return;
+	}
+	CFREE(s->Rows);
+	CFREE(s->Runs);
+	CFREE(s);
+}
+size_t PicSpansMemSize(const PicSpans *s)
+{
+	if (s == NULL)
+	{
+		return 0;
+	}
+	return sizeof *s + (s->Height + 1) * sizeof *s->Rows +
+		s->Rows[s->Height] * sizeof *s->Runs;
+}
+
+bool PicSpansCanBlit(const PicSpans *s, const Uint32 aMask)
+{
+	return s != NULL && s->AMask == aMask;
+}
+
+// Loop over the visible part of each run in the clipped rectangle, with
+// _d and _src pointing at its first pixel and _n pixels long
+#define FOR_EACH_VISIBLE_RUN(_s, _data, _pitch, _dst, _dstPitch, _r, _body)\
+	for (int _y = 0; _y < (_r)->Size.y; _y++)\
+	{\
+		const int _row = (_r)->Src.y + _y;\
+		const int _left = (_r)->Src.x;\
+		const int _right = _left + (_r)->Size.x;\
+		const Uint32 *_srcRow = (_data) + _row * (_pitch);\
+		Uint32 *_dstRow = (_dst) + ((_r)->Dst.y + _y) * (_dstPitch) +\
+			(_r)->Dst.x - _left;\
+		const PicRun *_run = (_s)->Runs + (_s)->Rows[_row];\
+		const PicRun *_runEnd = (_s)->Runs + (_s)->Rows[_row + 1];\
+		for (; _run < _runEnd; _run++)\
+		{\
+			const int _start = MAX((int)_run->Start, _left);\
+			const int _n = MIN(_run->Start + _run->Length, _right) - _start;\
+			if (_n <= 0)\
+			{\
+				continue;\
+			}\
+			Uint32 *_d = _dstRow + _start;\
+			const Uint32 *_src = _srcRow + _start;\
+			_body\
+		}\
+	}
+
+void PicSpansBlit(
+	const PicSpans *s, const Uint32 *data, const int pitch,
+	Uint32 *dst, const int dstPitch, const BlitSpanRect *r)
+{
+	FOR_EACH_VISIBLE_RUN(s, data, pitch, dst, dstPitch, r,
+		// Runs without alpha are invisible to Blit
+		if (_run->IsOpaque)
+		{
+			memcpy(_d, _src, _n * sizeof *_d);
+		}
+	)
+}
+void PicSpansBlitMasked(
+	const PicSpans *s, const Uint32 *data, const int pitch,
+	Uint32 *dst, const int dstPitch, const BlitSpanRect *r,
+	const Uint32 mask)
+{
+	FOR_EACH_VISIBLE_RUN(s, data, pitch, dst, dstPitch, r,
+		gBlitSpan.Masked(_d, _src, _n, mask, false);
+	)
+}
+void PicSpansBlitBlend(
+	const PicSpans *s, const Uint32 *data, const int pitch,
+	Uint32 *dst, const int dstPitch, const BlitSpanRect *r,
+	const Uint32 blend, const Uint8 alpha)
+{
+	FOR_EACH_VISIBLE_RUN(s, data, pitch, dst, dstPitch, r,
+		gBlitSpan.Blend(_d, _src, _n, blend, alpha, s->AMask);
+	)
+}
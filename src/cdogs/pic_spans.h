@@ -0,0 +1,78 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <SDL_stdinc.h>
+
+#include "blit_span.h"
+#include "vector.h"
+
+// Run-length encoded form of a picture, so that blitters can skip its
+// transparent (zero) pixels and copy opaque ones in bulk
+typedef struct
+{
+	Uint16 Start;
+	Uint16 Length;
+	// Whether every pixel has some alpha; runs without any are kept
+	// separate so they can be skipped by blitters that test alpha
+	bool IsOpaque;
+} PicRun;
+typedef struct
+{
+	Uint32 AMask;	// alpha mask that IsOpaque was computed with
+	int Height;
+	int *Rows;	// index of the first run of each row, plus one past the end
+	PicRun *Runs;
+} PicSpans;
+
+PicSpans *PicSpansNew(const Uint32 *data, const Vec2i size, const Uint32 aMask);
+PicSpans *PicSpansCopy(const PicSpans *s);
+void PicSpansFree(PicSpans *s);
+// Memory used by the runs, in bytes
+size_t PicSpansMemSize(const PicSpans *s);
+
+// Whether the runs can be used to blit with this alpha mask
+bool PicSpansCanBlit(const PicSpans *s, const Uint32 aMask);
+
+// Blit the clipped part of a picture; these behave like the span blitters
+// except that transparent runs are skipped without being read
+// pitch is the width of the picture and dstPitch the width of dst
+void PicSpansBlit(
+	const PicSpans *s, const Uint32 *data, const int pitch,
+	Uint32 *dst, const int dstPitch, const BlitSpanRect *r);
+void PicSpansBlitMasked(
+	const PicSpans *s, const Uint32 *data, const int pitch,
+	Uint32 *dst, const int dstPitch, const BlitSpanRect *r,
+	const Uint32 mask);
+void PicSpansBlitBlend(
+	const PicSpans *s, const Uint32 *data, const int pitch,
+	Uint32 *dst, const int dstPitch, const BlitSpanRect *r,
+	const Uint32 blend, const Uint8 alpha);
@@ -33,16 +33,20 @@
 #include "json_utils.h"
 #include "net_util.h"
 #include "map.h"
+#include "uid_map.h"
 
 
 CArray gPickups;
 static unsigned int sPickupUIDs;
+// Destroyed pickups can still be found by UID until their slot is reused
+static UIDMap sPickupIndices;
 
 
 void PickupsInit(void)
 {
 	CArrayInit(&gPickups, sizeof(Pickup));
 	CArrayReserve(&gPickups, 128);
+	UIDMapInit(&sPickupIndices);
 	sPickupUIDs = 0;
 }
 void PickupsTerminate(void)
@@ -56,6 +60,7 @@ void PickupsTerminate(void)
 		}
 	}
 	CArrayTerminate(&gPickups);
+	UIDMapTerminate(&sPickupIndices);
 }
 int PickupsGetNextUID(void)
 {
@@ -90,8 +95,10 @@ void PickupAdd(const NAddPickup ap)
 		i = (int)gPickups.size - 1;
 		p = CArrayGet(&gPickups, i);
 	}
+	UIDMapRemoveIndex(&sPickupIndices, p->UID, i);
 	memset(p, 0, sizeof *p);
 	p->UID = ap.UID;
+	UIDMapSet(&sPickupIndices, p->UID, i);
 	p->class = StrPickupClass(ap.PickupClass);
 	p->tileItem.x = p->tileItem.y = -1;
 	p->tileItem.flags = ap.TileItemFlags;
@@ -125,10 +132,10 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 	{
 	case PICKUP_JEWEL:
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_SCORE);
-			e.u.Score.PlayerUID = a->PlayerUID;
-			e.u.Score.Score = p->class->u.Score;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_SCORE);
+			e->u.Score.PlayerUID = a->PlayerUID;
+			e->u.Score.Score = p->class->u.Score;
+			GameEventsCommit(&gGameEvents, e);
 			sound = "pickup";
 			UpdateMissionObjective(
 				&gMission, p->tileItem.flags, OBJECTIVE_COLLECT);
@@ -141,12 +148,12 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 		if (a->health < ActorGetCharacter(a)->maxHealth)
 		{
 			canPickup = true;
-			GameEvent e = GameEventNew(GAME_EVENT_ACTOR_HEAL);
-			e.u.Heal.UID = a->uid;
-			e.u.Heal.PlayerUID = a->PlayerUID;
-			e.u.Heal.Amount = p->class->u.Health;
-			e.u.Heal.IsRandomSpawned = p->IsRandomSpawned;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_HEAL);
+			e->u.Heal.UID = a->uid;
+			e->u.Heal.PlayerUID = a->PlayerUID;
+			e->u.Heal.Amount = p->class->u.Health;
+			e->u.Heal.IsRandomSpawned = p->IsRandomSpawned;
+			GameEventsCommit(&gGameEvents, e);
 		}
 		break;
 
@@ -179,14 +186,15 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 			}
 
 			// Take ammo
-			GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD_AMMO);
-			e.u.AddAmmo.UID = a->uid;
-			e.u.AddAmmo.PlayerUID = a->PlayerUID;
-			e.u.AddAmmo.AmmoId = p->class->u.Ammo.Id;
-			e.u.AddAmmo.Amount = p->class->u.Ammo.Amount;
-			e.u.AddAmmo.IsRandomSpawned = p->IsRandomSpawned;
+			GameEvent *e =
+				GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_ADD_AMMO);
+			e->u.AddAmmo.UID = a->uid;
+			e->u.AddAmmo.PlayerUID = a->PlayerUID;
+			e->u.AddAmmo.AmmoId = p->class->u.Ammo.Id;
+			e->u.AddAmmo.Amount = p->class->u.Ammo.Amount;
+			e->u.AddAmmo.IsRandomSpawned = p->IsRandomSpawned;
 			// Note: receiving end will prevent ammo from exceeding max
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsCommit(&gGameEvents, e);
 
 			sound = ammo->Sound;
 		}
@@ -194,10 +202,10 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 
 	case PICKUP_KEYCARD:
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_ADD_KEYS);
-			e.u.AddKeys.KeyFlags = p->class->u.Keys;
-			e.u.AddKeys.Pos = Vec2i2Net(actorPos);
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ADD_KEYS);
+			e->u.AddKeys.KeyFlags = p->class->u.Keys;
+			e->u.AddKeys.Pos = Vec2i2Net(actorPos);
+			GameEventsCommit(&gGameEvents, e);
 		}
 		break;
 
@@ -205,13 +213,14 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 		if (pickupAll)
 		{
 			const GunDescription *gun = IdGunDescription(p->class->u.GunId);
-			GameEvent e = GameEventNew(GAME_EVENT_ACTOR_REPLACE_GUN);
-			e.u.ActorReplaceGun.UID = a->uid;
-			e.u.ActorReplaceGun.GunIdx =
+			GameEvent *e =
+				GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_REPLACE_GUN);
+			e->u.ActorReplaceGun.UID = a->uid;
+			e->u.ActorReplaceGun.GunIdx =
 				(int)a->guns.size == MAX_WEAPONS ?
 				a->gunIndex : (int)a->guns.size;
-			strcpy(e.u.ActorReplaceGun.Gun, gun->name);
-			GameEventsEnqueue(&gGameEvents, e);
+			strcpy(e->u.ActorReplaceGun.Gun, gun->name);
+			GameEventsCommit(&gGameEvents, e);
 
 			// If the player has less ammo than the default amount,
 			// replenish up to this amount
@@ -223,13 +232,13 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 					ammo->Amount * 2 - *(int *)CArrayGet(&a->ammo, ammoId);
 				if (ammoDeficit > 0)
 				{
-					e = GameEventNew(GAME_EVENT_ACTOR_ADD_AMMO);
-					e.u.AddAmmo.UID = a->uid;
-					e.u.AddAmmo.PlayerUID = a->PlayerUID;
-					e.u.AddAmmo.AmmoId = ammoId;
-					e.u.AddAmmo.Amount = ammoDeficit;
-					e.u.AddAmmo.IsRandomSpawned = false;
-					GameEventsEnqueue(&gGameEvents, e);
+					e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_ADD_AMMO);
+					e->u.AddAmmo.UID = a->uid;
+					e->u.AddAmmo.PlayerUID = a->PlayerUID;
+					e->u.AddAmmo.AmmoId = ammoId;
+					e->u.AddAmmo.Amount = ammoDeficit;
+					e->u.AddAmmo.IsRandomSpawned = false;
+					GameEventsCommit(&gGameEvents, e);
 				}
 			}
 		}
@@ -247,16 +256,16 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 	{
 		if (sound != NULL)
 		{
-			GameEvent es = GameEventNew(GAME_EVENT_SOUND_AT);
-			strcpy(es.u.SoundAt.Sound, sound);
-			es.u.SoundAt.Pos = Vec2i2Net(actorPos);
-			es.u.SoundAt.IsHit = false;
-			GameEventsEnqueue(&gGameEvents, es);
+			GameEvent *es = GameEventsAdd(&gGameEvents, GAME_EVENT_SOUND_AT);
+			strcpy(es->u.SoundAt.Sound, sound);
+			es->u.SoundAt.Pos = Vec2i2Net(actorPos);
+			es->u.SoundAt.IsHit = false;
+			GameEventsCommit(&gGameEvents, es);
 		}
-		GameEvent e = GameEventNew(GAME_EVENT_REMOVE_PICKUP);
-		e.u.RemovePickup.UID = p->UID;
-		e.u.RemovePickup.SpawnerUID = p->SpawnerUID;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_REMOVE_PICKUP);
+		e->u.RemovePickup.UID = p->UID;
+		e->u.RemovePickup.SpawnerUID = p->SpawnerUID;
+		GameEventsCommit(&gGameEvents, e);
 		// Prevent multiple pickups by marking
 		p->PickedUp = true;
 	}
@@ -282,13 +291,6 @@ static const Pic *GetPickupPic(const int id, Vec2i *offset)
 
 Pickup *PickupGetByUID(const int uid)
 {
-	for (int i = 0; i < (int)gPickups.size; i++)
-	{
-		Pickup *p = CArrayGet(&gPickups, i);
-		if (p->UID == uid)
-		{
-			return p;
-		}
-	}
-	return NULL;
+	const int id = UIDMapGet(&sPickupIndices, uid);
+	return id >= 0 ? CArrayGet(&gPickups, id) : NULL;
 }
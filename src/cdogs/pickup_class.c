@@ -53,21 +53,17 @@ PickupClass *StrPickupClass(const char *s)
 	{
 		return NULL;
 	}
-	for (int i = 0; i < (int)gPickupClasses.CustomClasses.size; i++)
+	// Custom classes shadow built-in ones
+	PickupClass *c = NameIndexGet(
+		&gPickupClasses.CustomClassIndex, &gPickupClasses.CustomClasses, s);
+	if (c == NULL)
 	{
-		PickupClass *c = CArrayGet(&gPickupClasses.CustomClasses, i);
-		if (strcmp(s, c->Name) == 0)
-		{
-			return c;
-		}
+		c = NameIndexGet(
+			&gPickupClasses.ClassIndex, &gPickupClasses.Classes, s);
 	}
-	for (int i = 0; i < (int)gPickupClasses.Classes.size; i++)
+	if (c != NULL)
 	{
-		PickupClass *c = CArrayGet(&gPickupClasses.Classes, i);
-		if (strcmp(s, c->Name) == 0)
-		{
-			return c;
-		}
+		return c;
 	}
 	CASSERT(false, "cannot parse bullet name");
 	return NULL;
@@ -128,21 +124,17 @@ int StrPickupClassId(const char *s)
 	{
 		return 0;
 	}
-	for (int i = 0; i < (int)gPickupClasses.CustomClasses.size; i++)
+	int idx = NameIndexFind(
+		&gPickupClasses.CustomClassIndex, &gPickupClasses.CustomClasses, s);
+	if (idx >= 0)
 	{
-		Ammo *a = CArrayGet(&gPickupClasses.CustomClasses, i);
-		if (strcmp(s, a->Name) == 0)
-		{
-			return i + (int)gPickupClasses.Classes.size;
-		}
+		return idx + (int)gPickupClasses.Classes.size;
 	}
-	for (int i = 0; i < (int)gPickupClasses.Classes.size; i++)
+	idx = NameIndexFind(
+		&gPickupClasses.ClassIndex, &gPickupClasses.Classes, s);
+	if (idx >= 0)
 	{
-		Ammo *a = CArrayGet(&gPickupClasses.Classes, i);
-		if (strcmp(s, a->Name) == 0)
-		{
-			return i;
-		}
+		return idx;
 	}
 	CASSERT(false, "cannot parse pickup class name");
 	return 0;
@@ -150,12 +142,18 @@ int StrPickupClassId(const char *s)
 
 #define VERSION 1
 
+static const char *PickupClassGetName(const void *c)
+{
+	return ((const PickupClass *)c)->Name;
+}
 void PickupClassesInit(
 	PickupClasses *classes, const char *filename,
 	const AmmoClasses *ammo, const GunClasses *guns)
 {
 	CArrayInit(&classes->Classes, sizeof(PickupClass));
 	CArrayInit(&classes->CustomClasses, sizeof(PickupClass));
+	NameIndexInit(&classes->ClassIndex, PickupClassGetName);
+	NameIndexInit(&classes->CustomClassIndex, PickupClassGetName);
 
 	FILE *f = fopen(filename, "r");
 	json_t *root = NULL;
@@ -280,12 +278,19 @@ void PickupClassesClear(CArray *classes)
 	}
 	CArrayClear(classes);
 }
+void PickupClassesClearCustom(PickupClasses *classes)
+{
+	PickupClassesClear(&classes->CustomClasses);
+	NameIndexClear(&classes->CustomClassIndex);
+}
 void PickupClassesTerminate(PickupClasses *classes)
 {
 	PickupClassesClear(&classes->Classes);
 	CArrayTerminate(&classes->Classes);
 	PickupClassesClear(&classes->CustomClasses);
 	CArrayTerminate(&classes->CustomClasses);
+	NameIndexTerminate(&classes->ClassIndex);
+	NameIndexTerminate(&classes->CustomClassIndex);
 }
 
 int PickupClassesGetScoreCount(const PickupClasses *classes)
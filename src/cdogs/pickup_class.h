@@ -30,6 +30,7 @@
 #include <json/json.h>
 
 #include "ammo.h"
+#include "name_index.h"
 #include "utils.h"
 #include "weapon.h"
 
@@ -63,6 +64,8 @@ typedef struct
 {
 	CArray Classes;	// of PickupClass
 	CArray CustomClasses;	// of PickupClass
+	NameIndex ClassIndex;
+	NameIndex CustomClassIndex;
 } PickupClasses;
 extern PickupClasses gPickupClasses;
 
@@ -82,6 +85,7 @@ void PickupClassesLoadJSON(CArray *classes, json_t *root);
 void PickupClassesLoadAmmo(CArray *classes, const CArray *ammoClasses);
 void PickupClassesLoadGuns(CArray *classes, const CArray *gunClasses);
 void PickupClassesClear(CArray *classes);
+void PickupClassesClearCustom(PickupClasses *classes);
 void PickupClassesTerminate(PickupClasses *classes);
 
 // Count the number of "Score" type pickups
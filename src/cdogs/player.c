@@ -31,14 +31,18 @@
 #include "log.h"
 #include "net_client.h"
 #include "player_template.h"
+#include "uid_map.h"
 
 
 CArray gPlayerDatas;
+// Index into gPlayerDatas by UID
+static UIDMap sPlayerIndices;
 
 
 void PlayerDataInit(CArray *p)
 {
 	CArrayInit(p, sizeof(PlayerData));
+	UIDMapInit(&sPlayerIndices);
 }
 
 void PlayerDataAddOrUpdate(const NPlayerData pd)
@@ -50,6 +54,7 @@ void PlayerDataAddOrUpdate(const NPlayerData pd)
 		memset(&pNew, 0, sizeof pNew);
 		CArrayPushBack(&gPlayerDatas, &pNew);
 		p = CArrayGet(&gPlayerDatas, (int)gPlayerDatas.size - 1);
+		UIDMapSet(&sPlayerIndices, pd.UID, (int)gPlayerDatas.size - 1);
 
 		// Set defaults
 		p->ActorUID = -1;
@@ -94,27 +99,25 @@ static void PlayerTerminate(PlayerData *p);
 void PlayerRemove(const int uid)
 {
 	// Find the player so we can remove by index
-	PlayerData *p = NULL;
-	int i;
-	for (i = 0; i < (int)gPlayerDatas.size; i++)
-	{
-		PlayerData *pi = CArrayGet(&gPlayerDatas, i);
-		if (pi->UID == uid)
-		{
-			p = pi;
-			break;
-		}
-	}
-	if (p == NULL)
+	const int i = UIDMapGet(&sPlayerIndices, uid);
+	if (i < 0)
 	{
 		return;
 	}
+	PlayerData *p = CArrayGet(&gPlayerDatas, i);
 	if (p->ActorUID >= 0)
 	{
 		ActorDestroy(ActorGetByUID(p->ActorUID));
 	}
 	PlayerTerminate(p);
 	CArrayDelete(&gPlayerDatas, i);
+	// Players after the removed one have shifted down
+	UIDMapRemove(&sPlayerIndices, uid);
+	for (int j = i; j < (int)gPlayerDatas.size; j++)
+	{
+		const PlayerData *pj = CArrayGet(&gPlayerDatas, j);
+		UIDMapSet(&sPlayerIndices, pj->UID, j);
+	}
 
 	LOG(LM_MAIN, LL_INFO, "remove player UID(%d)", uid);
 }
@@ -246,16 +249,13 @@ void PlayerDataTerminate(CArray *p)
 		PlayerTerminate(CArrayGet(p, i));
 	}
 	CArrayTerminate(p);
+	UIDMapTerminate(&sPlayerIndices);
 }
 
 PlayerData *PlayerDataGetByUID(const int uid)
 {
-	for (int i = 0; i < (int)gPlayerDatas.size; i++)
-	{
-		PlayerData *p = CArrayGet(&gPlayerDatas, i);
-		if (p->UID == uid) return p;
-	}
-	return NULL;
+	const int i = UIDMapGet(&sPlayerIndices, uid);
+	return i >= 0 ? CArrayGet(&gPlayerDatas, i) : NULL;
 }
 
 int GetNumPlayers(
@@ -35,6 +35,9 @@
 #include "net_util.h"
 #include "pickup.h"
 
+static ConfigHandle sGameAmmo = CONFIG_HANDLE("Game.Ammo");
+static ConfigHandle sGameHealthPickups = CONFIG_HANDLE("Game.HealthPickups");
+
 
 #define TIME_DECAY_EXPONENT 1.04
 #define HEALTH_W 6
@@ -140,7 +143,7 @@ void HealthSpawnerInit(PowerupSpawner *p, Map *map)
 	PowerupSpawnerInit(p, map);
 	p->Enabled =
 		AreHealthPickupsAllowed(gCampaign.Entry.Mode) &&
-		ConfigGetBool(&gConfig, "Game.HealthPickups") &&
+		ConfigHandleGetBool(&sGameHealthPickups) &&
 		!gCampaign.IsClient;
 	p->SpawnTime = HEALTH_SPAWN_TIME;
 	p->RateScaleFunc = HealthScale;
@@ -172,14 +175,14 @@ static double HealthScale(void *data)
 static void HealthPlace(const Vec2i pos, void *data)
 {
 	UNUSED(data);
-	GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
-	e.u.AddPickup.UID = PickupsGetNextUID();
-	e.u.AddPickup.Pos = Vec2i2Net(pos);
-	strcpy(e.u.AddPickup.PickupClass, "health");
-	e.u.AddPickup.IsRandomSpawned = true;
-	e.u.AddPickup.SpawnerUID = -1;
-	e.u.AddPickup.TileItemFlags = 0;
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ADD_PICKUP);
+	e->u.AddPickup.UID = PickupsGetNextUID();
+	e->u.AddPickup.Pos = Vec2i2Net(pos);
+	strcpy(e->u.AddPickup.PickupClass, "health");
+	e->u.AddPickup.IsRandomSpawned = true;
+	e->u.AddPickup.SpawnerUID = -1;
+	e->u.AddPickup.TileItemFlags = 0;
+	GameEventsCommit(&gGameEvents, e);
 }
 
 
@@ -192,7 +195,7 @@ void AmmoSpawnerInit(PowerupSpawner *p, Map *map, const int ammoId)
 	PowerupSpawnerInit(p, map);
 	// TODO: disable ammo spawners unless classic mode
 	p->Enabled =
-		ConfigGetBool(&gConfig, "Game.Ammo") &&
+		ConfigHandleGetBool(&sGameAmmo) &&
 		!gCampaign.IsClient;
 	p->SpawnTime = AMMO_SPAWN_TIME;
 	p->RateScaleFunc = AmmoScale;
@@ -234,13 +237,13 @@ static double AmmoScale(void *data)
 static void AmmoPlace(const Vec2i pos, void *data)
 {
 	const int ammoId = *(int *)data;
-	GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
-	e.u.AddPickup.UID = PickupsGetNextUID();
-	e.u.AddPickup.Pos = Vec2i2Net(pos);
+	GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ADD_PICKUP);
+	e->u.AddPickup.UID = PickupsGetNextUID();
+	e->u.AddPickup.Pos = Vec2i2Net(pos);
 	const Ammo *a = AmmoGetById(&gAmmo, ammoId);
-	sprintf(e.u.AddPickup.PickupClass, "ammo_%s", a->Name);
-	e.u.AddPickup.IsRandomSpawned = true;
-	e.u.AddPickup.SpawnerUID = -1;
-	e.u.AddPickup.TileItemFlags = 0;
-	GameEventsEnqueue(&gGameEvents, e);
+	sprintf(e->u.AddPickup.PickupClass, "ammo_%s", a->Name);
+	e->u.AddPickup.IsRandomSpawned = true;
+	e->u.AddPickup.SpawnerUID = -1;
+	e->u.AddPickup.TileItemFlags = 0;
+	GameEventsCommit(&gGameEvents, e);
 }
@@ -0,0 +1,331 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "present.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "utils.h"
+
+
+void BrightnessLUTInit(BrightnessLUT *lut, const int brightness)
+{
+	double f = pow(1.07177346254, brightness);	// 10th root of 2; i.e. n^10 = 2
+	int m = (int)(0xFF * f);
+	for (int c = 0; c < 256; c++)
+	{
+		// Saturated multiply
+		lut->Channel[c] = (Uint8)MIN(c * m / 0xFF, 0xFF);
+	}
+}
+static Uint32 Brighten(const BrightnessLUT *lut, const Uint32 p)
+{
+	return
+		lut->Channel[p & 0xFF] |
+		(lut->Channel[(p >> 8) & 0xFF] << 8) |
+		(lut->Channel[(p >> 16) & 0xFF] << 16) |
+		((Uint32)lut->Channel[p >> 24] << 24);
+}
+#define BRIGHTEN(_lut, _p) ((_lut) != NULL ? Brighten(_lut, _p) : (_p))
+
+void Present16LUTInit(
+	Present16LUT *lut16, const SDL_PixelFormat *f, const BrightnessLUT *lut)
+{
+	// Same as SDL_MapRGB for formats without a palette or alpha, which
+	// maps each channel separately
+	for (int c = 0; c < 256; c++)
+	{
+		const Uint8 b = lut != NULL ? lut->Channel[c] : (Uint8)c;
+		lut16->R[c] = (Uint16)(((b >> f->Rloss) << f->Rshift) & f->Rmask);
+		lut16->G[c] = (Uint16)(((b >> f->Gloss) << f->Gshift) & f->Gmask);
+		lut16->B[c] = (Uint16)(((b >> f->Bloss) << f->Bshift) & f->Bmask);
+	}
+}
+
+void PresentCopy(
+	Uint32 *d, const Uint32 *s, const int w, const Rect2i r,
+	const BrightnessLUT *lut)
+{
+	for (int y = r.Pos.y; y < r.Pos.y + r.Size.y; y++)
+	{
+		const int idx = r.Pos.x + y * w;
+		if (lut == NULL)
+		{
+			memcpy(d + idx, s + idx, r.Size.x * sizeof *d);
+			continue;
+		}
+		for (int x = 0; x < r.Size.x; x++)
+		{
+			d[idx + x] = Brighten(lut, s[idx + x]);
+		}
+	}
+}
+
+void PresentTo16(
+	Uint16 *d, const Uint32 *s, const int w, const Rect2i r,
+	const Present16LUT *lut16)
+{
+	for (int y = r.Pos.y; y < r.Pos.y + r.Size.y; y++)
+	{
+		const int idx = r.Pos.x + y * w;
+		for (int x = 0; x < r.Size.x; x++)
+		{
+			// Frame pixels are 0x??RRGGBB
+			const Uint32 p = s[idx + x];
+			d[idx + x] =
+				lut16->R[(p >> 16) & 0xFF] |
+				lut16->G[(p >> 8) & 0xFF] |
+				lut16->B[p & 0xFF];
+		}
+	}
+}
+
+#define PixelIndex(x, y, w)		(y * w + x)
+
+void PresentScale(
+	Uint32 *d, const Uint32 *s, const int w, const Rect2i r, const int sf,
+	const BrightnessLUT *lut)
+{
+	int sx;
+	int sy;
+	int f = sf;
+
+	int dx, dy, dw;
+
+	if (f > 4)
+	{
+		f = 4;	/* max 4x for the moment */
+	}
+
+	dw = w * f;
+
+	for (sy = r.Pos.y; sy < r.Pos.y + r.Size.y; sy++) {
+		dy = f * sy;
+		for (sx = r.Pos.x; sx < r.Pos.x + r.Size.x; sx++)
+		{
+			Uint32 p = BRIGHTEN(lut, s[PixelIndex(sx, sy, w)]);
+			dx = f * sx;
+
+			switch (f) {
+				case 4:
+					/* right side */
+					d[PixelIndex((dx + 3),	(dy + 1),	dw)] = p;
+					d[PixelIndex((dx + 3),	(dy + 2),	dw)] = p;
+					d[PixelIndex((dx + 3),	dy,		dw)] = p;
+
+					/* bottom row */
+					d[PixelIndex(dx,	(dy + 3),	dw)] = p;
+					d[PixelIndex((dx + 1),	(dy + 3),	dw)] = p;
+					d[PixelIndex((dx + 2),	(dy + 3),	dw)] = p;
+
+					/* bottom right */
+					d[PixelIndex((dx + 3),	(dy + 3),	dw)] = p;
+
+					// fall through
+				case 3:
+					/* right side */
+					d[PixelIndex((dx + 2),	(dy + 1),	dw)] = p;
+					d[PixelIndex((dx + 2),	dy,		dw)] = p;
+
+					/* bottom row */
+					d[PixelIndex(dx,	(dy + 2),	dw)] = p;
+					d[PixelIndex((dx + 1),	(dy + 2),	dw)] = p;
+
+					/* bottom right */
+					d[PixelIndex((dx + 2),	(dy + 2),	dw)] = p;
+
+					// fall through
+				case 2:
+					d[PixelIndex((dx + 1),	dy,		dw)] = p;
+					d[PixelIndex((dx + 1),	(dy + 1),	dw)] = p;
+					d[PixelIndex(dx,	(dy + 1),	dw)] = p;
+
+					// fall through
+				default:
+					d[PixelIndex(dx,	dy,		dw)] = p;
+			}
+		}
+	}
+}
+
+static Uint32 PixAvg(Uint32 p1, Uint32 p2)
+{
+	union
+	{
+		Uint8 rgba[4];
+		Uint32 out;
+	} u1, u2;
+	int i;
+	u1.out = p1;
+	u2.out = p2;
+	for (i = 0; i < 4; i++)
+	{
+		u1.rgba[i] = (Uint8)CLAMP(((int)u1.rgba[i] + u2.rgba[i]) / 2, 0, 255);
+	}
+	return u1.out;
+}
+static Uint32 Pix3rds(Uint32 p1, Uint32 p2)
+{
+	union
+	{
+		Uint8 rgba[4];
+		Uint32 out;
+	} u1, u2;
+	int i;
+	u1.out = p1;
+	u2.out = p2;
+	for (i = 0; i < 4; i++)
+	{
+		u1.rgba[i] = (Uint8)CLAMP(((int)u1.rgba[i] + u2.rgba[i]*2) / 3, 0, 255);
+	}
+	return u1.out;
+}
+void PresentBilinear(
+	Uint32 *dest, const Uint32 *src,
+	const int w, const int h, const Rect2i r, const int scaleFactor)
+{
+	int sx, sy;
+	int dw = scaleFactor * w;
+	// Pixels are blended with the ones right and below, so the ones left
+	// and above the rectangle change too
+	const int left = MAX(r.Pos.x - 1, 0);
+	const int top = MAX(r.Pos.y - 1, 0);
+	for (sy = top; sy < r.Pos.y + r.Size.y; sy++)
+	{
+		int dy = scaleFactor * sy;
+		for (sx = left; sx < r.Pos.x + r.Size.x; sx++)
+		{
+			Uint32 p = src[PixelIndex(sx, sy, w)];
+			int dx = scaleFactor * sx;
+			switch (scaleFactor)
+			{
+			#define BLIT(x, y, pix) dest[PixelIndex((x), (y), dw)] = pix;
+			case 4:
+				{
+					// 0 1 2 3|g
+					// 4 5 6 7|h
+					// 8 9 a b|i
+					// c d e f|j
+					// k-l-m-n+o
+					Uint32 pg = src[PixelIndex(MIN(sx+1, w-1), sy, w)];
+					Uint32 p2 = PixAvg(p, pg);
+					Uint32 p1 = PixAvg(p, p2);
+					Uint32 p3 = PixAvg(p2, pg);
+					Uint32 pk = src[PixelIndex(sx, MIN(sy+1, h-1), w)];
+					Uint32 p8 = PixAvg(p, pk);
+					Uint32 p4 = PixAvg(p, p8);
+					Uint32 pc = PixAvg(p8, pk);
+					Uint32 po = src[PixelIndex(MIN(sx+1, w-1), MIN(sy+1, h-1), w)];
+					Uint32 pi = PixAvg(pg, po);
+					Uint32 pa = PixAvg(p8, pi);
+					Uint32 p9 = PixAvg(p8, pa);
+					Uint32 pb = PixAvg(pa, pi);
+					Uint32 p6 = PixAvg(p2, pa);
+					Uint32 p5 = PixAvg(p4, p6);
+					Uint32 pm = PixAvg(pk, po);
+					Uint32 pe = PixAvg(pa, pm);
+					Uint32 ph = PixAvg(pg, pi);
+					Uint32 p7 = PixAvg(p6, ph);
+					Uint32 pj = PixAvg(pi, po);
+					Uint32 pd = PixAvg(pc, pe);
+					Uint32 pf = PixAvg(pe, pj);
+					BLIT(dx, dy, p);
+					BLIT(dx+1, dy, p1);
+					BLIT(dx+2, dy, p2);
+					BLIT(dx+3, dy, p3);
+					BLIT(dx, dy+1, p4);
+					BLIT(dx+1, dy+1, p5);
+					BLIT(dx+2, dy+1, p6);
+					BLIT(dx+3, dy+1, p7);
+					BLIT(dx, dy+2, p8);
+					BLIT(dx+1, dy+2, p9);
+					BLIT(dx+2, dy+2, pa);
+					BLIT(dx+3, dy+2, pb);
+					BLIT(dx, dy+3, pc);
+					BLIT(dx+1, dy+3, pd);
+					BLIT(dx+2, dy+3, pe);
+					BLIT(dx+3, dy+3, pf);
+				}
+				break;
+			case 3:
+				{
+					// 0 1 2|9
+					// 3 4 5|a
+					// 6 7 8|b
+					// c-d-e+f
+					Uint32 p9 = src[PixelIndex(MIN(sx+1, w-1), sy, w)];
+					Uint32 p1 = Pix3rds(p9, p);
+					Uint32 p2 = Pix3rds(p, p9);
+					Uint32 pc = src[PixelIndex(sx, MIN(sy+1, h-1), w)];
+					Uint32 p3 = Pix3rds(pc, p);
+					Uint32 p6 = Pix3rds(p, pc);
+					Uint32 pf = src[PixelIndex(MIN(sx+1, w-1), MIN(sy+1, h-1), w)];
+					Uint32 pa = Pix3rds(pf, p9);
+					Uint32 pb = Pix3rds(p9, pf);
+					Uint32 p4 = Pix3rds(pa, p3);
+					Uint32 p5 = Pix3rds(p3, pa);
+					Uint32 p7 = Pix3rds(pb, p6);
+					Uint32 p8 = Pix3rds(p6, pb);
+					BLIT(dx, dy, p);
+					BLIT(dx+1, dy, p1);
+					BLIT(dx+2, dy, p2);
+					BLIT(dx, dy+1, p3);
+					BLIT(dx+1, dy+1, p4);
+					BLIT(dx+2, dy+1, p5);
+					BLIT(dx, dy+2, p6);
+					BLIT(dx+1, dy+2, p7);
+					BLIT(dx+2, dy+2, p8);
+				}
+				break;
+			case 2:
+				{
+					// 0 1|4
+					// 2 3|5
+					// 6-7+8
+					Uint32 p4 = src[PixelIndex(MIN(sx+1, w-1), sy, w)];
+					Uint32 p1 = PixAvg(p, p4);
+					Uint32 p6 = src[PixelIndex(sx, MIN(sy+1, h-1), w)];
+					Uint32 p2 = PixAvg(p, p6);
+					Uint32 p8 = src[PixelIndex(MIN(sx+1, w-1), MIN(sy+1, h-1), w)];
+					Uint32 p5 = PixAvg(p4, p8);
+					Uint32 p3 = PixAvg(p2, p5);
+					BLIT(dx, dy, p);
+					BLIT(dx+1, dy, p1);
+					BLIT(dx, dy+1, p2);
+					BLIT(dx+1, dy+1, p3);
+				}
+				break;
+			default:
+				BLIT(dx, dy, p);
+				break;
+			#undef BLIT
+			}
+		}
+	}
+}
+
@@ -0,0 +1,68 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <SDL_video.h>
+
+#include "vector.h"
+
+// Kernels that present rectangles of the frame buffer to the screen,
+// scaling and adjusting brightness in the same pass
+
+// Brightness as a per-channel table; pass NULL to kernels for none
+typedef struct
+{
+	Uint8 Channel[256];
+} BrightnessLUT;
+void BrightnessLUTInit(BrightnessLUT *lut, const int brightness);
+
+// Brightness and conversion to a 16-bit screen format, per channel
+typedef struct
+{
+	Uint16 R[256];
+	Uint16 G[256];
+	Uint16 B[256];
+} Present16LUT;
+void Present16LUTInit(
+	Present16LUT *lut16, const SDL_PixelFormat *f, const BrightnessLUT *lut);
+
+// All take the frame width w; r is the rectangle of the frame to present
+void PresentCopy(
+	Uint32 *d, const Uint32 *s, const int w, const Rect2i r,
+	const BrightnessLUT *lut);
+void PresentTo16(
+	Uint16 *d, const Uint32 *s, const int w, const Rect2i r,
+	const Present16LUT *lut16);
+void PresentScale(
+	Uint32 *d, const Uint32 *s, const int w, const Rect2i r, const int sf,
+	const BrightnessLUT *lut);
+// Blends each source pixel into several output pixels, so brighten the frame
+// first (e.g. with PresentCopy) rather than each time it is read
+void PresentBilinear(
+	Uint32 *dest, const Uint32 *src,
+	const int w, const int h, const Rect2i r, const int scaleFactor);
@@ -0,0 +1,181 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "profiler.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "utils.h"
+
+Profiler gProfiler;
+
+
+const char *ProfileSectionStr(const ProfileSection s)
+{
+	switch (s)
+	{
+		T2S(PROFILE_UPDATE, "Update");
+		T2S(PROFILE_LOS, "LOS");
+		T2S(PROFILE_AI, "AI");
+		T2S(PROFILE_ACTORS, "Actors");
+		T2S(PROFILE_OBJECTS, "Objects");
+		T2S(PROFILE_MOBILE_OBJECTS, "Mobile objects");
+		T2S(PROFILE_PARTICLES, "Particles");
+		T2S(PROFILE_EVENTS, "Events");
+		T2S(PROFILE_DRAW, "Draw");
+		T2S(PROFILE_DRAW_BUFFER, "Draw buffer");
+		T2S(PROFILE_BLIT, "Blit");
+	default:
+		return "";
+	}
+}
+
+uint64_t ProfilerNow(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	if (freq.QuadPart == 0)
+	{
+		QueryPerformanceFrequency(&freq);
+	}
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000000u +
+		(uint64_t)(now.QuadPart % freq.QuadPart) * 1000000000u /
+		(uint64_t)freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void ProfilerReset(Profiler *p)
+{
+	memset(p->Total, 0, sizeof p->Total);
+	memset(p->Calls, 0, sizeof p->Calls);
+	memset(p->Frame, 0, sizeof p->Frame);
+	memset(p->History, 0, sizeof p->History);
+	p->HistoryIndex = 0;
+	p->HistoryCount = 0;
+	p->Frames = 0;
+}
+
+bool ProfilerOpenCSV(Profiler *p, const char *filename)
+{
+	ProfilerTerminate(p);
+	p->CSV = fopen(filename, "w");
+	if (p->CSV == NULL)
+	{
+		fprintf(stderr, "Cannot open profile output %s\n", filename);
+		return false;
+	}
+	fprintf(p->CSV, "Frame");
+	for (int i = 0; i < PROFILE_COUNT; i++)
+	{
+		fprintf(p->CSV, ",%s", ProfileSectionStr((ProfileSection)i));
+	}
+	fprintf(p->CSV, "\n");
+	return true;
+}
+void ProfilerTerminate(Profiler *p)
+{
+	if (p->CSV != NULL)
+	{
+		fclose(p->CSV);
+		p->CSV = NULL;
+	}
+}
+
+void ProfilerFrameEnd(Profiler *p)
+{
+	// Skip frames where nothing was timed, e.g. menus
+	bool any = false;
+	for (int i = 0; i < PROFILE_COUNT; i++)
+	{
+		if (p->Frame[i] > 0)
+		{
+			any = true;
+			break;
+		}
+	}
+	if (!any) return;
+
+	uint32_t *row = p->History[p->HistoryIndex];
+	for (int i = 0; i < PROFILE_COUNT; i++)
+	{
+		p->Total[i] += p->Frame[i];
+		row[i] = (uint32_t)(p->Frame[i] / 1000);
+	}
+	memset(p->Frame, 0, sizeof p->Frame);
+	p->HistoryIndex = (p->HistoryIndex + 1) % PROFILER_HISTORY;
+	p->HistoryCount = MIN(p->HistoryCount + 1, PROFILER_HISTORY);
+
+	if (p->CSV != NULL)
+	{
+		fprintf(p->CSV, "%d", p->Frames);
+		for (int i = 0; i < PROFILE_COUNT; i++)
+		{
+			fprintf(p->CSV, ",%u", (unsigned)row[i]);
+		}
+		fprintf(p->CSV, "\n");
+	}
+	p->Frames++;
+}
+
+uint32_t ProfilerHistoryGet(
+	const Profiler *p, const int n, const ProfileSection s)
+{
+	if (n < 0 || n >= p->HistoryCount) return 0;
+	const int i =
+		(p->HistoryIndex - 1 - n + PROFILER_HISTORY) % PROFILER_HISTORY;
+	return p->History[i][s];
+}
+
+void ProfilerPrint(const Profiler *p, FILE *f, const int ticks)
+{
+	// Percentages are of the top-level sections
+	const uint64_t total = p->Total[PROFILE_UPDATE] +
+		p->Total[PROFILE_DRAW] + p->Total[PROFILE_BLIT];
+	fprintf(f, "%-16s %10s %12s %7s\n", "Section", "Total ms", "us/tick", "%");
+	for (int i = 0; i < PROFILE_COUNT; i++)
+	{
+		const double ms = (double)p->Total[i] / 1000000.0;
+		const double usPerTick =
+			ticks > 0 ? (double)p->Total[i] / 1000.0 / ticks : 0;
+		const double percent =
+			total > 0 ? 100.0 * (double)p->Total[i] / (double)total : 0;
+		fprintf(f, "%-16s %10.2f %12.2f %7.1f\n",
+			ProfileSectionStr((ProfileSection)i), ms, usPerTick, percent);
+	}
+}
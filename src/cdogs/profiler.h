@@ -0,0 +1,96 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Lightweight per-subsystem timers
+// Wrap a section of code in PROFILE_BEGIN/PROFILE_END; when the profiler is
+// disabled this costs a branch per section.
+// Times accumulate per frame; ProfilerFrameEnd folds them into the totals,
+// the history ring buffer and the CSV output, if any.
+typedef enum
+{
+	PROFILE_UPDATE,	// whole game update
+	PROFILE_LOS,
+	PROFILE_AI,
+	PROFILE_ACTORS,
+	PROFILE_OBJECTS,
+	PROFILE_MOBILE_OBJECTS,
+	PROFILE_PARTICLES,
+	PROFILE_EVENTS,
+	PROFILE_DRAW,	// whole game draw
+	PROFILE_DRAW_BUFFER,
+	PROFILE_BLIT,
+	PROFILE_COUNT
+} ProfileSection;
+const char *ProfileSectionStr(const ProfileSection s);
+
+// Number of frames kept for the overlay graph
+#define PROFILER_HISTORY 128
+
+typedef struct
+{
+	bool Enabled;
+	uint64_t Total[PROFILE_COUNT];	// in nanoseconds
+	int Calls[PROFILE_COUNT];
+	uint64_t Frame[PROFILE_COUNT];	// current frame, in nanoseconds
+	// Ring buffer of per-frame times, in microseconds
+	uint32_t History[PROFILER_HISTORY][PROFILE_COUNT];
+	int HistoryIndex;	// next slot to write
+	int HistoryCount;
+	int Frames;
+	FILE *CSV;
+} Profiler;
+extern Profiler gProfiler;
+
+// Monotonic time in nanoseconds
+uint64_t ProfilerNow(void);
+
+void ProfilerReset(Profiler *p);
+// Start writing one CSV row per frame; closed by ProfilerTerminate
+bool ProfilerOpenCSV(Profiler *p, const char *filename);
+void ProfilerTerminate(Profiler *p);
+void ProfilerFrameEnd(Profiler *p);
+// Get a section's time, in microseconds, n frames ago (0 = last frame)
+uint32_t ProfilerHistoryGet(
+	const Profiler *p, const int n, const ProfileSection s);
+// Print a table of section times, averaged over a number of ticks
+void ProfilerPrint(const Profiler *p, FILE *f, const int ticks);
+
+#define PROFILE_BEGIN(_section) \
+	const uint64_t _profileStart##_section = \
+		gProfiler.Enabled ? ProfilerNow() : 0
+#define PROFILE_END(_section) \
+	if (gProfiler.Enabled) \
+	{ \
+		gProfiler.Frame[_section] += ProfilerNow() - _profileStart##_section; \
+		gProfiler.Calls[_section]++; \
+	}
@@ -0,0 +1,172 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "slot_pool.h"
+
+#include <string.h>
+
+#include "utils.h"
+
+typedef struct
+{
+	int Next;	// next free slot, or -1
+	int Generation;
+} SlotPoolSlot;
+
+#define LIVE_BITS 32
+
+
+void SlotPoolInit(SlotPool *p, CArray *items)
+{
+	CASSERT(items->size == 0, "pool items must start empty");
+	p->Items = items;
+	CArrayInit(&p->Slots, sizeof(SlotPoolSlot));
+	CArrayReserve(&p->Slots, items->capacity);
+	CArrayInit(&p->Live, sizeof(uint32_t));
+	p->FreeHead = p->FreeTail = -1;
+	p->Count = 0;
+}
+void SlotPoolTerminate(SlotPool *p)
+{
+	CArrayTerminate(&p->Slots);
+	CArrayTerminate(&p->Live);
+	p->Items = NULL;
+	p->FreeHead = p->FreeTail = -1;
+	p->Count = 0;
+}
+
+static void SetLive(SlotPool *p, const int idx, const bool live)
+{
+	uint32_t *bits = CArrayGet(&p->Live, idx / LIVE_BITS);
+	const uint32_t mask = 1u << (idx % LIVE_BITS);
+	if (live)
+	{
+		*bits |= mask;
+	}
+	else
+	{
+		*bits &= ~mask;
+	}
+}
+
+int SlotPoolAdd(SlotPool *p)
+{
+	int idx;
+	if (p->FreeHead >= 0)
+	{
+		// Reuse the oldest free slot
+		idx = p->FreeHead;
+		const SlotPoolSlot *s = CArrayGet(&p->Slots, idx);
+		p->FreeHead = s->Next;
+		if (p->FreeHead < 0)
+		{
+			p->FreeTail = -1;
+		}
+	}
+	else
+	{
+		idx = (int)p->Items->size;
+		CArrayResize(p->Items, p->Items->size + 1, NULL);
+		memset(CArrayGet(p->Items, idx), 0, p->Items->elemSize);
+		SlotPoolSlot s;
+		s.Next = -1;
+		s.Generation = 0;
+		CArrayPushBack(&p->Slots, &s);
+		if (idx % LIVE_BITS == 0)
+		{
+			const uint32_t bits = 0;
+			CArrayPushBack(&p->Live, &bits);
+		}
+	}
+	SetLive(p, idx, true);
+	p->Count++;
+	return idx;
+}
+
+void SlotPoolRemove(SlotPool *p, const int idx)
+{
+	CASSERT(SlotPoolIsLive(p, idx), "removing dead slot");
+	SetLive(p, idx, false);
+	SlotPoolSlot *s = CArrayGet(&p->Slots, idx);
+	s->Generation++;
+	s->Next = -1;
+	if (p->FreeTail >= 0)
+	{
+		SlotPoolSlot *tail = CArrayGet(&p->Slots, p->FreeTail);
+		tail->Next = idx;
+	}
+	else
+	{
+		p->FreeHead = idx;
+	}
+	p->FreeTail = idx;
+	p->Count--;
+}
+
+bool SlotPoolIsLive(const SlotPool *p, const int idx)
+{
+	if (idx < 0 || idx >= (int)p->Slots.size)
+	{
+		return false;
+	}
+	const uint32_t *bits = CArrayGet(&p->Live, idx / LIVE_BITS);
+	return !!(*bits & (1u << (idx % LIVE_BITS)));
+}
+int SlotPoolGetGeneration(const SlotPool *p, const int idx)
+{
+	const SlotPoolSlot *s = CArrayGet(&p->Slots, idx);
+	return s->Generation;
+}
+bool SlotPoolIsCurrent(const SlotPool *p, const int idx, const int generation)
+{
+	return SlotPoolIsLive(p, idx) &&
+		SlotPoolGetGeneration(p, idx) == generation;
+}
+
+int SlotPoolNext(const SlotPool *p, const int idx)
+{
+	const int size = (int)p->Slots.size;
+	int i = idx;
+	while (i < size)
+	{
+		const uint32_t *bits = CArrayGet(&p->Live, i / LIVE_BITS);
+		uint32_t word = *bits >> (i % LIVE_BITS);
+		if (word == 0)
+		{
+			// Skip the rest of this word
+			i = (i / LIVE_BITS + 1) * LIVE_BITS;
+			continue;
+		}
+		while (!(word & 1))
+		{
+			word >>= 1;
+			i++;
+		}
+		return i;
+	}
+	return -1;
+}
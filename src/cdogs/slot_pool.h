@@ -0,0 +1,76 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "c_array.h"
+
+// Slot allocator for entity arrays (actors, objects etc.)
+// Entities stay in a plain CArray so they can still be accessed by index;
+// the pool tracks which slots are live with a bitmap, and keeps a free list
+// of dead slots so add and remove are O(1).
+// Dead slots are reused oldest-first, so a destroyed entity keeps its data
+// (and stays findable by UID) for as long as possible.
+// Each slot has a generation that is bumped when the slot is freed; use it
+// to detect stale indices.
+typedef struct
+{
+	CArray *Items;
+	CArray Slots;	// of SlotPoolSlot, one per item
+	CArray Live;	// of uint32_t, bitmap of live slots
+	int FreeHead;
+	int FreeTail;
+	int Count;	// number of live slots
+} SlotPool;
+
+void SlotPoolInit(SlotPool *p, CArray *items);
+// Note: does not terminate the items array
+void SlotPoolTerminate(SlotPool *p);
+
+// Allocate a slot and return its index
+// New slots are zeroed, but reused slots keep their old data; the caller
+// should clear them.
+int SlotPoolAdd(SlotPool *p);
+void SlotPoolRemove(SlotPool *p, const int idx);
+bool SlotPoolIsLive(const SlotPool *p, const int idx);
+int SlotPoolGetGeneration(const SlotPool *p, const int idx);
+// Whether a slot is live and hasn't been freed since generation was taken
+bool SlotPoolIsCurrent(const SlotPool *p, const int idx, const int generation);
+// Get the first live slot at or after idx, or -1 if none
+int SlotPoolNext(const SlotPool *p, const int idx);
+
+// Convenience macro for looping through the live items of a pool
+#define SLOT_POOL_FOREACH(_type, _var, _p)\
+	for (int i = SlotPoolNext(&(_p), 0);\
+		i >= 0;\
+		i = SlotPoolNext(&(_p), i + 1))\
+	{\
+		_type *_var = CArrayGet((_p).Items, i);
+#define SLOT_POOL_FOREACH_END() }
@@ -135,6 +135,10 @@ void SoundAdd(CArray *sounds, const char *name, Mix_Chunk *data)
 }
 
 static void SoundLoadDirImpl(SoundDevice *s, const char *path, const char *prefix);
+static const char *SoundDataGetName(const void *sound)
+{
+	return ((const SoundData *)sound)->Name;
+}
 void SoundInitialize(SoundDevice *device, const char *path)
 {
 	/*#if defined(__RS97__)
@@ -154,6 +158,8 @@ void SoundInitialize(SoundDevice *device, const char *path)
 
 	CArrayInit(&device->sounds, sizeof(SoundData));
 	CArrayInit(&device->customSounds, sizeof(SoundData));
+	NameIndexInit(&device->soundIndex, SoundDataGetName);
+	NameIndexInit(&device->customSoundIndex, SoundDataGetName);
 	SoundLoadDirImpl(device, path, NULL);
 
 	// Look for commonly used sounds to set our pointers
@@ -272,6 +278,11 @@ void SoundClear(CArray *sounds)
 	}
 	CArrayClear(sounds);
 }
+void SoundClearCustom(SoundDevice *device)
+{
+	SoundClear(&device->customSounds);
+	NameIndexClear(&device->customSoundIndex);
+}
 
 void SoundTerminate(SoundDevice *device, const bool waitForSoundsComplete)
 {
@@ -302,6 +313,8 @@ void SoundTerminate(SoundDevice *device, const bool waitForSoundsComplete)
 	CArrayTerminate(&device->sounds);
 	SoundClear(&device->customSounds);
 	CArrayTerminate(&device->customSounds);
+	NameIndexTerminate(&device->soundIndex);
+	NameIndexTerminate(&device->customSoundIndex);
 }
 
 #define OUT_OF_SIGHT_DISTANCE_PLUS 200
@@ -529,21 +542,17 @@ Mix_Chunk *StrSound(const char *s)
 	{
 		return NULL;
 	}
-	for (int i = 0; i < (int)gSoundDevice.customSounds.size; i++)
+	// Custom sounds shadow built-in ones
+	SoundData *sound = NameIndexGet(
+		&gSoundDevice.customSoundIndex, &gSoundDevice.customSounds, s);
+	if (sound == NULL)
 	{
-		SoundData *sound = CArrayGet(&gSoundDevice.customSounds, i);
-		if (strcmp(sound->Name, s) == 0)
-		{
-			return sound->data;
-		}
+		sound = NameIndexGet(
+			&gSoundDevice.soundIndex, &gSoundDevice.sounds, s);
 	}
-	for (int i = 0; i < (int)gSoundDevice.sounds.size; i++)
+	if (sound != NULL)
 	{
-		SoundData *sound = CArrayGet(&gSoundDevice.sounds, i);
-		if (strcmp(sound->Name, s) == 0)
-		{
-			return sound->data;
-		}
+		return sound->data;
 	}
 	return NULL;
 }
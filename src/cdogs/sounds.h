@@ -54,6 +54,7 @@
 
 #include "c_array.h"
 #include "defs.h"
+#include "name_index.h"
 #include "sys_config.h"
 #include "utils.h"
 #include "vector.h"
@@ -88,6 +89,8 @@ typedef struct
 
 	CArray sounds;	// of SoundData
 	CArray customSounds;	// of SoundData
+	NameIndex soundIndex;
+	NameIndex customSoundIndex;
 
 	// Some commonly-used sounds, store them here for quick access
 	CArray footstepSounds;	// of Mix_Chunk *
@@ -124,6 +127,7 @@ void SoundInitialize(SoundDevice *device, const char *path);
 void SoundAdd(CArray *sounds, const char *name, Mix_Chunk *data);
 void SoundReconfigure(SoundDevice *s);
 void SoundClear(CArray *sounds);
+void SoundClearCustom(SoundDevice *device);
 void SoundTerminate(SoundDevice *device, const bool waitForSoundsComplete);
 void SoundPlay(SoundDevice *device, Mix_Chunk *data);
 void SoundSetEarsSide(const bool isLeft, const Vec2i pos);
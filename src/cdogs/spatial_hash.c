@@ -0,0 +1,230 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "spatial_hash.h"
+
+#include "utils.h"
+
+#define KIND_COUNT (KIND_PICKUP + 1)
+
+// Back-index from thing id to where its entry is stored
+typedef struct
+{
+	int Cell;	// -1 if not in hash
+	int Slot;
+} SpatialHashRef;
+
+
+void SpatialHashInit(SpatialHash *h, const Vec2i size, const Vec2i cellSize)
+{
+	memset(h, 0, sizeof *h);
+	h->CellSize = cellSize;
+	h->Size = Vec2iNew(
+		(size.x + cellSize.x - 1) / cellSize.x,
+		(size.y + cellSize.y - 1) / cellSize.y);
+	// Cells are zeroed and initialised on first insert;
+	// it's very slow to do 128x128 mallocs
+	CArrayInit(&h->Cells, sizeof(CArray));
+	CArrayResize(&h->Cells, h->Size.x * h->Size.y, NULL);
+	CArrayFillZero(&h->Cells);
+	for (int i = 0; i < KIND_COUNT; i++)
+	{
+		CArrayInit(&h->Index[i], sizeof(SpatialHashRef));
+	}
+}
+void SpatialHashTerminate(SpatialHash *h)
+{
+	for (int i = 0; i < (int)h->Cells.size; i++)
+	{
+		CArray *cell = CArrayGet(&h->Cells, i);
+		if (cell->elemSize > 0)
+		{
+			CArrayTerminate(cell);
+		}
+	}
+	CArrayTerminate(&h->Cells);
+	for (int i = 0; i < KIND_COUNT; i++)
+	{
+		CArrayTerminate(&h->Index[i]);
+	}
+}
+
+static SpatialHashRef *GetRef(const SpatialHash *h, const ThingId id)
+{
+	const CArray *index = &h->Index[id.Kind];
+	if (id.Id < 0 || id.Id >= (int)index->size)
+	{
+		return NULL;
+	}
+	SpatialHashRef *ref = CArrayGet(index, id.Id);
+	return ref->Cell >= 0 ? ref : NULL;
+}
+static int GetCellIndex(const SpatialHash *h, const Vec2i pos)
+{
+	const Vec2i cell = SpatialHashGetCell(h, pos);
+	return CLAMP(cell.y, 0, h->Size.y - 1) * h->Size.x +
+		CLAMP(cell.x, 0, h->Size.x - 1);
+}
+
+void SpatialHashInsert(SpatialHash *h, const SpatialHashEntry *e)
+{
+	CASSERT(e->Id.Id >= 0, "invalid ThingId");
+	CASSERT(
+		e->Id.Kind >= 0 && e->Id.Kind < KIND_COUNT, "unknown thing kind");
+	CASSERT(GetRef(h, e->Id) == NULL, "thing already in spatial hash");
+	const int cellIndex = GetCellIndex(h, e->Pos);
+	CArray *cell = CArrayGet(&h->Cells, cellIndex);
+	// Lazy initialisation
+	if (cell->elemSize == 0)
+	{
+		CArrayInit(cell, sizeof(SpatialHashEntry));
+	}
+	CArrayPushBack(cell, e);
+
+	CArray *index = &h->Index[e->Id.Kind];
+	if (e->Id.Id >= (int)index->size)
+	{
+		SpatialHashRef none;
+		none.Cell = -1;
+		none.Slot = -1;
+		CArrayResize(index, e->Id.Id + 1, &none);
+	}
+	SpatialHashRef *ref = CArrayGet(index, e->Id.Id);
+	ref->Cell = cellIndex;
+	ref->Slot = (int)cell->size - 1;
+}
+
+void SpatialHashRemove(SpatialHash *h, const ThingId id)
+{
+	SpatialHashRef *ref = GetRef(h, id);
+	if (ref == NULL)
+	{
+		return;
+	}
+	CArray *cell = CArrayGet(&h->Cells, ref->Cell);
+	// Swap with the last entry so removal doesn't shift the array
+	const int last = (int)cell->size - 1;
+	if (ref->Slot != last)
+	{
+		const SpatialHashEntry *moved = CArrayGet(cell, last);
+		memcpy(CArrayGet(cell, ref->Slot), moved, sizeof *moved);
+		SpatialHashRef *movedRef =
+			CArrayGet(&h->Index[moved->Id.Kind], moved->Id.Id);
+		movedRef->Slot = ref->Slot;
+	}
+	cell->size--;
+	ref->Cell = -1;
+	ref->Slot = -1;
+}
+
+void SpatialHashUpdate(SpatialHash *h, const SpatialHashEntry *e)
+{
+	const SpatialHashRef *ref = GetRef(h, e->Id);
+	if (ref != NULL && ref->Cell == GetCellIndex(h, e->Pos))
+	{
+		// Same cell; update in place
+		memcpy(
+			CArrayGet(CArrayGet(&h->Cells, ref->Cell), ref->Slot),
+			e, sizeof *e);
+		return;
+	}
+	SpatialHashRemove(h, e->Id);
+	SpatialHashInsert(h, e);
+}
+
+SpatialHashEntry *SpatialHashGet(const SpatialHash *h, const ThingId id)
+{
+	const SpatialHashRef *ref = GetRef(h, id);
+	if (ref == NULL)
+	{
+		return NULL;
+	}
+	return CArrayGet(CArrayGet(&h->Cells, ref->Cell), ref->Slot);
+}
+
+Vec2i SpatialHashGetCell(const SpatialHash *h, const Vec2i pos)
+{
+	return Vec2iNew(pos.x / h->CellSize.x, pos.y / h->CellSize.y);
+}
+
+const CArray *SpatialHashGetCellEntries(
+	const SpatialHash *h, const Vec2i cell)
+{
+	if (cell.x < 0 || cell.x >= h->Size.x ||
+		cell.y < 0 || cell.y >= h->Size.y)
+	{
+		return NULL;
+	}
+	const CArray *entries =
+		CArrayGet(&h->Cells, cell.y * h->Size.x + cell.x);
+	return entries->size > 0 ? entries : NULL;
+}
+
+void SpatialHashQuery(
+	const SpatialHash *h, const Vec2i pos, const int cellRadius,
+	const int mask, CArray *out)
+{
+	const Vec2i center = SpatialHashGetCell(h, pos);
+	const Vec2i start = Vec2iNew(
+		MAX(center.x - cellRadius, 0), MAX(center.y - cellRadius, 0));
+	const Vec2i end = Vec2iNew(
+		MIN(center.x + cellRadius, h->Size.x - 1),
+		MIN(center.y + cellRadius, h->Size.y - 1));
+	Vec2i cv;
+	for (cv.y = start.y; cv.y <= end.y; cv.y++)
+	{
+		for (cv.x = start.x; cv.x <= end.x; cv.x++)
+		{
+			const CArray *cell =
+				CArrayGet(&h->Cells, cv.y * h->Size.x + cv.x);
+			if (cell->size == 0)
+			{
+				continue;
+			}
+			// Reserve for the whole cell so we can copy without checks
+			if (out->size + cell->size > out->capacity)
+			{
+				CArrayReserve(
+					out, MAX(out->capacity * 2, out->size + cell->size));
+			}
+			SpatialHashEntry *dst = (SpatialHashEntry *)out->data + out->size;
+			const SpatialHashEntry *e = cell->data;
+			if (mask == 0)
+			{
+				memcpy(dst, e, cell->size * sizeof *e);
+				out->size += cell->size;
+				continue;
+			}
+			for (int i = 0; i < (int)cell->size; i++, e++)
+			{
+				if (!(e->Flags & mask)) continue;
+				*dst++ = *e;
+				out->size++;
+			}
+		}
+	}
+}
@@ -0,0 +1,82 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include "c_array.h"
+#include "tile.h"
+#include "vector.h"
+
+// Broadphase for tile items
+// The map is divided into a uniform grid of cells; each cell holds a dense
+// array of entries with the data needed for collision tests stored inline,
+// so queries don't need to chase the owning actor/object/particle arrays.
+// Each thing kind also has a back-index (by id) to its cell and slot, so
+// insert, move and remove are all O(1).
+typedef struct
+{
+	ThingId Id;
+	Vec2i Pos;
+	Vec2i Size;
+	int Flags;
+	int Team;
+} SpatialHashEntry;
+
+typedef struct
+{
+	Vec2i CellSize;
+	Vec2i Size;	// in cells
+	CArray Cells;	// of CArray of SpatialHashEntry, lazily initialised
+	CArray Index[KIND_PICKUP + 1];	// of SpatialHashRef, by ThingId.Id
+} SpatialHash;
+
+void SpatialHashInit(SpatialHash *h, const Vec2i size, const Vec2i cellSize);
+void SpatialHashTerminate(SpatialHash *h);
+
+// Add a new entry; the thing must not already be in the hash
+void SpatialHashInsert(SpatialHash *h, const SpatialHashEntry *e);
+// Remove an entry if it exists
+void SpatialHashRemove(SpatialHash *h, const ThingId id);
+// Update the position and inline data of an existing entry, or insert it
+void SpatialHashUpdate(SpatialHash *h, const SpatialHashEntry *e);
+// Get the entry for a thing, or NULL if not in the hash
+SpatialHashEntry *SpatialHashGet(const SpatialHash *h, const ThingId id);
+
+Vec2i SpatialHashGetCell(const SpatialHash *h, const Vec2i pos);
+// Get all entries in a cell, or NULL if the cell is empty or outside
+const CArray *SpatialHashGetCellEntries(
+	const SpatialHash *h, const Vec2i cell);
+
+// Batched query: collect all entries in cells within cellRadius of the
+// cell containing pos, that have any of the flags in mask (or all entries
+// if mask is 0), into out (of SpatialHashEntry).
+// Entries are collected in row-major cell order.
+void SpatialHashQuery(
+	const SpatialHash *h, const Vec2i pos, const int cellRadius,
+	const int mask, CArray *out);
@@ -76,10 +76,6 @@ void TileDestroy(Tile *t)
 	{
 		CArrayTerminate(&t->triggers);
 	}
-	if (t->things.elemSize > 0)
-	{
-		CArrayTerminate(&t->things);
-	}
 }
 
 bool IsTileItemInsideTile(TTileItem *i, Vec2i tilePos)
@@ -103,32 +99,6 @@ bool TileIsNormalFloor(Tile *t)
 {
 	return t->flags & MAPTILE_IS_NORMAL_FLOOR;
 }
-bool TileIsClear(Tile *t)
-{
-	// Check if tile is normal floor
-	const int normalFloorFlags =
-		MAPTILE_IS_NORMAL_FLOOR | MAPTILE_IS_DRAINAGE | MAPTILE_OFFSET_PIC;
-	if (t->flags & ~normalFloorFlags) return false;
-	// Check if tile has no things on it, excluding particles
-	for (int i = 0; i < (int)t->things.size; i++)
-	{
-		const ThingId *tid = CArrayGet(&t->things, i);
-		if (tid->Kind != KIND_PARTICLE) return false;
-	}
-	return true;
-}
-bool TileHasCharacter(Tile *t)
-{
-	for (int i = 0; i < (int)t->things.size; i++)
-	{
-		ThingId *tid = CArrayGet(&t->things, i);
-		if (tid->Kind == KIND_CHARACTER)
-		{
-			return true;
-		}
-	}
-	return false;
-}
 
 void TileSetAlternateFloor(Tile *t, NamedPic *p)
 {
@@ -137,7 +107,7 @@ void TileSetAlternateFloor(Tile *t, NamedPic *p)
 }
 
 
-TTileItem *ThingIdGetTileItem(ThingId *tid)
+TTileItem *ThingIdGetTileItem(const ThingId *tid)
 {
 	TTileItem *ti = NULL;
 	switch (tid->Kind)
@@ -157,7 +157,6 @@ typedef struct
 	int flags;
 	bool isVisited;
 	CArray triggers;	// of Trigger *
-	CArray things;		// of ThingId
 } Tile;
 
 
@@ -168,9 +167,7 @@ bool IsTileItemInsideTile(TTileItem *i, Vec2i tilePos);
 bool TileCanSee(Tile *t);
 bool TileCanWalk(const Tile *t);
 bool TileIsNormalFloor(Tile *t);
-bool TileIsClear(Tile *t);
-bool TileHasCharacter(Tile *t);
 void TileSetAlternateFloor(Tile *t, NamedPic *p);
 
-TTileItem *ThingIdGetTileItem(ThingId *tid);
+TTileItem *ThingIdGetTileItem(const ThingId *tid);
 bool TileItemIsDebris(const TTileItem *t);
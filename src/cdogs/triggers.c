@@ -193,7 +193,7 @@ static void ActionRun(Action *a, CArray *mapTriggers)
 		break;
 
 	case ACTION_EVENT:
-		GameEventsEnqueue(&gGameEvents, a->a.Event);
+		GameEventsEnqueue(&gGameEvents, &a->a.Event);
 		break;
 
 	case ACTION_ACTIVATEWATCH:
@@ -220,7 +220,7 @@ static bool ConditionsMet(CArray *conditions, const int ticks)
 		switch (c->Type)
 		{
 		case CONDITION_TILECLEAR:
-			conditionMet = TileIsClear(MapGetTile(&gMap, c->Pos));
+			conditionMet = MapTileIsClear(&gMap, c->Pos);
 			break;
 		}
 		if (conditionMet)
@@ -0,0 +1,163 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "uid_map.h"
+
+#include <limits.h>
+
+#include "utils.h"
+
+#define UID_MAP_EMPTY INT_MIN
+#define UID_MAP_INITIAL_SIZE 64
+// Grow when more than 3/4 full
+#define UID_MAP_IS_FULL(_count, _size) ((_count) * 4 >= (int)(_size) * 3)
+
+
+static void Rehash(UIDMap *m, const int size);
+
+void UIDMapInit(UIDMap *m)
+{
+	CArrayInit(&m->Entries, sizeof(UIDMapEntry));
+	m->Count = 0;
+	Rehash(m, UID_MAP_INITIAL_SIZE);
+}
+void UIDMapTerminate(UIDMap *m)
+{
+	CArrayTerminate(&m->Entries);
+	m->Count = 0;
+}
+void UIDMapClear(UIDMap *m)
+{
+	for (int i = 0; i < (int)m->Entries.size; i++)
+	{
+		UIDMapEntry *e = CArrayGet(&m->Entries, i);
+		e->UID = UID_MAP_EMPTY;
+	}
+	m->Count = 0;
+}
+
+static int Hash(const int uid, const int mask)
+{
+	// Fibonacci hashing; UIDs are mostly sequential so spread them out
+	return (int)(((unsigned)uid * 2654435769u) >> 7) & mask;
+}
+static int FindSlot(const UIDMap *m, const int uid)
+{
+	const int mask = (int)m->Entries.size - 1;
+	for (int i = Hash(uid, mask);; i = (i + 1) & mask)
+	{
+		const UIDMapEntry *e = CArrayGet(&m->Entries, i);
+		if (e->UID == uid || e->UID == UID_MAP_EMPTY)
+		{
+			return i;
+		}
+	}
+}
+
+void UIDMapSet(UIDMap *m, const int uid, const int index)
+{
+	CASSERT(uid != UID_MAP_EMPTY, "invalid UID");
+	UIDMapEntry *e = CArrayGet(&m->Entries, FindSlot(m, uid));
+	if (e->UID == uid)
+	{
+		e->Index = index;
+		return;
+	}
+	e->UID = uid;
+	e->Index = index;
+	m->Count++;
+	if (UID_MAP_IS_FULL(m->Count, m->Entries.size))
+	{
+		Rehash(m, (int)m->Entries.size * 2);
+	}
+}
+
+void UIDMapRemove(UIDMap *m, const int uid)
+{
+	if (m->Entries.size == 0) return;
+	const int mask = (int)m->Entries.size - 1;
+	int i = FindSlot(m, uid);
+	UIDMapEntry *e = CArrayGet(&m->Entries, i);
+	if (e->UID == UID_MAP_EMPTY)
+	{
+		return;
+	}
+	// Backward-shift: pull later entries in the run into the hole, as long
+	// as that doesn't move them before their home slot
+	for (int j = (i + 1) & mask;; j = (j + 1) & mask)
+	{
+		UIDMapEntry *next = CArrayGet(&m->Entries, j);
+		if (next->UID == UID_MAP_EMPTY)
+		{
+			break;
+		}
+		const int home = Hash(next->UID, mask);
+		// Distance from home, wrapping around the table
+		if (((j - home) & mask) >= ((j - i) & mask))
+		{
+			*e = *next;
+			e = next;
+			i = j;
+		}
+	}
+	e->UID = UID_MAP_EMPTY;
+	m->Count--;
+}
+
+void UIDMapRemoveIndex(UIDMap *m, const int uid, const int index)
+{
+	if (UIDMapGet(m, uid) == index)
+	{
+		UIDMapRemove(m, uid);
+	}
+}
+
+int UIDMapGet(const UIDMap *m, const int uid)
+{
+	// Allow lookups after terminate, e.g. during shutdown
+	if (m->Entries.size == 0) return -1;
+	const UIDMapEntry *e = CArrayGet(&m->Entries, FindSlot(m, uid));
+	return e->UID == uid ? e->Index : -1;
+}
+
+static void Rehash(UIDMap *m, const int size)
+{
+	CArray old = m->Entries;
+	CArrayInit(&m->Entries, sizeof(UIDMapEntry));
+	UIDMapEntry empty;
+	empty.UID = UID_MAP_EMPTY;
+	empty.Index = -1;
+	CArrayResize(&m->Entries, size, &empty);
+	for (int i = 0; i < (int)old.size; i++)
+	{
+		const UIDMapEntry *e = CArrayGet(&old, i);
+		if (e->UID == UID_MAP_EMPTY) continue;
+		UIDMapEntry *dst = CArrayGet(&m->Entries, FindSlot(m, e->UID));
+		*dst = *e;
+	}
+	CArrayTerminate(&old);
+}
@@ -0,0 +1,58 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include "c_array.h"
+
+// Hash map from UID to array index, for O(1) *GetByUID lookups
+// Open addressing with linear probing; removal uses backward-shift so there
+// are no tombstones and probe lengths stay short under churn.
+typedef struct
+{
+	int UID;
+	int Index;
+} UIDMapEntry;
+
+typedef struct
+{
+	CArray Entries;	// of UIDMapEntry; size is always a power of 2
+	int Count;
+} UIDMap;
+
+void UIDMapInit(UIDMap *m);
+void UIDMapTerminate(UIDMap *m);
+void UIDMapClear(UIDMap *m);
+
+// Add or replace the index for a UID
+void UIDMapSet(UIDMap *m, const int uid, const int index);
+// Remove a UID if it exists
+void UIDMapRemove(UIDMap *m, const int uid);
+// Remove a UID only if it maps to this index; use when reusing a slot
+void UIDMapRemoveIndex(UIDMap *m, const int uid, const int index);
+// Get the index for a UID, or -1 if not found
+int UIDMapGet(const UIDMap *m, const int uid);
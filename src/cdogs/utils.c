@@ -67,6 +67,8 @@ int debug_level = D_NORMAL;
 bool gTrue = true;
 bool gFalse = false;
 
+unsigned int gAllocCount = 0;
+
 // From answer by ThiefMaster
 // http://stackoverflow.com/a/5309508/2038264
 // License: http://creativecommons.org/licenses/by-sa/3.0/
@@ -64,6 +64,10 @@ extern int debug_level;
 extern bool gTrue;
 extern bool gFalse;
 
+// Number of heap allocations made through the C*ALLOC macros
+// Use to check that hot paths don't allocate
+extern unsigned int gAllocCount;
+
 #define D_NORMAL	0
 #define D_VERBOSE	1
 #define D_MAX		2
@@ -93,6 +97,7 @@ extern bool gFalse;
 
 #define _CCHECKALLOC(_func, _var, _size)\
 {\
+	gAllocCount++;\
 	if (_var == NULL && _size > 0)\
 	{\
 		debug(D_MAX,\
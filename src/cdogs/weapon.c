@@ -61,6 +61,8 @@
 #include "objs.h"
 #include "sounds.h"
 
+static ConfigHandle sSoundReloads = CONFIG_HANDLE("Sound.Reloads");
+
 GunClasses gGunDescriptions;
 
 const TOffsetPic cGunPics[GUNPIC_COUNT][DIRECTION_COUNT][GUNSTATE_COUNT] = {
@@ -101,11 +103,17 @@ const OffsetTable cMuzzleOffset[GUNPIC_COUNT] = {
 
 // Initialise all the static weapon data
 #define VERSION 1
+static const char *GunDescriptionGetName(const void *gd)
+{
+	return ((const GunDescription *)gd)->name;
+}
 void WeaponInitialize(GunClasses *g)
 {
 	memset(g, 0, sizeof *g);
 	CArrayInit(&g->Guns, sizeof(const GunDescription));
 	CArrayInit(&g->CustomGuns, sizeof(const GunDescription));
+	NameIndexInit(&g->GunIndex, GunDescriptionGetName);
+	NameIndexInit(&g->CustomGunIndex, GunDescriptionGetName);
 }
 static void LoadGunDescription(
 	GunDescription *g, json_t *node, const GunDescription *defaultGun);
@@ -142,6 +150,8 @@ void WeaponLoadJSON(GunClasses *g, CArray *classes, json_t *root)
 		if (idx >= 0 && idx < GUN_COUNT && classes == &g->Guns)
 		{
 			memcpy(CArrayGet(&g->Guns, idx), &gd, sizeof gd);
+			// Renamed in place
+			NameIndexClear(&g->GunIndex);
 		}
 		else
 		{
@@ -280,6 +290,8 @@ void WeaponTerminate(GunClasses *g)
 	CArrayTerminate(&g->Guns);
 	WeaponClassesClear(&g->CustomGuns);
 	CArrayTerminate(&g->CustomGuns);
+	NameIndexTerminate(&g->GunIndex);
+	NameIndexTerminate(&g->CustomGunIndex);
 }
 void WeaponClassesClear(CArray *classes)
 {
@@ -291,6 +303,11 @@ void WeaponClassesClear(CArray *classes)
 	}
 	CArrayClear(classes);
 }
+void WeaponClassesClearCustom(GunClasses *g)
+{
+	WeaponClassesClear(&g->CustomGuns);
+	NameIndexClear(&g->CustomGunIndex);
+}
 
 Weapon WeaponCreate(const GunDescription *gun)
 {
@@ -304,25 +321,19 @@ Weapon WeaponCreate(const GunDescription *gun)
 	return w;
 }
 
-// TODO: use map structure?
 const GunDescription *StrGunDescription(const char *s)
 {
-	for (int i = 0; i < (int)gGunDescriptions.Guns.size; i++)
+	// Note: built-in guns take precedence over custom ones
+	const GunDescription *gd = NameIndexGet(
+		&gGunDescriptions.GunIndex, &gGunDescriptions.Guns, s);
+	if (gd == NULL)
 	{
-		const GunDescription *gd = CArrayGet(&gGunDescriptions.Guns, i);
-		if (strcmp(s, gd->name) == 0)
-		{
-			return gd;
-		}
+		gd = NameIndexGet(
+			&gGunDescriptions.CustomGunIndex, &gGunDescriptions.CustomGuns, s);
 	}
-	for (int i = 0; i < (int)gGunDescriptions.CustomGuns.size; i++)
+	if (gd != NULL)
 	{
-		const GunDescription *gd =
-			CArrayGet(&gGunDescriptions.CustomGuns, i);
-		if (strcmp(s, gd->name) == 0)
-		{
-			return gd;
-		}
+		return gd;
 	}
 	fprintf(stderr, "Cannot parse gun name: %s\n", s);
 	return NULL;
@@ -369,18 +380,18 @@ void WeaponUpdate(
 	const int playerUID)
 {
 	// Reload sound
-	if (ConfigGetBool(&gConfig, "Sound.Reloads") &&
+	if (ConfigHandleGetBool(&sSoundReloads) &&
 		w->lock > w->Gun->ReloadLead &&
 		w->lock - ticks <= w->Gun->ReloadLead &&
 		w->lock > 0 &&
 		w->Gun->ReloadSound != NULL)
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_GUN_RELOAD);
-		e.u.GunReload.PlayerUID = playerUID;
-		strcpy(e.u.GunReload.Gun, w->Gun->name);
-		e.u.GunReload.FullPos = Vec2i2Net(fullPos);
-		e.u.GunReload.Direction = (int)d;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_GUN_RELOAD);
+		e->u.GunReload.PlayerUID = playerUID;
+		strcpy(e->u.GunReload.Gun, w->Gun->name);
+		e->u.GunReload.FullPos = Vec2i2Net(fullPos);
+		e->u.GunReload.Direction = (int)d;
+		GameEventsCommit(&gGameEvents, e);
 	}
 	w->lock -= ticks;
 	if (w->lock < 0)
@@ -418,10 +429,10 @@ void WeaponFire(
 {
 	if (w->state != GUNSTATE_FIRING && w->state != GUNSTATE_RECOIL)
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_GUN_STATE);
-		e.u.GunState.ActorUID = uid;
-		e.u.GunState.State = GUNSTATE_FIRING;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_GUN_STATE);
+		e->u.GunState.ActorUID = uid;
+		e->u.GunState.State = GUNSTATE_FIRING;
+		GameEventsCommit(&gGameEvents, e);
 	}
 	if (!w->Gun->CanShoot)
 	{
@@ -449,25 +460,25 @@ void GunFire(
 	const int flags, const int playerUID, const int uid,
 	const bool playSound, const bool isGun)
 {
-	GameEvent e = GameEventNew(GAME_EVENT_GUN_FIRE);
-	e.u.GunFire.UID = uid;
-	e.u.GunFire.PlayerUID = playerUID;
-	strcpy(e.u.GunFire.Gun, g->name);
-	e.u.GunFire.MuzzleFullPos = Vec2i2Net(fullPos);
-	e.u.GunFire.Z = z;
-	e.u.GunFire.Angle = (float)radians;
-	e.u.GunFire.Sound = playSound;
-	e.u.GunFire.Flags = flags;
-	e.u.GunFire.IsGun = isGun;
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_GUN_FIRE);
+	e->u.GunFire.UID = uid;
+	e->u.GunFire.PlayerUID = playerUID;
+	strcpy(e->u.GunFire.Gun, g->name);
+	e->u.GunFire.MuzzleFullPos = Vec2i2Net(fullPos);
+	e->u.GunFire.Z = z;
+	e->u.GunFire.Angle = (float)radians;
+	e->u.GunFire.Sound = playSound;
+	e->u.GunFire.Flags = flags;
+	e->u.GunFire.IsGun = isGun;
+	GameEventsCommit(&gGameEvents, e);
 }
 
 void GunAddBrass(
 	const GunDescription *g, const direction_e d, const Vec2i pos)
 {
 	CASSERT(g->Brass, "Cannot create brass for no-brass weapon");
-	GameEvent e = GameEventNew(GAME_EVENT_ADD_PARTICLE);
-	e.u.AddParticle.Class = g->Brass;
+	GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ADD_PARTICLE);
+	e->u.AddParticle.Class = g->Brass;
 	double x, y;
 	const double radians = dir2radians[d];
 	GetVectorsForRadians(radians, &x, &y);
@@ -475,16 +486,16 @@ void GunAddBrass(
 		(int)round(x), (int)round(y)), 7));
 	const Vec2i muzzleOffset = GunGetMuzzleOffset(g, d);
 	const Vec2i muzzlePosition = Vec2iAdd(pos, muzzleOffset);
-	e.u.AddParticle.FullPos = Vec2iMinus(muzzlePosition, ejectionPortOffset);
-	e.u.AddParticle.Z = g->MuzzleHeight;
-	e.u.AddParticle.Vel = Vec2iScaleDiv(
+	e->u.AddParticle.FullPos = Vec2iMinus(muzzlePosition, ejectionPortOffset);
+	e->u.AddParticle.Z = g->MuzzleHeight;
+	e->u.AddParticle.Vel = Vec2iScaleDiv(
 		GetFullVectorsForRadians(radians + PI / 2), 3);
-	e.u.AddParticle.Vel.x += (rand() % 128) - 64;
-	e.u.AddParticle.Vel.y += (rand() % 128) - 64;
-	e.u.AddParticle.Angle = RAND_DOUBLE(0, PI * 2);
-	e.u.AddParticle.DZ = (rand() % 6) + 6;
-	e.u.AddParticle.Spin = RAND_DOUBLE(-0.1, 0.1);
-	GameEventsEnqueue(&gGameEvents, e);
+	e->u.AddParticle.Vel.x += (rand() % 128) - 64;
+	e->u.AddParticle.Vel.y += (rand() % 128) - 64;
+	e->u.AddParticle.Angle = RAND_DOUBLE(0, PI * 2);
+	e->u.AddParticle.DZ = (rand() % 6) + 6;
+	e->u.AddParticle.Spin = RAND_DOUBLE(-0.1, 0.1);
+	GameEventsCommit(&gGameEvents, e);
 }
 
 Vec2i GunGetMuzzleOffset(const GunDescription *desc, const direction_e dir)
@@ -50,6 +50,7 @@
 
 #include "bullet_class.h"
 #include "defs.h"
+#include "name_index.h"
 #include "pic.h"
 #include "pics.h"
 #include "sounds.h"
@@ -132,6 +133,8 @@ typedef struct
 	CArray Guns;	// of GunDescription
 	GunDescription Default;
 	CArray CustomGuns;	// of GunDescription
+	NameIndex GunIndex;
+	NameIndex CustomGunIndex;
 } GunClasses;
 
 typedef struct
@@ -151,6 +154,7 @@ extern const OffsetTable cMuzzleOffset[GUNPIC_COUNT];
 void WeaponInitialize(GunClasses *g);
 void WeaponLoadJSON(GunClasses *g, CArray *classes, json_t *root);
 void WeaponClassesClear(CArray *classes);
+void WeaponClassesClearCustom(GunClasses *g);
 void WeaponTerminate(GunClasses *g);
 Weapon WeaponCreate(const GunDescription *gun);
 const GunDescription *StrGunDescription(const char *s);
@@ -79,14 +79,28 @@
 #include <cdogs/pic_manager.h>
 #include <cdogs/pics.h>
 #include <cdogs/powerup.h>
+#include <cdogs/profiler.h>
 #include <cdogs/triggers.h>
 
+#include "headless.h"
+
+static ConfigHandle sGameFPS = CONFIG_HANDLE("Game.FPS");
+static ConfigHandle sGameSwitchMoveStyle =
+	CONFIG_HANDLE("Game.SwitchMoveStyle");
+static ConfigHandle sInputPlayerKeys0Map =
+	CONFIG_HANDLE("Input.PlayerKeys0.map");
+static ConfigHandle sInterfaceShowProfiler =
+	CONFIG_HANDLE("Interface.ShowProfiler");
+static ConfigHandle sInterfaceSplitscreen =
+	CONFIG_HANDLE("Interface.Splitscreen");
+static ConfigHandle sStartServer = CONFIG_HANDLE("StartServer");
+
 
 static void PlayerSpecialCommands(TActor *actor, const int cmd)
 {
 	if ((cmd & CMD_BUTTON2) && CMD_HAS_DIRECTION(cmd))
 	{
-		if (ConfigGetEnum(&gConfig, "Game.SwitchMoveStyle") == SWITCHMOVE_SLIDE)
+		if (ConfigHandleGetEnum(&sGameSwitchMoveStyle) == SWITCHMOVE_SLIDE)
 		{
 			SlideActor(actor, cmd);
 		}
@@ -96,13 +110,13 @@ static void PlayerSpecialCommands(TActor *actor, const int cmd)
 		!(cmd & CMD_BUTTON2) &&
 		!actor->specialCmdDir &&
 		!actor->CanPickupSpecial &&
-		!(ConfigGetEnum(&gConfig, "Game.SwitchMoveStyle") == SWITCHMOVE_SLIDE && CMD_HAS_DIRECTION(cmd)) &&
+		!(ConfigHandleGetEnum(&sGameSwitchMoveStyle) == SWITCHMOVE_SLIDE && CMD_HAS_DIRECTION(cmd)) &&
 		ActorCanSwitchGun(actor))
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_ACTOR_SWITCH_GUN);
-		e.u.ActorSwitchGun.UID = actor->uid;
-		e.u.ActorSwitchGun.GunIdx = (actor->gunIndex + 1) % actor->guns.size;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_SWITCH_GUN);
+		e->u.ActorSwitchGun.UID = actor->uid;
+		e->u.ActorSwitchGun.GunIdx = (actor->gunIndex + 1) % actor->guns.size;
+		GameEventsCommit(&gGameEvents, e);
 	}
 }
 
@@ -193,9 +207,9 @@ bool RunGame(const CampaignOptions *co, struct MissionOptions *m, Map *map)
 			// Only reset for local players; for remote ones wait for the
 			// client ready message
 			if (!p->IsLocal) continue;
-			GameEvent e = GameEventNew(GAME_EVENT_PLAYER_DATA);
-			e.u.PlayerData = PlayerDataMissionReset(p);
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_PLAYER_DATA);
+			e->u.PlayerData = PlayerDataMissionReset(p);
+			GameEventsCommit(&gGameEvents, e);
 		}
 		// Process the events to force add the players
 		HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
@@ -250,8 +264,8 @@ bool RunGame(const CampaignOptions *co, struct MissionOptions *m, Map *map)
 		PicManagerGetPic(&gPicManager, "crosshair_trail"));
 
 	NetServerSendGameStartMessages(&gNetServer, NET_SERVER_BCAST);
-	GameEvent start = GameEventNew(GAME_EVENT_GAME_START);
-	GameEventsEnqueue(&gGameEvents, start);
+	GameEvent *start = GameEventsAdd(&gGameEvents, GAME_EVENT_GAME_START);
+	GameEventsCommit(&gGameEvents, start);
 
 	// Set mission complete and display exit if it is complete
 	MissionSetMessageIfComplete(m);
@@ -260,9 +274,16 @@ bool RunGame(const CampaignOptions *co, struct MissionOptions *m, Map *map)
 		&data, RunGameUpdate, &data, RunGameDraw);
 	data.loop.InputData = &data;
 	data.loop.InputFunc = RunGameInput;
-	data.loop.FPS = ConfigGetInt(&gConfig, "Game.FPS");
+	data.loop.FPS = ConfigHandleGetInt(&sGameFPS);
 	data.loop.InputEverySecondFrame = true;
+	data.loop.Headless = gHeadless.Enabled;
+	data.loop.MaxFrames = gHeadless.Ticks;
+	// Only pay for timing when something will consume it
+	const bool profilerWasEnabled = gProfiler.Enabled;
+	gProfiler.Enabled = profilerWasEnabled || gProfiler.CSV != NULL ||
+		ConfigHandleGetBool(&sInterfaceShowProfiler);
 	GameLoop(&data.loop);
+	gProfiler.Enabled = profilerWasEnabled;
 
 	// Flush events
 	HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
@@ -285,8 +306,8 @@ static void RunGameInput(void *data)
 
 	if (gEventHandlers.HasQuit)
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_MISSION_END);
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_MISSION_END);
+		GameEventsCommit(&gGameEvents, e);
 		return;
 	}
 
@@ -328,7 +349,7 @@ static void RunGameInput(void *data)
 	// Check if automap key is pressed by any player
 	rData->isMap =
 		IsAutoMapEnabled(gCampaign.Entry.Mode) &&
-		(KeyIsDown(&gEventHandlers.keyboard, ConfigGetInt(&gConfig, "Input.PlayerKeys0.map")) ||
+		(KeyIsDown(&gEventHandlers.keyboard, ConfigHandleGetInt(&sInputPlayerKeys0Map)) ||
 		(cmdAll & CMD_MAP));
 
 	// Check if escape was pressed
@@ -344,8 +365,8 @@ static void RunGameInput(void *data)
 		if (rData->pausingDevice != INPUT_DEVICE_UNSET)
 		{
 			// Exit
-			GameEvent e = GameEventNew(GAME_EVENT_MISSION_END);
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_MISSION_END);
+			GameEventsCommit(&gGameEvents, e);
 			// Need to unpause to process the quit
 			rData->pausingDevice = INPUT_DEVICE_UNSET;
 		}
@@ -371,7 +392,7 @@ static GameLoopResult RunGameUpdate(void *data)
 
 	// If we're not hosting a net game,
 	// don't update if the game has paused or has automap shown
-	if (!gCampaign.IsClient && !ConfigGetBool(&gConfig, "StartServer") &&
+	if (!gCampaign.IsClient && !ConfigHandleGetBool(&sStartServer) &&
 		(rData->pausingDevice != INPUT_DEVICE_UNSET || rData->isMap))
 	{
 		return UPDATE_RESULT_DRAW;
@@ -380,6 +401,7 @@ static GameLoopResult RunGameUpdate(void *data)
 	// Update all the things in the game
 	const int ticksPerFrame = 1;
 
+	PROFILE_BEGIN(PROFILE_UPDATE);
 	LOSReset(&gMap.LOS);
 	for (int i = 0, idx = 0; i < (int)gPlayerDatas.size; i++, idx++)
 	{
@@ -388,10 +410,12 @@ static GameLoopResult RunGameUpdate(void *data)
 		TActor *player = ActorGetByUID(p->ActorUID);
 		if (player->dead > DEATH_MAX) continue;
 		// Calculate LOS for all players alive or dying
-		LOSCalcFrom(
-			&gMap,
+		PROFILE_BEGIN(PROFILE_LOS);
+		LOSCalcFromCached(
+			&gMap, p->UID,
 			Vec2iToTile(Vec2iNew(player->tileItem.x, player->tileItem.y)),
 			!gCampaign.IsClient);
+		PROFILE_END(PROFILE_LOS);
 
 		if (player->dead) continue;
 
@@ -403,7 +427,9 @@ static GameLoopResult RunGameUpdate(void *data)
 		}
 		if (p->inputDevice == INPUT_DEVICE_AI)
 		{
+			PROFILE_BEGIN(PROFILE_AI);
 			rData->cmds[idx] = AICoopGetCmd(player, ticksPerFrame);
+			PROFILE_END(PROFILE_AI);
 		}
 		PlayerSpecialCommands(player, rData->cmds[idx]);
 		CommandActor(player, rData->cmds[idx], ticksPerFrame);
@@ -411,12 +437,14 @@ static GameLoopResult RunGameUpdate(void *data)
 
 	if (!gCampaign.IsClient)
 	{
+		PROFILE_BEGIN(PROFILE_AI);
 		CommandBadGuys(ticksPerFrame);
+		PROFILE_END(PROFILE_AI);
 	}
 
 	// If split screen never and players are too close to the
 	// edge of the screen, forcefully pull them towards the center
-	if (ConfigGetEnum(&gConfig, "Interface.Splitscreen") == SPLITSCREEN_NEVER &&
+	if (ConfigHandleGetEnum(&sInterfaceSplitscreen) == SPLITSCREEN_NEVER &&
 		CameraIsSingleScreen() &&
 		GetNumPlayers(true, true, true) > 1)
 	{
@@ -452,19 +480,28 @@ static GameLoopResult RunGameUpdate(void *data)
 			}
 			if (!Vec2iIsZero(vel))
 			{
-				GameEvent ei = GameEventNew(GAME_EVENT_ACTOR_IMPULSE);
-				ei.u.ActorImpulse.UID = p->uid;
-				ei.u.ActorImpulse.Vel = Vec2i2Net(Vec2iScale(vel, 64));
-				ei.u.ActorImpulse.Pos = Vec2i2Net(Vec2iZero());
-				GameEventsEnqueue(&gGameEvents, ei);
+				GameEvent *ei =
+					GameEventsAdd(&gGameEvents, GAME_EVENT_ACTOR_IMPULSE);
+				ei->u.ActorImpulse.UID = p->uid;
+				ei->u.ActorImpulse.Vel = Vec2i2Net(Vec2iScale(vel, 64));
+				ei->u.ActorImpulse.Pos = Vec2i2Net(Vec2iZero());
+				GameEventsCommit(&gGameEvents, ei);
 			}
 		}
 	}
 
+	PROFILE_BEGIN(PROFILE_ACTORS);
 	UpdateAllActors(ticksPerFrame);
+	PROFILE_END(PROFILE_ACTORS);
+	PROFILE_BEGIN(PROFILE_OBJECTS);
 	UpdateObjects(ticksPerFrame);
+	PROFILE_END(PROFILE_OBJECTS);
+	PROFILE_BEGIN(PROFILE_MOBILE_OBJECTS);
 	UpdateMobileObjects(ticksPerFrame);
+	PROFILE_END(PROFILE_MOBILE_OBJECTS);
+	PROFILE_BEGIN(PROFILE_PARTICLES);
 	ParticlesUpdate(&gParticles, ticksPerFrame);
+	PROFILE_END(PROFILE_PARTICLES);
 
 	UpdateWatches(&rData->map->triggers, ticksPerFrame);
 
@@ -484,13 +521,16 @@ static GameLoopResult RunGameUpdate(void *data)
 		rData->m->isDone = true;
 	}
 
+	PROFILE_BEGIN(PROFILE_EVENTS);
 	HandleGameEvents(
 		&gGameEvents, &rData->Camera,
 		&rData->healthSpawner, &rData->ammoSpawners);
+	PROFILE_END(PROFILE_EVENTS);
 
 	rData->m->time += ticksPerFrame;
 
 	CameraUpdate(&rData->Camera, ticksPerFrame, 1000 / rData->loop.FPS);
+	PROFILE_END(PROFILE_UPDATE);
 
 	return UPDATE_RESULT_DRAW;
 }
@@ -506,10 +546,11 @@ static void CheckMissionCompletion(const struct MissionOptions *mo)
 		const int update = MapGetExploredPercentage(&gMap) - o->done;
 		if (update > 0 && !gCampaign.IsClient)
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_OBJECTIVE_UPDATE);
-			e.u.ObjectiveUpdate.ObjectiveId = i;
-			e.u.ObjectiveUpdate.Count = update;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e =
+				GameEventsAdd(&gGameEvents, GAME_EVENT_OBJECTIVE_UPDATE);
+			e->u.ObjectiveUpdate.ObjectiveId = i;
+			e->u.ObjectiveUpdate.Count = update;
+			GameEventsCommit(&gGameEvents, e);
 		}
 	}
 
@@ -517,19 +558,20 @@ static void CheckMissionCompletion(const struct MissionOptions *mo)
 		GetNumPlayers(PLAYER_ALIVE_OR_DYING, false, false) > 0 && IsMissionComplete(mo);
 	if (mo->state == MISSION_STATE_PLAY && isMissionComplete)
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_MISSION_PICKUP);
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_MISSION_PICKUP);
+		GameEventsCommit(&gGameEvents, e);
 	}
 	if (mo->state == MISSION_STATE_PICKUP && !isMissionComplete)
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_MISSION_INCOMPLETE);
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e =
+			GameEventsAdd(&gGameEvents, GAME_EVENT_MISSION_INCOMPLETE);
+		GameEventsCommit(&gGameEvents, e);
 	}
 	if (mo->state == MISSION_STATE_PICKUP &&
 		mo->pickupTime + PICKUP_LIMIT <= mo->time)
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_MISSION_END);
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_MISSION_END);
+		GameEventsCommit(&gGameEvents, e);
 	}
 
 	// Check that all players have been destroyed
@@ -547,13 +589,14 @@ static void CheckMissionCompletion(const struct MissionOptions *mo)
 	}
 	if (allPlayersDestroyed && AreAllPlayersDeadAndNoLives())
 	{
-		GameEvent e = GameEventNew(GAME_EVENT_MISSION_END);
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_MISSION_END);
+		GameEventsCommit(&gGameEvents, e);
 	}
 }
 static void RunGameDraw(void *data)
 {
 	RunGameData *rData = data;
+	PROFILE_BEGIN(PROFILE_DRAW);
 
 	// Draw everything
 	CameraDraw(&rData->Camera, rData->pausingDevice);
@@ -568,4 +611,5 @@ static void RunGameDraw(void *data)
 	{
 		AutomapDraw(0, rData->Camera.HUD.showExit);
 	}
+	PROFILE_END(PROFILE_DRAW);
 }
@@ -0,0 +1,136 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2015, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "headless.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <cdogs/ai.h>
+#include <cdogs/ai_coop.h>
+#include <cdogs/campaigns.h>
+#include <cdogs/game_events.h>
+#include <cdogs/handle_game_events.h>
+#include <cdogs/mission.h>
+#include <cdogs/net_client.h>
+#include <cdogs/path_cache.h>
+#include <cdogs/player.h>
+#include <cdogs/profiler.h>
+
+#include "game.h"
+
+HeadlessOptions gHeadless;
+
+
+void HeadlessOptionsInit(HeadlessOptions *o)
+{
+	memset(o, 0, sizeof *o);
+	o->Ticks = 3000;
+	o->Players = 1;
+}
+
+static void AddAIPlayers(const int numPlayers);
+bool HeadlessRun(const HeadlessOptions *o)
+{
+	if (!gCampaign.IsLoaded)
+	{
+		fprintf(stderr, "Headless mode needs a campaign to run\n");
+		return false;
+	}
+	if (o->Mission < 0 || o->Mission >= (int)gCampaign.Setting.Missions.size)
+	{
+		fprintf(stderr, "Mission %d does not exist in campaign %s\n",
+			o->Mission, gCampaign.Setting.Title);
+		return false;
+	}
+
+	PlayerDataTerminate(&gPlayerDatas);
+	PlayerDataInit(&gPlayerDatas);
+	GameEventsInit(&gGameEvents);
+
+	AddAIPlayers(CLAMP(o->Players, 1, MAX_LOCAL_PLAYERS));
+
+	// The seed drives map generation and the simulation
+	gCampaign.seed = o->Seed;
+	gCampaign.MissionIndex = o->Mission;
+	CampaignAndMissionSetup(1, &gCampaign, &gMission);
+	for (int i = 0; i < (int)gPlayerDatas.size; i++)
+	{
+		AICoopSelectWeapons(
+			CArrayGet(&gPlayerDatas, i), i, &gMission.Weapons);
+	}
+
+	printf("Running %s mission %d with %d player(s), seed %u\n",
+		gCampaign.Setting.Title, o->Mission, (int)gPlayerDatas.size,
+		o->Seed);
+	ProfilerReset(&gProfiler);
+	gProfiler.Enabled = true;
+	const uint64_t start = ProfilerNow();
+	RunGame(&gCampaign, &gMission, &gMap);
+	const uint64_t elapsed = ProfilerNow() - start;
+	gProfiler.Enabled = false;
+
+	const int ticks = gMission.time;
+	const double seconds = (double)elapsed / 1000000000.0;
+	printf("Ran %d ticks in %.3fs (%.1f ticks/sec)\n",
+		ticks, seconds, seconds > 0 ? ticks / seconds : 0);
+	ProfilerPrint(&gProfiler, stdout, ticks);
+	printf("Path cache: %d hits, %d partial hits, %d misses\n",
+		gPathCache.Hits, gPathCache.PartialHits, gPathCache.Misses);
+	printf("Flow fields: %d lookups, %d builds\n",
+		gPathCache.flow.Lookups, gPathCache.flow.Builds);
+	printf("AI: %d decisions, %d skipped, %d deferred\n",
+		gAIScheduleStats.Thinks, gAIScheduleStats.Skipped,
+		gAIScheduleStats.Deferred);
+	// Events used to be queued as whole GameEvents, whatever their type
+	printf("Game events: %d, %.0f bytes/tick queued (%.0f as whole events)\n",
+		gGameEvents.Adds,
+		ticks > 0 ? (double)gGameEvents.BytesAdded / ticks : 0,
+		ticks > 0 ? (double)gGameEvents.Adds * sizeof(GameEvent) / ticks : 0);
+
+	MissionEnd();
+	MissionOptionsTerminate(&gMission);
+	GameEventsTerminate(&gGameEvents);
+	CampaignUnload(&gCampaign);
+	return true;
+}
+static void AddAIPlayers(const int numPlayers)
+{
+	for (int i = 0; i < numPlayers; i++)
+	{
+		GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_PLAYER_DATA);
+		e->u.PlayerData = PlayerDataDefault(i);
+		e->u.PlayerData.UID = gNetClient.FirstPlayerUID + i;
+		GameEventsCommit(&gGameEvents, e);
+	}
+	// Process the events to force add the players
+	HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
+	for (int i = 0; i < (int)gPlayerDatas.size; i++)
+	{
+		PlayerSetInputDevice(CArrayGet(&gPlayerDatas, i), INPUT_DEVICE_AI, 0);
+	}
+}
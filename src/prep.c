@@ -175,10 +175,10 @@ bool NumPlayersSelection(
 		// Add the players
 		for (int i = 0; i < numPlayers; i++)
 		{
-			GameEvent e = GameEventNew(GAME_EVENT_PLAYER_DATA);
-			e.u.PlayerData = PlayerDataDefault(i);
-			e.u.PlayerData.UID = gNetClient.FirstPlayerUID + i;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEvent *e = GameEventsAdd(&gGameEvents, GAME_EVENT_PLAYER_DATA);
+			e->u.PlayerData = PlayerDataDefault(i);
+			e->u.PlayerData.UID = gNetClient.FirstPlayerUID + i;
+			GameEventsCommit(&gGameEvents, e);
 		}
 		// Process the events to force add the players
 		HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
@@ -30,7 +30,7 @@ Pic *PicManagerGetFromOld(PicManager *pm, int idx)
 	UNUSED(idx);
 	return NULL;
 }
-Pic *PicManagerGetPic(const PicManager *pm, const char *name)
+Pic *PicManagerGetPic(PicManager *pm, const char *name)
 {
 	UNUSED(pm);
 	UNUSED(name);
@@ -0,0 +1,291 @@
+#include <cbehave/cbehave.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <blit_span.h>
+#include <color.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+// ARGB, like the screen format on most platforms
+#define A_SHIFT 24
+#define A_MASK 0xFF000000u
+static color_t ToColor(const Uint32 p)
+{
+	color_t c;
+	c.r = (Uint8)(p >> 16);
+	c.g = (Uint8)(p >> 8);
+	c.b = (Uint8)p;
+	c.a = (Uint8)(p >> A_SHIFT);
+	return c;
+}
+static Uint32 ToPixel(const color_t c)
+{
+	return ((Uint32)c.r << 16) | ((Uint32)c.g << 8) | c.b |
+		((Uint32)c.a << A_SHIFT);
+}
+
+// The per-pixel blitters as they were, for comparison
+static void RefCopy(Uint32 *dst, const Uint32 *src, const int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		if ((src[i] & A_MASK) == 0) continue;
+		dst[i] = src[i];
+	}
+}
+static Uint32 RefPixelMult(Uint32 p, Uint32 m)
+{
+	return
+		((p & 0xFF) * (m & 0xFF) / 0xFF) |
+		((((p & 0xFF00) >> 8) * ((m & 0xFF00) >> 8) / 0xFF) << 8) |
+		((((p & 0xFF0000) >> 16) * ((m & 0xFF0000) >> 16) / 0xFF) << 16) |
+		((((p & 0xFF000000) >> 24) * ((m & 0xFF000000) >> 24) / 0xFF) << 24);
+}
+static void RefMasked(
+	Uint32 *dst, const Uint32 *src, const int n,
+	const Uint32 mask, const bool isTransparent)
+{
+	for (int i = 0; i < n; i++)
+	{
+		if (isTransparent && src[i] == 0) continue;
+		dst[i] = RefPixelMult(src[i], mask);
+	}
+}
+static void RefBlend(
+	Uint32 *dst, const Uint32 *src, const int n, const color_t blend)
+{
+	for (int i = 0; i < n; i++)
+	{
+		if (src[i] == 0) continue;
+		color_t blendedColor = ColorMult(ToColor(src[i]), blend);
+		blendedColor.a = blend.a;
+		blendedColor = ColorAlphaBlend(ToColor(dst[i]), blendedColor);
+		dst[i] = ToPixel(blendedColor);
+	}
+}
+
+#define SPAN_MAX 37
+static Uint32 RandomPixel(void)
+{
+	// Plenty of transparent and extreme pixels
+	switch (rand() % 6)
+	{
+	case 0: return 0;
+	case 1: return (Uint32)rand() & ~A_MASK;
+	case 2: return 0xFFFFFFFFu;
+	default: return ((Uint32)rand() << 16) ^ (Uint32)rand();
+	}
+}
+static void RandomPixels(Uint32 *p, const int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		p[i] = RandomPixel();
+	}
+}
+
+// Compare an implementation against the reference on many random spans,
+// of all lengths and alignments
+static bool IsExact(const BlitSpanImpl impl)
+{
+	BlitSpanUse(impl);
+	Uint32 src[SPAN_MAX + 4];
+	Uint32 dst1[SPAN_MAX + 4];
+	Uint32 dst2[SPAN_MAX + 4];
+	for (int i = 0; i < 2000; i++)
+	{
+		const int n = i % SPAN_MAX;
+		const int offset = (i / SPAN_MAX) % 4;
+		RandomPixels(src, SPAN_MAX + 4);
+		RandomPixels(dst1, SPAN_MAX + 4);
+		memcpy(dst2, dst1, sizeof dst1);
+		const Uint32 mask = RandomPixel();
+		color_t blend = ToColor(RandomPixel());
+		switch (i % 4)
+		{
+		case 0:
+			RefCopy(dst1 + offset, src + offset, n);
+			gBlitSpan.Copy(dst2 + offset, src + offset, n, A_MASK);
+			break;
+		case 1:
+		case 2:
+			RefMasked(dst1 + offset, src + offset, n, mask, i % 4 == 1);
+			gBlitSpan.Masked(
+				dst2 + offset, src + offset, n, mask, i % 4 == 1);
+			break;
+		default:
+			RefBlend(dst1 + offset, src + offset, n, blend);
+			gBlitSpan.Blend(
+				dst2 + offset, src + offset, n,
+				ToPixel(blend), blend.a, A_MASK);
+			break;
+		}
+		if (memcmp(dst1, dst2, sizeof dst1) != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Megapixels per second for blitting sprites over a screen
+#define BENCH_W 320
+#define BENCH_H 240
+#define BENCH_SPRITE 16
+static double Bench(const int blitter)
+{
+	static Uint32 screen[BENCH_W * BENCH_H];
+	Uint32 sprite[BENCH_SPRITE * BENCH_SPRITE];
+	RandomPixels(sprite, BENCH_SPRITE * BENCH_SPRITE);
+	const color_t blend = { 200, 100, 50, 128 };
+	const Uint32 blendPixel = ToPixel(blend);
+	const int reps = 20;
+	const clock_t t = clock();
+	for (int r = 0; r < reps; r++)
+	{
+		for (int y = 0; y + BENCH_SPRITE <= BENCH_H; y += BENCH_SPRITE)
+		{
+			for (int x = 0; x + BENCH_SPRITE <= BENCH_W; x += BENCH_SPRITE)
+			{
+				for (int i = 0; i < BENCH_SPRITE; i++)
+				{
+					Uint32 *d = screen + (y + i) * BENCH_W + x;
+					const Uint32 *s = sprite + i * BENCH_SPRITE;
+					switch (blitter)
+					{
+					case 0:
+						gBlitSpan.Copy(d, s, BENCH_SPRITE, A_MASK);
+						break;
+					case 1:
+						gBlitSpan.Masked(d, s, BENCH_SPRITE, blendPixel, true);
+						break;
+					default:
+						gBlitSpan.Blend(
+							d, s, BENCH_SPRITE, blendPixel, blend.a, A_MASK);
+						break;
+					}
+				}
+			}
+		}
+	}
+	const double seconds = (double)(clock() - t) / CLOCKS_PER_SEC;
+	return seconds > 0 ? reps * BENCH_W * BENCH_H / seconds / 1e6 : 0;
+}
+
+
+FEATURE(1, "Span blitters")
+	SCENARIO("Same pixels as the per-pixel blitters")
+	{
+		bool exact[BLIT_SPAN_COUNT];
+		GIVEN("random sprites and backgrounds")
+			srand(1);
+		GIVEN_END
+
+		WHEN("I blit spans with each implementation");
+			for (int i = 0; i < BLIT_SPAN_COUNT; i++)
+			{
+				exact[i] = !BlitSpanIsCompiled((BlitSpanImpl)i) ||
+					IsExact((BlitSpanImpl)i);
+			}
+		WHEN_END
+
+		THEN("they should be pixel-exact");
+			for (int i = 0; i < BLIT_SPAN_COUNT; i++)
+			{
+				SHOULD_BE_TRUE(exact[i]);
+			}
+		THEN_END
+	}
+	SCENARIO_END
+
+	SCENARIO("Throughput")
+	{
+		double mpx[BLIT_SPAN_COUNT][3];
+		GIVEN("a screen of sprites")
+			srand(1);
+		GIVEN_END
+
+		WHEN("I blit them with each implementation");
+			memset(mpx, 0, sizeof mpx);
+			for (int i = 0; i < BLIT_SPAN_COUNT; i++)
+			{
+				if (!BlitSpanIsCompiled((BlitSpanImpl)i)) continue;
+				BlitSpanUse((BlitSpanImpl)i);
+				for (int b = 0; b < 3; b++)
+				{
+					mpx[i][b] = Bench(b);
+				}
+				printf("\t\t%s: copy %.0f, masked %.0f, blend %.0f Mpx/s\n",
+					BlitSpanImplStr((BlitSpanImpl)i),
+					mpx[i][0], mpx[i][1], mpx[i][2]);
+			}
+		WHEN_END
+
+		THEN("the portable blitters should run");
+			SHOULD_BE_TRUE(mpx[BLIT_SPAN_PORTABLE][0] > 0);
+		THEN_END
+	}
+	SCENARIO_END
+
+	SCENARIO("Clipping")
+	{
+		BlitSpanRect r;
+		bool inside, partial, outside;
+		GIVEN("a 10x8 picture")
+		GIVEN_END
+
+		WHEN("I clip it against a 0-99 by 0-49 rectangle");
+			inside = BlitSpanClip(
+				&r, Vec2iNew(10, 8), Vec2iNew(20, 20), 0, 0, 99, 49);
+		WHEN_END
+
+		THEN("a picture inside should be whole");
+			SHOULD_BE_TRUE(inside);
+			SHOULD_INT_EQUAL(r.Src.x, 0);
+			SHOULD_INT_EQUAL(r.Src.y, 0);
+			SHOULD_INT_EQUAL(r.Size.x, 10);
+			SHOULD_INT_EQUAL(r.Size.y, 8);
+		THEN_END
+
+		THEN("a picture over the corner should be cut");
+			partial = BlitSpanClip(
+				&r, Vec2iNew(10, 8), Vec2iNew(-3, 45), 0, 0, 99, 49);
+			SHOULD_BE_TRUE(partial);
+			SHOULD_INT_EQUAL(r.Src.x, 3);
+			SHOULD_INT_EQUAL(r.Src.y, 0);
+			SHOULD_INT_EQUAL(r.Dst.x, 0);
+			SHOULD_INT_EQUAL(r.Dst.y, 45);
+			SHOULD_INT_EQUAL(r.Size.x, 7);
+			SHOULD_INT_EQUAL(r.Size.y, 5);
+		THEN_END
+
+		THEN("a picture outside should not be drawn");
+			outside = BlitSpanClip(
+				&r, Vec2iNew(10, 8), Vec2iNew(100, 0), 0, 0, 99, 49);
+			SHOULD_BE_TRUE(!outside);
+		THEN_END
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("Span blitter features are:", features);
+}
@@ -0,0 +1,200 @@
+#include "campaign_maps.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <tinydir/tinydir.h>
+
+#include <ammo.h>
+#include <bullet_class.h>
+#include <campaigns.h>
+#include <config.h>
+#include <json_utils.h>
+#include <los.h>
+#include <map_classic.h>
+#include <map_new.h>
+#include <map_object.h>
+#include <map_static.h>
+#include <pickup_class.h>
+#include <sys_config.h>
+#include <weapon.h>
+
+#define CAMPAIGN_DIRS { "missions", "dogfights" }
+
+void CampaignMapsInit(void)
+{
+	gConfig = ConfigDefault();
+	AmmoInitialize(&gAmmo, "data/ammo.json");
+	BulletAndWeaponInitialize(
+		&gBulletClasses, &gGunDescriptions,
+		"data/bullets.json", "data/guns.json");
+	PickupClassesInit(
+		&gPickupClasses, "data/pickups.json", &gAmmo, &gGunDescriptions);
+	MapObjectsInit(&gMapObjects, "data/map_objects.json");
+	gCampaign.Entry.Mode = GAME_MODE_NORMAL;
+}
+void CampaignMapsTerminate(void)
+{
+	MapObjectsTerminate(&gMapObjects);
+	PickupClassesTerminate(&gPickupClasses);
+	WeaponTerminate(&gGunDescriptions);
+	BulletTerminate(&gBulletClasses);
+	AmmoTerminate(&gAmmo);
+	ConfigDestroy(&gConfig);
+}
+
+static void LoadMapTiles(Map *map, Mission *m, const int missionIndex)
+{
+	memset(map, 0, sizeof *map);
+	CArrayInit(&map->Tiles, sizeof(Tile));
+	CArrayInit(&map->iMap, sizeof(unsigned short));
+	map->Size = m->Size;
+	LOSInit(map, map->Size);
+	for (int i = 0; i < map->Size.x * map->Size.y; i++)
+	{
+		Tile t;
+		unsigned short tI = MAP_FLOOR;
+		TileInit(&t);
+		CArrayPushBack(&map->Tiles, &t);
+		CArrayPushBack(&map->iMap, &tI);
+	}
+	gCampaign.MissionIndex = missionIndex;
+	if (m->Type == MAPTYPE_CLASSIC)
+	{
+		MapClassicLoad(map, m, &gCampaign);
+	}
+	else
+	{
+		struct MissionOptions mo;
+		memset(&mo, 0, sizeof mo);
+		mo.missionData = m;
+		MapStaticLoad(map, &mo);
+	}
+	Vec2i v;
+	for (v.y = 0; v.y < map->Size.y; v.y++)
+	{
+		for (v.x = 0; v.x < map->Size.x; v.x++)
+		{
+			Tile *t = MapGetTile(map, v);
+			switch (IMapGet(map, v) & MAP_MASKACCESS)
+			{
+			case MAP_WALL:
+			case MAP_DOOR:
+				t->flags = MAPTILE_NO_SEE | MAPTILE_NO_WALK;
+				break;
+			case MAP_NOTHING:
+				t->flags = MAPTILE_NO_WALK;
+				break;
+			default:
+				t->flags = 0;
+				break;
+			}
+		}
+	}
+}
+static void FreeMapTiles(Map *map)
+{
+	LOSTerminate(&map->LOS);
+	CArrayTerminate(&map->Tiles);
+	CArrayTerminate(&map->iMap);
+}
+
+// Archives have custom pics and data, which need a display to load, so just
+// load their missions
+static bool LoadArchiveMissions(CArray *missions, const char *path)
+{
+	char buf[CDOGS_PATH_MAX];
+	int version = 0;
+	json_t *root = NULL;
+	if (snprintf(buf, sizeof buf, "%s/campaign.json", path) >= (int)sizeof buf)
+	{
+		return false;
+	}
+	FILE *f = fopen(buf, "r");
+	if (f == NULL) return false;
+	if (json_stream_parse(f, &root) == JSON_OK)
+	{
+		LoadInt(&version, root, "Version");
+	}
+	fclose(f);
+	json_free_value(&root);
+	if (snprintf(buf, sizeof buf, "%s/missions.json", path) >= (int)sizeof buf)
+	{
+		return false;
+	}
+	f = fopen(buf, "r");
+	if (f == NULL) return false;
+	const bool ok = json_stream_parse(f, &root) == JSON_OK;
+	fclose(f);
+	if (ok)
+	{
+		LoadMissions(
+			missions, json_find_first_label(root, "Missions")->child,
+			version);
+	}
+	json_free_value(&root);
+	return ok;
+}
+static int ForEachInCampaign(
+	const tinydir_file *file, CampaignMapFunc f, void *data)
+{
+	CampaignSetting setting;
+	CampaignSettingInit(&setting);
+	const bool isArchive = strcmp(file->extension, "cdogscpn") == 0;
+	const bool loaded = isArchive ?
+		LoadArchiveMissions(&setting.Missions, file->path) :
+		MapNewLoad(file->path, &setting) == 0;
+	if (loaded)
+	{
+		for (int i = 0; i < (int)setting.Missions.size; i++)
+		{
+			Map map;
+			Mission *m = CArrayGet(&setting.Missions, i);
+			LoadMapTiles(&map, m, i);
+			f(&map, m, data);
+			FreeMapTiles(&map);
+		}
+	}
+	CampaignSettingTerminate(&setting);
+	return loaded ? 1 : 0;
+}
+static int ForEachInDir(const char *path, CampaignMapFunc f, void *data)
+{
+	tinydir_dir dir;
+	if (tinydir_open_sorted(&dir, path) == -1)
+	{
+		printf("Cannot open campaigns dir %s\n", path);
+		return 0;
+	}
+	int campaigns = 0;
+	for (int i = 0; i < (int)dir.n_files; i++)
+	{
+		tinydir_file file;
+		tinydir_readfile_n(&dir, &file, i);
+		if (strcmp(file.name, ".") == 0 || strcmp(file.name, "..") == 0)
+		{
+			continue;
+		}
+		if (strcmp(file.extension, "cdogscpn") == 0 ||
+			(file.is_reg && strcmp(file.extension, "cpn") == 0))
+		{
+			campaigns += ForEachInCampaign(&file, f, data);
+		}
+		else if (file.is_dir)
+		{
+			campaigns += ForEachInDir(file.path, f, data);
+		}
+	}
+	tinydir_close(&dir);
+	return campaigns;
+}
+int CampaignMapsForEach(CampaignMapFunc f, void *data)
+{
+	const char *dirs[] = CAMPAIGN_DIRS;
+	int campaigns = 0;
+	for (int i = 0; i < (int)(sizeof dirs / sizeof dirs[0]); i++)
+	{
+		campaigns += ForEachInDir(dirs[i], f, data);
+	}
+	return campaigns;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <map.h>
+#include <mission.h>
+
+// The campaigns shipped with the game, for tests on real maps
+// Tests that use these run from the game data dir.
+
+// Load the game data that the campaigns use
+void CampaignMapsInit(void);
+void CampaignMapsTerminate(void);
+
+// Called with each mission's map, laid out as the game does but without
+// pics: walls and doors (closed) block sight, and walls, doors and empty
+// tiles block walking
+// The map is freed after the call.
+typedef void (*CampaignMapFunc)(Map *map, Mission *m, void *data);
+// Returns the number of campaigns loaded
+int CampaignMapsForEach(CampaignMapFunc f, void *data);
@@ -19,7 +19,7 @@ Pic *PicManagerGetFromOld(PicManager *pm, int idx)
 	UNUSED(idx);
 	return NULL;
 }
-Pic *PicManagerGetPic(const PicManager *pm, const char *name)
+Pic *PicManagerGetPic(PicManager *pm, const char *name)
 {
 	UNUSED(pm);
 	UNUSED(name);
@@ -149,6 +149,84 @@ FEATURE(4, "Save config as latest format by default")
 	SCENARIO_END
 FEATURE_END
 
+static int sBrightnessChanges = 0;
+static void OnBrightnessChange(const Config *c, void *data)
+{
+	UNUSED(c);
+	UNUSED(data);
+	sBrightnessChanges++;
+}
+
+FEATURE(5, "Config reads and change notification")
+	SCENARIO("Read configs without allocating")
+	{
+		ConfigHandle handle = CONFIG_HANDLE("Game.SightRange");
+		int sum = 0;
+		unsigned int allocs;
+		GIVEN("the global config")
+			gConfig = ConfigLoad(NULL);
+			ConfigGet(&gConfig, "Game.SightRange")->u.Int.Value = 7;
+		GIVEN_END
+
+		WHEN("I read config values many times, by name and by handle")
+			const unsigned int start = gAllocCount;
+			for (int i = 0; i < 1000; i++)
+			{
+				sum += ConfigGetInt(&gConfig, "Game.SightRange");
+				sum += ConfigGetBool(&gConfig, "Game.Ammo") ? 1 : 0;
+				sum += ConfigHandleGetInt(&handle);
+			}
+			allocs = gAllocCount - start;
+		WHEN_END
+
+		THEN("the values should be correct, with no allocations")
+			SHOULD_INT_EQUAL(ConfigHandleGetInt(&handle), 7);
+			SHOULD_INT_EQUAL(
+				sum,
+				1000 * (14 + (ConfigGetBool(&gConfig, "Game.Ammo") ? 1 : 0)));
+			SHOULD_INT_EQUAL(allocs, 0);
+		THEN_END
+
+		ConfigDestroy(&gConfig);
+	}
+	SCENARIO_END
+
+	SCENARIO("Notify listeners when changes are applied")
+	{
+		Config config;
+		GIVEN("a config with a listener on a value")
+			config = ConfigLoad(NULL);
+			sBrightnessChanges = 0;
+			ConfigAddListener(
+				ConfigGet(&config, "Graphics.Brightness"),
+				OnBrightnessChange, NULL);
+			ConfigAddListener(
+				ConfigGet(&config, "Graphics"), OnBrightnessChange, NULL);
+		GIVEN_END
+
+		WHEN("I change an unrelated value and apply the changes")
+			ConfigGet(&config, "Game.FriendlyFire")->u.Bool.Value = true;
+			ConfigSetChanged(&config);
+		WHEN_END
+
+		THEN("no listeners should be called")
+			SHOULD_INT_EQUAL(sBrightnessChanges, 0);
+		THEN_END
+
+		WHEN("I change the value and apply the changes")
+			ConfigGet(&config, "Graphics.Brightness")->u.Int.Value = 5;
+			ConfigSetChanged(&config);
+		WHEN_END
+
+		THEN("the value and group listeners should be called once each")
+			SHOULD_INT_EQUAL(sBrightnessChanges, 2);
+		THEN_END
+
+		ConfigDestroy(&config);
+	}
+	SCENARIO_END
+FEATURE_END
+
 int main(void)
 {
 	cbehave_feature features[] =
@@ -156,7 +234,8 @@ int main(void)
 		{feature_idx(1)},
 		{feature_idx(2)},
 		{feature_idx(3)},
-		{feature_idx(4)}
+		{feature_idx(4)},
+		{feature_idx(5)}
 	};
 
 	return cbehave_runner("Config features are:", features);
@@ -0,0 +1,93 @@
+#include <cbehave/cbehave.h>
+
+#include <string.h>
+
+#include <dirty_blocks.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+// Not a whole number of blocks, to check the edges
+#define W (DIRTY_BLOCK_SIZE * 5 + 4)
+#define H (DIRTY_BLOCK_SIZE * 3 + 2)
+
+
+FEATURE(1, "Dirty blocks")
+	SCENARIO("Finding what changed")
+	{
+		DirtyBlocks d;
+		Uint32 frame[W * H];
+		int first, same;
+		GIVEN("a frame")
+			DirtyBlocksInit(&d, Vec2iNew(W, H));
+			for (int i = 0; i < W * H; i++)
+			{
+				frame[i] = (Uint32)i;
+			}
+		GIVEN_END
+
+		WHEN("I update with it twice");
+			first = DirtyBlocksUpdate(&d, frame);
+			same = DirtyBlocksUpdate(&d, frame);
+		WHEN_END
+
+		THEN("all of it should be dirty the first time only");
+			SHOULD_INT_EQUAL(first, W * H);
+			SHOULD_INT_EQUAL(same, 0);
+			SHOULD_INT_EQUAL(d.NumRects, 0);
+		THEN_END
+
+		THEN("a changed pixel should dirty its block");
+			frame[DIRTY_BLOCK_SIZE + 3 + (DIRTY_BLOCK_SIZE * 2 + 5) * W] = 0;
+			SHOULD_INT_EQUAL(
+				DirtyBlocksUpdate(&d, frame),
+				DIRTY_BLOCK_SIZE * DIRTY_BLOCK_SIZE);
+			SHOULD_INT_EQUAL(d.NumRects, 1);
+			SHOULD_INT_EQUAL(d.Rects[0].Pos.x, DIRTY_BLOCK_SIZE);
+			SHOULD_INT_EQUAL(d.Rects[0].Pos.y, DIRTY_BLOCK_SIZE * 2);
+			SHOULD_INT_EQUAL(d.Rects[0].Size.x, DIRTY_BLOCK_SIZE);
+			SHOULD_INT_EQUAL(d.Rects[0].Size.y, DIRTY_BLOCK_SIZE);
+		THEN_END
+
+		THEN("adjacent blocks should merge into one rectangle");
+			// A 2x2 square of blocks, including the partial ones at the
+			// bottom right corner
+			frame[W - 1 + (H - 1) * W] = 0;
+			frame[W - 1 - DIRTY_BLOCK_SIZE + (H - 1) * W] = 0;
+			frame[W - 1 + (H - 1 - DIRTY_BLOCK_SIZE) * W] = 0;
+			frame[W - 1 - DIRTY_BLOCK_SIZE + (H - 1 - DIRTY_BLOCK_SIZE) * W] = 0;
+			DirtyBlocksUpdate(&d, frame);
+			SHOULD_INT_EQUAL(d.NumRects, 1);
+			SHOULD_INT_EQUAL(d.Rects[0].Pos.x, DIRTY_BLOCK_SIZE * 4);
+			SHOULD_INT_EQUAL(d.Rects[0].Pos.y, DIRTY_BLOCK_SIZE * 2);
+			SHOULD_INT_EQUAL(d.Rects[0].Size.x, W - DIRTY_BLOCK_SIZE * 4);
+			SHOULD_INT_EQUAL(d.Rects[0].Size.y, H - DIRTY_BLOCK_SIZE * 2);
+		THEN_END
+
+		THEN("invalidating should dirty the whole frame");
+			DirtyBlocksInvalidate(&d);
+			SHOULD_INT_EQUAL(DirtyBlocksUpdate(&d, frame), W * H);
+			SHOULD_INT_EQUAL(d.NumRects, 1);
+			DirtyBlocksTerminate(&d);
+		THEN_END
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("Dirty blocks features are:", features);
+}
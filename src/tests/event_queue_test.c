@@ -0,0 +1,241 @@
+#include <cbehave/cbehave.h>
+
+#include <string.h>
+
+#include <event_queue.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+// Records of varying size, like game events
+typedef struct
+{
+	int Index;
+	int Delay;
+	char Payload[1];
+} Record;
+static int RecordSize(const int index)
+{
+	return (int)sizeof(Record) + (index * 37) % 300;
+}
+static Record *AddRecord(EventQueue *q, const int index)
+{
+	const int size = RecordSize(index);
+	Record *r = EventQueueAdd(q, size);
+	r->Index = index;
+	r->Delay = index % 3;
+	memset(r->Payload, index & 0xFF, size - offsetof(Record, Payload));
+	return r;
+}
+// Whether a record is intact and where it should be in the order
+static bool RecordIsOK(const Record *r, const int index)
+{
+	if (r == NULL || r->Index != index)
+	{
+		return false;
+	}
+	const int size = RecordSize(index);
+	for (int i = 0; i < size - (int)offsetof(Record, Payload); i++)
+	{
+		if (r->Payload[i] != (char)(index & 0xFF))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+static bool RecordIsDelayed(const void *elem)
+{
+	return ((const Record *)elem)->Delay > 0;
+}
+static bool RecordIsDone(const void *elem)
+{
+	return !RecordIsDelayed(elem);
+}
+
+#define NUM_RECORDS 100
+
+
+FEATURE(1, "Event queue")
+	SCENARIO("Adding and reading records")
+	{
+		EventQueue q;
+		bool zeroed = true;
+		bool aligned = true;
+		bool inOrder = true;
+		int blocks;
+		GIVEN("an empty queue")
+			EventQueueInit(&q);
+		GIVEN_END
+
+		WHEN("I add records of different sizes");
+			for (int i = 0; i < NUM_RECORDS; i++)
+			{
+				const Uint8 *r = EventQueueAdd(&q, RecordSize(i));
+				for (int j = 0; j < RecordSize(i); j++)
+				{
+					zeroed = zeroed && r[j] == 0;
+				}
+				aligned = aligned &&
+					(size_t)r % EVENT_QUEUE_ALIGN == 0;
+			}
+			blocks = (int)q.Blocks.size;
+			EventQueueClear(&q);
+			for (int i = 0; i < NUM_RECORDS; i++)
+			{
+				AddRecord(&q, i);
+			}
+		WHEN_END
+
+		THEN("they should be zeroed, aligned, and spread over blocks");
+			SHOULD_BE_TRUE(zeroed);
+			SHOULD_BE_TRUE(aligned);
+			SHOULD_INT_GT((int)q.Blocks.size, 1);
+			SHOULD_INT_EQUAL(q.Adds, NUM_RECORDS * 2);
+		THEN_END
+
+		THEN("clearing should reuse the blocks");
+			SHOULD_INT_EQUAL((int)q.Blocks.size, blocks);
+		THEN_END
+
+		THEN("I should read them back in order");
+			EventQueueIter it = EventQueueBegin();
+			for (int i = 0; i < NUM_RECORDS; i++)
+			{
+				inOrder = inOrder && RecordIsOK(EventQueueNext(&q, &it), i);
+			}
+			SHOULD_BE_TRUE(inOrder);
+			SHOULD_BE_TRUE(EventQueueNext(&q, &it) == NULL);
+			EventQueueTerminate(&q);
+		THEN_END
+	}
+	SCENARIO_END
+
+	SCENARIO("Adding records while reading")
+	{
+		EventQueue q;
+		int count = 0;
+		bool inOrder = true;
+		GIVEN("a queue with a record")
+			EventQueueInit(&q);
+			AddRecord(&q, 0);
+		GIVEN_END
+
+		WHEN("each record I read adds another");
+			EventQueueIter it = EventQueueBegin();
+			for (;;)
+			{
+				const Record *r = EventQueueNext(&q, &it);
+				if (r == NULL)
+				{
+					break;
+				}
+				inOrder = inOrder && RecordIsOK(r, count);
+				count++;
+				if (count < NUM_RECORDS)
+				{
+					AddRecord(&q, count);
+				}
+				// The record being read should not move
+				inOrder = inOrder && RecordIsOK(r, count - 1);
+			}
+		WHEN_END
+
+		THEN("I should read all of them in order");
+			SHOULD_INT_EQUAL(count, NUM_RECORDS);
+			SHOULD_BE_TRUE(inOrder);
+			EventQueueTerminate(&q);
+		THEN_END
+	}
+	SCENARIO_END
+
+	SCENARIO("Removing records")
+	{
+		EventQueue q;
+		bool inOrder = true;
+		int count = 0;
+		GIVEN("a queue with records, some delayed")
+			EventQueueInit(&q);
+			for (int i = 0; i < NUM_RECORDS; i++)
+			{
+				AddRecord(&q, i);
+			}
+		GIVEN_END
+
+		WHEN("I remove the ones that are done");
+			EventQueueRemoveIf(&q, RecordIsDone);
+		WHEN_END
+
+		THEN("the delayed ones should be left, in order");
+			EventQueueIter it = EventQueueBegin();
+			for (int i = 0; i < NUM_RECORDS; i++)
+			{
+				if (!RecordIsDelayed(&(Record){ i, i % 3, { 0 } }))
+				{
+					continue;
+				}
+				inOrder = inOrder && RecordIsOK(EventQueueNext(&q, &it), i);
+				count++;
+			}
+			SHOULD_BE_TRUE(inOrder);
+			SHOULD_BE_TRUE(EventQueueNext(&q, &it) == NULL);
+			SHOULD_INT_EQUAL(count, NUM_RECORDS * 2 / 3);
+		THEN_END
+
+		THEN("new records should move to the front once the rest are done");
+			// Not delayed
+			const int last = NUM_RECORDS + 2;
+			AddRecord(&q, last);
+			EventQueueRemoveIf(&q, RecordIsDelayed);
+			EventQueueIter it2 = EventQueueBegin();
+			SHOULD_BE_TRUE(RecordIsOK(EventQueueNext(&q, &it2), last));
+			SHOULD_BE_TRUE(EventQueueNext(&q, &it2) == NULL);
+			EventQueueTerminate(&q);
+		THEN_END
+	}
+	SCENARIO_END
+
+	SCENARIO("Large records")
+	{
+		EventQueue q;
+		Uint8 *big;
+		GIVEN("a queue")
+			EventQueueInit(&q);
+			AddRecord(&q, 0);
+		GIVEN_END
+
+		WHEN("I add a record bigger than a block");
+			big = EventQueueAdd(&q, EVENT_QUEUE_BLOCK_SIZE * 2);
+			memset(big, 0xAB, EVENT_QUEUE_BLOCK_SIZE * 2);
+			AddRecord(&q, 1);
+		WHEN_END
+
+		THEN("it should get a block of its own");
+			EventQueueIter it = EventQueueBegin();
+			SHOULD_BE_TRUE(RecordIsOK(EventQueueNext(&q, &it), 0));
+			SHOULD_BE_TRUE(EventQueueNext(&q, &it) == big);
+			SHOULD_BE_TRUE(RecordIsOK(EventQueueNext(&q, &it), 1));
+			SHOULD_INT_EQUAL(big[EVENT_QUEUE_BLOCK_SIZE * 2 - 1], 0xAB);
+			EventQueueTerminate(&q);
+		THEN_END
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("Event queue features are:", features);
+}
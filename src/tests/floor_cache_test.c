@@ -0,0 +1,98 @@
+#include <cbehave/cbehave.h>
+
+#include <floor_cache.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+#define TILE_W 4
+#define TILE_H 3
+
+static Pic MakePic(const Uint32 colour, const Vec2i size)
+{
+	Pic p;
+	memset(&p, 0, sizeof p);
+	p.size = size;
+	CMALLOC(p.Data, size.x * size.y * sizeof *p.Data);
+	for (int i = 0; i < size.x * size.y; i++)
+	{
+		p.Data[i] = colour;
+	}
+	return p;
+}
+
+
+FEATURE(1, "Floor cache")
+	SCENARIO("Drawing tiles")
+	{
+		FloorCache c;
+		Pic floor, other;
+		const Uint32 *first, *again;
+		GIVEN("a floor cache and a floor pic")
+			FloorCacheInit(
+				&c, Vec2iZero(), Vec2iNew(5, 4), Vec2iNew(TILE_W, TILE_H));
+			floor = MakePic(0xFF808080, Vec2iNew(TILE_W, TILE_H));
+			other = MakePic(0xFF404040, Vec2iNew(TILE_W, TILE_H));
+		GIVEN_END
+
+		WHEN("I get the same tile twice");
+			first = FloorCacheGet(&c, Vec2iNew(2, 1), &floor, 0xFFFFFFFF);
+			again = FloorCacheGet(&c, Vec2iNew(2, 1), &floor, 0xFFFFFFFF);
+		WHEN_END
+
+		THEN("it should only be drawn once");
+			SHOULD_BE_TRUE(first != NULL);
+			SHOULD_BE_TRUE(first == again);
+			SHOULD_INT_EQUAL(c.Draws, 1);
+			SHOULD_INT_EQUAL(c.Hits, 1);
+			SHOULD_INT_EQUAL(first[0], 0xFF808080);
+			SHOULD_INT_EQUAL(first[TILE_W * TILE_H - 1], 0xFF808080);
+		THEN_END
+
+		THEN("a changed mask or pic should redraw it");
+			const Uint32 *p = FloorCacheGet(
+				&c, Vec2iNew(2, 1), &floor, 0x00000000);
+			SHOULD_INT_EQUAL(p[0], 0);
+			p = FloorCacheGet(&c, Vec2iNew(2, 1), &other, 0xFFFFFFFF);
+			SHOULD_INT_EQUAL(p[0], 0xFF404040);
+			SHOULD_INT_EQUAL(c.Draws, 3);
+		THEN_END
+
+		THEN("a tile scrolled into the same cell should redraw it");
+			const Uint32 *scrolled = FloorCacheGet(
+				&c, Vec2iNew(7, -3), &floor, 0xFFFFFFFF);
+			SHOULD_BE_TRUE(scrolled == first);
+			SHOULD_INT_EQUAL(scrolled[0], 0xFF808080);
+			SHOULD_INT_EQUAL(c.Draws, 4);
+		THEN_END
+
+		THEN("pics that don't fill the tile should not be cached");
+			Pic small = MakePic(0xFF808080, Vec2iNew(TILE_W - 1, TILE_H));
+			SHOULD_BE_TRUE(
+				FloorCacheGet(&c, Vec2iNew(0, 0), &small, 0xFFFFFFFF) == NULL);
+			CFREE(small.Data);
+			CFREE(floor.Data);
+			CFREE(other.Data);
+			FloorCacheTerminate(&c);
+		THEN_END
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("Floor cache features are:", features);
+}
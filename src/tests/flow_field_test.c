@@ -0,0 +1,326 @@
+#include <cbehave/cbehave.h>
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <flow_field.h>
+#include <grid_path.h>
+#include <utils.h>
+
+#include "campaign_maps.h"
+
+// Walls and empty tiles block; doors block only while locked
+static bool sDoorsLocked = false;
+static bool IsMapTileOk(Map *map, Vec2i pos)
+{
+	if (MapGetTile(map, pos) == NULL) return false;
+	switch (IMapGet(map, pos) & MAP_MASKACCESS)
+	{
+	case MAP_WALL:
+	case MAP_NOTHING:
+		return false;
+	case MAP_DOOR:
+		return !sDoorsLocked;
+	default:
+		return true;
+	}
+}
+static Vec2i RandomFloor(Map *map)
+{
+	for (;;)
+	{
+		const Vec2i v = Vec2iNew(rand() % map->Size.x, rand() % map->Size.y);
+		if (IsMapTileOk(map, v)) return v;
+	}
+}
+
+static float PathCost(ASPath path)
+{
+	float cost = 0;
+	for (size_t i = 1; i < ASPathGetCount(path); i++)
+	{
+		cost += GridPathStepCost(
+			*(Vec2i *)ASPathGetNode(path, i - 1),
+			*(Vec2i *)ASPathGetNode(path, i));
+	}
+	return cost;
+}
+// Follow a field's next steps to its target, checking that each is a move
+// A* could make; returns the cost, or -1 if it fails
+static float FollowCost(
+	const FlowFields *ff, const FlowField *f, Map *map, Vec2i v)
+{
+	float cost = 0;
+	for (int steps = 0; steps < map->Size.x * map->Size.y; steps++)
+	{
+		if (Vec2iEqual(v, f->Target)) return cost;
+		Vec2i next;
+		if (!FlowFieldGetNext(ff, f, v, &next) ||
+			CHEBYSHEV_DISTANCE(v.x, v.y, next.x, next.y) != 1 ||
+			!IsMapTileOk(map, next) ||
+			!IsMapTileOk(map, Vec2iNew(v.x, next.y)) ||
+			!IsMapTileOk(map, Vec2iNew(next.x, v.y)))
+		{
+			return -1;
+		}
+		cost += GridPathStepCost(v, next);
+		v = next;
+	}
+	return -1;
+}
+static bool IsCostClose(const float a, const float b)
+{
+	return fabs(a - b) <= 0.001f * MAX(a, b);
+}
+
+// Compare with A* on the largest shipped maps
+#define BENCH_MAPS 5
+#define BENCH_PATHS 100
+typedef struct
+{
+	int Areas[BENCH_MAPS];	// largest first
+} LargestMaps;
+static void FindLargestMaps(Map *map, Mission *m, void *data)
+{
+	LargestMaps *l = data;
+	UNUSED(m);
+	int area = map->Size.x * map->Size.y;
+	for (int i = 0; i < BENCH_MAPS; i++)
+	{
+		if (area > l->Areas[i])
+		{
+			const int tmp = l->Areas[i];
+			l->Areas[i] = area;
+			area = tmp;
+		}
+	}
+}
+typedef struct
+{
+	int MinArea;
+	int Maps;
+	int Paths;
+	int Unreachable;
+	int Shorter;	// A* overestimates diagonals, so can miss the best path
+	bool SameReachable;
+	bool NoCostlier;
+	bool StepsFollowCosts;
+	clock_t FieldTime;
+	clock_t GridTime;
+} FieldBench;
+static void CompareTarget(
+	FieldBench *b, FlowFields *ff, GridPath *g, Map *map, const Vec2i target)
+{
+	clock_t t = clock();
+	const FlowField *f = FlowFieldsGet(ff, map, 1, target);
+	b->FieldTime += clock() - t;
+	for (int i = 0; i < BENCH_PATHS; i++)
+	{
+		const Vec2i from = RandomFloor(map);
+		const float cost = f->Cost[from.y * map->Size.x + from.x];
+		t = clock();
+		ASPath path = GridPathFind(g, map, IsMapTileOk, from, target);
+		b->GridTime += clock() - t;
+		b->Paths++;
+		Vec2i next;
+		if (path == NULL)
+		{
+			b->Unreachable++;
+			if (cost != FLT_MAX || FlowFieldGetNext(ff, f, from, &next))
+			{
+				b->SameReachable = false;
+			}
+			continue;
+		}
+		if (cost == FLT_MAX)
+		{
+			b->SameReachable = false;
+		}
+		else
+		{
+			const float gridCost = PathCost(path);
+			if (!IsCostClose(cost, gridCost))
+			{
+				b->Shorter++;
+				b->NoCostlier = b->NoCostlier && cost < gridCost;
+			}
+		}
+		const float followCost = FollowCost(ff, f, map, from);
+		if (followCost < 0 || !IsCostClose(cost, followCost))
+		{
+			b->StepsFollowCosts = false;
+		}
+		ASPathDestroy(path);
+	}
+}
+static void BenchMap(Map *map, Mission *m, void *data)
+{
+	FieldBench *b = data;
+	if (map->Size.x * map->Size.y < b->MinArea || b->Maps == BENCH_MAPS)
+	{
+		return;
+	}
+	b->Maps++;
+	const clock_t fieldTime = b->FieldTime;
+	const clock_t gridTime = b->GridTime;
+	// With doors locked, some rooms can't be reached
+	for (int i = 0; i < 2; i++)
+	{
+		sDoorsLocked = i == 1;
+		FlowFields ff;
+		GridPath g;
+		FlowFieldsInit(&ff, map->Size, IsMapTileOk);
+		GridPathInit(&g, map->Size);
+		CompareTarget(b, &ff, &g, map, RandomFloor(map));
+		GridPathTerminate(&g);
+		FlowFieldsTerminate(&ff);
+	}
+	sDoorsLocked = false;
+	printf("\t\t%s (%dx%d) field: %.1fms, A*: %.1fms\n",
+		m->Title, map->Size.x, map->Size.y,
+		(b->FieldTime - fieldTime) * 1000.0 / CLOCKS_PER_SEC,
+		(b->GridTime - gridTime) * 1000.0 / CLOCKS_PER_SEC);
+}
+
+// Field bookkeeping on the largest map
+typedef struct
+{
+	int Area;
+	bool Done;
+	int BuildsSameTile;
+	int BuildsTwoTargets;
+	int BuildsMoved;
+	int BuildsInvalidated;
+	int FieldsBeforeRemove;
+	int FieldsAfterRemove;
+	int BuildsReadded;
+} RebuildBench;
+static void RebuildMap(Map *map, Mission *m, void *data)
+{
+	RebuildBench *r = data;
+	UNUSED(m);
+	if (map->Size.x * map->Size.y != r->Area || r->Done)
+	{
+		return;
+	}
+	r->Done = true;
+	const Vec2i a = RandomFloor(map);
+	Vec2i moved;
+	do
+	{
+		moved = RandomFloor(map);
+	} while (Vec2iEqual(moved, a));
+	const Vec2i b = RandomFloor(map);
+	FlowFields ff;
+	FlowFieldsInit(&ff, map->Size, IsMapTileOk);
+	for (int i = 0; i < 100; i++)
+	{
+		FlowFieldsGet(&ff, map, 1, a);
+	}
+	r->BuildsSameTile = ff.Builds;
+	FlowFieldsGet(&ff, map, 2, b);
+	FlowFieldsGet(&ff, map, 1, a);
+	r->BuildsTwoTargets = ff.Builds;
+	FlowFieldsGet(&ff, map, 1, moved);
+	r->BuildsMoved = ff.Builds;
+	FlowFieldsInvalidate(&ff);
+	FlowFieldsGet(&ff, map, 1, moved);
+	FlowFieldsGet(&ff, map, 2, b);
+	r->BuildsInvalidated = ff.Builds;
+	r->FieldsBeforeRemove = (int)ff.fields.size;
+	FlowFieldsRemove(&ff, 2);
+	FlowFieldsRemove(&ff, 3);
+	r->FieldsAfterRemove = (int)ff.fields.size;
+	FlowFieldsGet(&ff, map, 2, b);
+	r->BuildsReadded = ff.Builds;
+	FlowFieldsTerminate(&ff);
+}
+
+
+FEATURE(1, "Flow fields")
+	SCENARIO("Costs and steps against A* on the largest shipped maps")
+	{
+		LargestMaps l;
+		FieldBench b;
+		memset(&l, 0, sizeof l);
+		memset(&b, 0, sizeof b);
+		b.SameReachable = true;
+		b.NoCostlier = true;
+		b.StepsFollowCosts = true;
+		GIVEN("the largest maps of the shipped campaigns")
+			CampaignMapsInit();
+			CampaignMapsForEach(FindLargestMaps, &l);
+			b.MinArea = l.Areas[BENCH_MAPS - 1];
+		GIVEN_END
+
+		WHEN("I get fields to targets and find A* paths from many tiles");
+			srand(1);
+			CampaignMapsForEach(BenchMap, &b);
+			printf("\t\tField: %.1fms, A*: %.1fms, %d/%d unreachable, "
+				"%d shorter\n",
+				b.FieldTime * 1000.0 / CLOCKS_PER_SEC,
+				b.GridTime * 1000.0 / CLOCKS_PER_SEC,
+				b.Unreachable, b.Paths, b.Shorter);
+		WHEN_END
+
+		THEN("the fields should lead to the targets at least as cheaply");
+			SHOULD_INT_EQUAL(b.Maps, BENCH_MAPS);
+			SHOULD_INT_EQUAL(b.Paths, BENCH_MAPS * 2 * BENCH_PATHS);
+			SHOULD_INT_GT(b.Unreachable, 0);
+			SHOULD_BE_TRUE(b.SameReachable);
+			SHOULD_BE_TRUE(b.NoCostlier);
+			SHOULD_INT_LE(b.Shorter, b.Paths / 100);
+			SHOULD_BE_TRUE(b.StepsFollowCosts);
+		THEN_END
+
+		CampaignMapsTerminate();
+	}
+	SCENARIO_END
+
+	SCENARIO("Rebuild only on changes")
+	{
+		LargestMaps l;
+		RebuildBench r;
+		memset(&l, 0, sizeof l);
+		memset(&r, 0, sizeof r);
+		GIVEN("the largest shipped map")
+			CampaignMapsInit();
+			CampaignMapsForEach(FindLargestMaps, &l);
+			r.Area = l.Areas[0];
+		GIVEN_END
+
+		WHEN("I get fields as targets stay, move, change and go");
+			srand(1);
+			CampaignMapsForEach(RebuildMap, &r);
+		WHEN_END
+
+		THEN("fields should be rebuilt only when needed");
+			SHOULD_BE_TRUE(r.Done);
+			SHOULD_INT_EQUAL(r.BuildsSameTile, 1);
+			SHOULD_INT_EQUAL(r.BuildsTwoTargets, 2);
+			SHOULD_INT_EQUAL(r.BuildsMoved, 3);
+			SHOULD_INT_EQUAL(r.BuildsInvalidated, 5);
+		THEN_END
+		THEN("removed targets should free their fields");
+			SHOULD_INT_EQUAL(r.FieldsBeforeRemove, 2);
+			SHOULD_INT_EQUAL(r.FieldsAfterRemove, 1);
+			SHOULD_INT_EQUAL(r.BuildsReadded, 6);
+		THEN_END
+
+		CampaignMapsTerminate();
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("Flow field features are:", features);
+}
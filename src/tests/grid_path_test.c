@@ -0,0 +1,297 @@
+#include <cbehave/cbehave.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <grid_path.h>
+#include <utils.h>
+
+#include "campaign_maps.h"
+
+// A plain grid for the simple cases
+#define MAP_W 128
+#define MAP_H 128
+static bool sWalls[MAP_H][MAP_W];
+static bool IsTileOk(Map *map, Vec2i pos)
+{
+	UNUSED(map);
+	return pos.x >= 0 && pos.x < MAP_W && pos.y >= 0 && pos.y < MAP_H &&
+		!sWalls[pos.y][pos.x];
+}
+// Walls and empty tiles block; doors are taken to be unlocked
+static bool IsMapTileOk(Map *map, Vec2i pos)
+{
+	if (MapGetTile(map, pos) == NULL) return false;
+	switch (IMapGet(map, pos) & MAP_MASKACCESS)
+	{
+	case MAP_WALL:
+	case MAP_NOTHING:
+		return false;
+	default:
+		return true;
+	}
+}
+static Vec2i RandomFloor(Map *map)
+{
+	for (;;)
+	{
+		const Vec2i v = Vec2iNew(rand() % map->Size.x, rand() % map->Size.y);
+		if (IsMapTileOk(map, v)) return v;
+	}
+}
+
+// The generic A* as used before, for comparison
+static void AddTileNeighbors(
+	ASNeighborList neighbors, void *node, void *context)
+{
+	const Vec2i *v = node;
+	Map *map = context;
+	Vec2i d;
+	for (d.y = v->y - 1; d.y <= v->y + 1; d.y++)
+	{
+		for (d.x = v->x - 1; d.x <= v->x + 1; d.x++)
+		{
+			if (d.x == v->x && d.y == v->y) continue;
+			if (!IsMapTileOk(map, d) ||
+				!IsMapTileOk(map, Vec2iNew(v->x, d.y)) ||
+				!IsMapTileOk(map, Vec2iNew(d.x, v->y)))
+			{
+				continue;
+			}
+			ASNeighborListAdd(neighbors, &d, GridPathStepCost(*v, d));
+		}
+	}
+}
+static float AStarHeuristic(void *fromNode, void *toNode, void *context)
+{
+	const Vec2i *v1 = fromNode;
+	const Vec2i *v2 = toNode;
+	UNUSED(context);
+	return (float)sqrt(DistanceSquared(
+		Vec2iCenterOfTile(*v1), Vec2iCenterOfTile(*v2)));
+}
+static ASPathNodeSource cPathNodeSource =
+{
+	sizeof(Vec2i), AddTileNeighbors, AStarHeuristic, NULL, NULL
+};
+
+static float PathCost(ASPath path)
+{
+	float cost = 0;
+	for (size_t i = 1; i < ASPathGetCount(path); i++)
+	{
+		cost += GridPathStepCost(
+			*(Vec2i *)ASPathGetNode(path, i - 1),
+			*(Vec2i *)ASPathGetNode(path, i));
+	}
+	return cost;
+}
+static bool IsPathValid(
+	ASPath path, const Vec2i from, const Vec2i to,
+	TileSelectFunc isTileOk, Map *map)
+{
+	const size_t count = ASPathGetCount(path);
+	if (count == 0) return false;
+	if (!Vec2iEqual(*(Vec2i *)ASPathGetNode(path, 0), from)) return false;
+	if (!Vec2iEqual(*(Vec2i *)ASPathGetNode(path, count - 1), to))
+	{
+		return false;
+	}
+	for (size_t i = 1; i < count; i++)
+	{
+		const Vec2i *a = ASPathGetNode(path, i - 1);
+		const Vec2i *b = ASPathGetNode(path, i);
+		if (CHEBYSHEV_DISTANCE(a->x, a->y, b->x, b->y) != 1 ||
+			!isTileOk(map, *b))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Compare with the generic A* on the largest shipped maps
+#define BENCH_MAPS 5
+#define BENCH_PATHS 100
+typedef struct
+{
+	int Areas[BENCH_MAPS];	// largest first
+} LargestMaps;
+static void FindLargestMaps(Map *map, Mission *m, void *data)
+{
+	LargestMaps *l = data;
+	UNUSED(m);
+	int area = map->Size.x * map->Size.y;
+	for (int i = 0; i < BENCH_MAPS; i++)
+	{
+		if (area > l->Areas[i])
+		{
+			const int tmp = l->Areas[i];
+			l->Areas[i] = area;
+			area = tmp;
+		}
+	}
+}
+typedef struct
+{
+	int MinArea;
+	int Maps;
+	int Paths;
+	bool SameResults;
+	bool Valid;
+	float GridCost;
+	float GenericCost;
+	clock_t GridTime;
+	clock_t GenericTime;
+} PathBench;
+static void BenchMap(Map *map, Mission *m, void *data)
+{
+	PathBench *b = data;
+	if (map->Size.x * map->Size.y < b->MinArea || b->Maps == BENCH_MAPS)
+	{
+		return;
+	}
+	b->Maps++;
+	GridPath g;
+	GridPathInit(&g, map->Size);
+	clock_t gridTime = 0;
+	clock_t genericTime = 0;
+	for (int i = 0; i < BENCH_PATHS; i++)
+	{
+		Vec2i from = RandomFloor(map);
+		Vec2i to = RandomFloor(map);
+		clock_t t = clock();
+		ASPath p1 = GridPathFind(&g, map, IsMapTileOk, from, to);
+		gridTime += clock() - t;
+		t = clock();
+		ASPath p2 = ASPathCreate(&cPathNodeSource, map, &from, &to);
+		genericTime += clock() - t;
+		b->Paths++;
+		if ((p1 == NULL) != (p2 == NULL))
+		{
+			b->SameResults = false;
+		}
+		if (p1 != NULL)
+		{
+			b->Valid =
+				b->Valid && IsPathValid(p1, from, to, IsMapTileOk, map);
+			b->GridCost += PathCost(p1);
+		}
+		if (p2 != NULL)
+		{
+			b->GenericCost += PathCost(p2);
+		}
+		ASPathDestroy(p1);
+		ASPathDestroy(p2);
+	}
+	printf("\t\t%s (%dx%d) grid: %.1fms, generic: %.1fms\n",
+		m->Title, map->Size.x, map->Size.y,
+		gridTime * 1000.0 / CLOCKS_PER_SEC,
+		genericTime * 1000.0 / CLOCKS_PER_SEC);
+	b->GridTime += gridTime;
+	b->GenericTime += genericTime;
+	GridPathTerminate(&g);
+}
+
+
+FEATURE(1, "Grid pathfinding")
+	SCENARIO("Straight path")
+	{
+		Map map;
+		GridPath g;
+		ASPath path;
+		GIVEN("an empty map")
+			memset(sWalls, 0, sizeof sWalls);
+			GridPathInit(&g, Vec2iNew(MAP_W, MAP_H));
+		GIVEN_END
+
+		WHEN("I find a path along a row");
+			path = GridPathFind(
+				&g, &map, IsTileOk, Vec2iNew(2, 5), Vec2iNew(12, 5));
+		WHEN_END
+
+		THEN("the path should be a straight line");
+			SHOULD_INT_EQUAL((int)ASPathGetCount(path), 11);
+			SHOULD_BE_TRUE(IsPathValid(
+				path, Vec2iNew(2, 5), Vec2iNew(12, 5), IsTileOk, &map));
+		THEN_END
+
+		ASPathDestroy(path);
+		GridPathTerminate(&g);
+	}
+	SCENARIO_END
+
+	SCENARIO("No path")
+	{
+		Map map;
+		GridPath g;
+		ASPath path;
+		GIVEN("a map split by a wall")
+			memset(sWalls, 0, sizeof sWalls);
+			for (int y = 0; y < MAP_H; y++)
+			{
+				sWalls[y][20] = true;
+			}
+			GridPathInit(&g, Vec2iNew(MAP_W, MAP_H));
+		GIVEN_END
+
+		WHEN("I find a path across the wall");
+			path = GridPathFind(
+				&g, &map, IsTileOk, Vec2iNew(2, 5), Vec2iNew(30, 5));
+		WHEN_END
+
+		THEN("there should be no path");
+			SHOULD_BE_TRUE(path == NULL);
+		THEN_END
+
+		GridPathTerminate(&g);
+	}
+	SCENARIO_END
+
+	SCENARIO("Compare with generic A* on the largest shipped maps")
+	{
+		LargestMaps l;
+		PathBench b;
+		memset(&l, 0, sizeof l);
+		memset(&b, 0, sizeof b);
+		b.SameResults = true;
+		b.Valid = true;
+		GIVEN("the largest maps of the shipped campaigns")
+			CampaignMapsInit();
+			CampaignMapsForEach(FindLargestMaps, &l);
+			b.MinArea = l.Areas[BENCH_MAPS - 1];
+		GIVEN_END
+
+		WHEN("I find many paths with both");
+			srand(1);
+			CampaignMapsForEach(BenchMap, &b);
+			printf("\t\tGrid: %.1fms, generic: %.1fms\n",
+				b.GridTime * 1000.0 / CLOCKS_PER_SEC,
+				b.GenericTime * 1000.0 / CLOCKS_PER_SEC);
+		WHEN_END
+
+		THEN("they should find the same paths");
+			SHOULD_INT_EQUAL(b.Maps, BENCH_MAPS);
+			SHOULD_INT_EQUAL(b.Paths, BENCH_MAPS * BENCH_PATHS);
+			SHOULD_BE_TRUE(b.SameResults);
+			SHOULD_BE_TRUE(b.Valid);
+			SHOULD_BE_TRUE(
+				fabs(b.GridCost - b.GenericCost) < b.GenericCost * 0.001);
+		THEN_END
+
+		CampaignMapsTerminate();
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("Grid path features are:", features);
+}
@@ -0,0 +1,365 @@
+#include <cbehave/cbehave.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <grid_path.h>
+#include <hpa_path.h>
+#include <utils.h>
+
+#include "campaign_maps.h"
+
+// Walls and empty tiles block; doors block only while locked
+static bool sDoorsLocked = false;
+static bool IsMapTileOk(Map *map, Vec2i pos)
+{
+	if (MapGetTile(map, pos) == NULL) return false;
+	switch (IMapGet(map, pos) & MAP_MASKACCESS)
+	{
+	case MAP_WALL:
+	case MAP_NOTHING:
+		return false;
+	case MAP_DOOR:
+		return !sDoorsLocked;
+	default:
+		return true;
+	}
+}
+static Vec2i RandomFloor(Map *map)
+{
+	for (;;)
+	{
+		const Vec2i v = Vec2iNew(rand() % map->Size.x, rand() % map->Size.y);
+		if (IsMapTileOk(map, v)) return v;
+	}
+}
+
+static float PathCost(ASPath path)
+{
+	float cost = 0;
+	for (size_t i = 1; i < ASPathGetCount(path); i++)
+	{
+		cost += GridPathStepCost(
+			*(Vec2i *)ASPathGetNode(path, i - 1),
+			*(Vec2i *)ASPathGetNode(path, i));
+	}
+	return cost;
+}
+static bool IsPathValid(
+	ASPath path, const Vec2i from, const Vec2i to, Map *map)
+{
+	const size_t count = ASPathGetCount(path);
+	if (count == 0) return false;
+	if (!Vec2iEqual(*(Vec2i *)ASPathGetNode(path, 0), from)) return false;
+	if (!Vec2iEqual(*(Vec2i *)ASPathGetNode(path, count - 1), to))
+	{
+		return false;
+	}
+	for (size_t i = 1; i < count; i++)
+	{
+		const Vec2i *a = ASPathGetNode(path, i - 1);
+		const Vec2i *b = ASPathGetNode(path, i);
+		if (CHEBYSHEV_DISTANCE(a->x, a->y, b->x, b->y) != 1 ||
+			!IsMapTileOk(map, *b) ||
+			!IsMapTileOk(map, Vec2iNew(a->x, b->y)) ||
+			!IsMapTileOk(map, Vec2iNew(b->x, a->y)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Compare with the full search on the largest shipped maps
+#define BENCH_MAPS 5
+#define BENCH_PATHS 100
+typedef struct
+{
+	int Areas[BENCH_MAPS];	// largest first
+} LargestMaps;
+static void FindLargestMaps(Map *map, Mission *m, void *data)
+{
+	LargestMaps *l = data;
+	UNUSED(m);
+	int area = map->Size.x * map->Size.y;
+	for (int i = 0; i < BENCH_MAPS; i++)
+	{
+		if (area > l->Areas[i])
+		{
+			const int tmp = l->Areas[i];
+			l->Areas[i] = area;
+			area = tmp;
+		}
+	}
+}
+typedef struct
+{
+	int MinArea;
+	int Maps;
+	int Paths;
+	int Found;
+	int GridFound;
+	bool NoFalsePaths;
+	bool Valid;
+	float HPACost;
+	float GridCost;
+	clock_t BuildTime;
+	clock_t HPATime;
+	clock_t GridTime;
+} PathBench;
+static void BenchMap(Map *map, Mission *m, void *data)
+{
+	PathBench *b = data;
+	if (map->Size.x * map->Size.y < b->MinArea || b->Maps == BENCH_MAPS)
+	{
+		return;
+	}
+	b->Maps++;
+	HPAPath h;
+	GridPath g;
+	HPAPathInit(&h, map->Size, IsMapTileOk);
+	GridPathInit(&g, map->Size);
+	clock_t t = clock();
+	ASPathDestroy(HPAPathFind(&h, map, Vec2iZero(), Vec2iZero()));
+	const clock_t buildTime = clock() - t;
+	clock_t hpaTime = 0;
+	clock_t gridTime = 0;
+	float hpaCost = 0;
+	float gridCost = 0;
+	for (int i = 0; i < BENCH_PATHS; i++)
+	{
+		const Vec2i from = RandomFloor(map);
+		const Vec2i to = RandomFloor(map);
+		t = clock();
+		ASPath p1 = HPAPathFind(&h, map, from, to);
+		hpaTime += clock() - t;
+		t = clock();
+		ASPath p2 = GridPathFind(&g, map, IsMapTileOk, from, to);
+		gridTime += clock() - t;
+		b->Paths++;
+		if (p1 != NULL && p2 == NULL)
+		{
+			b->NoFalsePaths = false;
+		}
+		if (p1 != NULL)
+		{
+			b->Valid = b->Valid && IsPathValid(p1, from, to, map);
+		}
+		if (p1 != NULL && p2 != NULL)
+		{
+			b->Found++;
+			hpaCost += PathCost(p1);
+			gridCost += PathCost(p2);
+		}
+		if (p2 != NULL)
+		{
+			b->GridFound++;
+		}
+		ASPathDestroy(p1);
+		ASPathDestroy(p2);
+	}
+	printf("\t\t%s (%dx%d) build: %.1fms, HPA*: %.1fms, A*: %.1fms, "
+		"%.1f%% longer\n",
+		m->Title, map->Size.x, map->Size.y,
+		buildTime * 1000.0 / CLOCKS_PER_SEC,
+		hpaTime * 1000.0 / CLOCKS_PER_SEC,
+		gridTime * 1000.0 / CLOCKS_PER_SEC,
+		gridCost > 0 ? (hpaCost / gridCost - 1) * 100 : 0);
+	b->BuildTime += buildTime;
+	b->HPATime += hpaTime;
+	b->GridTime += gridTime;
+	b->HPACost += hpaCost;
+	b->GridCost += gridCost;
+	GridPathTerminate(&g);
+	HPAPathTerminate(&h);
+}
+
+// Lock and unlock every door on the largest map, updating the clusters
+typedef struct
+{
+	int Area;
+	int Doors;
+	int Paths;
+	int ThroughDoors;
+	bool SameResults;
+	bool Valid;
+} DoorBench;
+static void SetDoorsLocked(HPAPath *h, Map *map, const bool locked)
+{
+	sDoorsLocked = locked;
+	Vec2i v;
+	for (v.y = 0; v.y < map->Size.y; v.y++)
+	{
+		for (v.x = 0; v.x < map->Size.x; v.x++)
+		{
+			if ((IMapGet(map, v) & MAP_MASKACCESS) == MAP_DOOR)
+			{
+				HPAPathUpdateTile(h, map, v);
+			}
+		}
+	}
+}
+// Returns whether the full search found a path
+static bool CheckSame(
+	DoorBench *d, HPAPath *h, GridPath *g, Map *map,
+	const Vec2i from, const Vec2i to)
+{
+	ASPath p1 = HPAPathFind(h, map, from, to);
+	ASPath p2 = GridPathFind(g, map, IsMapTileOk, from, to);
+	d->Paths++;
+	if ((p1 == NULL) != (p2 == NULL))
+	{
+		d->SameResults = false;
+	}
+	if (p1 != NULL)
+	{
+		d->Valid = d->Valid && IsPathValid(p1, from, to, map);
+	}
+	const bool found = p2 != NULL;
+	ASPathDestroy(p1);
+	ASPathDestroy(p2);
+	return found;
+}
+static void DoorsMap(Map *map, Mission *m, void *data)
+{
+	DoorBench *d = data;
+	UNUSED(m);
+	if (map->Size.x * map->Size.y != d->Area || d->Paths > 0)
+	{
+		return;
+	}
+	Vec2i v;
+	for (v.y = 0; v.y < map->Size.y; v.y++)
+	{
+		for (v.x = 0; v.x < map->Size.x; v.x++)
+		{
+			if ((IMapGet(map, v) & MAP_MASKACCESS) == MAP_DOOR)
+			{
+				d->Doors++;
+			}
+		}
+	}
+	// Paths between tiles that aren't doors, which need them while unlocked
+	Vec2i from[BENCH_PATHS];
+	Vec2i to[BENCH_PATHS];
+	bool open[BENCH_PATHS];
+	sDoorsLocked = true;
+	for (int i = 0; i < BENCH_PATHS; i++)
+	{
+		from[i] = RandomFloor(map);
+		to[i] = RandomFloor(map);
+	}
+	HPAPath h;
+	GridPath g;
+	HPAPathInit(&h, map->Size, IsMapTileOk);
+	GridPathInit(&g, map->Size);
+	SetDoorsLocked(&h, map, false);
+	for (int i = 0; i < BENCH_PATHS; i++)
+	{
+		open[i] = CheckSame(d, &h, &g, map, from[i], to[i]);
+	}
+	SetDoorsLocked(&h, map, true);
+	for (int i = 0; i < BENCH_PATHS; i++)
+	{
+		if (!CheckSame(d, &h, &g, map, from[i], to[i]) && open[i])
+		{
+			d->ThroughDoors++;
+		}
+	}
+	SetDoorsLocked(&h, map, false);
+	for (int i = 0; i < BENCH_PATHS; i++)
+	{
+		if (CheckSame(d, &h, &g, map, from[i], to[i]) != open[i])
+		{
+			d->SameResults = false;
+		}
+	}
+	sDoorsLocked = false;
+	GridPathTerminate(&g);
+	HPAPathTerminate(&h);
+}
+
+
+FEATURE(1, "Hierarchical pathfinding")
+	SCENARIO("Compare with full search on the largest shipped maps")
+	{
+		LargestMaps l;
+		PathBench b;
+		memset(&l, 0, sizeof l);
+		memset(&b, 0, sizeof b);
+		b.NoFalsePaths = true;
+		b.Valid = true;
+		GIVEN("the largest maps of the shipped campaigns")
+			CampaignMapsInit();
+			CampaignMapsForEach(FindLargestMaps, &l);
+			b.MinArea = l.Areas[BENCH_MAPS - 1];
+		GIVEN_END
+
+		WHEN("I find many paths with both");
+			srand(1);
+			CampaignMapsForEach(BenchMap, &b);
+			printf("\t\tBuild: %.1fms, HPA*: %.1fms, A*: %.1fms, "
+				"%d/%d found, %.1f%% longer\n",
+				b.BuildTime * 1000.0 / CLOCKS_PER_SEC,
+				b.HPATime * 1000.0 / CLOCKS_PER_SEC,
+				b.GridTime * 1000.0 / CLOCKS_PER_SEC,
+				b.Found, b.GridFound, (b.HPACost / b.GridCost - 1) * 100);
+		WHEN_END
+
+		THEN("the paths should be valid and nearly as short");
+			SHOULD_INT_EQUAL(b.Maps, BENCH_MAPS);
+			SHOULD_INT_EQUAL(b.Paths, BENCH_MAPS * BENCH_PATHS);
+			SHOULD_BE_TRUE(b.NoFalsePaths);
+			SHOULD_BE_TRUE(b.Valid);
+			SHOULD_INT_GE(b.Found, b.GridFound * 95 / 100);
+			SHOULD_BE_TRUE(b.HPACost < b.GridCost * 1.1f);
+		THEN_END
+
+		CampaignMapsTerminate();
+	}
+	SCENARIO_END
+
+	SCENARIO("Doors locking and unlocking")
+	{
+		LargestMaps l;
+		DoorBench d;
+		memset(&l, 0, sizeof l);
+		memset(&d, 0, sizeof d);
+		d.SameResults = true;
+		d.Valid = true;
+		GIVEN("the largest shipped map")
+			CampaignMapsInit();
+			CampaignMapsForEach(FindLargestMaps, &l);
+			d.Area = l.Areas[0];
+		GIVEN_END
+
+		WHEN("I find paths as all its doors unlock, lock and unlock again");
+			srand(1);
+			CampaignMapsForEach(DoorsMap, &d);
+			printf("\t\t%d doors, %d/%d paths need them\n",
+				d.Doors, d.ThroughDoors, BENCH_PATHS);
+		WHEN_END
+
+		THEN("the paths should follow the doors");
+			SHOULD_INT_GT(d.Doors, 0);
+			SHOULD_INT_GT(d.ThroughDoors, 0);
+			SHOULD_BE_TRUE(d.SameResults);
+			SHOULD_BE_TRUE(d.Valid);
+		THEN_END
+
+		CampaignMapsTerminate();
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("HPA* path features are:", features);
+}
@@ -0,0 +1,206 @@
+#include <cbehave/cbehave.h>
+
+#include <string.h>
+
+#include <hqx_pool.h>
+#include <hqx/hqx.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+// Odd sizes so that the bands are uneven
+#define W 61
+#define H 37
+#define FILL 0x12345678
+
+// Hashes of MakeImage scaled by the original, single-threaded hqx
+static Uint32 GoldenHash(const int scale)
+{
+	switch (scale)
+	{
+	case 2: return 0x6F8097C7;
+	case 3: return 0xD766C30C;
+	default: return 0x4C64F318;
+	}
+}
+
+static Uint32 sImage[W * H];
+static Uint32 sOut1[W * H * 16];
+static Uint32 sOut2[W * H * 16];
+
+// Blocks of a few colours, with noise, so that most hqx patterns turn up
+static void MakeImage(Uint32 *img)
+{
+	static const Uint32 colors[] =
+	{
+		0xFF000000, 0xFFFFFFFF, 0xFF808080, 0xFFFF0000,
+		0xFF20A040, 0xFF1020F0, 0xFF7F7F80, 0x80F0F0F0
+	};
+	Uint32 seed = 12345;
+	for (int y = 0; y < H; y++)
+	{
+		for (int x = 0; x < W; x++)
+		{
+			seed = seed * 1103515245 + 12345;
+			int c = (x / 5 + (y / 4) * 3) % 8;
+			if ((seed >> 16) % 4 == 0)
+			{
+				c = (seed >> 20) % 8;
+			}
+			img[y * W + x] = colors[c];
+		}
+	}
+}
+static Uint32 Hash(const Uint32 *p, const int n)
+{
+	Uint32 h = 2166136261u;
+	for (int i = 0; i < n; i++)
+	{
+		h = (h ^ p[i]) * 16777619u;
+	}
+	return h;
+}
+static void Scale(Uint32 *out, const int scale)
+{
+	switch (scale)
+	{
+	case 2: hq2x_32(sImage, out, W, H); break;
+	case 3: hq3x_32(sImage, out, W, H); break;
+	default: hq4x_32(sImage, out, W, H); break;
+	}
+}
+static void Fill(Uint32 *out)
+{
+	for (int i = 0; i < W * H * 16; i++)
+	{
+		out[i] = FILL;
+	}
+}
+
+
+FEATURE(1, "Golden images")
+	SCENARIO("Scale on one thread")
+	{
+		bool same[5];
+		GIVEN("an image")
+			hqxInit();
+			MakeImage(sImage);
+		GIVEN_END
+
+		WHEN("I scale it by 2, 3 and 4");
+			for (int scale = 2; scale <= 4; scale++)
+			{
+				Scale(sOut1, scale);
+				same[scale] =
+					Hash(sOut1, W * H * scale * scale) == GoldenHash(scale);
+			}
+		WHEN_END
+
+		THEN("the pixels should match the golden images");
+			SHOULD_BE_TRUE(same[2]);
+			SHOULD_BE_TRUE(same[3]);
+			SHOULD_BE_TRUE(same[4]);
+		THEN_END
+	}
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(2, "Pool")
+	SCENARIO("Scale in bands")
+	{
+		HqxPool pool;
+		bool same[4][5];
+		GIVEN("an image and pools of different sizes")
+			MakeImage(sImage);
+		GIVEN_END
+
+		WHEN("I scale it with each pool");
+			for (int workers = 0; workers < 4; workers++)
+			{
+				HqxPoolInit(&pool, workers);
+				for (int scale = 2; scale <= 4; scale++)
+				{
+					Fill(sOut2);
+					HqxPoolScale(
+						&pool, scale, sImage, sOut2, Vec2iNew(W, H), 0, H);
+					same[workers][scale] =
+						Hash(sOut2, W * H * scale * scale) ==
+						GoldenHash(scale);
+				}
+				HqxPoolTerminate(&pool);
+			}
+		WHEN_END
+
+		THEN("the pixels should match the golden images");
+			for (int workers = 0; workers < 4; workers++)
+			{
+				for (int scale = 2; scale <= 4; scale++)
+				{
+					SHOULD_BE_TRUE(same[workers][scale]);
+				}
+			}
+		THEN_END
+	}
+	SCENARIO_END
+
+	SCENARIO("Scale some rows")
+	{
+		HqxPool pool;
+		const int yStart = 10;
+		const int yEnd = 23;
+		const int scale = 3;
+		const int rowSize = W * scale * scale;
+		bool inside;
+		bool outside = true;
+		GIVEN("an image and a pool")
+			MakeImage(sImage);
+			HqxPoolInit(&pool, 3);
+		GIVEN_END
+
+		WHEN("I scale some of its rows");
+			Scale(sOut1, scale);
+			Fill(sOut2);
+			HqxPoolScale(
+				&pool, scale, sImage, sOut2, Vec2iNew(W, H), yStart, yEnd);
+			HqxPoolTerminate(&pool);
+			inside = memcmp(
+				sOut1 + yStart * rowSize, sOut2 + yStart * rowSize,
+				(yEnd - yStart) * rowSize * sizeof *sOut1) == 0;
+			for (int i = 0; i < W * H * scale * scale; i++)
+			{
+				if ((i < yStart * rowSize || i >= yEnd * rowSize) &&
+					sOut2[i] != FILL)
+				{
+					outside = false;
+				}
+			}
+		WHEN_END
+
+		THEN("those rows should be scaled as part of the whole image");
+			SHOULD_BE_TRUE(inside);
+		THEN_END
+		THEN("the other rows should be left alone");
+			SHOULD_BE_TRUE(outside);
+		THEN_END
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)},
+		{feature_idx(2)}
+	};
+
+	return cbehave_runner("Hqx features are:", features);
+}
@@ -0,0 +1,201 @@
+#include <cbehave/cbehave.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithms.h>
+#include <config.h>
+#include <los.h>
+#include <map.h>
+
+#include "campaign_maps.h"
+
+// Check visibility from every nth floor tile, across and down
+#define VIEWER_STRIDE 5
+
+// The previous LOS algorithm, kept here to check against: cast Xiaolin Wu
+// rays to every tile on the perimeter of the sight box, marking tiles up to
+// and including the first obstruction, then mark obstructions next to
+// visible floor
+typedef struct
+{
+	Map *Map;
+	bool *Visible;
+	Vec2i Center;
+	int SightRange2;
+} OldLOS;
+static void OldSetVisible(OldLOS *o, const Vec2i pos)
+{
+	if (MapGetTile(o->Map, pos) == NULL) return;
+	o->Visible[pos.y * o->Map->Size.x + pos.x] = true;
+}
+static bool OldIsNextTileBlockedAndSetVisibility(void *data, Vec2i pos)
+{
+	OldLOS *o = data;
+	if (DistanceSquared(o->Center, pos) >= o->SightRange2) return true;
+	const Tile *t = MapGetTile(o->Map, pos);
+	if (t == NULL) return true;
+	OldSetVisible(o, pos);
+	return t->flags & MAPTILE_NO_SEE;
+}
+static bool OldIsTileVisibleNonObstruction(OldLOS *o, const Vec2i pos)
+{
+	const Tile *t = MapGetTile(o->Map, pos);
+	if (t == NULL) return false;
+	return !(t->flags & MAPTILE_NO_SEE) &&
+		o->Visible[pos.y * o->Map->Size.x + pos.x];
+}
+static void OldCalcFrom(OldLOS *o, const Vec2i pos, const int sightRange)
+{
+	memset(o->Visible, 0, o->Map->Size.x * o->Map->Size.y);
+	Vec2i end;
+	for (end.x = pos.x - 1; end.x <= pos.x + 1; end.x++)
+	{
+		for (end.y = pos.y - 1; end.y <= pos.y + 1; end.y++)
+		{
+			OldSetVisible(o, end);
+		}
+	}
+
+	const Vec2i origin = Vec2iNew(pos.x - sightRange, pos.y - sightRange);
+	const Vec2i perimSize = Vec2iScale(Vec2iMinus(pos, origin), 2);
+	o->Center = pos;
+	o->SightRange2 = sightRange * sightRange;
+	HasClearLineData lineData;
+	lineData.IsBlocked = OldIsNextTileBlockedAndSetVisibility;
+	lineData.data = o;
+	end = origin;
+	for (; end.x < origin.x + perimSize.x; end.x++)
+	{
+		HasClearLineXiaolinWu(pos, end, &lineData);
+	}
+	for (; end.y < origin.y + perimSize.y; end.y++)
+	{
+		HasClearLineXiaolinWu(pos, end, &lineData);
+	}
+	for (; end.x > origin.x; end.x--)
+	{
+		HasClearLineXiaolinWu(pos, end, &lineData);
+	}
+	for (; end.y > origin.y; end.y--)
+	{
+		HasClearLineXiaolinWu(pos, end, &lineData);
+	}
+
+	for (end.y = origin.y; end.y < origin.y + perimSize.y; end.y++)
+	{
+		for (end.x = origin.x; end.x < origin.x + perimSize.x; end.x++)
+		{
+			const Tile *tile = MapGetTile(o->Map, end);
+			if (!tile || !(tile->flags & MAPTILE_NO_SEE))
+			{
+				continue;
+			}
+			if (DistanceSquared(pos, end) >= o->SightRange2)
+			{
+				continue;
+			}
+			Vec2i d;
+			for (d.x = -1; d.x < 2; d.x++)
+			{
+				for (d.y = -1; d.y < 2; d.y++)
+				{
+					if (OldIsTileVisibleNonObstruction(o, Vec2iAdd(end, d)))
+					{
+						OldSetVisible(o, end);
+					}
+				}
+			}
+		}
+	}
+}
+
+typedef struct
+{
+	int Campaigns;
+	int Maps;
+	int Viewers;
+	int Visible;	// tiles seen by either algorithm
+	int Different;
+} LOSCompare;
+
+static void CompareMission(Map *map, Mission *m, void *data)
+{
+	LOSCompare *c = data;
+	const int sightRange = ConfigGetInt(&gConfig, "Game.SightRange");
+	OldLOS o;
+	o.Map = map;
+	CCALLOC(o.Visible, map->Size.x * map->Size.y);
+	Vec2i v;
+	for (v.y = 0; v.y < map->Size.y; v.y += VIEWER_STRIDE)
+	{
+		for (v.x = 0; v.x < map->Size.x; v.x += VIEWER_STRIDE)
+		{
+			if (MapGetTile(map, v)->flags & MAPTILE_NO_WALK) continue;
+			c->Viewers++;
+			OldCalcFrom(&o, v, sightRange);
+			LOSReset(&map->LOS);
+			LOSCalcFrom(map, v, false);
+			Vec2i p;
+			for (p.y = 0; p.y < map->Size.y; p.y++)
+			{
+				for (p.x = 0; p.x < map->Size.x; p.x++)
+				{
+					const bool isNew = LOSTileIsVisible(map, p);
+					const bool isOld = o.Visible[p.y * map->Size.x + p.x];
+					if (!isNew && !isOld) continue;
+					c->Visible++;
+					if (isNew != isOld)
+					{
+						c->Different++;
+						printf("%s: viewer (%d, %d) tile (%d, %d) %s\n",
+							m->Title, v.x, v.y, p.x, p.y,
+							isOld ? "old only" : "new only");
+					}
+				}
+			}
+		}
+	}
+	CFREE(o.Visible);
+	c->Maps++;
+}
+
+FEATURE(1, "LOS on the shipped campaigns")
+	SCENARIO("Same visibility as ray casting")
+	{
+		LOSCompare c;
+		memset(&c, 0, sizeof c);
+		GIVEN("the game data and the shipped campaigns")
+			CampaignMapsInit();
+		GIVEN_END
+
+		WHEN("I calculate LOS from floor tiles of every mission");
+			c.Campaigns = CampaignMapsForEach(CompareMission, &c);
+			printf("%d campaigns, %d maps, %d viewers, %d visible tiles\n",
+				c.Campaigns, c.Maps, c.Viewers, c.Visible);
+		WHEN_END
+
+		THEN("every map should be checked");
+			SHOULD_INT_GT(c.Campaigns, 0);
+			SHOULD_INT_GT(c.Maps, 0);
+			SHOULD_INT_GT(c.Viewers, 0);
+		THEN_END
+
+		THEN("the visible tiles should be identical to the old algorithm");
+			SHOULD_INT_EQUAL(c.Different, 0);
+		THEN_END
+
+		CampaignMapsTerminate();
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("LOS features are:", features);
+}
@@ -0,0 +1,221 @@
+#include <cbehave/cbehave.h>
+
+#include <stdio.h>
+
+#include <name_index.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+typedef struct
+{
+	char *Name;
+	int Value;
+} Item;
+static const char *ItemGetName(const void *item)
+{
+	return ((const Item *)item)->Name;
+}
+static void AddItem(CArray *items, const char *name, const int value)
+{
+	Item item;
+	CSTRDUP(item.Name, name);
+	item.Value = value;
+	CArrayPushBack(items, &item);
+}
+static void ClearItems(CArray *items)
+{
+	CA_FOREACH(Item, item, *items)
+		CFREE(item->Name);
+	CA_FOREACH_END()
+	CArrayClear(items);
+}
+// Lookup as the registries do it: custom items shadow built-in ones
+static const Item *GetItem(
+	NameIndex *index, CArray *items, NameIndex *customIndex, CArray *custom,
+	const char *name)
+{
+	const Item *item = NameIndexGet(customIndex, custom, name);
+	if (item == NULL)
+	{
+		item = NameIndexGet(index, items, name);
+	}
+	return item;
+}
+
+
+FEATURE(1, "Name index")
+	SCENARIO("Find items appended after the index is created")
+	{
+		CArray items;
+		NameIndex ni;
+		GIVEN("an index over some items")
+			CArrayInit(&items, sizeof(Item));
+			NameIndexInit(&ni, ItemGetName);
+			AddItem(&items, "uzi", 1);
+			AddItem(&items, "shotgun", 2);
+		GIVEN_END
+
+		WHEN("I look up an item, then add lots more")
+			SHOULD_INT_EQUAL(NameIndexFind(&ni, &items, "shotgun"), 1);
+			for (int i = 0; i < 1000; i++)
+			{
+				char buf[32];
+				sprintf(buf, "gun%d", i);
+				AddItem(&items, buf, i);
+			}
+		WHEN_END
+
+		THEN("all the items should be found, and unknown names not");
+			bool allCorrect = true;
+			for (int i = 0; i < 1000; i++)
+			{
+				char buf[32];
+				sprintf(buf, "gun%d", i);
+				const Item *item = NameIndexGet(&ni, &items, buf);
+				allCorrect = allCorrect && item != NULL && item->Value == i;
+			}
+			SHOULD_BE_TRUE(allCorrect);
+			SHOULD_INT_EQUAL(NameIndexFind(&ni, &items, "uzi"), 0);
+			SHOULD_INT_EQUAL(NameIndexFind(&ni, &items, "laser"), -1);
+			SHOULD_INT_EQUAL(NameIndexFind(&ni, &items, NULL), -1);
+		THEN_END
+
+		ClearItems(&items);
+		CArrayTerminate(&items);
+		NameIndexTerminate(&ni);
+	}
+	SCENARIO_END
+
+	SCENARIO("Duplicate names")
+	{
+		CArray items;
+		NameIndex ni;
+		GIVEN("items with the same name")
+			CArrayInit(&items, sizeof(Item));
+			NameIndexInit(&ni, ItemGetName);
+			AddItem(&items, "blood", 1);
+			AddItem(&items, "blood", 2);
+		GIVEN_END
+
+		THEN("the first one should be found, like a linear scan");
+			SHOULD_INT_EQUAL(NameIndexFind(&ni, &items, "blood"), 0);
+		THEN_END
+
+		ClearItems(&items);
+		CArrayTerminate(&items);
+		NameIndexTerminate(&ni);
+	}
+	SCENARIO_END
+
+	SCENARIO("Clear and reload")
+	{
+		CArray items;
+		NameIndex ni;
+		GIVEN("an index that has been used")
+			CArrayInit(&items, sizeof(Item));
+			NameIndexInit(&ni, ItemGetName);
+			AddItem(&items, "a", 1);
+			AddItem(&items, "b", 2);
+			SHOULD_INT_EQUAL(NameIndexFind(&ni, &items, "b"), 1);
+		GIVEN_END
+
+		WHEN("I replace the items with the same number of different ones")
+			ClearItems(&items);
+			NameIndexClear(&ni);
+			AddItem(&items, "b", 3);
+			AddItem(&items, "c", 4);
+		WHEN_END
+
+		THEN("the new items should be found");
+			SHOULD_INT_EQUAL(NameIndexFind(&ni, &items, "a"), -1);
+			SHOULD_INT_EQUAL(NameIndexFind(&ni, &items, "b"), 0);
+			SHOULD_INT_EQUAL(NameIndexFind(&ni, &items, "c"), 1);
+		THEN_END
+
+		WHEN("I remove items without clearing the index")
+			ClearItems(&items);
+			AddItem(&items, "d", 5);
+		WHEN_END
+
+		THEN("the shrunk array should be reindexed");
+			SHOULD_INT_EQUAL(NameIndexFind(&ni, &items, "d"), 0);
+			SHOULD_INT_EQUAL(NameIndexFind(&ni, &items, "b"), -1);
+		THEN_END
+
+		ClearItems(&items);
+		CArrayTerminate(&items);
+		NameIndexTerminate(&ni);
+	}
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(2, "Custom items shadow built-in items")
+	SCENARIO("Shadowing and unloading")
+	{
+		CArray items;
+		CArray custom;
+		NameIndex index;
+		NameIndex customIndex;
+		GIVEN("built-in and custom items sharing a name")
+			CArrayInit(&items, sizeof(Item));
+			CArrayInit(&custom, sizeof(Item));
+			NameIndexInit(&index, ItemGetName);
+			NameIndexInit(&customIndex, ItemGetName);
+			AddItem(&items, "wall", 1);
+			AddItem(&items, "floor", 2);
+			AddItem(&custom, "wall", 10);
+		GIVEN_END
+
+		THEN("the custom item should be found first");
+			SHOULD_INT_EQUAL(
+				GetItem(&index, &items, &customIndex, &custom, "wall")->Value,
+				10);
+			SHOULD_INT_EQUAL(
+				GetItem(&index, &items, &customIndex, &custom, "floor")->Value,
+				2);
+		THEN_END
+
+		WHEN("I unload the custom items and load another campaign's")
+			ClearItems(&custom);
+			NameIndexClear(&customIndex);
+			AddItem(&custom, "floor", 20);
+		WHEN_END
+
+		THEN("the built-in item should no longer be shadowed");
+			SHOULD_INT_EQUAL(
+				GetItem(&index, &items, &customIndex, &custom, "wall")->Value,
+				1);
+			SHOULD_INT_EQUAL(
+				GetItem(&index, &items, &customIndex, &custom, "floor")->Value,
+				20);
+		THEN_END
+
+		ClearItems(&items);
+		ClearItems(&custom);
+		CArrayTerminate(&items);
+		CArrayTerminate(&custom);
+		NameIndexTerminate(&index);
+		NameIndexTerminate(&customIndex);
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)},
+		{feature_idx(2)}
+	};
+
+	return cbehave_runner("Name index features are:", features);
+}
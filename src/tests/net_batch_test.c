@@ -0,0 +1,248 @@
+#include <cbehave/cbehave.h>
+
+#include <string.h>
+
+#include <net_batch.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+// Payloads of varying length, with a message type past one varint byte
+#define NUM_MSGS 100
+static uint32_t MsgType(const int index)
+{
+	return (uint32_t)(index * 7) % 200;
+}
+static size_t MsgLen(const int index)
+{
+	return (size_t)(index * 37) % 150;
+}
+static void MsgPayload(uint8_t *buf, const int index)
+{
+	memset(buf, index & 0xFF, MsgLen(index));
+}
+static bool MsgIsOK(
+	const int index, const uint32_t msg, const uint8_t *payload,
+	const size_t len)
+{
+	if (msg != MsgType(index) || len != MsgLen(index))
+	{
+		return false;
+	}
+	for (int i = 0; i < (int)len; i++)
+	{
+		if (payload[i] != (uint8_t)(index & 0xFF))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Batch messages the way the net code does: take the frame when full
+// Returns the number of frames, with their sizes in frameSizes
+static int BatchAll(NetBatch *b, CArray *frames, int *frameSizes)
+{
+	int numFrames = 0;
+	uint8_t buf[256];
+	for (int i = 0; i < NUM_MSGS; i++)
+	{
+		MsgPayload(buf, i);
+		if (!NetBatchHasRoom(b, MsgType(i), MsgLen(i)))
+		{
+			for (int j = 0; j < (int)b->Data.size; j++)
+			{
+				CArrayPushBack(frames, CArrayGet(&b->Data, j));
+			}
+			frameSizes[numFrames++] = (int)b->Data.size;
+			NetBatchClear(b);
+		}
+		NetBatchAdd(b, MsgType(i), buf, MsgLen(i));
+	}
+	for (int j = 0; j < (int)b->Data.size; j++)
+	{
+		CArrayPushBack(frames, CArrayGet(&b->Data, j));
+	}
+	frameSizes[numFrames++] = (int)b->Data.size;
+	NetBatchClear(b);
+	return numFrames;
+}
+
+FEATURE(1, "Message batching")
+	SCENARIO("Batch and read back messages")
+		GIVEN("a batch")
+			NetBatch b;
+			NetBatchInit(&b);
+			CArray frames;
+			CArrayInit(&frames, sizeof(uint8_t));
+			int frameSizes[NUM_MSGS];
+
+		WHEN("I add many messages, taking frames when they are full")
+			const int numFrames = BatchAll(&b, &frames, frameSizes);
+
+		THEN("the messages are spread over frames no bigger than the limit")
+			SHOULD_INT_GT(numFrames, 1);
+			bool sizesOK = true;
+			for (int i = 0; i < numFrames; i++)
+			{
+				sizesOK = sizesOK && frameSizes[i] > 0 &&
+					frameSizes[i] <= NET_BATCH_FRAME_SIZE;
+			}
+			SHOULD_BE_TRUE(sizesOK);
+		THEN("reading the frames gives back the messages in order")
+			int index = 0;
+			bool msgsOK = true;
+			uint8_t *frame = frames.data;
+			for (int i = 0; i < numFrames; i++)
+			{
+				NetBatchReader r = NetBatchReaderNew(frame, frameSizes[i]);
+				uint32_t msg;
+				uint8_t *payload;
+				size_t len;
+				while (NetBatchNext(&r, &msg, &payload, &len))
+				{
+					msgsOK = msgsOK && MsgIsOK(index, msg, payload, len);
+					index++;
+				}
+				msgsOK = msgsOK && r.Cur == r.End;
+				frame += frameSizes[i];
+			}
+			SHOULD_BE_TRUE(msgsOK);
+			SHOULD_INT_EQUAL(index, NUM_MSGS);
+
+		NetBatchTerminate(&b);
+		CArrayTerminate(&frames);
+	SCENARIO_END
+
+	SCENARIO("Oversized message")
+		GIVEN("a batch with a message in it")
+			NetBatch b;
+			NetBatchInit(&b);
+			uint8_t small[8];
+			memset(small, 1, sizeof small);
+			NetBatchAdd(&b, 1, small, sizeof small);
+
+		WHEN("I check for room for a message bigger than a frame")
+			uint8_t big[NET_BATCH_FRAME_SIZE + 100];
+			memset(big, 2, sizeof big);
+			const bool roomWithMsg = NetBatchHasRoom(&b, 2, sizeof big);
+			NetBatchClear(&b);
+			const bool roomEmpty = NetBatchHasRoom(&b, 2, sizeof big);
+
+		THEN("it only fits in an empty frame")
+			SHOULD_BE_TRUE(!roomWithMsg);
+			SHOULD_BE_TRUE(roomEmpty);
+		THEN("it can be read back on its own")
+			NetBatchAdd(&b, 2, big, sizeof big);
+			NetBatchReader r = NetBatchReaderNew(b.Data.data, b.Data.size);
+			uint32_t msg;
+			uint8_t *payload;
+			size_t len;
+			const bool readBig = NetBatchNext(&r, &msg, &payload, &len);
+			SHOULD_BE_TRUE(readBig);
+			SHOULD_INT_EQUAL((int)msg, 2);
+			SHOULD_INT_EQUAL((int)len, (int)sizeof big);
+			const bool readMore = NetBatchNext(&r, &msg, &payload, &len);
+			SHOULD_BE_TRUE(!readMore);
+
+		NetBatchTerminate(&b);
+	SCENARIO_END
+
+	SCENARIO("Truncated frame")
+		GIVEN("a frame of two messages")
+			NetBatch b;
+			NetBatchInit(&b);
+			uint8_t payload3[10];
+			memset(payload3, 3, sizeof payload3);
+			NetBatchAdd(&b, 3, payload3, sizeof payload3);
+			NetBatchAdd(&b, 4, payload3, sizeof payload3);
+
+		WHEN("I read it with the last bytes cut off")
+			NetBatchReader r =
+				NetBatchReaderNew(b.Data.data, b.Data.size - 2);
+			uint32_t msg;
+			uint8_t *payload;
+			size_t len;
+			const bool first = NetBatchNext(&r, &msg, &payload, &len);
+			const bool second = NetBatchNext(&r, &msg, &payload, &len);
+
+		THEN("only the whole message is read, and the reader stops short")
+			SHOULD_BE_TRUE(first);
+			SHOULD_BE_TRUE(!second);
+			SHOULD_BE_TRUE(r.Cur != r.End);
+
+		NetBatchTerminate(&b);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(2, "Latest state per entity")
+	SCENARIO("Newer state replaces older")
+		GIVEN("latest state for two entities")
+			NetLatest l;
+			NetLatestInit(&l);
+			uint8_t payload[4] = { 1, 1, 1, 1 };
+			NetLatestSet(&l, 5, 100, payload, sizeof payload);
+			NetLatestSet(&l, 5, 200, payload, sizeof payload);
+
+		WHEN("I set newer state for the first, and another type for it")
+			payload[0] = 2;
+			NetLatestSet(&l, 5, 100, payload, 2);
+			NetLatestSet(&l, 6, 100, payload, 1);
+
+		THEN("the first is replaced in place, and the other type is added")
+			SHOULD_INT_EQUAL((int)l.Msgs.size, 3);
+			const NetLatestMsg *m = CArrayGet(&l.Msgs, 0);
+			SHOULD_INT_EQUAL((int)m->Msg, 5);
+			SHOULD_INT_EQUAL((int)m->Len, 2);
+			SHOULD_INT_EQUAL((int)m->Data[0], 2);
+			const NetLatestMsg *m2 = CArrayGet(&l.Msgs, 2);
+			SHOULD_INT_EQUAL((int)m2->Msg, 6);
+		THEN("clearing it leaves room for new state")
+			NetLatestClear(&l);
+			NetLatestSet(&l, 5, 100, payload, sizeof payload);
+			SHOULD_INT_EQUAL((int)l.Msgs.size, 1);
+
+		NetLatestTerminate(&l);
+	SCENARIO_END
+
+	SCENARIO("The largest latest message fits")
+		GIVEN("an actor move payload of the largest encoded size")
+			NetLatest l;
+			NetLatestInit(&l);
+			uint8_t payload[NActorMove_size];
+			for (int i = 0; i < (int)sizeof payload; i++)
+			{
+				payload[i] = (uint8_t)i;
+			}
+
+		WHEN("I set it as the latest state")
+			NetLatestSet(&l, 5, 100, payload, sizeof payload);
+
+		THEN("it is kept whole")
+			SHOULD_INT_EQUAL((int)l.Msgs.size, 1);
+			const NetLatestMsg *m = CArrayGet(&l.Msgs, 0);
+			SHOULD_INT_EQUAL((int)m->Len, NActorMove_size);
+			SHOULD_BE_TRUE(memcmp(m->Data, payload, sizeof payload) == 0);
+
+		NetLatestTerminate(&l);
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)},
+		{feature_idx(2)}
+	};
+
+	return cbehave_runner("NetBatch features are:", features);
+}
@@ -0,0 +1,191 @@
+#include <cbehave/cbehave.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <enet/enet.h>
+
+#include <net_batch.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+// A client sends the same per-tick state to a server over a lossy local
+// link, both reliably on one channel and unreliable sequenced on another,
+// the way the game sends events and latest actor state.
+#define CHANNEL_RELIABLE 0
+#define CHANNEL_LATEST 1
+#define LOSS_PERCENT 5
+#define NUM_TICKS 200
+#define TICK_MS 5
+#define DRAIN_MS 5000
+
+// Drop received datagrams at random, deterministically
+static int sLossPercent = 0;
+static unsigned sSeed = 1;
+static int ENET_CALLBACK DropSome(ENetHost *host, ENetEvent *event)
+{
+	UNUSED(host);
+	UNUSED(event);
+	sSeed = sSeed * 1103515245 + 12345;
+	return (int)((sSeed >> 16) % 100) < sLossPercent ? 1 : 0;
+}
+
+typedef struct
+{
+	int Received;
+	int Last;	// last tick received
+	bool InOrder;
+	int TotalAge;	// in ticks, from sending to receiving
+	int MaxAge;
+} ChannelStats;
+static void ChannelStatsInit(ChannelStats *s)
+{
+	memset(s, 0, sizeof *s);
+	s->Last = -1;
+	s->InOrder = true;
+}
+
+static void SendTick(ENetPeer *peer, NetBatch *b, const int tick)
+{
+	const uint32_t t = (uint32_t)tick;
+	NetBatchAdd(b, 1, (const uint8_t *)&t, sizeof t);
+	enet_peer_send(peer, CHANNEL_RELIABLE, enet_packet_create(
+		b->Data.data, b->Data.size, ENET_PACKET_FLAG_RELIABLE));
+	enet_peer_send(peer, CHANNEL_LATEST, enet_packet_create(
+		b->Data.data, b->Data.size, 0));
+	NetBatchClear(b);
+}
+
+static void OnReceive(ENetEvent *event, const int tick, ChannelStats *stats)
+{
+	ChannelStats *s = &stats[event->channelID];
+	NetBatchReader r = NetBatchReaderNew(
+		event->packet->data, event->packet->dataLength);
+	uint32_t msg;
+	uint8_t *payload;
+	size_t len;
+	while (NetBatchNext(&r, &msg, &payload, &len))
+	{
+		uint32_t t;
+		memcpy(&t, payload, sizeof t);
+		s->Received++;
+		s->InOrder = s->InOrder && (int)t > s->Last;
+		s->Last = (int)t;
+		const int age = tick - (int)t;
+		s->TotalAge += age;
+		s->MaxAge = MAX(s->MaxAge, age);
+	}
+	enet_packet_destroy(event->packet);
+}
+
+// Service both hosts until the time is up; returns whether connected
+static bool Service(
+	ENetHost *server, ENetHost *client, const int ms, const int tick,
+	ChannelStats *stats)
+{
+	bool connected = false;
+	const enet_uint32 end = enet_time_get() + ms;
+	do
+	{
+		ENetEvent event;
+		while (enet_host_service(client, &event, 0) > 0)
+		{
+			connected = connected || event.type == ENET_EVENT_TYPE_CONNECT;
+		}
+		while (enet_host_service(server, &event, 1) > 0)
+		{
+			if (event.type == ENET_EVENT_TYPE_RECEIVE)
+			{
+				OnReceive(&event, tick, stats);
+			}
+		}
+	} while ((int)(end - enet_time_get()) > 0);
+	return connected;
+}
+
+FEATURE(1, "Lossy link")
+	SCENARIO("Latest state and reliable messages over a lossy link")
+		GIVEN("a client connected to a server over a lossy local link")
+			SHOULD_INT_EQUAL(enet_initialize(), 0);
+			ENetAddress addr;
+			enet_address_set_host(&addr, "127.0.0.1");
+			addr.port = 0;
+			ENetHost *server = enet_host_create(&addr, 1, 2, 0, 0);
+			SHOULD_BE_TRUE(server != NULL);
+			ENetHost *client = enet_host_create(NULL, 1, 2, 0, 0);
+			SHOULD_BE_TRUE(client != NULL);
+			addr.port = server->address.port;
+			ENetPeer *peer = enet_host_connect(client, &addr, 2, 0);
+			ChannelStats stats[2];
+			ChannelStatsInit(&stats[CHANNEL_RELIABLE]);
+			ChannelStatsInit(&stats[CHANNEL_LATEST]);
+			const bool connected = Service(server, client, 1000, 0, stats);
+			SHOULD_BE_TRUE(connected);
+			server->intercept = DropSome;
+			client->intercept = DropSome;
+			sLossPercent = LOSS_PERCENT;
+
+		WHEN("the client sends state every tick")
+			NetBatch b;
+			NetBatchInit(&b);
+			int tick;
+			for (tick = 0; tick < NUM_TICKS; tick++)
+			{
+				SendTick(peer, &b, tick);
+				Service(server, client, TICK_MS, tick, stats);
+			}
+			// Let the reliable channel catch up
+			const enet_uint32 drainEnd = enet_time_get() + DRAIN_MS;
+			while (stats[CHANNEL_RELIABLE].Received < NUM_TICKS &&
+				(int)(drainEnd - enet_time_get()) > 0)
+			{
+				Service(server, client, TICK_MS, tick, stats);
+				tick++;
+			}
+			const ChannelStats *rel = &stats[CHANNEL_RELIABLE];
+			const ChannelStats *lat = &stats[CHANNEL_LATEST];
+			printf(
+				"%d%% loss over %d ticks:\n"
+				"  reliable: %d received, mean age %.2f ticks, max %d\n"
+				"  latest:   %d received, mean age %.2f ticks, max %d\n",
+				LOSS_PERCENT, NUM_TICKS,
+				rel->Received, (double)rel->TotalAge / MAX(rel->Received, 1),
+				rel->MaxAge,
+				lat->Received, (double)lat->TotalAge / MAX(lat->Received, 1),
+				lat->MaxAge);
+
+		THEN("every reliable message arrives, in order")
+			SHOULD_INT_EQUAL(rel->Received, NUM_TICKS);
+			SHOULD_BE_TRUE(rel->InOrder);
+		THEN("latest state never goes backwards, and mostly arrives")
+			SHOULD_BE_TRUE(lat->InOrder);
+			SHOULD_INT_GE(lat->Received, NUM_TICKS * 8 / 10);
+		THEN("latest state is never held up behind a lost packet")
+			SHOULD_INT_LE(lat->MaxAge, rel->MaxAge);
+
+		NetBatchTerminate(&b);
+		enet_peer_disconnect_now(peer, 0);
+		enet_host_destroy(client);
+		enet_host_destroy(server);
+		enet_deinitialize();
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("Lossy link features are:", features);
+}
@@ -0,0 +1,319 @@
+#include <cbehave/cbehave.h>
+
+#include <string.h>
+
+#include <net_snapshot.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+// A world of actors and objects with fields set from their UIDs
+static void MakeWorld(NetSnapshot *s, const uint32_t seq, const int n)
+{
+	NetSnapshotClear(s);
+	s->Seq = seq;
+	// Add out of order, to be sorted
+	for (int i = n - 1; i >= 0; i--)
+	{
+		NetSnapshotEntity *e =
+			NetSnapshotAdd(s, NET_SNAPSHOT_OBJECT, (uint32_t)i);
+		e->Fields[0] = i * 100;
+		e->Fields[1] = -i;
+		e = NetSnapshotAdd(s, NET_SNAPSHOT_ACTOR, (uint32_t)i * 3);
+		e->Fields[0] = i * 1000;
+		e->Fields[NET_SNAPSHOT_FIELDS - 1] = 7;
+	}
+	NetSnapshotSort(s);
+}
+static bool SnapshotsEqual(const NetSnapshot *a, const NetSnapshot *b)
+{
+	if (a->Seq != b->Seq || a->Entities.size != b->Entities.size)
+	{
+		return false;
+	}
+	for (int i = 0; i < (int)a->Entities.size; i++)
+	{
+		const NetSnapshotEntity *ea = CArrayGet(&a->Entities, i);
+		const NetSnapshotEntity *eb = CArrayGet(&b->Entities, i);
+		if (ea->Kind != eb->Kind || ea->UID != eb->UID ||
+			memcmp(ea->Fields, eb->Fields, sizeof ea->Fields) != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Leave out actors further than maxX, as the server does for actors out of
+// a client's view
+static void FilterActors(
+	NetSnapshot *dst, const NetSnapshot *world, const int32_t maxX)
+{
+	NetSnapshotClear(dst);
+	dst->Seq = world->Seq;
+	CA_FOREACH(const NetSnapshotEntity, e, world->Entities)
+		if (e->Kind == NET_SNAPSHOT_ACTOR && e->Fields[0] > maxX) continue;
+		CArrayPushBack(&dst->Entities, e);
+	CA_FOREACH_END()
+}
+// Send a client its filtered world as a delta against base
+static bool SendFiltered(
+	NetSnapshot *d, const NetSnapshot *world, const NetSnapshot *base,
+	const int32_t maxX)
+{
+	NetSnapshot s;
+	NetSnapshotInit(&s);
+	FilterActors(&s, world, maxX);
+	CArray buf;
+	CArrayInit(&buf, sizeof(uint8_t));
+	NetSnapshotEncode(&buf, &s, base, 0);
+	const bool ok = NetSnapshotDecode(d, base, buf.data, buf.size);
+	CArrayTerminate(&buf);
+	NetSnapshotTerminate(&s);
+	return ok;
+}
+static void MoveActor(NetSnapshot *s, const uint32_t uid, const int32_t x)
+{
+	CA_FOREACH(NetSnapshotEntity, e, s->Entities)
+		if (e->Kind == NET_SNAPSHOT_ACTOR && e->UID == uid)
+		{
+			e->Fields[0] = x;
+		}
+	CA_FOREACH_END()
+}
+
+FEATURE(1, "Snapshot deltas")
+	SCENARIO("Round trip against the empty baseline")
+		GIVEN("a snapshot of a world")
+			NetSnapshot s;
+			NetSnapshotInit(&s);
+			MakeWorld(&s, 1, 20);
+			CArray buf;
+			CArrayInit(&buf, sizeof(uint8_t));
+			NetSnapshot d;
+			NetSnapshotInit(&d);
+
+		WHEN("I encode it against the empty baseline and decode it")
+			NetSnapshotEncode(&buf, &s, NULL, NET_SNAPSHOT_JOIN);
+			uint32_t seq, baseSeq, flags;
+			const bool headerOK = NetSnapshotReadHeader(
+				buf.data, buf.size, &seq, &baseSeq, &flags);
+			const bool decoded =
+				NetSnapshotDecode(&d, NULL, buf.data, buf.size);
+
+		THEN("the header and the snapshot come back as they were")
+			SHOULD_BE_TRUE(headerOK);
+			SHOULD_INT_EQUAL((int)seq, 1);
+			SHOULD_INT_EQUAL((int)baseSeq, 0);
+			SHOULD_INT_EQUAL((int)flags, NET_SNAPSHOT_JOIN);
+			SHOULD_BE_TRUE(decoded);
+			SHOULD_BE_TRUE(SnapshotsEqual(&s, &d));
+		THEN("entities can be found by kind and UID")
+			const NetSnapshotEntity *e =
+				NetSnapshotFind(&d, NET_SNAPSHOT_ACTOR, 9);
+			SHOULD_BE_TRUE(e != NULL);
+			SHOULD_INT_EQUAL((int)e->Fields[0], 3000);
+			const NetSnapshotEntity *missing =
+				NetSnapshotFind(&d, NET_SNAPSHOT_ACTOR, 10);
+			SHOULD_BE_TRUE(missing == NULL);
+
+		NetSnapshotTerminate(&s);
+		NetSnapshotTerminate(&d);
+		CArrayTerminate(&buf);
+	SCENARIO_END
+
+	SCENARIO("Deltas against a baseline")
+		GIVEN("a baseline, and a world with changes, adds and removes")
+			NetSnapshot base;
+			NetSnapshotInit(&base);
+			MakeWorld(&base, 4, 20);
+			NetSnapshot s;
+			NetSnapshotInit(&s);
+			MakeWorld(&s, 5, 25);
+			// Remove one of each kind
+			CArrayDelete(&s.Entities, 0);
+			CArrayDelete(&s.Entities, (int)s.Entities.size - 1);
+			CA_FOREACH(NetSnapshotEntity, e, s.Entities)
+				if (e->Kind == NET_SNAPSHOT_OBJECT && e->UID == 3)
+				{
+					e->Fields[1] = 123456;
+				}
+			CA_FOREACH_END()
+			CArray full, delta, empty;
+			CArrayInit(&full, sizeof(uint8_t));
+			CArrayInit(&delta, sizeof(uint8_t));
+			CArrayInit(&empty, sizeof(uint8_t));
+			NetSnapshot d;
+			NetSnapshotInit(&d);
+
+		WHEN("I encode it against the baseline and decode it")
+			NetSnapshotEncode(&full, &s, NULL, 0);
+			NetSnapshotEncode(&delta, &s, &base, 0);
+			const bool decoded =
+				NetSnapshotDecode(&d, &base, delta.data, delta.size);
+
+		THEN("the snapshot comes back as it was, from a smaller delta")
+			SHOULD_BE_TRUE(decoded);
+			SHOULD_BE_TRUE(SnapshotsEqual(&s, &d));
+			SHOULD_INT_GT((int)full.size, (int)delta.size);
+		THEN("an unchanged world encodes as just the header")
+			NetSnapshotCopy(&base, &s);
+			s.Seq = 6;
+			NetSnapshotEncode(&empty, &s, &base, 0);
+			SHOULD_INT_EQUAL((int)empty.size, 3);
+
+		NetSnapshotTerminate(&base);
+		NetSnapshotTerminate(&s);
+		NetSnapshotTerminate(&d);
+		CArrayTerminate(&full);
+		CArrayTerminate(&delta);
+		CArrayTerminate(&empty);
+	SCENARIO_END
+
+	SCENARIO("Bad deltas")
+		GIVEN("a delta against a baseline")
+			NetSnapshot base;
+			NetSnapshotInit(&base);
+			MakeWorld(&base, 1, 10);
+			NetSnapshot other;
+			NetSnapshotInit(&other);
+			MakeWorld(&other, 2, 10);
+			NetSnapshot s;
+			NetSnapshotInit(&s);
+			MakeWorld(&s, 3, 12);
+			CArray buf;
+			CArrayInit(&buf, sizeof(uint8_t));
+			NetSnapshotEncode(&buf, &s, &base, 0);
+			NetSnapshot d;
+			NetSnapshotInit(&d);
+
+		WHEN("I decode it against the wrong baseline, or cut short")
+			const bool wrongBase =
+				NetSnapshotDecode(&d, &other, buf.data, buf.size);
+			const bool noBase = NetSnapshotDecode(&d, NULL, buf.data, buf.size);
+			const bool truncated =
+				NetSnapshotDecode(&d, &base, buf.data, buf.size - 1);
+
+		THEN("it is rejected")
+			SHOULD_BE_TRUE(!wrongBase);
+			SHOULD_BE_TRUE(!noBase);
+			SHOULD_BE_TRUE(!truncated);
+
+		NetSnapshotTerminate(&base);
+		NetSnapshotTerminate(&other);
+		NetSnapshotTerminate(&s);
+		NetSnapshotTerminate(&d);
+		CArrayTerminate(&buf);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(2, "Snapshot history")
+	SCENARIO("Keep recent snapshots")
+		GIVEN("a history")
+			NetSnapshotHistory h;
+			NetSnapshotHistoryInit(&h);
+			NetSnapshot s;
+			NetSnapshotInit(&s);
+
+		WHEN("I add more snapshots than it keeps")
+			const int n = NET_SNAPSHOT_HISTORY + 4;
+			for (int i = 1; i <= n; i++)
+			{
+				MakeWorld(&s, (uint32_t)i, i);
+				NetSnapshotHistoryAdd(&h, &s);
+			}
+
+		THEN("the recent ones are kept, and the oldest are gone")
+			const NetSnapshot *latest = NetSnapshotHistoryGet(&h, (uint32_t)n);
+			SHOULD_BE_TRUE(latest != NULL);
+			SHOULD_INT_EQUAL((int)latest->Entities.size, n * 2);
+			const NetSnapshot *oldest = NetSnapshotHistoryGet(
+				&h, (uint32_t)(n - NET_SNAPSHOT_HISTORY + 1));
+			SHOULD_BE_TRUE(oldest != NULL);
+			const NetSnapshot *gone = NetSnapshotHistoryGet(&h, 4);
+			SHOULD_BE_TRUE(gone == NULL);
+			const NetSnapshot *empty = NetSnapshotHistoryGet(&h, 0);
+			SHOULD_BE_TRUE(empty == NULL);
+		THEN("clearing it forgets them all")
+			NetSnapshotHistoryClear(&h);
+			const NetSnapshot *cleared = NetSnapshotHistoryGet(&h, (uint32_t)n);
+			SHOULD_BE_TRUE(cleared == NULL);
+
+		NetSnapshotHistoryTerminate(&h);
+		NetSnapshotTerminate(&s);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(3, "Actors leaving a client's view")
+	SCENARIO("Leave and re-enter the view")
+		GIVEN("a client that has a snapshot with an actor in view")
+			NetSnapshot world;
+			NetSnapshotInit(&world);
+			MakeWorld(&world, 1, 10);
+			const int32_t maxX = 5000;
+			NetSnapshot first, left, back;
+			NetSnapshotInit(&first);
+			NetSnapshotInit(&left);
+			NetSnapshotInit(&back);
+			const bool firstOK = SendFiltered(&first, &world, NULL, maxX);
+			CArray removed;
+			CArrayInit(&removed, sizeof(NetSnapshotEntity));
+
+		WHEN("the actor moves out of view")
+			MoveActor(&world, 3, maxX + 1000);
+			world.Seq = 2;
+			const bool leftOK = SendFiltered(&left, &world, &first, maxX);
+			NetSnapshotGetRemoved(&removed, &left, &first, NET_SNAPSHOT_ACTOR);
+
+		THEN("it is removed, and the client knows where it was last seen")
+			SHOULD_BE_TRUE(firstOK);
+			SHOULD_BE_TRUE(leftOK);
+			SHOULD_BE_TRUE(
+				NetSnapshotFind(&left, NET_SNAPSHOT_ACTOR, 3) == NULL);
+			SHOULD_INT_EQUAL((int)removed.size, 1);
+			const NetSnapshotEntity *r = CArrayGet(&removed, 0);
+			SHOULD_INT_EQUAL((int)r->UID, 3);
+			SHOULD_INT_EQUAL(r->Fields[0], 1000);
+
+		WHEN("it comes back into view")
+			MoveActor(&world, 3, 2000);
+			world.Seq = 3;
+			const bool backOK = SendFiltered(&back, &world, &left, maxX);
+			NetSnapshotGetRemoved(&removed, &back, &left, NET_SNAPSHOT_ACTOR);
+
+		THEN("it is added again with its full state, and nothing is removed")
+			SHOULD_BE_TRUE(backOK);
+			const NetSnapshotEntity *e =
+				NetSnapshotFind(&back, NET_SNAPSHOT_ACTOR, 3);
+			SHOULD_BE_TRUE(e != NULL);
+			SHOULD_INT_EQUAL(e->Fields[0], 2000);
+			SHOULD_INT_EQUAL(e->Fields[NET_SNAPSHOT_FIELDS - 1], 7);
+			SHOULD_INT_EQUAL((int)removed.size, 0);
+
+		NetSnapshotTerminate(&world);
+		NetSnapshotTerminate(&first);
+		NetSnapshotTerminate(&left);
+		NetSnapshotTerminate(&back);
+		CArrayTerminate(&removed);
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)},
+		{feature_idx(2)},
+		{feature_idx(3)}
+	};
+
+	return cbehave_runner("NetSnapshot features are:", features);
+}
@@ -0,0 +1,222 @@
+#include <cbehave/cbehave.h>
+
+#include <string.h>
+
+#include <ai_utils.h>
+#include <path_cache.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+#define MAP_W 64
+#define MAP_H 64
+static bool sWalls[MAP_H][MAP_W];
+static Tile sTiles[MAP_H][MAP_W];
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+Tile *MapGetTile(Map *map, Vec2i pos)
+{
+	UNUSED(map);
+	if (pos.x < 0 || pos.x >= MAP_W || pos.y < 0 || pos.y >= MAP_H)
+	{
+		return NULL;
+	}
+	return &sTiles[pos.y][pos.x];
+}
+int MapGetDoorKeycardFlag(Map *map, Vec2i pos)
+{
+	UNUSED(map);
+	UNUSED(pos);
+	return 0;
+}
+bool IsTileWalkable(Map *map, const Vec2i pos)
+{
+	return MapGetTile(map, pos) != NULL && !sWalls[pos.y][pos.x];
+}
+bool IsTileWalkableAroundObjects(Map *map, const Vec2i pos)
+{
+	return IsTileWalkable(map, pos);
+}
+
+static void Setup(Map *map, PathCache *pc)
+{
+	memset(sWalls, 0, sizeof sWalls);
+	memset(sTiles, 0, sizeof sTiles);
+	memset(map, 0, sizeof *map);
+	map->Size = Vec2iNew(MAP_W, MAP_H);
+	PathCacheInit(pc, map);
+}
+static int Find(PathCache *pc, const Vec2i from, const Vec2i to)
+{
+	CachedPath p = PathCacheCreate(pc, from, to, true, true);
+	const int count = (int)CachedPathGetCount(&p);
+	CachedPathDestroy(&p);
+	return count;
+}
+
+
+FEATURE(1, "Path cache lookups")
+	SCENARIO("Exact match")
+	{
+		Map map;
+		PathCache pc;
+		CachedPath p1, p2;
+		GIVEN("a cache with a path")
+			Setup(&map, &pc);
+			p1 = PathCacheCreate(
+				&pc, Vec2iNew(1, 1), Vec2iNew(10, 5), true, true);
+		GIVEN_END
+
+		WHEN("I find the same path");
+			p2 = PathCacheCreate(
+				&pc, Vec2iNew(1, 1), Vec2iNew(10, 5), true, true);
+		WHEN_END
+
+		THEN("the cached path should be returned");
+			SHOULD_INT_EQUAL(pc.Hits, 1);
+			SHOULD_INT_EQUAL(pc.Misses, 1);
+			SHOULD_BE_TRUE(p1.Path == p2.Path);
+		THEN_END
+
+		CachedPathDestroy(&p1);
+		CachedPathDestroy(&p2);
+		PathCacheTerminate(&pc);
+	}
+	SCENARIO_END
+
+	SCENARIO("Reuse the end of a path")
+	{
+		Map map;
+		PathCache pc;
+		CachedPath p;
+		Vec2i mid;
+		GIVEN("a cache with a path")
+			Setup(&map, &pc);
+			p = PathCacheCreate(
+				&pc, Vec2iNew(1, 1), Vec2iNew(20, 5), true, true);
+			mid = *CachedPathGetNode(&p, 4);
+			CachedPathDestroy(&p);
+		GIVEN_END
+
+		WHEN("I find a path from a tile along it to the same destination");
+			p = PathCacheCreate(&pc, mid, Vec2iNew(20, 5), true, true);
+		WHEN_END
+
+		THEN("the end of the cached path should be returned");
+			SHOULD_INT_EQUAL(pc.PartialHits, 1);
+			SHOULD_INT_EQUAL(pc.Misses, 1);
+			SHOULD_BE_TRUE(Vec2iEqual(*CachedPathGetNode(&p, 0), mid));
+			SHOULD_BE_TRUE(Vec2iEqual(
+				*CachedPathGetNode(&p, CachedPathGetCount(&p) - 1),
+				Vec2iNew(20, 5)));
+		THEN_END
+
+		CachedPathDestroy(&p);
+		PathCacheTerminate(&pc);
+	}
+	SCENARIO_END
+
+	SCENARIO("Evict the least recently used path")
+	{
+		Map map;
+		PathCache pc;
+		GIVEN("a full cache of paths to different destinations")
+			Setup(&map, &pc);
+			for (int i = 0; i < 128; i++)
+			{
+				Find(&pc, Vec2iNew(1, 1), Vec2iNew(20 + i % 32, 20 + i / 32));
+			}
+		GIVEN_END
+
+		WHEN("I use the oldest path, then add a new path");
+			Find(&pc, Vec2iNew(1, 1), Vec2iNew(20, 20));
+			Find(&pc, Vec2iNew(1, 1), Vec2iNew(60, 60));
+		WHEN_END
+
+		THEN("the recently used path should still be cached");
+			pc.Hits = pc.Misses = 0;
+			Find(&pc, Vec2iNew(1, 1), Vec2iNew(20, 20));
+			SHOULD_INT_EQUAL(pc.Hits, 1);
+		THEN_END
+
+		THEN("the second oldest path should have been evicted");
+			pc.Hits = pc.Misses = 0;
+			Find(&pc, Vec2iNew(1, 1), Vec2iNew(21, 20));
+			SHOULD_INT_EQUAL(pc.Misses, 1);
+		THEN_END
+
+		PathCacheTerminate(&pc);
+	}
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(2, "Path cache invalidation")
+	SCENARIO("Invalidate a tile")
+	{
+		Map map;
+		PathCache pc;
+		GIVEN("a cache with two paths in different areas")
+			Setup(&map, &pc);
+			Find(&pc, Vec2iNew(1, 1), Vec2iNew(10, 1));
+			Find(&pc, Vec2iNew(1, 50), Vec2iNew(10, 50));
+		GIVEN_END
+
+		WHEN("a tile on one of the paths changes");
+			PathCacheInvalidateTile(&pc, Vec2iNew(5, 1));
+		WHEN_END
+
+		THEN("only that path should be recalculated");
+			pc.Hits = pc.Misses = 0;
+			Find(&pc, Vec2iNew(1, 1), Vec2iNew(10, 1));
+			Find(&pc, Vec2iNew(1, 50), Vec2iNew(10, 50));
+			SHOULD_INT_EQUAL(pc.Misses, 1);
+			SHOULD_INT_EQUAL(pc.Hits, 1);
+		THEN_END
+
+		PathCacheTerminate(&pc);
+	}
+	SCENARIO_END
+
+	SCENARIO("Retry failed paths")
+	{
+		Map map;
+		PathCache pc;
+		GIVEN("a cache with a path blocked by a wall")
+			Setup(&map, &pc);
+			for (int y = 0; y < MAP_H; y++)
+			{
+				sWalls[y][20] = true;
+			}
+			Find(&pc, Vec2iNew(1, 1), Vec2iNew(30, 1));
+		GIVEN_END
+
+		WHEN("a hole in the wall opens far away");
+			sWalls[60][20] = false;
+			PathCacheInvalidateTile(&pc, Vec2iNew(20, 60));
+		WHEN_END
+
+		THEN("the path should be found");
+			SHOULD_INT_GT(Find(&pc, Vec2iNew(1, 1), Vec2iNew(30, 1)), 1);
+		THEN_END
+
+		PathCacheTerminate(&pc);
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)},
+		{feature_idx(2)}
+	};
+
+	return cbehave_runner("Path cache features are:", features);
+}
@@ -0,0 +1,280 @@
+#include <cbehave/cbehave.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <pic_spans.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+#define A_MASK 0xFF000000u
+
+// A sprite like a character or bullet: an opaque blob, a few pixels
+// with colour but no alpha, and transparency around it
+static void MakeSprite(Uint32 *data, const Vec2i size)
+{
+	const Vec2i centre = Vec2iScaleDiv(size, 2);
+	const int r2 = size.x * size.x / 9;
+	for (int y = 0; y < size.y; y++)
+	{
+		for (int x = 0; x < size.x; x++)
+		{
+			const int dx = x - centre.x;
+			const int dy = y - centre.y;
+			Uint32 *p = data + y * size.x + x;
+			if (dx * dx + dy * dy > r2)
+			{
+				*p = 0;
+			}
+			else if ((x + y) % 7 == 0)
+			{
+				*p = (Uint32)rand() & ~A_MASK;
+			}
+			else
+			{
+				*p = A_MASK | (Uint32)rand();
+			}
+		}
+	}
+}
+
+// Blit the clipped picture span by span, as the blitters did
+static void BlitRows(
+	const Uint32 *data, const int pitch, Uint32 *dst, const int dstPitch,
+	const BlitSpanRect *r, const int blitter)
+{
+	for (int i = 0; i < r->Size.y; i++)
+	{
+		Uint32 *d = dst + (r->Dst.y + i) * dstPitch + r->Dst.x;
+		const Uint32 *s = data + (r->Src.y + i) * pitch + r->Src.x;
+		switch (blitter)
+		{
+		case 0: gBlitSpan.Copy(d, s, r->Size.x, A_MASK); break;
+		case 1: gBlitSpan.Masked(d, s, r->Size.x, 0x80FF8040, true); break;
+		default:
+			gBlitSpan.Blend(d, s, r->Size.x, 0xFF80C0FF, 128, A_MASK);
+			break;
+		}
+	}
+}
+static void BlitRuns(
+	const PicSpans *s, const Uint32 *data, const int pitch,
+	Uint32 *dst, const int dstPitch, const BlitSpanRect *r, const int blitter)
+{
+	switch (blitter)
+	{
+	case 0: PicSpansBlit(s, data, pitch, dst, dstPitch, r); break;
+	case 1:
+		PicSpansBlitMasked(s, data, pitch, dst, dstPitch, r, 0x80FF8040);
+		break;
+	default:
+		PicSpansBlitBlend(s, data, pitch, dst, dstPitch, r, 0xFF80C0FF, 128);
+		break;
+	}
+}
+
+#define SCREEN_W 96
+#define SCREEN_H 64
+static bool IsSameAsRows(const int blitter)
+{
+	Uint32 screen1[SCREEN_W * SCREEN_H];
+	Uint32 screen2[SCREEN_W * SCREEN_H];
+	for (int i = 0; i < 500; i++)
+	{
+		const Vec2i size = Vec2iNew(1 + rand() % 40, 1 + rand() % 40);
+		Uint32 *data;
+		CMALLOC(data, size.x * size.y * sizeof *data);
+		MakeSprite(data, size);
+		PicSpans *s = PicSpansNew(data, size, A_MASK);
+		for (int j = 0; j < SCREEN_W * SCREEN_H; j++)
+		{
+			screen1[j] = screen2[j] = (Uint32)rand();
+		}
+		// Place it so it is often partly off screen
+		const Vec2i pos = Vec2iNew(
+			rand() % (SCREEN_W + size.x) - size.x,
+			rand() % (SCREEN_H + size.y) - size.y);
+		BlitSpanRect r;
+		if (BlitSpanClip(&r, size, pos, 0, 0, SCREEN_W - 1, SCREEN_H - 1))
+		{
+			BlitRows(data, size.x, screen1, SCREEN_W, &r, blitter);
+			BlitRuns(s, data, size.x, screen2, SCREEN_W, &r, blitter);
+		}
+		PicSpansFree(s);
+		CFREE(data);
+		if (memcmp(screen1, screen2, sizeof screen1) != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Megapixels per second of sprites over a screen, using runs or not
+#define BENCH_W 320
+#define BENCH_H 240
+#define BENCH_SPRITE 16
+static double Bench(
+	const PicSpans *s, const Uint32 *data, const int blitter)
+{
+	static Uint32 screen[BENCH_W * BENCH_H];
+	const int reps = 40;
+	const clock_t t = clock();
+	for (int i = 0; i < reps; i++)
+	{
+		// Overlapping sprites, like a crowd of actors and their bullets
+		for (int y = -4; y < BENCH_H; y += BENCH_SPRITE / 2)
+		{
+			for (int x = -4; x < BENCH_W; x += BENCH_SPRITE / 2)
+			{
+				BlitSpanRect r;
+				if (!BlitSpanClip(
+					&r, Vec2iNew(BENCH_SPRITE, BENCH_SPRITE), Vec2iNew(x, y),
+					0, 0, BENCH_W - 1, BENCH_H - 1))
+				{
+					continue;
+				}
+				if (s != NULL)
+				{
+					BlitRuns(
+						s, data, BENCH_SPRITE, screen, BENCH_W, &r, blitter);
+				}
+				else
+				{
+					BlitRows(data, BENCH_SPRITE, screen, BENCH_W, &r, blitter);
+				}
+			}
+		}
+	}
+	const double seconds = (double)(clock() - t) / CLOCKS_PER_SEC;
+	const double pixels = (double)reps *
+		(BENCH_W / (BENCH_SPRITE / 2)) * (BENCH_H / (BENCH_SPRITE / 2)) *
+		BENCH_SPRITE * BENCH_SPRITE;
+	return seconds > 0 ? pixels / seconds / 1e6 : 0;
+}
+
+
+FEATURE(1, "Pic spans")
+	SCENARIO("Runs of a row")
+	{
+		const Uint32 row[] =
+		{
+			0, A_MASK | 1, A_MASK | 2, 0x00123456, A_MASK, 0, 0, 5
+		};
+		PicSpans *s;
+		GIVEN("a row with transparent, opaque and alpha-less pixels")
+		GIVEN_END
+
+		WHEN("I make its runs");
+			s = PicSpansNew(row, Vec2iNew(8, 1), A_MASK);
+		WHEN_END
+
+		THEN("the runs should cover the non-zero pixels, split by alpha");
+			SHOULD_INT_EQUAL(s->Rows[0], 0);
+			SHOULD_INT_EQUAL(s->Rows[1], 4);
+			SHOULD_INT_EQUAL(s->Runs[0].Start, 1);
+			SHOULD_INT_EQUAL(s->Runs[0].Length, 2);
+			SHOULD_BE_TRUE(s->Runs[0].IsOpaque);
+			SHOULD_INT_EQUAL(s->Runs[1].Start, 3);
+			SHOULD_INT_EQUAL(s->Runs[1].Length, 1);
+			SHOULD_BE_TRUE(!s->Runs[1].IsOpaque);
+			SHOULD_INT_EQUAL(s->Runs[2].Start, 4);
+			SHOULD_INT_EQUAL(s->Runs[2].Length, 1);
+			SHOULD_BE_TRUE(s->Runs[2].IsOpaque);
+			SHOULD_INT_EQUAL(s->Runs[3].Start, 7);
+			SHOULD_INT_EQUAL(s->Runs[3].Length, 1);
+			SHOULD_BE_TRUE(!s->Runs[3].IsOpaque);
+		THEN_END
+
+		THEN("they should only be used with the same alpha mask");
+			SHOULD_BE_TRUE(PicSpansCanBlit(s, A_MASK));
+			SHOULD_BE_TRUE(!PicSpansCanBlit(s, 0x000000FF));
+			SHOULD_BE_TRUE(!PicSpansCanBlit(NULL, A_MASK));
+		THEN_END
+
+		THEN("a copy should have the same runs");
+			PicSpans *c = PicSpansCopy(s);
+			SHOULD_INT_EQUAL(PicSpansMemSize(c), PicSpansMemSize(s));
+			SHOULD_BE_TRUE(memcmp(
+				c->Runs, s->Runs, s->Rows[1] * sizeof *s->Runs) == 0);
+			PicSpansFree(c);
+			PicSpansFree(s);
+		THEN_END
+	}
+	SCENARIO_END
+
+	SCENARIO("Same pixels as the span blitters")
+	{
+		bool same[3];
+		GIVEN("random sprites, some partly off screen")
+			srand(1);
+		GIVEN_END
+
+		WHEN("I blit them using their runs");
+			for (int i = 0; i < 3; i++)
+			{
+				same[i] = IsSameAsRows(i);
+			}
+		WHEN_END
+
+		THEN("the pixels should match blitting every row");
+			SHOULD_BE_TRUE(same[0]);
+			SHOULD_BE_TRUE(same[1]);
+			SHOULD_BE_TRUE(same[2]);
+		THEN_END
+	}
+	SCENARIO_END
+
+	SCENARIO("Memory and speed")
+	{
+		Uint32 data[BENCH_SPRITE * BENCH_SPRITE];
+		PicSpans *s;
+		double rows[3], runs[3];
+		GIVEN("a mostly transparent sprite")
+			srand(1);
+			MakeSprite(data, Vec2iNew(BENCH_SPRITE, BENCH_SPRITE));
+			s = PicSpansNew(
+				data, Vec2iNew(BENCH_SPRITE, BENCH_SPRITE), A_MASK);
+		GIVEN_END
+
+		WHEN("I fill a screen with it");
+			for (int i = 0; i < 3; i++)
+			{
+				rows[i] = Bench(NULL, data, i);
+				runs[i] = Bench(s, data, i);
+			}
+			printf("\t\tspans: %d bytes for %d bytes of pixels\n",
+				(int)PicSpansMemSize(s), (int)sizeof data);
+			printf("\t\trows: copy %.0f, masked %.0f, blend %.0f Mpx/s\n",
+				rows[0], rows[1], rows[2]);
+			printf("\t\truns: copy %.0f, masked %.0f, blend %.0f Mpx/s\n",
+				runs[0], runs[1], runs[2]);
+		WHEN_END
+
+		THEN("the runs should be smaller than the pixels");
+			SHOULD_INT_LE((int)PicSpansMemSize(s), (int)sizeof data);
+			PicSpansFree(s);
+		THEN_END
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("Pic spans features are:", features);
+}
@@ -50,9 +50,14 @@ bool ConfigIsOld(FILE *f)
 	UNUSED(f);
 	return false;
 }
-void hqxInit(void)
+void HqxPoolInit(HqxPool *p, const int numWorkers)
 {
-	return;
+	UNUSED(p);
+	UNUSED(numWorkers);
+}
+void HqxPoolTerminate(HqxPool *p)
+{
+	UNUSED(p);
 }
 
 
@@ -0,0 +1,249 @@
+#include <cbehave/cbehave.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <present.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+#define W 320
+#define H 240
+#define BRIGHTNESS 5
+
+// Brightness as it was applied, to the whole frame with a separate pass
+static void RefBrightness(Uint32 *screen, const int brightness)
+{
+	double f = pow(1.07177346254, brightness);
+	int m = (int)(0xFF * f);
+	for (int idx = 0; idx < W * H; idx++)
+	{
+		Uint32 p = screen[idx];
+		Uint32 pp;
+		screen[idx] = 0;
+		pp = ((p & 0xFF) * m / 0xFF);
+		screen[idx] |= (pp | -!!(pp >> 8)) & 0xFF;
+		pp = (((p >> 8) & 0xFF) * m / 0xFF);
+		screen[idx] |= ((pp | -!!(pp >> 8)) & 0xFF) << 8;
+		pp = (((p >> 16) & 0xFF) * m / 0xFF);
+		screen[idx] |= ((pp | -!!(pp >> 8)) & 0xFF) << 16;
+		pp = (((p >> 24) & 0xFF) * m / 0xFF);
+		screen[idx] |= ((pp | -!!(pp >> 8)) & 0xFF) << 24;
+	}
+}
+static Uint16 Ref565(const Uint32 p)
+{
+	return (Uint16)(
+		(((p >> 16) & 0xFF) >> 3) << 11 |
+		(((p >> 8) & 0xFF) >> 2) << 5 |
+		((p & 0xFF) >> 3));
+}
+static SDL_PixelFormat Format565(void)
+{
+	SDL_PixelFormat f;
+	memset(&f, 0, sizeof f);
+	f.BitsPerPixel = 16;
+	f.BytesPerPixel = 2;
+	f.Rloss = 3;
+	f.Gloss = 2;
+	f.Bloss = 3;
+	f.Rshift = 11;
+	f.Gshift = 5;
+	f.Bshift = 0;
+	f.Rmask = 0xF800;
+	f.Gmask = 0x07E0;
+	f.Bmask = 0x001F;
+	return f;
+}
+
+static Uint32 sFrame[W * H];
+static Uint32 sBright[W * H];
+static Uint32 sPresent[W * H];
+static Uint32 sOut1[W * H * 16];
+static Uint32 sOut2[W * H * 16];
+static Uint16 sOut16a[W * H];
+static Uint16 sOut16b[W * H];
+static const Rect2i sAll = { { 0, 0 }, { W, H } };
+
+// Present a frame the old way, brightness then scaling, or fused
+typedef enum
+{
+	KERNEL_COPY,
+	KERNEL_16,
+	KERNEL_SCALE2,
+	KERNEL_BILINEAR2,
+	KERNEL_COUNT
+} Kernel;
+static const char *KernelStr(const Kernel k)
+{
+	switch (k)
+	{
+		T2S(KERNEL_COPY, "copy");
+		T2S(KERNEL_16, "16-bit");
+		T2S(KERNEL_SCALE2, "scale 2x");
+		T2S(KERNEL_BILINEAR2, "bilinear 2x");
+	default: return "";
+	}
+}
+static void PresentTwoPass(const Kernel k, const Present16LUT *identity16)
+{
+	memcpy(sBright, sFrame, sizeof sBright);
+	RefBrightness(sBright, BRIGHTNESS);
+	switch (k)
+	{
+	case KERNEL_COPY: PresentCopy(sOut1, sBright, W, sAll, NULL); break;
+	case KERNEL_16: PresentTo16(sOut16a, sBright, W, sAll, identity16); break;
+	case KERNEL_SCALE2: PresentScale(sOut1, sBright, W, sAll, 2, NULL); break;
+	default: PresentBilinear(sOut1, sBright, W, H, sAll, 2); break;
+	}
+}
+static void PresentFused(
+	const Kernel k, const BrightnessLUT *lut, const Present16LUT *lut16)
+{
+	switch (k)
+	{
+	case KERNEL_COPY: PresentCopy(sOut2, sFrame, W, sAll, lut); break;
+	case KERNEL_16: PresentTo16(sOut16b, sFrame, W, sAll, lut16); break;
+	case KERNEL_SCALE2: PresentScale(sOut2, sFrame, W, sAll, 2, lut); break;
+	default:
+		// Bilinear reads each pixel several times, so brighten it first
+		PresentCopy(sPresent, sFrame, W, sAll, lut);
+		PresentBilinear(sOut2, sPresent, W, H, sAll, 2);
+		break;
+	}
+}
+static bool IsSame(const Kernel k)
+{
+	if (k == KERNEL_16)
+	{
+		return memcmp(sOut16a, sOut16b, sizeof sOut16a) == 0;
+	}
+	const int scale = k == KERNEL_COPY ? 1 : 2;
+	return memcmp(sOut1, sOut2, W * H * scale * scale * sizeof *sOut1) == 0;
+}
+
+
+FEATURE(1, "Present")
+	SCENARIO("Brightness table")
+	{
+		BrightnessLUT lut;
+		GIVEN("the default brightness")
+		GIVEN_END
+
+		WHEN("I make its table");
+			BrightnessLUTInit(&lut, 0);
+		WHEN_END
+
+		THEN("it should not change anything");
+			for (int i = 0; i < 256; i++)
+			{
+				SHOULD_INT_EQUAL(lut.Channel[i], i);
+			}
+		THEN_END
+
+		THEN("a brighter table should saturate");
+			BrightnessLUTInit(&lut, 10);
+			SHOULD_INT_EQUAL(lut.Channel[0], 0);
+			SHOULD_INT_EQUAL(lut.Channel[100], 200);
+			SHOULD_INT_EQUAL(lut.Channel[255], 255);
+		THEN_END
+	}
+	SCENARIO_END
+
+	SCENARIO("16-bit conversion")
+	{
+		Present16LUT lut16;
+		SDL_PixelFormat f;
+		GIVEN("a 565 screen format")
+			f = Format565();
+		GIVEN_END
+
+		WHEN("I make its table with no brightness");
+			Present16LUTInit(&lut16, &f, NULL);
+		WHEN_END
+
+		THEN("pixels should convert like SDL_MapRGB");
+			for (int i = 0; i < 1000; i++)
+			{
+				const Uint32 p = ((Uint32)rand() << 16) ^ (Uint32)rand();
+				Uint16 out;
+				const Rect2i one = { { 0, 0 }, { 1, 1 } };
+				PresentTo16(&out, &p, 1, one, &lut16);
+				SHOULD_INT_EQUAL(out, Ref565(p));
+			}
+		THEN_END
+	}
+	SCENARIO_END
+
+	SCENARIO("Fused brightness")
+	{
+		BrightnessLUT lut;
+		Present16LUT lut16, identity16;
+		bool same[KERNEL_COUNT];
+		double before[KERNEL_COUNT], after[KERNEL_COUNT];
+		GIVEN("a random frame and some brightness")
+			srand(1);
+			for (int i = 0; i < W * H; i++)
+			{
+				sFrame[i] = ((Uint32)rand() << 16) ^ (Uint32)rand();
+			}
+			const SDL_PixelFormat f = Format565();
+			BrightnessLUTInit(&lut, BRIGHTNESS);
+			Present16LUTInit(&lut16, &f, &lut);
+			Present16LUTInit(&identity16, &f, NULL);
+		GIVEN_END
+
+		WHEN("I present it in one pass and in two");
+			const int reps = 20;
+			for (int k = 0; k < KERNEL_COUNT; k++)
+			{
+				PresentTwoPass(k, &identity16);
+				PresentFused(k, &lut, &lut16);
+				same[k] = IsSame(k);
+				clock_t t = clock();
+				for (int i = 0; i < reps; i++)
+				{
+					PresentTwoPass(k, &identity16);
+				}
+				before[k] = (double)(clock() - t) * 1000 / CLOCKS_PER_SEC / reps;
+				t = clock();
+				for (int i = 0; i < reps; i++)
+				{
+					PresentFused(k, &lut, &lut16);
+				}
+				after[k] = (double)(clock() - t) * 1000 / CLOCKS_PER_SEC / reps;
+				printf("\t\t%s: %.2fms before, %.2fms after\n",
+					KernelStr(k), before[k], after[k]);
+			}
+		WHEN_END
+
+		THEN("the pixels should be the same");
+			for (int k = 0; k < KERNEL_COUNT; k++)
+			{
+				SHOULD_BE_TRUE(same[k]);
+			}
+		THEN_END
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("Present features are:", features);
+}
@@ -0,0 +1,104 @@
+#include <cbehave/cbehave.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <profiler.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+static void AddFrame(Profiler *p, const uint64_t updateUs)
+{
+	p->Frame[PROFILE_UPDATE] = updateUs * 1000;
+	ProfilerFrameEnd(p);
+}
+
+
+FEATURE(1, "Frame history")
+	SCENARIO("Read back recent frames")
+	{
+		Profiler p;
+		memset(&p, 0, sizeof p);
+		GIVEN("a profiler with some frames")
+			AddFrame(&p, 10);
+			AddFrame(&p, 20);
+			AddFrame(&p, 30);
+		GIVEN_END
+
+		THEN("the history should return the most recent frame first");
+			SHOULD_INT_EQUAL(p.HistoryCount, 3);
+			SHOULD_INT_EQUAL(
+				(int)ProfilerHistoryGet(&p, 0, PROFILE_UPDATE), 30);
+			SHOULD_INT_EQUAL(
+				(int)ProfilerHistoryGet(&p, 2, PROFILE_UPDATE), 10);
+			SHOULD_INT_EQUAL(
+				(int)ProfilerHistoryGet(&p, 3, PROFILE_UPDATE), 0);
+		THEN_END
+
+		THEN("the totals should include every frame");
+			SHOULD_BE_TRUE(p.Total[PROFILE_UPDATE] == 60000);
+		THEN_END
+	}
+	SCENARIO_END
+
+	SCENARIO("Wrap around the ring buffer")
+	{
+		Profiler p;
+		memset(&p, 0, sizeof p);
+		GIVEN("a profiler with more frames than its history")
+			for (int i = 0; i < PROFILER_HISTORY + 5; i++)
+			{
+				AddFrame(&p, (uint64_t)i);
+			}
+		GIVEN_END
+
+		THEN("only the most recent frames should be kept");
+			SHOULD_INT_EQUAL(p.HistoryCount, PROFILER_HISTORY);
+			SHOULD_INT_EQUAL(
+				(int)ProfilerHistoryGet(&p, 0, PROFILE_UPDATE),
+				PROFILER_HISTORY + 4);
+			SHOULD_INT_EQUAL(
+				(int)ProfilerHistoryGet(&p, PROFILER_HISTORY - 1, PROFILE_UPDATE),
+				5);
+		THEN_END
+	}
+	SCENARIO_END
+
+	SCENARIO("Skip frames with nothing timed")
+	{
+		Profiler p;
+		memset(&p, 0, sizeof p);
+		GIVEN("a profiler with one frame")
+			AddFrame(&p, 10);
+		GIVEN_END
+
+		WHEN("an empty frame ends");
+			ProfilerFrameEnd(&p);
+		WHEN_END
+
+		THEN("it should not be recorded");
+			SHOULD_INT_EQUAL(p.HistoryCount, 1);
+			SHOULD_INT_EQUAL(p.Frames, 1);
+		THEN_END
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("Profiler features are:", features);
+}
@@ -0,0 +1,149 @@
+#include <cbehave/cbehave.h>
+
+#include <slot_pool.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+typedef struct
+{
+	int Value;
+} Item;
+
+static void AddItems(SlotPool *p, const int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		const int idx = SlotPoolAdd(p);
+		Item *item = CArrayGet(p->Items, idx);
+		item->Value = idx;
+	}
+}
+static int SumLive(const SlotPool *p, int *count)
+{
+	int sum = 0;
+	*count = 0;
+	SLOT_POOL_FOREACH(const Item, item, *p)
+		sum += item->Value;
+		(*count)++;
+	SLOT_POOL_FOREACH_END()
+	return sum;
+}
+
+
+FEATURE(1, "Slot pool")
+	SCENARIO("Add and iterate")
+	{
+		CArray items;
+		SlotPool p;
+		GIVEN("a pool with 100 items")
+			CArrayInit(&items, sizeof(Item));
+			SlotPoolInit(&p, &items);
+			AddItems(&p, 100);
+		GIVEN_END
+
+		int count;
+		int sum;
+		WHEN("I remove every odd item and iterate")
+			for (int i = 1; i < 100; i += 2)
+			{
+				SlotPoolRemove(&p, i);
+			}
+			sum = SumLive(&p, &count);
+		WHEN_END
+
+		THEN("only the even items should be visited");
+			SHOULD_INT_EQUAL(count, 50);
+			SHOULD_INT_EQUAL(p.Count, 50);
+			SHOULD_INT_EQUAL(sum, 49 * 50);
+			SHOULD_BE_TRUE(SlotPoolIsLive(&p, 98));
+			SHOULD_BE_TRUE(!SlotPoolIsLive(&p, 99));
+			SHOULD_INT_EQUAL(SlotPoolNext(&p, 99), -1);
+		THEN_END
+
+		SlotPoolTerminate(&p);
+		CArrayTerminate(&items);
+	}
+	SCENARIO_END
+
+	SCENARIO("Reuse slots")
+	{
+		CArray items;
+		SlotPool p;
+		GIVEN("a pool with some removed items")
+			CArrayInit(&items, sizeof(Item));
+			SlotPoolInit(&p, &items);
+			AddItems(&p, 40);
+			SlotPoolRemove(&p, 35);
+			SlotPoolRemove(&p, 3);
+		GIVEN_END
+
+		int first;
+		int second;
+		int third;
+		WHEN("I add more items")
+			first = SlotPoolAdd(&p);
+			second = SlotPoolAdd(&p);
+			third = SlotPoolAdd(&p);
+		WHEN_END
+
+		THEN("the oldest freed slots should be reused first, then new ones");
+			SHOULD_INT_EQUAL(first, 35);
+			SHOULD_INT_EQUAL(second, 3);
+			SHOULD_INT_EQUAL(third, 40);
+			SHOULD_INT_EQUAL((int)items.size, 41);
+			SHOULD_INT_EQUAL(p.Count, 41);
+		THEN_END
+
+		SlotPoolTerminate(&p);
+		CArrayTerminate(&items);
+	}
+	SCENARIO_END
+
+	SCENARIO("Stale indices")
+	{
+		CArray items;
+		SlotPool p;
+		int generation;
+		GIVEN("a pool with an item")
+			CArrayInit(&items, sizeof(Item));
+			SlotPoolInit(&p, &items);
+			AddItems(&p, 1);
+			generation = SlotPoolGetGeneration(&p, 0);
+		GIVEN_END
+
+		WHEN("I remove the item and reuse its slot")
+			SlotPoolRemove(&p, 0);
+			SlotPoolAdd(&p);
+		WHEN_END
+
+		THEN("the old generation should be stale");
+			SHOULD_BE_TRUE(SlotPoolIsLive(&p, 0));
+			SHOULD_BE_TRUE(!SlotPoolIsCurrent(&p, 0, generation));
+			SHOULD_BE_TRUE(
+				SlotPoolIsCurrent(&p, 0, SlotPoolGetGeneration(&p, 0)));
+		THEN_END
+
+		SlotPoolTerminate(&p);
+		CArrayTerminate(&items);
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)}
+	};
+
+	return cbehave_runner("Slot pool features are:", features);
+}
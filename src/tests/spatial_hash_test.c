@@ -0,0 +1,343 @@
+#include <cbehave/cbehave.h>
+
+#include <time.h>
+
+#include <spatial_hash.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+#define CELL_W 16
+#define CELL_H 12
+
+static SpatialHashEntry MakeEntry(
+	const TileItemKind kind, const int id, const Vec2i pos)
+{
+	SpatialHashEntry e;
+	memset(&e, 0, sizeof e);
+	e.Id.Kind = kind;
+	e.Id.Id = id;
+	e.Pos = pos;
+	e.Size = Vec2iNew(8, 6);
+	e.Flags = TILEITEM_IMPASSABLE;
+	return e;
+}
+static int CountQuery(
+	const SpatialHash *h, const Vec2i pos, const int mask)
+{
+	CArray out;
+	CArrayInit(&out, sizeof(SpatialHashEntry));
+	SpatialHashQuery(h, pos, 1, mask, &out);
+	const int count = (int)out.size;
+	CArrayTerminate(&out);
+	return count;
+}
+
+
+FEATURE(1, "Spatial hash updates")
+	SCENARIO("Insert and query")
+	{
+		SpatialHash h;
+		GIVEN("a spatial hash with items in three cells")
+			SpatialHashInit(
+				&h, Vec2iNew(CELL_W * 10, CELL_H * 10),
+				Vec2iNew(CELL_W, CELL_H));
+			SpatialHashEntry e = MakeEntry(KIND_CHARACTER, 0, Vec2iNew(8, 6));
+			SpatialHashInsert(&h, &e);
+			e = MakeEntry(KIND_OBJECT, 0, Vec2iNew(24, 6));
+			e.Flags = TILEITEM_IS_WRECK;
+			SpatialHashInsert(&h, &e);
+			e = MakeEntry(KIND_PARTICLE, 3, Vec2iNew(100, 100));
+			SpatialHashInsert(&h, &e);
+		GIVEN_END
+
+		WHEN("I query around the first cell");
+		WHEN_END
+
+		THEN("only the neighbouring items matching the mask are returned");
+			SHOULD_INT_EQUAL(CountQuery(&h, Vec2iNew(8, 6), 0), 2);
+			SHOULD_INT_EQUAL(
+				CountQuery(&h, Vec2iNew(8, 6), TILEITEM_IMPASSABLE), 1);
+			SHOULD_INT_EQUAL(CountQuery(&h, Vec2iNew(100, 100), 0), 1);
+		THEN_END
+		SpatialHashTerminate(&h);
+	}
+	SCENARIO_END
+	SCENARIO("Remove from middle of cell")
+	{
+		SpatialHash h;
+		GIVEN("a cell with three items")
+			SpatialHashInit(
+				&h, Vec2iNew(CELL_W * 4, CELL_H * 4),
+				Vec2iNew(CELL_W, CELL_H));
+			for (int i = 0; i < 3; i++)
+			{
+				SpatialHashEntry e =
+					MakeEntry(KIND_MOBILEOBJECT, i, Vec2iNew(8, 6));
+				SpatialHashInsert(&h, &e);
+			}
+		GIVEN_END
+
+		WHEN("I remove the first item")
+			ThingId tid;
+			tid.Kind = KIND_MOBILEOBJECT;
+			tid.Id = 0;
+			SpatialHashRemove(&h, tid);
+		WHEN_END
+
+		THEN("the other items can still be found by id");
+			SHOULD_BE_TRUE(SpatialHashGet(&h, tid) == NULL);
+			for (int i = 1; i < 3; i++)
+			{
+				tid.Id = i;
+				const SpatialHashEntry *e = SpatialHashGet(&h, tid);
+				SHOULD_BE_TRUE(e != NULL);
+				SHOULD_INT_EQUAL(e->Id.Id, i);
+			}
+			SHOULD_INT_EQUAL(CountQuery(&h, Vec2iNew(8, 6), 0), 2);
+		THEN_END
+		SpatialHashTerminate(&h);
+	}
+	SCENARIO_END
+	SCENARIO("Move between cells")
+	{
+		SpatialHash h;
+		SpatialHashEntry e;
+		GIVEN("an item in a cell")
+			SpatialHashInit(
+				&h, Vec2iNew(CELL_W * 10, CELL_H * 10),
+				Vec2iNew(CELL_W, CELL_H));
+			e = MakeEntry(KIND_PICKUP, 5, Vec2iNew(8, 6));
+			SpatialHashInsert(&h, &e);
+		GIVEN_END
+
+		WHEN("I move it to a far away cell")
+			e.Pos = Vec2iNew(CELL_W * 8 + 1, CELL_H * 8 + 1);
+			SpatialHashUpdate(&h, &e);
+		WHEN_END
+
+		THEN("it is only found in the new cell");
+			SHOULD_INT_EQUAL(CountQuery(&h, Vec2iNew(8, 6), 0), 0);
+			SHOULD_BE_TRUE(
+				SpatialHashGetCellEntries(&h, Vec2iNew(8, 8)) != NULL);
+			SHOULD_INT_EQUAL(SpatialHashGet(&h, e.Id)->Pos.x, e.Pos.x);
+		THEN_END
+		SpatialHashTerminate(&h);
+	}
+	SCENARIO_END
+FEATURE_END
+
+
+// The previous broadphase: per-tile arrays of ThingId, linear removal, and
+// an indirection into the owning array for every candidate
+#define BENCH_MAP_W 64
+#define BENCH_MAP_H 64
+#define BENCH_ITEMS 1000
+#define BENCH_TICKS 200
+#define BENCH_QUERY_W 8
+#define BENCH_QUERY_H 6
+typedef struct
+{
+	Vec2i Pos;
+	Vec2i Size;
+	int Flags;
+	char Padding[512];	// owning structs are much larger than the item
+} BenchItem;
+static CArray sTiles[BENCH_MAP_W * BENCH_MAP_H];	// of ThingId
+static CArray *GetTile(const Vec2i pos)
+{
+	return &sTiles[(pos.y / CELL_H) * BENCH_MAP_W + pos.x / CELL_W];
+}
+static void TilesRemove(const ThingId tid, const Vec2i pos)
+{
+	CArray *t = GetTile(pos);
+	for (int i = 0; i < (int)t->size; i++)
+	{
+		const ThingId *other = CArrayGet(t, i);
+		if (other->Id == tid.Id && other->Kind == tid.Kind)
+		{
+			CArrayDelete(t, i);
+			return;
+		}
+	}
+}
+static bool Overlaps(const Vec2i pos, const Vec2i pos2, const Vec2i size2)
+{
+	return
+		abs(pos.x - pos2.x) < (BENCH_QUERY_W + size2.x) / 2 &&
+		abs(pos.y - pos2.y) < (BENCH_QUERY_H + size2.y) / 2;
+}
+static int TilesQuery(const CArray *items, const Vec2i pos, const int mask)
+{
+	int count = 0;
+	const Vec2i tv = Vec2iNew(pos.x / CELL_W, pos.y / CELL_H);
+	Vec2i dv;
+	for (dv.y = -1; dv.y <= 1; dv.y++)
+	{
+		for (dv.x = -1; dv.x <= 1; dv.x++)
+		{
+			const Vec2i dtv = Vec2iAdd(tv, dv);
+			if (dtv.x < 0 || dtv.x >= BENCH_MAP_W ||
+				dtv.y < 0 || dtv.y >= BENCH_MAP_H)
+			{
+				continue;
+			}
+			const CArray *t = &sTiles[dtv.y * BENCH_MAP_W + dtv.x];
+			for (int i = 0; i < (int)t->size; i++)
+			{
+				const ThingId *tid = CArrayGet(t, i);
+				const BenchItem *item = CArrayGet(items, tid->Id);
+				if (mask != 0 && !(item->Flags & mask)) continue;
+				if (!Overlaps(pos, item->Pos, item->Size)) continue;
+				count++;
+			}
+		}
+	}
+	return count;
+}
+// Items are clustered in one part of the map, like a big firefight
+#define BENCH_AREA_W 16
+#define BENCH_AREA_H 16
+static Vec2i RandomPos(void)
+{
+	return Vec2iNew(
+		rand() % (BENCH_AREA_W * CELL_W), rand() % (BENCH_AREA_H * CELL_H));
+}
+static Vec2i Jitter(const Vec2i pos)
+{
+	return Vec2iClamp(
+		Vec2iAdd(pos, Vec2iNew(rand() % 9 - 4, rand() % 9 - 4)),
+		Vec2iZero(),
+		Vec2iNew(BENCH_MAP_W * CELL_W - 1, BENCH_MAP_H * CELL_H - 1));
+}
+
+FEATURE(2, "Spatial hash benchmark")
+	SCENARIO("Move and query many items")
+	{
+		CArray items;
+		SpatialHash h;
+		GIVEN("many items in both the tile arrays and the spatial hash")
+			CArrayInit(&items, sizeof(BenchItem));
+			SpatialHashInit(
+				&h, Vec2iNew(BENCH_MAP_W * CELL_W, BENCH_MAP_H * CELL_H),
+				Vec2iNew(CELL_W, CELL_H));
+			srand(1);
+			for (int i = 0; i < BENCH_ITEMS; i++)
+			{
+				BenchItem item;
+				memset(&item, 0, sizeof item);
+				item.Pos = RandomPos();
+				item.Size = Vec2iNew(4, 4);
+				item.Flags = (i % 3) ? TILEITEM_CAN_BE_SHOT : 0;
+				CArrayPushBack(&items, &item);
+				ThingId tid;
+				tid.Kind = KIND_MOBILEOBJECT;
+				tid.Id = i;
+				CArray *t = GetTile(item.Pos);
+				if (t->elemSize == 0) CArrayInit(t, sizeof(ThingId));
+				CArrayPushBack(t, &tid);
+				SpatialHashEntry e = MakeEntry(tid.Kind, i, item.Pos);
+				e.Size = item.Size;
+				e.Flags = item.Flags;
+				SpatialHashInsert(&h, &e);
+			}
+		GIVEN_END
+
+		int tilesHits = 0;
+		int hashHits = 0;
+		clock_t tilesTime = 0;
+		clock_t hashTime = 0;
+		WHEN("I move and query every item each tick")
+			CArray out;
+			CArrayInit(&out, sizeof(SpatialHashEntry));
+			Vec2i *newPos;
+			CMALLOC(newPos, BENCH_ITEMS * sizeof *newPos);
+			for (int tick = 0; tick < BENCH_TICKS; tick++)
+			{
+				for (int i = 0; i < BENCH_ITEMS; i++)
+				{
+					const BenchItem *item = CArrayGet(&items, i);
+					newPos[i] = Jitter(item->Pos);
+				}
+
+				clock_t start = clock();
+				for (int i = 0; i < BENCH_ITEMS; i++)
+				{
+					BenchItem *item = CArrayGet(&items, i);
+					ThingId tid;
+					tid.Kind = KIND_MOBILEOBJECT;
+					tid.Id = i;
+					if (GetTile(newPos[i]) != GetTile(item->Pos))
+					{
+						TilesRemove(tid, item->Pos);
+						CArray *t = GetTile(newPos[i]);
+						if (t->elemSize == 0) CArrayInit(t, sizeof(ThingId));
+						CArrayPushBack(t, &tid);
+					}
+					item->Pos = newPos[i];
+					tilesHits += TilesQuery(
+						&items, newPos[i], TILEITEM_CAN_BE_SHOT);
+				}
+				tilesTime += clock() - start;
+
+				start = clock();
+				for (int i = 0; i < BENCH_ITEMS; i++)
+				{
+					ThingId tid;
+					tid.Kind = KIND_MOBILEOBJECT;
+					tid.Id = i;
+					SpatialHashEntry e = *SpatialHashGet(&h, tid);
+					e.Pos = newPos[i];
+					SpatialHashUpdate(&h, &e);
+					SpatialHashQuery(
+						&h, newPos[i], 1, TILEITEM_CAN_BE_SHOT, &out);
+					for (int j = 0; j < (int)out.size; j++)
+					{
+						const SpatialHashEntry *o = CArrayGet(&out, j);
+						if (Overlaps(newPos[i], o->Pos, o->Size)) hashHits++;
+					}
+					CArrayClear(&out);
+				}
+				hashTime += clock() - start;
+			}
+			CFREE(newPos);
+			CArrayTerminate(&out);
+			printf(
+				"\t%d items x %d ticks: tile arrays %.1fms, "
+				"spatial hash %.1fms\n",
+				BENCH_ITEMS, BENCH_TICKS,
+				tilesTime * 1000.0 / CLOCKS_PER_SEC,
+				hashTime * 1000.0 / CLOCKS_PER_SEC);
+		WHEN_END
+
+		THEN("both broadphases find the same candidates");
+			SHOULD_INT_EQUAL(hashHits, tilesHits);
+		THEN_END
+		for (int i = 0; i < BENCH_MAP_W * BENCH_MAP_H; i++)
+		{
+			CArrayTerminate(&sTiles[i]);
+		}
+		CArrayTerminate(&items);
+		SpatialHashTerminate(&h);
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)},
+		{feature_idx(2)}
+	};
+
+	return cbehave_runner("Spatial hash features are:", features);
+}
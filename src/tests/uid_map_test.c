@@ -0,0 +1,198 @@
+#include <cbehave/cbehave.h>
+
+#include <time.h>
+
+#include <uid_map.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+
+FEATURE(1, "UID map")
+	SCENARIO("Set and get")
+	{
+		UIDMap m;
+		GIVEN("a UID map with some UIDs")
+			UIDMapInit(&m);
+			UIDMapSet(&m, 0, 3);
+			UIDMapSet(&m, 7, 1);
+			UIDMapSet(&m, -5, 2);
+		GIVEN_END
+
+		WHEN("I update one UID")
+			UIDMapSet(&m, 7, 9);
+		WHEN_END
+
+		THEN("I should get the latest indices, and -1 for unknown UIDs");
+			SHOULD_INT_EQUAL(UIDMapGet(&m, 0), 3);
+			SHOULD_INT_EQUAL(UIDMapGet(&m, 7), 9);
+			SHOULD_INT_EQUAL(UIDMapGet(&m, -5), 2);
+			SHOULD_INT_EQUAL(UIDMapGet(&m, 1), -1);
+			SHOULD_INT_EQUAL(m.Count, 3);
+		THEN_END
+
+		UIDMapTerminate(&m);
+	}
+	SCENARIO_END
+
+	SCENARIO("Remove and grow")
+	{
+		UIDMap m;
+		GIVEN("a UID map with enough UIDs to grow and collide")
+			UIDMapInit(&m);
+			for (int i = 0; i < 1000; i++)
+			{
+				UIDMapSet(&m, i, i * 2);
+			}
+		GIVEN_END
+
+		WHEN("I remove every third UID")
+			for (int i = 0; i < 1000; i += 3)
+			{
+				UIDMapRemove(&m, i);
+			}
+		WHEN_END
+
+		THEN("the removed UIDs should be gone and the rest still found");
+			bool allCorrect = true;
+			for (int i = 0; i < 1000; i++)
+			{
+				const int expected = (i % 3) == 0 ? -1 : i * 2;
+				allCorrect = allCorrect && UIDMapGet(&m, i) == expected;
+			}
+			SHOULD_BE_TRUE(allCorrect);
+			SHOULD_INT_EQUAL(m.Count, 666);
+		THEN_END
+
+		UIDMapTerminate(&m);
+	}
+	SCENARIO_END
+
+	SCENARIO("Remove only if index matches")
+	{
+		UIDMap m;
+		GIVEN("a UID map with a UID")
+			UIDMapInit(&m);
+			UIDMapSet(&m, 4, 1);
+		GIVEN_END
+
+		WHEN("I reuse a different slot that used to have that UID")
+			UIDMapRemoveIndex(&m, 4, 2);
+		WHEN_END
+
+		THEN("the UID should still be mapped");
+			SHOULD_INT_EQUAL(UIDMapGet(&m, 4), 1);
+		THEN_END
+
+		WHEN("I reuse the slot it maps to")
+			UIDMapRemoveIndex(&m, 4, 1);
+		WHEN_END
+
+		THEN("the UID should be gone");
+			SHOULD_INT_EQUAL(UIDMapGet(&m, 4), -1);
+		THEN_END
+
+		UIDMapTerminate(&m);
+	}
+	SCENARIO_END
+FEATURE_END
+
+// Look up every live entity once per tick, with some entities dying and
+// being replaced each tick, like a busy wave
+#define BENCH_LOOKUPS 200000
+#define BENCH_CHURN 16
+typedef struct
+{
+	int UID;
+	bool isInUse;
+} BenchEntity;
+static int ScanGet(const CArray *entities, const int uid)
+{
+	for (int i = 0; i < (int)entities->size; i++)
+	{
+		const BenchEntity *e = CArrayGet(entities, i);
+		if (e->UID == uid) return i;
+	}
+	return -1;
+}
+static double Bench(const int count, const bool useMap, int *found)
+{
+	CArray entities;
+	CArrayInit(&entities, sizeof(BenchEntity));
+	UIDMap m;
+	UIDMapInit(&m);
+	int nextUID = 0;
+	for (int i = 0; i < count; i++)
+	{
+		BenchEntity e;
+		e.UID = nextUID++;
+		e.isInUse = true;
+		CArrayPushBack(&entities, &e);
+		UIDMapSet(&m, e.UID, i);
+	}
+	srand(1);
+	const clock_t start = clock();
+	for (int lookups = 0; lookups < BENCH_LOOKUPS;)
+	{
+		for (int i = 0; i < BENCH_CHURN; i++)
+		{
+			const int slot = rand() % count;
+			BenchEntity *e = CArrayGet(&entities, slot);
+			UIDMapRemoveIndex(&m, e->UID, slot);
+			e->UID = nextUID++;
+			UIDMapSet(&m, e->UID, slot);
+		}
+		for (int i = 0; i < count && lookups < BENCH_LOOKUPS; i++, lookups++)
+		{
+			const int uid = nextUID - 1 - rand() % count;
+			const int idx = useMap ? UIDMapGet(&m, uid) : ScanGet(&entities, uid);
+			if (idx >= 0) (*found)++;
+		}
+	}
+	const clock_t elapsed = clock() - start;
+	UIDMapTerminate(&m);
+	CArrayTerminate(&entities);
+	return elapsed * 1e9 / CLOCKS_PER_SEC / BENCH_LOOKUPS;
+}
+
+FEATURE(2, "UID map benchmark")
+	SCENARIO("Lookup cost as entity count grows")
+	{
+		int scanFound = 0;
+		int mapFound = 0;
+		WHEN("I look up entities by UID with a scan and with the map")
+			for (int count = 64; count <= 4096; count *= 4)
+			{
+				const double scanNs = Bench(count, false, &scanFound);
+				const double mapNs = Bench(count, true, &mapFound);
+				printf(
+					"\t%d entities: scan %.1fns/lookup, map %.1fns/lookup\n",
+					count, scanNs, mapNs);
+			}
+		WHEN_END
+
+		THEN("both should find the same entities");
+			SHOULD_INT_EQUAL(mapFound, scanFound);
+		THEN_END
+	}
+	SCENARIO_END
+FEATURE_END
+
+int main(void)
+{
+	cbehave_feature features[] =
+	{
+		{feature_idx(1)},
+		{feature_idx(2)}
+	};
+
+	return cbehave_runner("UID map features are:", features);
+}